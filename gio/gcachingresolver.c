@@ -0,0 +1,1108 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2024 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib.h>
+#include "glibintl.h"
+
+#include "gcachingresolver.h"
+#include "gcancellable.h"
+#include "ginetaddress.h"
+#include "gioerror.h"
+#include "gnetworkmonitor.h"
+#include "gtask.h"
+#include "gthreadedresolver.h"
+#include "gthreadedresolver-private.h"
+
+/**
+ * GCachingResolver:
+ *
+ * `GCachingResolver` is a [class@Gio.Resolver] which caches the results of
+ * another resolver in memory.
+ *
+ * Every lookup is forwarded to the
+ * [property@Gio.CachingResolver:base-resolver] the first time, and its
+ * result is then kept for a while, so that repeated lookups of the same name,
+ * address or records (for example when opening many connections to the same
+ * host with [class@Gio.SocketClient]) are answered without going to the
+ * system resolver again.
+ *
+ * Records are kept for as long as their DNS time-to-live allows, if the base
+ * resolver reports it (the default [class@Gio.Resolver] does). Other results
+ * are kept for [property@Gio.CachingResolver:default-ttl] seconds, and
+ * lookups which failed with %G_RESOLVER_ERROR_NOT_FOUND for
+ * [property@Gio.CachingResolver:negative-ttl] seconds. Other errors are never
+ * cached. At most [property@Gio.CachingResolver:max-entries] results are
+ * kept, the least recently used ones being dropped first.
+ *
+ * Concurrent asynchronous lookups of the same query are coalesced into a
+ * single lookup on the base resolver.
+ *
+ * The cache is cleared whenever the resolver emits [signal@Gio.Resolver::reload],
+ * which happens when the base resolver emits it and when the default
+ * [iface@Gio.NetworkMonitor] reports a change in the network configuration.
+ * It can also be cleared explicitly with [method@Gio.CachingResolver.clear].
+ *
+ * To use it for all lookups in an application, set it as the default
+ * resolver:
+ * ```c
+ * g_autoptr(GResolver) base_resolver = g_resolver_get_default ();
+ * g_autoptr(GResolver) resolver = g_caching_resolver_new (base_resolver);
+ *
+ * g_resolver_set_default (resolver);
+ * ```
+ *
+ * Since: 2.82
+ */
+
+typedef enum {
+  QUERY_BY_NAME,
+  QUERY_BY_ADDRESS,
+  QUERY_RECORDS,
+} QueryType;
+
+typedef struct {
+  QueryType type;
+  gchar *name;  /* (owned) (nullable) hostname or rrname */
+  GInetAddress *address;  /* (owned) (nullable) */
+  GResolverNameLookupFlags flags;
+  GResolverRecordType record_type;
+} Query;
+
+typedef struct {
+  gchar *key;  /* (owned) */
+  QueryType type;
+  gint64 expiry;  /* monotonic time, in microseconds */
+  gpointer value;  /* (owned) (nullable) */
+  GError *error;  /* (owned) (nullable) */
+  GList link;  /* in GCachingResolver.lru */
+} CacheEntry;
+
+typedef struct {
+  gint ref_count;  /* (atomic) */
+  GCachingResolver *resolver;  /* (owned) */
+  gchar *key;  /* (owned) */
+  Query query;
+  guint generation;  /* of the cache when the lookup was started */
+  GPtrArray *waiters;  /* (owned) (nullable) (element-type Waiter), protected by GCachingResolver.lock */
+} PendingLookup;
+
+typedef struct {
+  GTask *task;  /* (owned) */
+  GSource *cancel_source;  /* (owned) (nullable) */
+} Waiter;
+
+struct _GCachingResolver
+{
+  GResolver parent_instance;
+
+  GResolver *base_resolver;  /* (owned) */
+  gulong base_reload_id;
+  GNetworkMonitor *network_monitor;  /* (owned) */
+  gulong network_changed_id;
+
+  GMutex lock;
+  GHashTable *cache;  /* (owned) (element-type utf8 CacheEntry), protected by @lock */
+  GQueue lru;  /* (element-type CacheEntry) most recently used first, protected by @lock */
+  GHashTable *pending;  /* (owned) (element-type utf8 PendingLookup), protected by @lock */
+  guint generation;  /* incremented when the cache is cleared, protected by @lock */
+  guint max_entries;  /* protected by @lock */
+  guint default_ttl;  /* protected by @lock */
+  guint negative_ttl;  /* protected by @lock */
+};
+
+typedef GResolverClass GCachingResolverClass;
+
+typedef enum {
+  PROP_BASE_RESOLVER = 1,
+  PROP_MAX_ENTRIES,
+  PROP_DEFAULT_TTL,
+  PROP_NEGATIVE_TTL,
+} GCachingResolverProperty;
+
+static GParamSpec *props[PROP_NEGATIVE_TTL + 1] = { NULL, };
+
+G_DEFINE_TYPE (GCachingResolver, g_caching_resolver, G_TYPE_RESOLVER)
+
+static void
+free_records (GList *records)
+{
+  g_list_free_full (records, (GDestroyNotify) g_variant_unref);
+}
+
+static gpointer
+copy_object (gconstpointer src,
+             gpointer      user_data)
+{
+  return g_object_ref ((gpointer) src);
+}
+
+static gpointer
+copy_variant (gconstpointer src,
+              gpointer      user_data)
+{
+  return g_variant_ref ((GVariant *) src);
+}
+
+static gpointer
+value_copy (QueryType     type,
+            gconstpointer value)
+{
+  switch (type)
+    {
+    case QUERY_BY_NAME:
+      return g_list_copy_deep ((GList *) value, copy_object, NULL);
+    case QUERY_BY_ADDRESS:
+      return g_strdup (value);
+    case QUERY_RECORDS:
+      return g_list_copy_deep ((GList *) value, copy_variant, NULL);
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static GDestroyNotify
+value_free_func (QueryType type)
+{
+  switch (type)
+    {
+    case QUERY_BY_NAME:
+      return (GDestroyNotify) g_resolver_free_addresses;
+    case QUERY_BY_ADDRESS:
+      return g_free;
+    case QUERY_RECORDS:
+      return (GDestroyNotify) free_records;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* Names are case-insensitive in DNS, so they are folded in the key. */
+static gchar *
+query_key (const Query *query)
+{
+  gchar *key, *folded;
+
+  switch (query->type)
+    {
+    case QUERY_BY_NAME:
+      folded = g_ascii_strdown (query->name, -1);
+      key = g_strdup_printf ("n%u:%s", (guint) query->flags, folded);
+      g_free (folded);
+      return key;
+    case QUERY_BY_ADDRESS:
+      folded = g_inet_address_to_string (query->address);
+      key = g_strconcat ("a:", folded, NULL);
+      g_free (folded);
+      return key;
+    case QUERY_RECORDS:
+      folded = g_ascii_strdown (query->name, -1);
+      key = g_strdup_printf ("r%u:%s", (guint) query->record_type, folded);
+      g_free (folded);
+      return key;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+query_copy (Query       *dest,
+            const Query *src)
+{
+  *dest = *src;
+  dest->name = g_strdup (src->name);
+  if (src->address != NULL)
+    dest->address = g_object_ref (src->address);
+}
+
+static void
+query_clear (Query *query)
+{
+  g_clear_pointer (&query->name, g_free);
+  g_clear_object (&query->address);
+}
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+  g_free (entry->key);
+  if (entry->value != NULL)
+    value_free_func (entry->type) (entry->value);
+  g_clear_error (&entry->error);
+  g_free (entry);
+}
+
+static void
+cache_remove_unlocked (GCachingResolver *self,
+                       CacheEntry       *entry)
+{
+  g_queue_unlink (&self->lru, &entry->link);
+  g_hash_table_remove (self->cache, entry->key);
+}
+
+static void
+cache_trim_unlocked (GCachingResolver *self)
+{
+  while (self->lru.length > self->max_entries)
+    cache_remove_unlocked (self, self->lru.tail->data);
+}
+
+/* Returns %TRUE on a cache hit, in which case exactly one of @value and
+ * @error is set. */
+static gboolean
+cache_lookup_unlocked (GCachingResolver  *self,
+                       const gchar       *key,
+                       QueryType          type,
+                       gpointer          *value,
+                       GError           **error)
+{
+  CacheEntry *entry;
+
+  entry = g_hash_table_lookup (self->cache, key);
+  if (entry == NULL)
+    return FALSE;
+
+  if (entry->expiry <= g_get_monotonic_time ())
+    {
+      cache_remove_unlocked (self, entry);
+      return FALSE;
+    }
+
+  g_queue_unlink (&self->lru, &entry->link);
+  g_queue_push_head_link (&self->lru, &entry->link);
+
+  if (entry->error != NULL)
+    {
+      *value = NULL;
+      *error = g_error_copy (entry->error);
+    }
+  else
+    *value = value_copy (type, entry->value);
+
+  return TRUE;
+}
+
+/* @ttl is in seconds, or %G_MAXUINT32 if the base resolver did not say. */
+static void
+cache_store_unlocked (GCachingResolver *self,
+                      const gchar      *key,
+                      QueryType         type,
+                      gconstpointer     value,
+                      const GError     *error,
+                      guint32           ttl)
+{
+  CacheEntry *entry;
+
+  if (error != NULL)
+    {
+      if (!g_error_matches (error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND))
+        return;
+      ttl = self->negative_ttl;
+    }
+  else if (ttl == G_MAXUINT32)
+    ttl = self->default_ttl;
+
+  if (self->max_entries == 0 || ttl == 0)
+    return;
+
+  entry = g_hash_table_lookup (self->cache, key);
+  if (entry != NULL)
+    cache_remove_unlocked (self, entry);
+
+  entry = g_new0 (CacheEntry, 1);
+  entry->key = g_strdup (key);
+  entry->type = type;
+  entry->expiry = g_get_monotonic_time () + (gint64) ttl * G_USEC_PER_SEC;
+  entry->link.data = entry;
+  if (error != NULL)
+    entry->error = g_error_copy (error);
+  else
+    entry->value = value_copy (type, value);
+
+  g_hash_table_insert (self->cache, entry->key, entry);
+  g_queue_push_head_link (&self->lru, &entry->link);
+
+  cache_trim_unlocked (self);
+}
+
+static gpointer
+base_lookup (GCachingResolver  *self,
+             const Query       *query,
+             guint32           *ttl,
+             GCancellable      *cancellable,
+             GError           **error)
+{
+  *ttl = G_MAXUINT32;
+
+  switch (query->type)
+    {
+    case QUERY_BY_NAME:
+      return g_resolver_lookup_by_name_with_flags (self->base_resolver,
+                                                   query->name,
+                                                   query->flags,
+                                                   cancellable,
+                                                   error);
+    case QUERY_BY_ADDRESS:
+      return g_resolver_lookup_by_address (self->base_resolver,
+                                           query->address,
+                                           cancellable,
+                                           error);
+    case QUERY_RECORDS:
+      if (G_IS_THREADED_RESOLVER (self->base_resolver))
+        return g_threaded_resolver_lookup_records_with_ttl (G_THREADED_RESOLVER (self->base_resolver),
+                                                            query->name,
+                                                            query->record_type,
+                                                            ttl,
+                                                            cancellable,
+                                                            error);
+      return g_resolver_lookup_records (self->base_resolver,
+                                        query->name,
+                                        query->record_type,
+                                        cancellable,
+                                        error);
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static gpointer
+lookup_sync (GCachingResolver  *self,
+             const Query       *query,
+             GCancellable      *cancellable,
+             GError           **error)
+{
+  gchar *key;
+  gpointer value = NULL;
+  GError *local_error = NULL;
+  guint32 ttl;
+  guint generation;
+  gboolean hit;
+
+  key = query_key (query);
+
+  g_mutex_lock (&self->lock);
+  hit = cache_lookup_unlocked (self, key, query->type, &value, &local_error);
+  generation = self->generation;
+  g_mutex_unlock (&self->lock);
+
+  if (!hit)
+    {
+      value = base_lookup (self, query, &ttl, cancellable, &local_error);
+
+      /* Don't store a result from before the cache was cleared */
+      g_mutex_lock (&self->lock);
+      if (generation == self->generation)
+        cache_store_unlocked (self, key, query->type, value, local_error, ttl);
+      g_mutex_unlock (&self->lock);
+    }
+
+  g_free (key);
+
+  if (local_error != NULL)
+    g_propagate_error (error, local_error);
+
+  return value;
+}
+
+static PendingLookup *
+pending_lookup_ref (PendingLookup *pending)
+{
+  g_atomic_int_inc (&pending->ref_count);
+  return pending;
+}
+
+static void
+pending_lookup_unref (PendingLookup *pending)
+{
+  if (!g_atomic_int_dec_and_test (&pending->ref_count))
+    return;
+
+  g_assert (pending->waiters == NULL || pending->waiters->len == 0);
+
+  g_clear_pointer (&pending->waiters, g_ptr_array_unref);
+  query_clear (&pending->query);
+  g_free (pending->key);
+  g_object_unref (pending->resolver);
+  g_free (pending);
+}
+
+static void
+waiter_free (Waiter *waiter)
+{
+  if (waiter->cancel_source != NULL)
+    {
+      g_source_destroy (waiter->cancel_source);
+      g_source_unref (waiter->cancel_source);
+    }
+
+  g_object_unref (waiter->task);
+  g_free (waiter);
+}
+
+static void
+return_result (GTask     *task,
+               QueryType  type,
+               gpointer   value,
+               GError    *error)
+{
+  if (error != NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_pointer (task, value, value_free_func (type));
+}
+
+/* A waiter whose cancellable is cancelled returns straight away, without
+ * cancelling the lookup shared with other waiters. */
+static gboolean
+waiter_cancelled_cb (GCancellable *cancellable,
+                     gpointer      user_data)
+{
+  GTask *task = user_data;
+  GCachingResolver *self = g_task_get_source_object (task);
+  PendingLookup *pending = g_task_get_task_data (task);
+  Waiter *waiter = NULL;
+  guint i;
+
+  g_mutex_lock (&self->lock);
+
+  for (i = 0; pending->waiters != NULL && i < pending->waiters->len; i++)
+    {
+      Waiter *w = g_ptr_array_index (pending->waiters, i);
+
+      if (w->task == task)
+        {
+          waiter = g_ptr_array_steal_index (pending->waiters, i);
+          break;
+        }
+    }
+
+  g_mutex_unlock (&self->lock);
+
+  if (waiter != NULL)
+    {
+      g_task_return_error_if_cancelled (task);
+      waiter_free (waiter);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+base_lookup_cb (GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  PendingLookup *pending = user_data;
+  GCachingResolver *self = pending->resolver;
+  QueryType type = pending->query.type;
+  gpointer value = NULL;
+  GError *error = NULL;
+  guint32 ttl = G_MAXUINT32;
+  GPtrArray *waiters;
+  guint i;
+
+  switch (type)
+    {
+    case QUERY_BY_NAME:
+      if (pending->query.flags == G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT)
+        value = g_resolver_lookup_by_name_finish (self->base_resolver, result, &error);
+      else
+        value = g_resolver_lookup_by_name_with_flags_finish (self->base_resolver, result, &error);
+      break;
+    case QUERY_BY_ADDRESS:
+      value = g_resolver_lookup_by_address_finish (self->base_resolver, result, &error);
+      break;
+    case QUERY_RECORDS:
+      value = g_resolver_lookup_records_finish (self->base_resolver, result, &error);
+      if (value != NULL && G_IS_THREADED_RESOLVER (self->base_resolver))
+        ttl = g_threaded_resolver_get_records_ttl (result);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  g_mutex_lock (&self->lock);
+
+  if (g_hash_table_lookup (self->pending, pending->key) == pending)
+    g_hash_table_remove (self->pending, pending->key);
+
+  /* Don't store a result from before the cache was cleared */
+  if (pending->generation == self->generation)
+    cache_store_unlocked (self, pending->key, type, value, error, ttl);
+  waiters = g_steal_pointer (&pending->waiters);
+
+  g_mutex_unlock (&self->lock);
+
+  for (i = 0; i < waiters->len; i++)
+    {
+      Waiter *waiter = g_ptr_array_index (waiters, i);
+
+      if (error != NULL)
+        return_result (waiter->task, type, NULL, g_error_copy (error));
+      else
+        return_result (waiter->task, type, value_copy (type, value), NULL);
+
+      waiter_free (waiter);
+    }
+
+  g_ptr_array_unref (waiters);
+
+  if (value != NULL)
+    value_free_func (type) (value);
+  g_clear_error (&error);
+
+  pending_lookup_unref (pending);
+}
+
+static void
+base_lookup_async (PendingLookup *pending)
+{
+  GResolver *base_resolver = pending->resolver->base_resolver;
+  const Query *query = &pending->query;
+
+  /* The base lookup is not cancellable, as it is shared by all waiters. */
+  switch (query->type)
+    {
+    case QUERY_BY_NAME:
+      if (query->flags == G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT)
+        g_resolver_lookup_by_name_async (base_resolver, query->name, NULL,
+                                         base_lookup_cb, pending_lookup_ref (pending));
+      else
+        g_resolver_lookup_by_name_with_flags_async (base_resolver, query->name,
+                                                    query->flags, NULL,
+                                                    base_lookup_cb, pending_lookup_ref (pending));
+      break;
+    case QUERY_BY_ADDRESS:
+      g_resolver_lookup_by_address_async (base_resolver, query->address, NULL,
+                                          base_lookup_cb, pending_lookup_ref (pending));
+      break;
+    case QUERY_RECORDS:
+      g_resolver_lookup_records_async (base_resolver, query->name,
+                                       query->record_type, NULL,
+                                       base_lookup_cb, pending_lookup_ref (pending));
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+lookup_async (GCachingResolver    *self,
+              const Query         *query,
+              GCancellable        *cancellable,
+              GAsyncReadyCallback  callback,
+              gpointer             user_data,
+              gpointer             source_tag)
+{
+  GTask *task;
+  gchar *key;
+  gpointer value = NULL;
+  GError *error = NULL;
+  PendingLookup *pending;
+  Waiter *waiter;
+  gboolean start = FALSE;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+  g_task_set_name (task, "[gio] caching resolver lookup");
+
+  key = query_key (query);
+
+  g_mutex_lock (&self->lock);
+
+  if (cache_lookup_unlocked (self, key, query->type, &value, &error))
+    {
+      g_mutex_unlock (&self->lock);
+
+      return_result (task, query->type, value, error);
+      g_object_unref (task);
+      g_free (key);
+      return;
+    }
+
+  pending = g_hash_table_lookup (self->pending, key);
+  if (pending == NULL)
+    {
+      pending = g_new0 (PendingLookup, 1);
+      pending->ref_count = 1;
+      pending->resolver = g_object_ref (self);
+      pending->key = g_steal_pointer (&key);
+      query_copy (&pending->query, query);
+      pending->generation = self->generation;
+      pending->waiters = g_ptr_array_new ();
+
+      g_hash_table_insert (self->pending, pending->key, pending);
+      start = TRUE;
+    }
+
+  g_task_set_task_data (task, pending_lookup_ref (pending),
+                        (GDestroyNotify) pending_lookup_unref);
+
+  waiter = g_new0 (Waiter, 1);
+  waiter->task = g_steal_pointer (&task);
+  if (cancellable != NULL)
+    {
+      waiter->cancel_source = g_cancellable_source_new (cancellable);
+      g_task_attach_source (waiter->task, waiter->cancel_source,
+                            (GSourceFunc) waiter_cancelled_cb);
+    }
+  g_ptr_array_add (pending->waiters, waiter);
+
+  if (start)
+    pending_lookup_ref (pending);
+
+  g_mutex_unlock (&self->lock);
+
+  if (start)
+    {
+      base_lookup_async (pending);
+      pending_lookup_unref (pending);
+    }
+
+  g_free (key);
+}
+
+static gpointer
+lookup_finish (GCachingResolver  *self,
+               GAsyncResult      *result,
+               GError           **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static GList *
+lookup_by_name_with_flags (GResolver                 *resolver,
+                           const gchar               *hostname,
+                           GResolverNameLookupFlags   flags,
+                           GCancellable              *cancellable,
+                           GError                   **error)
+{
+  Query query = { QUERY_BY_NAME, (gchar *) hostname, NULL, flags, 0 };
+
+  return lookup_sync (G_CACHING_RESOLVER (resolver), &query, cancellable, error);
+}
+
+static GList *
+lookup_by_name (GResolver     *resolver,
+                const gchar   *hostname,
+                GCancellable  *cancellable,
+                GError       **error)
+{
+  return lookup_by_name_with_flags (resolver, hostname,
+                                    G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT,
+                                    cancellable, error);
+}
+
+static void
+lookup_by_name_with_flags_async (GResolver                *resolver,
+                                 const gchar              *hostname,
+                                 GResolverNameLookupFlags  flags,
+                                 GCancellable             *cancellable,
+                                 GAsyncReadyCallback       callback,
+                                 gpointer                  user_data)
+{
+  Query query = { QUERY_BY_NAME, (gchar *) hostname, NULL, flags, 0 };
+
+  lookup_async (G_CACHING_RESOLVER (resolver), &query, cancellable,
+                callback, user_data, lookup_by_name_with_flags_async);
+}
+
+static void
+lookup_by_name_async (GResolver           *resolver,
+                      const gchar         *hostname,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             user_data)
+{
+  lookup_by_name_with_flags_async (resolver, hostname,
+                                   G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT,
+                                   cancellable, callback, user_data);
+}
+
+static GList *
+lookup_by_name_finish (GResolver     *resolver,
+                       GAsyncResult  *result,
+                       GError       **error)
+{
+  return lookup_finish (G_CACHING_RESOLVER (resolver), result, error);
+}
+
+static gchar *
+lookup_by_address (GResolver     *resolver,
+                   GInetAddress  *address,
+                   GCancellable  *cancellable,
+                   GError       **error)
+{
+  Query query = { QUERY_BY_ADDRESS, NULL, address, 0, 0 };
+
+  return lookup_sync (G_CACHING_RESOLVER (resolver), &query, cancellable, error);
+}
+
+static void
+lookup_by_address_async (GResolver           *resolver,
+                         GInetAddress        *address,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             user_data)
+{
+  Query query = { QUERY_BY_ADDRESS, NULL, address, 0, 0 };
+
+  lookup_async (G_CACHING_RESOLVER (resolver), &query, cancellable,
+                callback, user_data, lookup_by_address_async);
+}
+
+static gchar *
+lookup_by_address_finish (GResolver     *resolver,
+                          GAsyncResult  *result,
+                          GError       **error)
+{
+  return lookup_finish (G_CACHING_RESOLVER (resolver), result, error);
+}
+
+static GList *
+lookup_records (GResolver            *resolver,
+                const gchar          *rrname,
+                GResolverRecordType   record_type,
+                GCancellable         *cancellable,
+                GError              **error)
+{
+  Query query = { QUERY_RECORDS, (gchar *) rrname, NULL, 0, record_type };
+
+  return lookup_sync (G_CACHING_RESOLVER (resolver), &query, cancellable, error);
+}
+
+static void
+lookup_records_async (GResolver           *resolver,
+                      const gchar         *rrname,
+                      GResolverRecordType  record_type,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             user_data)
+{
+  Query query = { QUERY_RECORDS, (gchar *) rrname, NULL, 0, record_type };
+
+  lookup_async (G_CACHING_RESOLVER (resolver), &query, cancellable,
+                callback, user_data, lookup_records_async);
+}
+
+static GList *
+lookup_records_finish (GResolver     *resolver,
+                       GAsyncResult  *result,
+                       GError       **error)
+{
+  return lookup_finish (G_CACHING_RESOLVER (resolver), result, error);
+}
+
+static void
+g_caching_resolver_reload (GResolver *resolver)
+{
+  g_caching_resolver_clear (G_CACHING_RESOLVER (resolver));
+}
+
+static void
+emit_reload (GCachingResolver *self)
+{
+  g_signal_emit_by_name (self, "reload");
+}
+
+static void
+network_changed_cb (GNetworkMonitor *monitor,
+                    gboolean         network_available,
+                    gpointer         user_data)
+{
+  emit_reload (G_CACHING_RESOLVER (user_data));
+}
+
+static void
+g_caching_resolver_init (GCachingResolver *self)
+{
+  g_mutex_init (&self->lock);
+  self->cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       NULL, (GDestroyNotify) cache_entry_free);
+  self->pending = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         NULL, (GDestroyNotify) pending_lookup_unref);
+  g_queue_init (&self->lru);
+  self->max_entries = 256;
+  self->default_ttl = 60;
+  self->negative_ttl = 10;
+}
+
+static void
+g_caching_resolver_constructed (GObject *object)
+{
+  GCachingResolver *self = G_CACHING_RESOLVER (object);
+
+  G_OBJECT_CLASS (g_caching_resolver_parent_class)->constructed (object);
+
+  if (self->base_resolver == NULL)
+    self->base_resolver = g_resolver_get_default ();
+
+  self->base_reload_id =
+    g_signal_connect_swapped (self->base_resolver, "reload",
+                              G_CALLBACK (emit_reload), self);
+
+  self->network_monitor = g_object_ref (g_network_monitor_get_default ());
+  self->network_changed_id =
+    g_signal_connect (self->network_monitor, "network-changed",
+                      G_CALLBACK (network_changed_cb), self);
+}
+
+static void
+g_caching_resolver_dispose (GObject *object)
+{
+  GCachingResolver *self = G_CACHING_RESOLVER (object);
+
+  g_clear_signal_handler (&self->base_reload_id, self->base_resolver);
+  g_clear_signal_handler (&self->network_changed_id, self->network_monitor);
+  g_clear_object (&self->network_monitor);
+
+  G_OBJECT_CLASS (g_caching_resolver_parent_class)->dispose (object);
+}
+
+static void
+g_caching_resolver_finalize (GObject *object)
+{
+  GCachingResolver *self = G_CACHING_RESOLVER (object);
+
+  /* Pending lookups hold a reference on the resolver. */
+  g_assert (g_hash_table_size (self->pending) == 0);
+
+  g_hash_table_unref (self->pending);
+  g_hash_table_unref (self->cache);
+  g_clear_object (&self->base_resolver);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (g_caching_resolver_parent_class)->finalize (object);
+}
+
+static void
+g_caching_resolver_get_property (GObject    *object,
+                                 guint       prop_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  GCachingResolver *self = G_CACHING_RESOLVER (object);
+
+  switch ((GCachingResolverProperty) prop_id)
+    {
+    case PROP_BASE_RESOLVER:
+      g_value_set_object (value, self->base_resolver);
+      break;
+    case PROP_MAX_ENTRIES:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->max_entries);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_DEFAULT_TTL:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->default_ttl);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_NEGATIVE_TTL:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->negative_ttl);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+g_caching_resolver_set_property (GObject      *object,
+                                 guint         prop_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  GCachingResolver *self = G_CACHING_RESOLVER (object);
+
+  switch ((GCachingResolverProperty) prop_id)
+    {
+    case PROP_BASE_RESOLVER:
+      g_assert (self->base_resolver == NULL);
+      self->base_resolver = g_value_dup_object (value);
+      break;
+    case PROP_MAX_ENTRIES:
+      g_mutex_lock (&self->lock);
+      self->max_entries = g_value_get_uint (value);
+      cache_trim_unlocked (self);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_DEFAULT_TTL:
+      g_mutex_lock (&self->lock);
+      self->default_ttl = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_NEGATIVE_TTL:
+      g_mutex_lock (&self->lock);
+      self->negative_ttl = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+g_caching_resolver_class_init (GCachingResolverClass *resolver_class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (resolver_class);
+
+  object_class->constructed = g_caching_resolver_constructed;
+  object_class->dispose = g_caching_resolver_dispose;
+  object_class->finalize = g_caching_resolver_finalize;
+  object_class->get_property = g_caching_resolver_get_property;
+  object_class->set_property = g_caching_resolver_set_property;
+
+  resolver_class->reload                           = g_caching_resolver_reload;
+  resolver_class->lookup_by_name                   = lookup_by_name;
+  resolver_class->lookup_by_name_async             = lookup_by_name_async;
+  resolver_class->lookup_by_name_finish            = lookup_by_name_finish;
+  resolver_class->lookup_by_name_with_flags        = lookup_by_name_with_flags;
+  resolver_class->lookup_by_name_with_flags_async  = lookup_by_name_with_flags_async;
+  resolver_class->lookup_by_name_with_flags_finish = lookup_by_name_finish;
+  resolver_class->lookup_by_address                = lookup_by_address;
+  resolver_class->lookup_by_address_async          = lookup_by_address_async;
+  resolver_class->lookup_by_address_finish         = lookup_by_address_finish;
+  resolver_class->lookup_records                   = lookup_records;
+  resolver_class->lookup_records_async             = lookup_records_async;
+  resolver_class->lookup_records_finish            = lookup_records_finish;
+
+  /**
+   * GCachingResolver:base-resolver:
+   *
+   * The resolver doing the lookups which are not in the cache. If it is not
+   * set, the default [class@Gio.Resolver] at construction time is used.
+   *
+   * Since: 2.82
+   */
+  props[PROP_BASE_RESOLVER] =
+    g_param_spec_object ("base-resolver", NULL, NULL,
+                         G_TYPE_RESOLVER,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GCachingResolver:max-entries:
+   *
+   * The maximum number of lookup results to keep. If this is `0`, nothing
+   * is cached, but concurrent asynchronous lookups are still coalesced.
+   *
+   * Since: 2.82
+   */
+  props[PROP_MAX_ENTRIES] =
+    g_param_spec_uint ("max-entries", NULL, NULL,
+                       0, G_MAXUINT, 256,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GCachingResolver:default-ttl:
+   *
+   * How long to keep results for which the base resolver does not report a
+   * time-to-live, in seconds. This includes all name and address lookups.
+   *
+   * Since: 2.82
+   */
+  props[PROP_DEFAULT_TTL] =
+    g_param_spec_uint ("default-ttl", NULL, NULL,
+                       0, G_MAXUINT32 - 1, 60,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GCachingResolver:negative-ttl:
+   *
+   * How long to remember that a lookup failed with
+   * %G_RESOLVER_ERROR_NOT_FOUND, in seconds. If this is `0`, failed lookups
+   * are not cached.
+   *
+   * Since: 2.82
+   */
+  props[PROP_NEGATIVE_TTL] =
+    g_param_spec_uint ("negative-ttl", NULL, NULL,
+                       0, G_MAXUINT32 - 1, 10,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, G_N_ELEMENTS (props), props);
+}
+
+/**
+ * g_caching_resolver_new:
+ * @base_resolver: the resolver to cache the results of
+ *
+ * Creates a new #GCachingResolver caching the results of @base_resolver.
+ *
+ * Returns: (transfer full) (type GCachingResolver): a new #GCachingResolver
+ *
+ * Since: 2.82
+ */
+GResolver *
+g_caching_resolver_new (GResolver *base_resolver)
+{
+  g_return_val_if_fail (G_IS_RESOLVER (base_resolver), NULL);
+
+  return g_object_new (G_TYPE_CACHING_RESOLVER,
+                       "base-resolver", base_resolver,
+                       NULL);
+}
+
+/**
+ * g_caching_resolver_get_base_resolver:
+ * @resolver: a #GCachingResolver
+ *
+ * Gets the resolver whose results @resolver caches.
+ *
+ * Returns: (transfer none): the base resolver
+ *
+ * Since: 2.82
+ */
+GResolver *
+g_caching_resolver_get_base_resolver (GCachingResolver *resolver)
+{
+  g_return_val_if_fail (G_IS_CACHING_RESOLVER (resolver), NULL);
+
+  return resolver->base_resolver;
+}
+
+/**
+ * g_caching_resolver_clear:
+ * @resolver: a #GCachingResolver
+ *
+ * Drops all cached results, so that the next lookups are forwarded to the
+ * base resolver. Lookups which are already in progress still complete, but
+ * their results are not cached, and later lookups do not wait for them.
+ *
+ * This is done automatically when @resolver emits
+ * [signal@Gio.Resolver::reload].
+ *
+ * Since: 2.82
+ */
+void
+g_caching_resolver_clear (GCachingResolver *resolver)
+{
+  g_return_if_fail (G_IS_CACHING_RESOLVER (resolver));
+
+  g_mutex_lock (&resolver->lock);
+  g_hash_table_remove_all (resolver->cache);
+  g_queue_init (&resolver->lru);
+  g_hash_table_remove_all (resolver->pending);
+  resolver->generation++;
+  g_mutex_unlock (&resolver->lock);
+}
@@ -0,0 +1,52 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2024 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_CACHING_RESOLVER_H__
+#define __G_CACHING_RESOLVER_H__
+
+#if !defined (__GIO_GIO_H_INSIDE__) && !defined (GIO_COMPILATION)
+#error "Only <gio/gio.h> can be included directly."
+#endif
+
+#include <gio/gresolver.h>
+
+G_BEGIN_DECLS
+
+#define G_TYPE_CACHING_RESOLVER         (g_caching_resolver_get_type ())
+#define G_CACHING_RESOLVER(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), G_TYPE_CACHING_RESOLVER, GCachingResolver))
+#define G_IS_CACHING_RESOLVER(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), G_TYPE_CACHING_RESOLVER))
+
+typedef struct _GCachingResolver GCachingResolver;
+
+GIO_AVAILABLE_IN_2_82
+GType      g_caching_resolver_get_type          (void) G_GNUC_CONST;
+
+GIO_AVAILABLE_IN_2_82
+GResolver *g_caching_resolver_new               (GResolver        *base_resolver);
+
+GIO_AVAILABLE_IN_2_82
+GResolver *g_caching_resolver_get_base_resolver (GCachingResolver *resolver);
+
+GIO_AVAILABLE_IN_2_82
+void       g_caching_resolver_clear             (GCachingResolver *resolver);
+
+G_END_DECLS
+
+#endif /* __G_CACHING_RESOLVER_H__ */
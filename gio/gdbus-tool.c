@@ -34,11 +34,13 @@
 #endif
 
 #include <gi18n.h>
+#include <glib/gstdio.h>
 
 #ifdef G_OS_WIN32
 #include "glib/glib-private.h"
 #endif
 
+#include "gdbusdaemon.h"
 #include "gdbusprivate.h"
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -118,6 +120,7 @@ usage (gint *argc, gchar **argv[], gboolean use_stdout)
                          "  call         Invoke a method on a remote object\n"
                          "  emit         Emit a signal\n"
                          "  wait         Wait for a bus name to appear\n"
+                         "  bench        Measure D-Bus throughput and latency\n"
                          "\n"
                          "Use “%s COMMAND --help” to get help on each command.\n"),
                        program_name);
@@ -2404,6 +2407,787 @@ handle_wait (gint        *argc,
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+#define BENCH_OBJECT_PATH "/org/gtk/GDBus/Bench"
+#define BENCH_INTERFACE   "org.gtk.GDBus.Bench"
+
+static const gchar bench_introspection_xml[] =
+  "<node>"
+  "  <interface name='" BENCH_INTERFACE "'>"
+  "    <method name='Echo'>"
+  "      <arg type='ay' name='payload' direction='in'/>"
+  "      <arg type='ay' name='payload' direction='out'/>"
+  "    </method>"
+  "    <method name='Emit'>"
+  "      <arg type='u' name='count' direction='in'/>"
+  "      <arg type='ay' name='payload' direction='in'/>"
+  "    </method>"
+  "    <signal name='Ping'>"
+  "      <arg type='x' name='timestamp'/>"
+  "      <arg type='ay' name='payload'/>"
+  "    </signal>"
+  "    <property name='Payload' type='ay' access='readwrite'/>"
+  "  </interface>"
+  "</node>";
+
+static gboolean opt_bench_bus = FALSE;
+static gchar *opt_bench_workload = NULL;
+static gint opt_bench_concurrency = 1;
+static gint opt_bench_count = 10000;
+static gint opt_bench_payload_size = 0;
+
+static const GOptionEntry bench_entries[] =
+{
+  { "bus", 'b', 0, G_OPTION_ARG_NONE, &opt_bench_bus, N_("Go through a private message bus instead of a peer-to-peer connection"), NULL },
+  { "workload", 'w', 0, G_OPTION_ARG_STRING, &opt_bench_workload, N_("Workload to run: call (default), signal or property"), N_("WORKLOAD") },
+  { "concurrency", 'j', 0, G_OPTION_ARG_INT, &opt_bench_concurrency, N_("Number of operations in flight at once (default: 1)"), N_("N") },
+  { "count", 'n', 0, G_OPTION_ARG_INT, &opt_bench_count, N_("Number of operations to run (default: 10000)"), N_("N") },
+  { "payload-size", 's', 0, G_OPTION_ARG_INT, &opt_bench_payload_size, N_("Size of the byte array passed with each operation (default: 0)"), N_("BYTES") },
+  G_OPTION_ENTRY_NULL
+};
+
+typedef enum {
+  BENCH_WORKLOAD_CALL,
+  BENCH_WORKLOAD_SIGNAL,
+  BENCH_WORKLOAD_PROPERTY,
+} BenchWorkload;
+
+/* The service side of the benchmark; runs in its own thread and
+ * #GMainContext so that it does not compete with the client for the main loop.
+ */
+typedef struct
+{
+  gboolean use_bus;
+  GDBusInterfaceInfo *interface_info;
+  GThread *thread;
+  GMainContext *context;
+  GMainLoop *loop;
+
+  /* only used from the service thread */
+  GDBusServer *server;          /* peer-to-peer mode */
+  gchar *tmpdir;
+  GPtrArray *peers;
+  GDBusDaemon *daemon;          /* message bus mode */
+  GDBusConnection *connection;
+  GVariant *property_value;
+
+  /* protected by @lock until @ready is set, read-only afterwards */
+  GMutex lock;
+  GCond cond;
+  gboolean ready;
+  GError *error;
+  gchar *address;
+  gchar *bus_name;              /* %NULL in peer-to-peer mode */
+} BenchService;
+
+static void
+bench_method_call (GDBusConnection       *connection,
+                   const gchar           *sender,
+                   const gchar           *object_path,
+                   const gchar           *interface_name,
+                   const gchar           *method_name,
+                   GVariant              *parameters,
+                   GDBusMethodInvocation *invocation,
+                   gpointer               user_data)
+{
+  if (g_strcmp0 (method_name, "Echo") == 0)
+    {
+      g_dbus_method_invocation_return_value (invocation, parameters);
+    }
+  else if (g_strcmp0 (method_name, "Emit") == 0)
+    {
+      GVariant *payload;
+      guint32 count, n;
+
+      /* The signals are queued before the reply, so the client has received
+       * all of them once the reply arrives. */
+      g_variant_get (parameters, "(u@ay)", &count, &payload);
+      for (n = 0; n < count; n++)
+        g_dbus_connection_emit_signal (connection,
+                                       sender,
+                                       BENCH_OBJECT_PATH,
+                                       BENCH_INTERFACE,
+                                       "Ping",
+                                       g_variant_new ("(x@ay)", g_get_monotonic_time (), payload),
+                                       NULL);
+      g_variant_unref (payload);
+
+      g_dbus_method_invocation_return_value (invocation, NULL);
+    }
+  else
+    g_assert_not_reached ();
+}
+
+static GVariant *
+bench_get_property (GDBusConnection  *connection,
+                    const gchar      *sender,
+                    const gchar      *object_path,
+                    const gchar      *interface_name,
+                    const gchar      *property_name,
+                    GError          **error,
+                    gpointer          user_data)
+{
+  BenchService *service = user_data;
+
+  return g_variant_ref (service->property_value);
+}
+
+static gboolean
+bench_set_property (GDBusConnection  *connection,
+                    const gchar      *sender,
+                    const gchar      *object_path,
+                    const gchar      *interface_name,
+                    const gchar      *property_name,
+                    GVariant         *value,
+                    GError          **error,
+                    gpointer          user_data)
+{
+  BenchService *service = user_data;
+
+  g_clear_pointer (&service->property_value, g_variant_unref);
+  service->property_value = g_variant_ref (value);
+
+  return TRUE;
+}
+
+static const GDBusInterfaceVTable bench_vtable =
+{
+  bench_method_call,
+  bench_get_property,
+  bench_set_property,
+  { 0 }
+};
+
+static gboolean
+bench_service_register (BenchService     *service,
+                        GDBusConnection  *connection,
+                        GError          **error)
+{
+  return g_dbus_connection_register_object (connection,
+                                            BENCH_OBJECT_PATH,
+                                            service->interface_info,
+                                            &bench_vtable,
+                                            service,
+                                            NULL,
+                                            error) != 0;
+}
+
+/* takes ownership of @error */
+static void
+bench_service_set_ready (BenchService *service,
+                         GError       *error)
+{
+  g_mutex_lock (&service->lock);
+  service->error = error;
+  service->ready = TRUE;
+  g_cond_signal (&service->cond);
+  g_mutex_unlock (&service->lock);
+}
+
+static gboolean
+bench_service_new_connection_cb (GDBusServer     *server,
+                                 GDBusConnection *connection,
+                                 gpointer         user_data)
+{
+  BenchService *service = user_data;
+  GError *error = NULL;
+
+  if (!bench_service_register (service, connection, &error))
+    {
+      g_printerr (_("Error: %s\n"), error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  g_ptr_array_add (service->peers, g_object_ref (connection));
+
+  return TRUE;
+}
+
+static void
+bench_service_connected_cb (GObject      *source_object,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+  BenchService *service = user_data;
+  GDBusConnection *connection;
+  GError *error = NULL;
+
+  connection = g_dbus_connection_new_for_address_finish (result, &error);
+  if (connection != NULL && !bench_service_register (service, connection, &error))
+    g_clear_object (&connection);
+
+  if (connection != NULL)
+    {
+      service->connection = connection;
+      g_mutex_lock (&service->lock);
+      service->bus_name = g_strdup (g_dbus_connection_get_unique_name (connection));
+      g_mutex_unlock (&service->lock);
+    }
+
+  bench_service_set_ready (service, error);
+}
+
+static gboolean
+bench_service_start_peer (BenchService  *service,
+                          GError       **error)
+{
+  gchar *listen_address;
+  gchar *guid;
+
+#ifdef G_OS_UNIX
+  service->tmpdir = g_dir_make_tmp ("gdbus-bench-XXXXXX", error);
+  if (service->tmpdir == NULL)
+    return FALSE;
+  listen_address = g_strdup_printf ("unix:tmpdir=%s", service->tmpdir);
+#else
+  listen_address = g_strdup ("nonce-tcp:host=localhost");
+#endif
+
+  guid = g_dbus_generate_guid ();
+  service->server = g_dbus_server_new_sync (listen_address,
+                                            G_DBUS_SERVER_FLAGS_NONE,
+                                            guid,
+                                            NULL, /* GDBusAuthObserver */
+                                            NULL, /* GCancellable */
+                                            error);
+  g_free (guid);
+  g_free (listen_address);
+
+  if (service->server == NULL)
+    return FALSE;
+
+  g_signal_connect (service->server, "new-connection",
+                    G_CALLBACK (bench_service_new_connection_cb), service);
+  g_dbus_server_start (service->server);
+
+  g_mutex_lock (&service->lock);
+  service->address = g_strdup (g_dbus_server_get_client_address (service->server));
+  g_mutex_unlock (&service->lock);
+
+  return TRUE;
+}
+
+static gboolean
+bench_service_start_bus (BenchService  *service,
+                         GError       **error)
+{
+  service->daemon = _g_dbus_daemon_new (NULL, NULL, error);
+  if (service->daemon == NULL)
+    return FALSE;
+
+  g_mutex_lock (&service->lock);
+  service->address = g_strdup (_g_dbus_daemon_get_address (service->daemon));
+  g_mutex_unlock (&service->lock);
+
+  /* This has to be asynchronous, as the bus is served from this thread. */
+  g_dbus_connection_new_for_address (service->address,
+                                     G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                     G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                     NULL, /* GDBusAuthObserver */
+                                     NULL, /* GCancellable */
+                                     bench_service_connected_cb,
+                                     service);
+
+  return TRUE;
+}
+
+static gpointer
+bench_service_thread_func (gpointer user_data)
+{
+  BenchService *service = user_data;
+  GError *error = NULL;
+
+  g_main_context_push_thread_default (service->context);
+
+  if (service->use_bus)
+    {
+      /* bench_service_connected_cb() signals readiness */
+      if (!bench_service_start_bus (service, &error))
+        bench_service_set_ready (service, g_steal_pointer (&error));
+    }
+  else
+    {
+      bench_service_start_peer (service, &error);
+      bench_service_set_ready (service, g_steal_pointer (&error));
+    }
+
+  g_main_loop_run (service->loop);
+
+  if (service->server != NULL)
+    {
+      g_dbus_server_stop (service->server);
+      g_clear_object (&service->server);
+    }
+  g_ptr_array_set_size (service->peers, 0);
+  g_clear_object (&service->connection);
+  g_clear_object (&service->daemon);
+
+  while (g_main_context_iteration (service->context, FALSE));
+
+  g_main_context_pop_thread_default (service->context);
+
+  return NULL;
+}
+
+static BenchService *
+bench_service_new (gboolean             use_bus,
+                   GDBusInterfaceInfo  *interface_info,
+                   GError             **error)
+{
+  BenchService *service;
+
+  service = g_new0 (BenchService, 1);
+  service->use_bus = use_bus;
+  service->interface_info = interface_info;
+  service->context = g_main_context_new ();
+  service->loop = g_main_loop_new (service->context, FALSE);
+  service->peers = g_ptr_array_new_with_free_func (g_object_unref);
+  service->property_value = g_variant_ref_sink (g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, NULL, 0, 1));
+  g_mutex_init (&service->lock);
+  g_cond_init (&service->cond);
+
+  service->thread = g_thread_new ("gdbus-bench-service", bench_service_thread_func, service);
+
+  g_mutex_lock (&service->lock);
+  while (!service->ready)
+    g_cond_wait (&service->cond, &service->lock);
+  g_mutex_unlock (&service->lock);
+
+  /* On error, the caller still has to free @service */
+  if (service->error != NULL)
+    g_propagate_error (error, g_steal_pointer (&service->error));
+
+  return service;
+}
+
+static gboolean
+bench_service_quit_cb (gpointer user_data)
+{
+  BenchService *service = user_data;
+
+  g_main_loop_quit (service->loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+bench_service_free (BenchService *service)
+{
+  g_main_context_invoke (service->context, bench_service_quit_cb, service);
+  g_thread_join (service->thread);
+
+  if (service->tmpdir != NULL)
+    {
+      g_rmdir (service->tmpdir);
+      g_free (service->tmpdir);
+    }
+  g_ptr_array_unref (service->peers);
+  g_variant_unref (service->property_value);
+  g_main_loop_unref (service->loop);
+  g_main_context_unref (service->context);
+  g_mutex_clear (&service->lock);
+  g_cond_clear (&service->cond);
+  g_clear_error (&service->error);
+  g_free (service->address);
+  g_free (service->bus_name);
+  g_free (service);
+}
+
+/* The client side of the benchmark, runs in the main thread */
+typedef struct
+{
+  BenchWorkload workload;
+  GDBusConnection *connection;
+  const gchar *bus_name;  /* %NULL in peer-to-peer mode */
+  GVariant *payload;
+  guint total;
+  guint concurrency;
+  guint started;
+  guint in_flight;
+  GArray *latencies;  /* (element-type gint64), in µs */
+  GError *error;
+} BenchClient;
+
+typedef struct
+{
+  BenchClient *client;
+  gint64 start_time;
+} BenchOperation;
+
+static void bench_client_start_operation (BenchClient *client);
+
+static void
+bench_client_call_cb (GObject      *source_object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  BenchOperation *operation = user_data;
+  BenchClient *client = operation->client;
+  GVariant *reply;
+  GError *error = NULL;
+
+  reply = g_dbus_connection_call_finish (client->connection, result, &error);
+  if (reply == NULL)
+    {
+      if (client->error == NULL)
+        client->error = g_steal_pointer (&error);
+      else
+        g_error_free (error);
+    }
+  else
+    {
+      gint64 latency = g_get_monotonic_time () - operation->start_time;
+
+      /* Latencies of signals are recorded as they arrive */
+      if (client->workload != BENCH_WORKLOAD_SIGNAL)
+        g_array_append_val (client->latencies, latency);
+      g_variant_unref (reply);
+    }
+
+  client->in_flight--;
+  g_free (operation);
+
+  if (client->error == NULL && client->started < client->total)
+    bench_client_start_operation (client);
+}
+
+static void
+bench_client_ping_cb (GDBusConnection *connection,
+                      const gchar     *sender_name,
+                      const gchar     *object_path,
+                      const gchar     *interface_name,
+                      const gchar     *signal_name,
+                      GVariant        *parameters,
+                      gpointer         user_data)
+{
+  BenchClient *client = user_data;
+  gint64 timestamp, latency;
+
+  g_variant_get (parameters, "(x@ay)", &timestamp, NULL);
+  latency = g_get_monotonic_time () - timestamp;
+  g_array_append_val (client->latencies, latency);
+}
+
+static void
+bench_client_start_operation (BenchClient *client)
+{
+  BenchOperation *operation;
+  const gchar *interface_name;
+  const gchar *method_name;
+  GVariant *parameters;
+  const GVariantType *reply_type;
+
+  operation = g_new0 (BenchOperation, 1);
+  operation->client = client;
+
+  switch (client->workload)
+    {
+    case BENCH_WORKLOAD_CALL:
+      interface_name = BENCH_INTERFACE;
+      method_name = "Echo";
+      parameters = g_variant_new_tuple (&client->payload, 1);
+      reply_type = G_VARIANT_TYPE ("(ay)");
+      client->started++;
+      break;
+
+    case BENCH_WORKLOAD_SIGNAL:
+      {
+        /* One call emits a whole burst of signals */
+        guint count = MIN (client->concurrency, client->total - client->started);
+
+        interface_name = BENCH_INTERFACE;
+        method_name = "Emit";
+        parameters = g_variant_new ("(u@ay)", count, client->payload);
+        reply_type = G_VARIANT_TYPE_UNIT;
+        client->started += count;
+      }
+      break;
+
+    case BENCH_WORKLOAD_PROPERTY:
+      interface_name = "org.freedesktop.DBus.Properties";
+      method_name = "Get";
+      parameters = g_variant_new ("(ss)", BENCH_INTERFACE, "Payload");
+      reply_type = G_VARIANT_TYPE ("(v)");
+      client->started++;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  client->in_flight++;
+  operation->start_time = g_get_monotonic_time ();
+  g_dbus_connection_call (client->connection,
+                          client->bus_name,
+                          BENCH_OBJECT_PATH,
+                          interface_name,
+                          method_name,
+                          parameters,
+                          reply_type,
+                          G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                          G_MAXINT,
+                          NULL,
+                          bench_client_call_cb,
+                          operation);
+}
+
+static gint
+compare_latencies (gconstpointer a,
+                   gconstpointer b)
+{
+  gint64 latency_a = *(const gint64 *) a;
+  gint64 latency_b = *(const gint64 *) b;
+
+  return (latency_a > latency_b) - (latency_a < latency_b);
+}
+
+static gint64
+bench_percentile (GArray *sorted_latencies,
+                  guint   percentile)
+{
+  guint index = (sorted_latencies->len * percentile) / 100;
+
+  return g_array_index (sorted_latencies, gint64, MIN (index, sorted_latencies->len - 1));
+}
+
+static void
+bench_print_results (BenchClient *client,
+                     gint64       elapsed)
+{
+  GArray *latencies = client->latencies;
+  gdouble seconds = MAX (elapsed, 1) / (gdouble) G_USEC_PER_SEC;
+  gint64 sum = 0;
+  GVariant *statistics;
+  guint64 messages_sent = 0, write_calls = 0;
+  guint i;
+
+  g_print (_("Elapsed:      %.3f s\n"), seconds);
+  g_print (_("Throughput:   %.1f operations/s, %.2f MiB/s of payload\n"),
+           latencies->len / seconds,
+           ((gdouble) latencies->len * opt_bench_payload_size) / seconds / (1024 * 1024));
+
+  if (latencies->len > 0)
+    {
+      g_array_sort (latencies, compare_latencies);
+      for (i = 0; i < latencies->len; i++)
+        sum += g_array_index (latencies, gint64, i);
+
+      g_print (_("Latency (µs): min %" G_GINT64_FORMAT ", mean %.1f, p50 %" G_GINT64_FORMAT
+                 ", p90 %" G_GINT64_FORMAT ", p99 %" G_GINT64_FORMAT ", max %" G_GINT64_FORMAT "\n"),
+               g_array_index (latencies, gint64, 0),
+               (gdouble) sum / latencies->len,
+               bench_percentile (latencies, 50),
+               bench_percentile (latencies, 90),
+               bench_percentile (latencies, 99),
+               g_array_index (latencies, gint64, latencies->len - 1));
+    }
+
+  statistics = g_dbus_connection_get_statistics (client->connection);
+  if (statistics != NULL)
+    {
+      g_variant_ref_sink (statistics);
+      g_variant_lookup (statistics, "messages-sent", "t", &messages_sent);
+      g_variant_lookup (statistics, "write-calls", "t", &write_calls);
+      g_print (_("Client:       %" G_GUINT64_FORMAT " messages sent in %" G_GUINT64_FORMAT " writes\n"),
+               messages_sent, write_calls);
+      g_variant_unref (statistics);
+    }
+}
+
+static gboolean
+handle_bench (gint        *argc,
+              gchar      **argv[],
+              gboolean     request_completion,
+              const gchar *completion_cur,
+              const gchar *completion_prev)
+{
+  gboolean ret;
+  GOptionContext *o;
+  gchar *s;
+  GError *error;
+  GDBusNodeInfo *node_info;
+  BenchService *service;
+  BenchClient client = { 0, };
+  guint8 *payload_data;
+  guint subscription_id;
+  gint64 start_time;
+  guint n;
+
+  ret = FALSE;
+  node_info = NULL;
+  service = NULL;
+  subscription_id = 0;
+
+  modify_argv0_for_command (argc, argv, "bench");
+
+  o = command_option_context_new (NULL, _("Measure D-Bus throughput and latency."),
+                                  bench_entries, request_completion);
+
+  if (!g_option_context_parse (o, argc, argv, NULL))
+    {
+      if (!request_completion)
+        {
+          s = g_option_context_get_help (o, FALSE, NULL);
+          g_printerr ("%s", s);
+          g_free (s);
+          goto out;
+        }
+    }
+
+  if (request_completion)
+    {
+      if (g_strcmp0 (completion_prev, "--workload") == 0)
+        g_print ("call \nsignal \nproperty \n");
+      else
+        g_print ("--bus \n--workload \n--concurrency \n--count \n--payload-size \n");
+      goto out;
+    }
+
+  if (opt_bench_workload == NULL || g_strcmp0 (opt_bench_workload, "call") == 0)
+    client.workload = BENCH_WORKLOAD_CALL;
+  else if (g_strcmp0 (opt_bench_workload, "signal") == 0)
+    client.workload = BENCH_WORKLOAD_SIGNAL;
+  else if (g_strcmp0 (opt_bench_workload, "property") == 0)
+    client.workload = BENCH_WORKLOAD_PROPERTY;
+  else
+    {
+      g_printerr (_("Error: Unknown workload “%s”\n"), opt_bench_workload);
+      goto out;
+    }
+
+  if (opt_bench_concurrency < 1 || opt_bench_count < 1 || opt_bench_payload_size < 0)
+    {
+      g_printerr (_("Error: Concurrency and count must be positive, and the payload size must not be negative\n"));
+      goto out;
+    }
+
+  node_info = g_dbus_node_info_new_for_xml (bench_introspection_xml, NULL);
+  g_assert (node_info != NULL);
+
+  error = NULL;
+  service = bench_service_new (opt_bench_bus, node_info->interfaces[0], &error);
+  if (error != NULL)
+    {
+      g_printerr (_("Error starting the benchmark service: %s\n"), error->message);
+      g_error_free (error);
+      goto out;
+    }
+
+  client.connection = g_dbus_connection_new_for_address_sync (service->address,
+                                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                              (opt_bench_bus ? G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION : 0),
+                                                              NULL, /* GDBusAuthObserver */
+                                                              NULL, /* GCancellable */
+                                                              &error);
+  if (client.connection == NULL)
+    {
+      g_printerr (_("Error connecting: %s\n"), error->message);
+      g_error_free (error);
+      goto out;
+    }
+  g_dbus_connection_set_statistics_enabled (client.connection, TRUE);
+
+  payload_data = g_malloc (opt_bench_payload_size);
+  for (n = 0; n < (guint) opt_bench_payload_size; n++)
+    payload_data[n] = n & 0xff;
+  client.payload = g_variant_ref_sink (g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+                                                                  payload_data,
+                                                                  opt_bench_payload_size,
+                                                                  1));
+  g_free (payload_data);
+
+  client.bus_name = service->bus_name;
+  client.total = opt_bench_count;
+  client.concurrency = opt_bench_concurrency;
+  client.latencies = g_array_sized_new (FALSE, FALSE, sizeof (gint64), client.total);
+
+  if (client.workload == BENCH_WORKLOAD_SIGNAL)
+    {
+      subscription_id = g_dbus_connection_signal_subscribe (client.connection,
+                                                            client.bus_name,
+                                                            BENCH_INTERFACE,
+                                                            "Ping",
+                                                            BENCH_OBJECT_PATH,
+                                                            NULL,
+                                                            G_DBUS_SIGNAL_FLAGS_NONE,
+                                                            bench_client_ping_cb,
+                                                            &client,
+                                                            NULL);
+    }
+  else if (client.workload == BENCH_WORKLOAD_PROPERTY)
+    {
+      GVariant *result;
+
+      result = g_dbus_connection_call_sync (client.connection,
+                                            client.bus_name,
+                                            BENCH_OBJECT_PATH,
+                                            "org.freedesktop.DBus.Properties",
+                                            "Set",
+                                            g_variant_new ("(ssv)", BENCH_INTERFACE, "Payload", client.payload),
+                                            NULL,
+                                            G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                                            -1,
+                                            NULL,
+                                            &error);
+      if (result == NULL)
+        {
+          g_printerr (_("Error: %s\n"), error->message);
+          g_error_free (error);
+          goto out;
+        }
+      g_variant_unref (result);
+    }
+
+  g_print (_("Workload:     %s, %u operations, concurrency %u, payload %d bytes\n"),
+           opt_bench_workload != NULL ? opt_bench_workload : "call",
+           client.total, client.concurrency, opt_bench_payload_size);
+  g_print (_("Transport:    %s (%s)\n"),
+           opt_bench_bus ? _("private message bus") : _("peer-to-peer"),
+           service->address);
+
+  start_time = g_get_monotonic_time ();
+
+  /* The signal workload has a single call in flight, emitting bursts of
+   * @concurrency signals. */
+  if (client.workload == BENCH_WORKLOAD_SIGNAL)
+    bench_client_start_operation (&client);
+  else
+    for (n = 0; n < client.concurrency && client.started < client.total; n++)
+      bench_client_start_operation (&client);
+
+  while (client.in_flight > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  if (client.error != NULL)
+    {
+      g_printerr (_("Error: %s\n"), client.error->message);
+      goto out;
+    }
+
+  bench_print_results (&client, g_get_monotonic_time () - start_time);
+
+  ret = TRUE;
+
+ out:
+  if (subscription_id != 0)
+    g_dbus_connection_signal_unsubscribe (client.connection, subscription_id);
+  if (client.connection != NULL)
+    g_dbus_connection_close_sync (client.connection, NULL, NULL);
+  g_clear_object (&client.connection);
+  g_clear_pointer (&client.payload, g_variant_unref);
+  g_clear_pointer (&client.latencies, g_array_unref);
+  g_clear_error (&client.error);
+  g_clear_pointer (&service, bench_service_free);
+  g_clear_pointer (&node_info, g_dbus_node_info_unref);
+  g_option_context_free (o);
+  g_free (opt_bench_workload);
+  opt_bench_workload = NULL;
+
+  return ret;
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 static gchar *
 pick_word_at (const gchar  *s,
               gint          cursor,
@@ -2546,6 +3330,16 @@ main (gint argc, gchar *argv[])
         ret = 0;
       goto out;
     }
+  else if (g_strcmp0 (command, "bench") == 0)
+    {
+      if (handle_bench (&argc,
+                        &argv,
+                        request_completion,
+                        completion_cur,
+                        completion_prev))
+        ret = 0;
+      goto out;
+    }
 #ifdef G_OS_WIN32
   else if (g_strcmp0 (command, _GDBUS_ARG_WIN32_RUN_SESSION_BUS) == 0)
     {
@@ -2623,7 +3417,7 @@ main (gint argc, gchar *argv[])
     {
       if (request_completion)
         {
-          g_print ("help \nemit \ncall \nintrospect \nmonitor \nwait \n");
+          g_print ("help \nemit \ncall \nintrospect \nmonitor \nwait \nbench \n");
           ret = 0;
           goto out;
         }
@@ -350,6 +350,9 @@ typedef struct SignalData SignalData;
 
 struct SignalData
 {
+  /* Creation order, so signals are delivered to subscriptions in the order
+   * they were first made, whichever index buckets they are in. */
+  guint64 serial;
   gchar *rule;
   gchar *sender;
   gchar *interface_name;
@@ -432,6 +435,124 @@ signal_data_free (SignalData *signal_data)
   g_free (signal_data);
 }
 
+/* The SignalData of each sender are indexed by object path, member and arg0,
+ * so that dispatching a signal only has to look at the few buckets whose
+ * SignalData can match it, rather than at every subscription. A %NULL field
+ * means the SignalData matches any value for it. Only exact arg0 matches are
+ * indexed; namespace and path matches on arg0 go in the %NULL arg0 buckets
+ * and are checked individually. */
+typedef struct
+{
+  const gchar *object_path;  /* (nullable) */
+  const gchar *member;  /* (nullable) */
+  const gchar *arg0;  /* (nullable) */
+} SignalDataKey;
+
+typedef struct
+{
+  SignalDataKey key;  /* (owned) strings */
+  GPtrArray *signal_data;  /* (owned) (element-type SignalData) unowned elements, in creation order */
+} SignalDataBucket;
+
+static guint
+signal_data_key_hash (gconstpointer data)
+{
+  const SignalDataKey *key = data;
+  guint hash = 0;
+
+  if (key->object_path != NULL)
+    hash = g_str_hash (key->object_path);
+  if (key->member != NULL)
+    hash = hash * 31 + g_str_hash (key->member);
+  if (key->arg0 != NULL)
+    hash = hash * 31 + g_str_hash (key->arg0);
+
+  return hash;
+}
+
+static gboolean
+signal_data_key_equal (gconstpointer a,
+                       gconstpointer b)
+{
+  const SignalDataKey *key_a = a;
+  const SignalDataKey *key_b = b;
+
+  return g_strcmp0 (key_a->object_path, key_b->object_path) == 0 &&
+         g_strcmp0 (key_a->member, key_b->member) == 0 &&
+         g_strcmp0 (key_a->arg0, key_b->arg0) == 0;
+}
+
+static void
+signal_data_key_init (SignalDataKey    *key,
+                      const SignalData *signal_data)
+{
+  key->object_path = signal_data->object_path;
+  key->member = signal_data->member;
+  if (signal_data->flags & (G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE | G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_PATH))
+    key->arg0 = NULL;
+  else
+    key->arg0 = signal_data->arg0;
+}
+
+static void
+signal_data_bucket_free (SignalDataBucket *bucket)
+{
+  g_free ((gchar *) bucket->key.object_path);
+  g_free ((gchar *) bucket->key.member);
+  g_free ((gchar *) bucket->key.arg0);
+  g_ptr_array_unref (bucket->signal_data);
+  g_free (bucket);
+}
+
+/* Returns a (element-type SignalDataKey SignalDataBucket) index */
+static GHashTable *
+signal_data_index_new (void)
+{
+  return g_hash_table_new_full (signal_data_key_hash, signal_data_key_equal,
+                                NULL, (GDestroyNotify) signal_data_bucket_free);
+}
+
+static void
+signal_data_index_add (GHashTable *index,
+                       SignalData *signal_data)
+{
+  SignalDataKey key;
+  SignalDataBucket *bucket;
+
+  signal_data_key_init (&key, signal_data);
+  bucket = g_hash_table_lookup (index, &key);
+  if (bucket == NULL)
+    {
+      bucket = g_new0 (SignalDataBucket, 1);
+      bucket->key.object_path = g_strdup (key.object_path);
+      bucket->key.member = g_strdup (key.member);
+      bucket->key.arg0 = g_strdup (key.arg0);
+      bucket->signal_data = g_ptr_array_new ();
+      g_hash_table_insert (index, &bucket->key, bucket);
+    }
+
+  g_ptr_array_add (bucket->signal_data, signal_data);
+}
+
+/* Returns %TRUE if @signal_data was found and removed */
+static gboolean
+signal_data_index_remove (GHashTable *index,
+                          SignalData *signal_data)
+{
+  SignalDataKey key;
+  SignalDataBucket *bucket;
+
+  signal_data_key_init (&key, signal_data);
+  bucket = g_hash_table_lookup (index, &key);
+  if (bucket == NULL || !g_ptr_array_remove (bucket->signal_data, signal_data))
+    return FALSE;
+
+  if (bucket->signal_data->len == 0)
+    g_hash_table_remove (index, &key);
+
+  return TRUE;
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 #ifdef G_OS_WIN32
@@ -557,7 +678,8 @@ struct _GDBusConnection
   /* Maps used for managing signal subscription, protected by @lock */
   GHashTable *map_rule_to_signal_data;                      /* match rule (gchar*)    -> SignalData */
   GHashTable *map_id_to_signal_data;                        /* id (guint)             -> SignalData */
-  GHashTable *map_sender_unique_name_to_signal_data_array;  /* unique sender (gchar*) -> GPtrArray* of SignalData */
+  GHashTable *map_sender_unique_name_to_signal_data_index;  /* unique sender (gchar*) -> index of SignalData (see signal_data_index_new()) */
+  guint64 next_signal_data_serial;
 
   /* Maps used for managing exported objects and subtrees,
    * protected by @lock
@@ -587,6 +709,11 @@ struct _GDBusConnection
    */
   GCredentials *credentials;
 
+  /* Per-method call statistics, see g_dbus_connection_set_statistics_enabled().
+   * %NULL if disabled. Protected by @lock.
+   */
+  GDBusStatistics *statistics;
+
   /* set to TRUE when finalizing */
   gboolean finalizing;
 };
@@ -598,6 +725,8 @@ typedef struct ExportedSubtree ExportedSubtree;
 static ExportedSubtree *exported_subtree_ref (ExportedSubtree *es);
 static void exported_subtree_unref (ExportedSubtree *es);
 
+typedef struct DispatchPool DispatchPool;
+
 enum
 {
   CLOSED_SIGNAL,
@@ -641,6 +770,7 @@ static void schedule_method_call (GDBusConnection            *connection,
                                   GVariant                   *parameters,
                                   const GDBusInterfaceVTable *vtable,
                                   GMainContext               *main_context,
+                                  DispatchPool               *pool,
                                   gpointer                    user_data);
 
 #define _G_ENSURE_LOCK(name) do {                                       \
@@ -805,7 +935,7 @@ g_dbus_connection_finalize (GObject *object)
 
   g_hash_table_unref (connection->map_rule_to_signal_data);
   g_hash_table_unref (connection->map_id_to_signal_data);
-  g_hash_table_unref (connection->map_sender_unique_name_to_signal_data_array);
+  g_hash_table_unref (connection->map_sender_unique_name_to_signal_data_index);
 
   g_hash_table_unref (connection->map_id_to_ei);
   g_hash_table_unref (connection->map_object_path_to_eo);
@@ -818,6 +948,8 @@ g_dbus_connection_finalize (GObject *object)
 
   g_free (connection->machine_id);
 
+  g_clear_pointer (&connection->statistics, _g_dbus_statistics_unref);
+
   g_mutex_clear (&connection->init_lock);
   g_mutex_clear (&connection->lock);
 
@@ -1194,10 +1326,10 @@ g_dbus_connection_init (GDBusConnection *connection)
                                                           g_str_equal);
   connection->map_id_to_signal_data = g_hash_table_new (g_direct_hash,
                                                         g_direct_equal);
-  connection->map_sender_unique_name_to_signal_data_array = g_hash_table_new_full (g_str_hash,
+  connection->map_sender_unique_name_to_signal_data_index = g_hash_table_new_full (g_str_hash,
                                                                                    g_str_equal,
                                                                                    g_free,
-                                                                                   (GDestroyNotify) g_ptr_array_unref);
+                                                                                   (GDestroyNotify) g_hash_table_unref);
 
   connection->map_object_path_to_eo = g_hash_table_new_full (g_str_hash,
                                                              g_str_equal,
@@ -1339,6 +1471,139 @@ g_dbus_connection_get_flags (GDBusConnection *connection)
   return connection->flags;
 }
 
+/**
+ * g_dbus_connection_set_memfd_threshold:
+ * @connection: a #GDBusConnection
+ * @threshold: size in bytes from which byte array arguments are passed as
+ *     memfds, or 0 to always send them inline
+ *
+ * Makes @connection pass top-level `ay` arguments of at least @threshold
+ * bytes in outgoing messages as sealed memfds rather than inline. The
+ * receiving GDBus peer maps them read-only, so their contents are neither
+ * copied through the socket nor into the received message. The method and
+ * signal signatures do not change, and receiving GDBus peers always undo this
+ * transparently; no opt-in is needed on their side.
+ *
+ * Only enable this when the peer is known to use GDBus, since other D-Bus
+ * implementations will see empty arrays and additional file descriptors.
+ * Message buses drop the header field that describes the memfds, so this is
+ * only supported on peer-to-peer connections that can pass file descriptors,
+ * and only on platforms with `memfd_create()`.
+ *
+ * Outgoing filters added with g_dbus_connection_add_filter() see the
+ * messages before their arrays are moved.
+ *
+ * Returns: %TRUE if arrays will be passed as memfds (or if @threshold is 0),
+ *     %FALSE if this is not supported on @connection
+ *
+ * Since: 2.82
+ */
+gboolean
+g_dbus_connection_set_memfd_threshold (GDBusConnection *connection,
+                                       gsize            threshold)
+{
+  g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), FALSE);
+  g_return_val_if_fail (check_initialized (connection), FALSE);
+
+#ifdef HAVE_MEMFD_CREATE
+  if (threshold > 0 &&
+      ((connection->flags & G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION) ||
+       !(connection->capabilities & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING)))
+    return FALSE;
+
+  _g_dbus_worker_set_memfd_threshold (connection->worker, threshold);
+
+  return TRUE;
+#else
+  return threshold == 0;
+#endif
+}
+
+/**
+ * g_dbus_connection_set_statistics_enabled:
+ * @connection: a #GDBusConnection
+ * @enabled: whether to collect statistics
+ *
+ * Enables or disables collecting statistics about method calls on
+ * @connection. See g_dbus_connection_get_statistics().
+ *
+ * Statistics are disabled by default, since collecting them takes a lock and
+ * a hash table lookup for every method call. Enabling them again, or enabling
+ * them while they are already enabled, resets all per-method counters.
+ *
+ * Since: 2.82
+ */
+void
+g_dbus_connection_set_statistics_enabled (GDBusConnection *connection,
+                                          gboolean         enabled)
+{
+  g_return_if_fail (G_IS_DBUS_CONNECTION (connection));
+
+  CONNECTION_LOCK (connection);
+  g_clear_pointer (&connection->statistics, _g_dbus_statistics_unref);
+  if (enabled)
+    connection->statistics = _g_dbus_statistics_new ();
+  CONNECTION_UNLOCK (connection);
+}
+
+/**
+ * g_dbus_connection_get_statistics:
+ * @connection: a #GDBusConnection
+ *
+ * Gets statistics about the traffic on @connection, if they have been enabled
+ * with g_dbus_connection_set_statistics_enabled().
+ *
+ * The result is a dictionary with the following keys:
+ *
+ * - `incoming-calls` and `outgoing-calls` (`aa{sv}`): one entry per
+ *   interface and method, with the keys `interface` (`s`, missing if the
+ *   calls had no interface), `member` (`s`), `calls` (`u`, number of calls
+ *   started), `errors` (`u`, number of calls which failed, were cancelled or
+ *   were never answered), `outstanding` (`u`, number of calls which are
+ *   still in progress), `total-latency` (`t`, sum of the latencies of all
+ *   finished calls in microseconds) and `latency-histogram` (`at`, where
+ *   element n is the number of calls which took between 2^n and 2^(n+1)
+ *   microseconds; the last element also counts all slower calls).
+ * - `messages-sent`, `bytes-sent`, `messages-received` and `bytes-received`
+ *   (`t`): traffic on the connection since it was created.
+ * - `write-queue-length` (`t`): number of messages waiting to be written.
+ * - `write-batches` and `write-calls` (`t`): number of batches of messages
+ *   written and of system calls needed to write them.
+ *
+ * Incoming calls are counted from when they are dispatched until they are
+ * replied to; outgoing calls from when they are sent until the reply arrives.
+ * Only outgoing calls which expect a reply are counted.
+ *
+ * Returns: (transfer floating) (nullable): a `a{sv}` dictionary, or %NULL if
+ *     statistics are not enabled
+ *
+ * Since: 2.82
+ */
+GVariant *
+g_dbus_connection_get_statistics (GDBusConnection *connection)
+{
+  GDBusStatistics *statistics = NULL;
+  GVariantBuilder builder;
+
+  g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), NULL);
+  g_return_val_if_fail (check_initialized (connection), NULL);
+
+  CONNECTION_LOCK (connection);
+  if (connection->statistics != NULL)
+    statistics = _g_dbus_statistics_ref (connection->statistics);
+  CONNECTION_UNLOCK (connection);
+
+  if (statistics == NULL)
+    return NULL;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+  _g_dbus_statistics_add_to_builder (statistics, &builder);
+  _g_dbus_worker_add_statistics (connection->worker, &builder);
+  _g_dbus_statistics_unref (statistics);
+
+  return g_variant_builder_end (&builder);
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 /* Called in a temporary thread without holding locks. */
@@ -1732,6 +1997,7 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
 {
   guchar *blob;
   gsize blob_size;
+  GArray *splices;
   guint32 serial_to_use;
 
   CONNECTION_ENSURE_LOCK (connection);
@@ -1754,10 +2020,11 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
                        error))
     return FALSE;
 
-  blob = g_dbus_message_to_blob (message,
-                                 &blob_size,
-                                 connection->capabilities,
-                                 error);
+  blob = _g_dbus_message_to_blob_with_splices (message,
+                                               &blob_size,
+                                               connection->capabilities,
+                                               &splices,
+                                               error);
   if (blob == NULL)
     return FALSE;
 
@@ -1809,7 +2076,8 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
   _g_dbus_worker_send_message (connection->worker,
                                message,
                                (gchar*) blob, /* transfer ownership */
-                               blob_size);
+                               blob_size,
+                               splices); /* transfer ownership */
 
   return TRUE;
 }
@@ -1881,6 +2149,12 @@ typedef struct
 
   GSource *timeout_source;  /* (owned) (nullable) */
 
+  /* set if statistics were enabled when the call was sent */
+  GDBusStatistics *statistics;  /* (owned) (nullable) */
+  gchar *interface_name;
+  gchar *member;
+  gint64 start_time;
+
   gboolean delivered;
 } SendMessageData;
 
@@ -1892,6 +2166,9 @@ send_message_data_free (SendMessageData *data)
   g_assert (data->timeout_source == NULL);
   g_assert (data->cancellable_handler_id == 0);
 
+  g_clear_pointer (&data->statistics, _g_dbus_statistics_unref);
+  g_free (data->interface_name);
+  g_free (data->member);
   g_slice_free (SendMessageData, data);
 }
 
@@ -1899,7 +2176,7 @@ send_message_data_free (SendMessageData *data)
 
 /* can be called from any thread with lock held; @task is (transfer none) */
 static void
-send_message_with_reply_cleanup (GTask *task, gboolean remove)
+send_message_with_reply_cleanup (GTask *task, gboolean remove, gboolean failed)
 {
   GDBusConnection *connection = g_task_get_source_object (task);
   SendMessageData *data = g_task_get_task_data (task);
@@ -1926,6 +2203,11 @@ send_message_with_reply_cleanup (GTask *task, gboolean remove)
       g_clear_pointer (&data->cancelled_idle_source, g_source_unref);
     }
 
+  if (data->statistics != NULL)
+    _g_dbus_statistics_call_finished (data->statistics, FALSE,
+                                      data->interface_name, data->member,
+                                      data->start_time, failed);
+
   if (remove)
     {
       gboolean removed = g_hash_table_remove (connection->map_method_serial_to_task,
@@ -1948,7 +2230,8 @@ send_message_data_deliver_reply_unlocked (GTask           *task,
 
   g_task_return_pointer (task, g_object_ref (reply), g_object_unref);
 
-  send_message_with_reply_cleanup (task, TRUE);
+  send_message_with_reply_cleanup (task, TRUE,
+                                   g_dbus_message_get_message_type (reply) == G_DBUS_MESSAGE_TYPE_ERROR);
 
  out:
   ;
@@ -1975,7 +2258,7 @@ send_message_data_deliver_error (GTask      *task,
    * from the task map and could end up dropping the last reference */
   g_object_ref (task);
 
-  send_message_with_reply_cleanup (task, TRUE);
+  send_message_with_reply_cleanup (task, TRUE, TRUE);
   CONNECTION_UNLOCK (connection);
 
   g_task_return_new_error_literal (task, domain, code, message);
@@ -2072,6 +2355,16 @@ g_dbus_connection_send_message_with_reply_unlocked (GDBusConnection     *connect
     }
   data->serial = *out_serial;
 
+  if (connection->statistics != NULL)
+    {
+      data->statistics = _g_dbus_statistics_ref (connection->statistics);
+      data->interface_name = g_strdup (g_dbus_message_get_interface (message));
+      data->member = g_strdup (g_dbus_message_get_member (message));
+      data->start_time = g_get_monotonic_time ();
+      _g_dbus_statistics_call_started (data->statistics, FALSE,
+                                       data->interface_name, data->member);
+    }
+
   if (cancellable != NULL)
     {
       data->cancellable_handler_id = g_cancellable_connect (cancellable,
@@ -2751,7 +3044,7 @@ cancel_method_on_close (gpointer key, gpointer value, gpointer user_data)
    * hash table - we're in the middle of a foreach; that would be unsafe.
    * Instead, return TRUE from this function so that it gets removed safely.
    */
-  send_message_with_reply_cleanup (task, FALSE);
+  send_message_with_reply_cleanup (task, FALSE, TRUE);
   return TRUE;
 }
 
@@ -3729,8 +4022,9 @@ add_signal_data (GDBusConnection *connection,
                  SignalData      *signal_data,
                  const char      *sender_unique_name)
 {
-  GPtrArray *signal_data_array;
+  GHashTable *signal_data_index;
 
+  signal_data->serial = connection->next_signal_data_serial++;
   g_hash_table_insert (connection->map_rule_to_signal_data,
                        signal_data->rule,
                        signal_data);
@@ -3746,16 +4040,16 @@ add_signal_data (GDBusConnection *connection,
         add_match_rule (connection, signal_data->rule);
     }
 
-  signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array,
+  signal_data_index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index,
                                            sender_unique_name);
-  if (signal_data_array == NULL)
+  if (signal_data_index == NULL)
     {
-      signal_data_array = g_ptr_array_new ();
-      g_hash_table_insert (connection->map_sender_unique_name_to_signal_data_array,
+      signal_data_index = signal_data_index_new ();
+      g_hash_table_insert (connection->map_sender_unique_name_to_signal_data_index,
                            g_strdup (sender_unique_name),
-                           signal_data_array);
+                           signal_data_index);
     }
-  g_ptr_array_add (signal_data_array, signal_data);
+  signal_data_index_add (signal_data_index, signal_data);
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -3992,7 +4286,7 @@ remove_signal_data_if_unused (GDBusConnection *connection,
                               SignalData *signal_data)
 {
   const gchar *sender_unique_name;
-  GPtrArray *signal_data_array;
+  GHashTable *signal_data_index;
 
   /* Cannot remove while there are still subscribers */
   if (signal_data->subscribers->len != 0)
@@ -4012,14 +4306,14 @@ remove_signal_data_if_unused (GDBusConnection *connection,
 
   g_warn_if_fail (g_hash_table_remove (connection->map_rule_to_signal_data, signal_data->rule));
 
-  signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array,
+  signal_data_index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index,
                                            sender_unique_name);
-  g_warn_if_fail (signal_data_array != NULL);
-  g_warn_if_fail (g_ptr_array_remove (signal_data_array, signal_data));
+  g_warn_if_fail (signal_data_index != NULL);
+  g_warn_if_fail (signal_data_index_remove (signal_data_index, signal_data));
 
-  if (signal_data_array->len == 0)
+  if (g_hash_table_size (signal_data_index) == 0)
     {
-      g_warn_if_fail (g_hash_table_remove (connection->map_sender_unique_name_to_signal_data_array,
+      g_warn_if_fail (g_hash_table_remove (connection->map_sender_unique_name_to_signal_data_index,
                                            sender_unique_name));
     }
 
@@ -4245,12 +4539,108 @@ path_rule_matches (const gchar *path_a,
   return memcmp (path_a, path_b, MIN (len_a, len_b)) == 0;
 }
 
+/* called in GDBusWorker thread WITH lock held
+ *
+ * @sender is (nullable) for peer-to-peer connections */
+static gboolean
+signal_data_matches (SignalData  *signal_data,
+                     const gchar *sender,
+                     const gchar *interface,
+                     const gchar *member,
+                     const gchar *path,
+                     const gchar *arg0,
+                     const gchar *arg0_path)
+{
+  if (signal_data->interface_name != NULL && g_strcmp0 (signal_data->interface_name, interface) != 0)
+    return FALSE;
+
+  if (signal_data->member != NULL && g_strcmp0 (signal_data->member, member) != 0)
+    return FALSE;
+
+  if (signal_data->object_path != NULL && g_strcmp0 (signal_data->object_path, path) != 0)
+    return FALSE;
+
+  if (signal_data->shared_name_watcher != NULL)
+    {
+      /* We want signals from a specified well-known name, which means
+       * the signal's sender needs to be the unique name that currently
+       * owns that well-known name, and we will have found this
+       * SignalData in
+       * connection->map_sender_unique_name_to_signal_data_index[""]. */
+      const WatchedName *watched_name;
+      const char *current_owner;
+
+      g_assert (signal_data->sender != NULL);
+      /* Invariant: We never need to watch for the owner of a unique
+       * name, or for the owner of DBUS_SERVICE_DBUS, either of which
+       * is always its own owner */
+      g_assert (!g_dbus_is_unique_name (signal_data->sender));
+      g_assert (g_strcmp0 (signal_data->sender, DBUS_SERVICE_DBUS) != 0);
+
+      watched_name = signal_data->shared_name_watcher->watched_name;
+      g_assert (watched_name != NULL);
+      current_owner = watched_name->owner;
+
+      /* Skip the signal if the actual sender is not known to own
+       * the required name */
+      if (current_owner == NULL || g_strcmp0 (current_owner, sender) != 0)
+        return FALSE;
+    }
+  else if (signal_data->sender != NULL)
+    {
+      /* We want signals from a unique name or o.fd.DBus... */
+      g_assert (g_dbus_is_unique_name (signal_data->sender)
+                || g_str_equal (signal_data->sender, DBUS_SERVICE_DBUS));
+
+      /* ... which means we must have found this SignalData in
+       * connection->map_sender_unique_name_to_signal_data_index[signal_data->sender],
+       * therefore we would only have found it if the signal's
+       * actual sender matches the required signal_data->sender */
+      g_assert (g_strcmp0 (signal_data->sender, sender) == 0);
+    }
+  /* else the sender is unspecified and we will accept anything */
+
+  if (signal_data->arg0 != NULL)
+    {
+      if (signal_data->flags & G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE)
+        {
+          if (arg0 == NULL || !namespace_rule_matches (signal_data->arg0, arg0))
+            return FALSE;
+        }
+      else if (signal_data->flags & G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_PATH)
+        {
+          if ((arg0 == NULL || !path_rule_matches (signal_data->arg0, arg0)) &&
+              (arg0_path == NULL || !path_rule_matches (signal_data->arg0, arg0_path)))
+            return FALSE;
+        }
+      else if (arg0 == NULL || !g_str_equal (signal_data->arg0, arg0))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gint
+signal_data_compare_serial (gconstpointer a,
+                            gconstpointer b)
+{
+  const SignalData *signal_data_a = *(SignalData * const *) a;
+  const SignalData *signal_data_b = *(SignalData * const *) b;
+
+  if (signal_data_a->serial < signal_data_b->serial)
+    return -1;
+  else if (signal_data_a->serial > signal_data_b->serial)
+    return 1;
+  else
+    return 0;
+}
+
 /* called in GDBusWorker thread WITH lock held
  *
  * @sender is (nullable) for peer-to-peer connections */
 static void
 schedule_callbacks (GDBusConnection *connection,
-                    GPtrArray       *signal_data_array,
+                    GHashTable      *signal_data_index,
                     GDBusMessage    *message,
                     const gchar     *sender)
 {
@@ -4260,6 +4650,12 @@ schedule_callbacks (GDBusConnection *connection,
   const gchar *path;
   const gchar *arg0;
   const gchar *arg0_path;
+  const gchar *paths[2], *members[2], *arg0s[2];
+  guint i, j, k;
+  SignalData *stack_matches[16];
+  GPtrArray *heap_matches = NULL;
+  SignalData **matches = stack_matches;
+  guint n_matches = 0;
 
   interface = NULL;
   member = NULL;
@@ -4290,79 +4686,61 @@ schedule_callbacks (GDBusConnection *connection,
            arg0);
 #endif
 
-  /* TODO: if this is slow, then we can change signal_data_array into
-   *       map_object_path_to_signal_data_array or something.
-   */
-  for (n = 0; n < signal_data_array->len; n++)
-    {
-      SignalData *signal_data = signal_data_array->pdata[n];
-
-      if (signal_data->interface_name != NULL && g_strcmp0 (signal_data->interface_name, interface) != 0)
-        continue;
-
-      if (signal_data->member != NULL && g_strcmp0 (signal_data->member, member) != 0)
-        continue;
-
-      if (signal_data->object_path != NULL && g_strcmp0 (signal_data->object_path, path) != 0)
-        continue;
-
-      if (signal_data->shared_name_watcher != NULL)
+  /* Only the buckets keyed on either the signal's value or on “any value”
+   * for each of the object path, member and arg0 can contain matching
+   * SignalData. */
+  paths[0] = path;
+  paths[1] = NULL;
+  members[0] = member;
+  members[1] = NULL;
+  arg0s[0] = arg0;
+  arg0s[1] = NULL;
+
+  for (i = 0; i < 2; i++)
+    for (j = 0; j < 2; j++)
+      for (k = (arg0 != NULL) ? 0 : 1; k < 2; k++)
         {
-          /* We want signals from a specified well-known name, which means
-           * the signal's sender needs to be the unique name that currently
-           * owns that well-known name, and we will have found this
-           * SignalData in
-           * connection->map_sender_unique_name_to_signal_data_array[""]. */
-          const WatchedName *watched_name;
-          const char *current_owner;
-
-          g_assert (signal_data->sender != NULL);
-          /* Invariant: We never need to watch for the owner of a unique
-           * name, or for the owner of DBUS_SERVICE_DBUS, either of which
-           * is always its own owner */
-          g_assert (!g_dbus_is_unique_name (signal_data->sender));
-          g_assert (g_strcmp0 (signal_data->sender, DBUS_SERVICE_DBUS) != 0);
-
-          watched_name = signal_data->shared_name_watcher->watched_name;
-          g_assert (watched_name != NULL);
-          current_owner = watched_name->owner;
-
-          /* Skip the signal if the actual sender is not known to own
-           * the required name */
-          if (current_owner == NULL || g_strcmp0 (current_owner, sender) != 0)
+          SignalDataKey key = { paths[i], members[j], arg0s[k] };
+          SignalDataBucket *bucket;
+
+          bucket = g_hash_table_lookup (signal_data_index, &key);
+          if (bucket == NULL)
             continue;
-        }
-      else if (signal_data->sender != NULL)
-        {
-          /* We want signals from a unique name or o.fd.DBus... */
-          g_assert (g_dbus_is_unique_name (signal_data->sender)
-                    || g_str_equal (signal_data->sender, DBUS_SERVICE_DBUS));
-
-          /* ... which means we must have found this SignalData in
-           * connection->map_sender_unique_name_to_signal_data_array[signal_data->sender],
-           * therefore we would only have found it if the signal's
-           * actual sender matches the required signal_data->sender */
-          g_assert (g_strcmp0 (signal_data->sender, sender) == 0);
-        }
-      /* else the sender is unspecified and we will accept anything */
 
-      if (signal_data->arg0 != NULL)
-        {
-          if (signal_data->flags & G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE)
-            {
-              if (arg0 == NULL || !namespace_rule_matches (signal_data->arg0, arg0))
-                continue;
-            }
-          else if (signal_data->flags & G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_PATH)
+          for (n = 0; n < bucket->signal_data->len; n++)
             {
-              if ((arg0 == NULL || !path_rule_matches (signal_data->arg0, arg0)) &&
-                  (arg0_path == NULL || !path_rule_matches (signal_data->arg0, arg0_path)))
+              SignalData *signal_data = bucket->signal_data->pdata[n];
+
+              if (!signal_data_matches (signal_data, sender, interface, member,
+                                        path, arg0, arg0_path))
                 continue;
+
+              if (heap_matches != NULL)
+                g_ptr_array_add (heap_matches, signal_data);
+              else if (n_matches < G_N_ELEMENTS (stack_matches))
+                stack_matches[n_matches] = signal_data;
+              else
+                {
+                  heap_matches = g_ptr_array_sized_new (n_matches * 2);
+                  for (m = 0; m < n_matches; m++)
+                    g_ptr_array_add (heap_matches, stack_matches[m]);
+                  g_ptr_array_add (heap_matches, signal_data);
+                }
+              n_matches++;
             }
-          else if (arg0 == NULL || !g_str_equal (signal_data->arg0, arg0))
-            continue;
         }
 
+  if (heap_matches != NULL)
+    matches = (SignalData **) heap_matches->pdata;
+
+  /* Keep delivering in subscription order, as the buckets are unordered. */
+  if (n_matches > 1)
+    qsort (matches, n_matches, sizeof (SignalData *), signal_data_compare_serial);
+
+  for (n = 0; n < n_matches; n++)
+    {
+      SignalData *signal_data = matches[n];
+
       if (signal_data->watched_name != NULL)
         {
           /* Invariant: SignalData should only have a watched_name if it
@@ -4400,6 +4778,8 @@ schedule_callbacks (GDBusConnection *connection,
           g_source_unref (idle_source);
         }
     }
+
+  g_clear_pointer (&heap_matches, g_ptr_array_unref);
 }
 
 /* called in GDBusWorker thread with lock held */
@@ -4407,7 +4787,7 @@ static void
 distribute_signals (GDBusConnection *connection,
                     GDBusMessage    *message)
 {
-  GPtrArray *signal_data_array;
+  GHashTable *signal_data_index;
   const gchar *sender, *interface, *member, *path;
 
   g_assert (g_dbus_message_get_message_type (message) == G_DBUS_MESSAGE_TYPE_SIGNAL);
@@ -4440,15 +4820,15 @@ distribute_signals (GDBusConnection *connection,
   /* collect subscribers that match on sender */
   if (sender != NULL)
     {
-      signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array, sender);
-      if (signal_data_array != NULL)
-        schedule_callbacks (connection, signal_data_array, message, sender);
+      signal_data_index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index, sender);
+      if (signal_data_index != NULL)
+        schedule_callbacks (connection, signal_data_index, message, sender);
     }
 
   /* collect subscribers not matching on sender, or matching a well-known name */
-  signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array, "");
-  if (signal_data_array != NULL)
-    schedule_callbacks (connection, signal_data_array, message, sender);
+  signal_data_index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index, "");
+  if (signal_data_index != NULL)
+    schedule_callbacks (connection, signal_data_index, message, sender);
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -4532,6 +4912,104 @@ exported_object_free (ExportedObject *eo)
   g_free (eo);
 }
 
+/* A thread pool method calls for an exported interface are dispatched to
+ * instead of the interface's #GMainContext, see
+ * g_dbus_connection_set_dispatch_thread_pool(). Every invocation pushed to
+ * the pool, or queued behind another invocation from the same sender, holds
+ * a reference to it. */
+struct DispatchPool
+{
+  gint                refcount;  /* (atomic) */
+
+  GThreadPool        *thread_pool;  /* (owned) */
+  GDBusDispatchFlags  flags;
+
+  GMutex              lock;
+  /* sender (or "" for peer-to-peer connections) → GQueue of
+   * (owned) GDBusMethodInvocation waiting for the sender's current call to
+   * finish; only used with %G_DBUS_DISPATCH_FLAGS_ORDER_PER_SENDER */
+  GHashTable         *busy_senders;  /* (owned) (element-type utf8 GQueue), protected by lock */
+};
+
+static void dispatch_pool_thread_func (gpointer data,
+                                       gpointer user_data);
+
+static DispatchPool *
+dispatch_pool_new (guint              max_threads,
+                   GDBusDispatchFlags flags)
+{
+  DispatchPool *pool;
+
+  pool = g_new0 (DispatchPool, 1);
+  pool->refcount = 1;
+  pool->flags = flags;
+  g_mutex_init (&pool->lock);
+  pool->busy_senders = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              g_free, (GDestroyNotify) g_queue_free);
+  /* Non-exclusive, so idle threads are shared with the rest of the process */
+  pool->thread_pool = g_thread_pool_new (dispatch_pool_thread_func, pool,
+                                         max_threads, FALSE, NULL);
+
+  return pool;
+}
+
+static DispatchPool *
+dispatch_pool_ref (DispatchPool *pool)
+{
+  g_atomic_int_inc (&pool->refcount);
+
+  return pool;
+}
+
+/* May be called with the connection lock held, and from a thread of the
+ * pool itself: in that case the GThreadPool is freed once the calling
+ * thread returns to it. */
+static void
+dispatch_pool_unref (DispatchPool *pool)
+{
+  if (!g_atomic_int_dec_and_test (&pool->refcount))
+    return;
+
+  g_assert (g_hash_table_size (pool->busy_senders) == 0);
+
+  g_thread_pool_free (pool->thread_pool, FALSE, FALSE);
+  g_hash_table_unref (pool->busy_senders);
+  g_mutex_clear (&pool->lock);
+  g_free (pool);
+}
+
+/* called in GDBusWorker thread with connection's lock held */
+static void
+dispatch_pool_push (DispatchPool          *pool,
+                    GDBusMethodInvocation *invocation)  /* (transfer full) */
+{
+  dispatch_pool_ref (pool);
+
+  if (pool->flags & G_DBUS_DISPATCH_FLAGS_ORDER_PER_SENDER)
+    {
+      const gchar *sender;
+      GQueue *queue;
+
+      sender = g_dbus_method_invocation_get_sender (invocation);
+      if (sender == NULL)
+        sender = "";
+
+      g_mutex_lock (&pool->lock);
+      queue = g_hash_table_lookup (pool->busy_senders, sender);
+      if (queue != NULL)
+        {
+          /* the thread running the sender's current call picks it up */
+          g_queue_push_tail (queue, invocation);
+          g_mutex_unlock (&pool->lock);
+          return;
+        }
+      g_hash_table_insert (pool->busy_senders, g_strdup (sender), g_queue_new ());
+      g_mutex_unlock (&pool->lock);
+    }
+
+  g_thread_pool_push (pool->thread_pool, invocation, NULL);
+}
+
 typedef struct
 {
   ExportedObject *eo;
@@ -4546,6 +5024,8 @@ typedef struct
   GMainContext               *context;  /* (owned) */
   gpointer                    user_data;
   GDestroyNotify              user_data_free_func;
+
+  DispatchPool               *pool;  /* (owned) (nullable), protected by connection lock */
 } ExportedInterface;
 
 static ExportedInterface *
@@ -4575,6 +5055,7 @@ exported_interface_unref (ExportedInterface *ei)
 
   g_main_context_unref (ei->context);
 
+  g_clear_pointer (&ei->pool, dispatch_pool_unref);
   g_free (ei->interface_name);
   _g_dbus_interface_vtable_free (ei->vtable);
   g_free (ei);
@@ -4929,7 +5410,7 @@ validate_and_maybe_schedule_property_getset (GDBusConnection            *connect
         {
           schedule_method_call (connection, message, registration_id, subtree_registration_id,
                                 interface_info, NULL, property_info, g_dbus_message_get_body (message),
-                                vtable, main_context, user_data);
+                                vtable, main_context, NULL, user_data);
           handled = TRUE;
           goto out;
         }
@@ -4940,7 +5421,7 @@ validate_and_maybe_schedule_property_getset (GDBusConnection            *connect
         {
           schedule_method_call (connection, message, registration_id, subtree_registration_id,
                                 interface_info, NULL, property_info, g_dbus_message_get_body (message),
-                                vtable, main_context, user_data);
+                                vtable, main_context, NULL, user_data);
           handled = TRUE;
           goto out;
         }
@@ -5172,7 +5653,7 @@ validate_and_maybe_schedule_property_get_all (GDBusConnection            *connec
     {
       schedule_method_call (connection, message, registration_id, subtree_registration_id,
                             interface_info, NULL, NULL, g_dbus_message_get_body (message),
-                            vtable, main_context, user_data);
+                            vtable, main_context, NULL, user_data);
       handled = TRUE;
       goto out;
     }
@@ -5471,6 +5952,49 @@ call_in_idle_cb (gpointer user_data)
   return FALSE;
 }
 
+/* called in a thread of the pool - no locks held */
+static void
+dispatch_pool_thread_func (gpointer data,
+                           gpointer user_data)
+{
+  GDBusMethodInvocation *invocation = data;  /* (owned) */
+  DispatchPool *pool = user_data;
+  gchar *sender = NULL;
+
+  if (pool->flags & G_DBUS_DISPATCH_FLAGS_ORDER_PER_SENDER)
+    {
+      sender = g_strdup (g_dbus_method_invocation_get_sender (invocation));
+      if (sender == NULL)
+        sender = g_strdup ("");
+    }
+
+  while (invocation != NULL)
+    {
+      call_in_idle_cb (invocation);
+      g_clear_object (&invocation);
+
+      /* run the calls the same sender made in the meantime, in order */
+      if (sender != NULL)
+        {
+          GQueue *queue;
+
+          g_mutex_lock (&pool->lock);
+          queue = g_hash_table_lookup (pool->busy_senders, sender);
+          invocation = g_queue_pop_head (queue);
+          if (invocation == NULL)
+            g_hash_table_remove (pool->busy_senders, sender);
+          g_mutex_unlock (&pool->lock);
+
+          /* we already hold a reference for the first invocation */
+          if (invocation != NULL)
+            dispatch_pool_unref (pool);
+        }
+    }
+
+  g_free (sender);
+  dispatch_pool_unref (pool);
+}
+
 /* called in GDBusWorker thread with connection's lock held */
 static void
 schedule_method_call (GDBusConnection            *connection,
@@ -5483,6 +6007,7 @@ schedule_method_call (GDBusConnection            *connection,
                       GVariant                   *parameters,
                       const GDBusInterfaceVTable *vtable,
                       GMainContext               *main_context,
+                      DispatchPool               *pool,
                       gpointer                    user_data)
 {
   GDBusMethodInvocation *invocation;
@@ -5499,12 +6024,22 @@ schedule_method_call (GDBusConnection            *connection,
                                               parameters,
                                               user_data);
 
+  if (connection->statistics != NULL)
+    _g_dbus_method_invocation_set_statistics (invocation, connection->statistics);
+
   /* TODO: would be nicer with a real MethodData like we already
    * have PropertyData and PropertyGetAllData... */
   g_object_set_data (G_OBJECT (invocation), "g-dbus-interface-vtable", (gpointer) vtable);
   g_object_set_data (G_OBJECT (invocation), "g-dbus-registration-id", GUINT_TO_POINTER (registration_id));
   g_object_set_data (G_OBJECT (invocation), "g-dbus-subtree-registration-id", GUINT_TO_POINTER (subtree_registration_id));
 
+  if (pool != NULL)
+    {
+      _g_dbus_method_invocation_set_in_dispatch_pool (invocation);
+      dispatch_pool_push (pool, g_steal_pointer (&invocation));
+      return;
+    }
+
   idle_source = g_idle_source_new ();
   g_source_set_priority (idle_source, G_PRIORITY_DEFAULT);
   g_source_set_callback (idle_source,
@@ -5525,6 +6060,7 @@ validate_and_maybe_schedule_method_call (GDBusConnection            *connection,
                                          GDBusInterfaceInfo         *interface_info,
                                          const GDBusInterfaceVTable *vtable,
                                          GMainContext               *main_context,
+                                         DispatchPool               *pool,
                                          gpointer                    user_data)
 {
   GDBusMethodInfo *method_info;
@@ -5592,7 +6128,7 @@ validate_and_maybe_schedule_method_call (GDBusConnection            *connection,
   /* schedule the call in idle */
   schedule_method_call (connection, message, registration_id, subtree_registration_id,
                         interface_info, method_info, NULL, parameters,
-                        vtable, main_context, user_data);
+                        vtable, main_context, pool, user_data);
   g_variant_unref (parameters);
   handled = TRUE;
 
@@ -5640,6 +6176,7 @@ obj_message_func (GDBusConnection *connection,
                                                              ei->interface_info,
                                                              ei->vtable,
                                                              ei->context,
+                                                             ei->pool,
                                                              ei->user_data);
           goto out;
         }
@@ -5864,6 +6401,79 @@ g_dbus_connection_unregister_object (GDBusConnection *connection,
   return ret;
 }
 
+/**
+ * g_dbus_connection_set_dispatch_thread_pool:
+ * @connection: a #GDBusConnection
+ * @registration_id: a registration id obtained from
+ *     g_dbus_connection_register_object()
+ * @max_threads: maximum number of method calls to the registered interface
+ *     that may run at the same time, or 0 to dispatch them to the
+ *     #GMainContext again
+ * @flags: flags from the #GDBusDispatchFlags enumeration
+ *
+ * Changes how incoming method calls for the interface registered as
+ * @registration_id are dispatched.
+ *
+ * By default, the `method_call` function of the #GDBusInterfaceVTable passed
+ * to g_dbus_connection_register_object() is invoked in the
+ * [thread-default main context][g-main-context-push-thread-default] of the
+ * thread that registered the object, one call at a time. If @max_threads is
+ * non-zero, it is instead invoked in a thread pool, with at most
+ * @max_threads calls to this registration running concurrently. The
+ * `method_call` function, and whatever it touches, must then be thread-safe.
+ * Property accesses are still handled in the #GMainContext.
+ *
+ * Calls are not guaranteed to be handled in the order they were received.
+ * Pass %G_DBUS_DISPATCH_FLAGS_ORDER_PER_SENDER to keep the calls made by each
+ * sender in order while still running calls from different senders in
+ * parallel.
+ *
+ * Calls that were received before the dispatch mode is changed are
+ * handled the way they were scheduled.
+ *
+ * Subtrees registered with g_dbus_connection_register_subtree() are
+ * always dispatched to their #GMainContext.
+ *
+ * Returns: %TRUE if @registration_id is a registered object,
+ *     %FALSE otherwise
+ *
+ * Since: 2.82
+ */
+gboolean
+g_dbus_connection_set_dispatch_thread_pool (GDBusConnection    *connection,
+                                            guint               registration_id,
+                                            guint               max_threads,
+                                            GDBusDispatchFlags  flags)
+{
+  ExportedInterface *ei;
+  gboolean ret;
+
+  g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), FALSE);
+  g_return_val_if_fail (check_initialized (connection), FALSE);
+  g_return_val_if_fail (max_threads <= G_MAXINT, FALSE);
+
+  ret = FALSE;
+
+  CONNECTION_LOCK (connection);
+
+  ei = g_hash_table_lookup (connection->map_id_to_ei,
+                            GUINT_TO_POINTER (registration_id));
+  if (ei == NULL)
+    goto out;
+
+  /* Calls already queued keep the old pool alive until they have run */
+  g_clear_pointer (&ei->pool, dispatch_pool_unref);
+  if (max_threads > 0)
+    ei->pool = dispatch_pool_new (max_threads, flags);
+
+  ret = TRUE;
+
+ out:
+  CONNECTION_UNLOCK (connection);
+
+  return ret;
+}
+
 typedef struct {
   GClosure *method_call_closure;
   GClosure *get_property_closure;
@@ -7178,6 +7788,7 @@ handle_subtree_method_invocation (GDBusConnection *connection,
                                                          interface_info,
                                                          interface_vtable,
                                                          es->context,
+                                                         NULL,
                                                          interface_user_data);
       CONNECTION_UNLOCK (connection);
     }
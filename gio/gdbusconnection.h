@@ -118,6 +118,14 @@ GIO_AVAILABLE_IN_ALL
 GDBusCapabilityFlags  g_dbus_connection_get_capabilities      (GDBusConnection    *connection);
 GIO_AVAILABLE_IN_2_60
 GDBusConnectionFlags  g_dbus_connection_get_flags             (GDBusConnection    *connection);
+GIO_AVAILABLE_IN_2_82
+gboolean         g_dbus_connection_set_memfd_threshold        (GDBusConnection    *connection,
+                                                               gsize               threshold);
+GIO_AVAILABLE_IN_2_82
+void             g_dbus_connection_set_statistics_enabled     (GDBusConnection    *connection,
+                                                               gboolean            enabled);
+GIO_AVAILABLE_IN_2_82
+GVariant        *g_dbus_connection_get_statistics             (GDBusConnection    *connection);
 
 /* ---------------------------------------------------------------------------------------------------- */
 
@@ -421,6 +429,11 @@ guint            g_dbus_connection_register_object_with_closures (GDBusConnectio
 GIO_AVAILABLE_IN_ALL
 gboolean         g_dbus_connection_unregister_object          (GDBusConnection            *connection,
                                                                guint                       registration_id);
+GIO_AVAILABLE_IN_2_82
+gboolean         g_dbus_connection_set_dispatch_thread_pool   (GDBusConnection            *connection,
+                                                               guint                       registration_id,
+                                                               guint                       max_threads,
+                                                               GDBusDispatchFlags          flags);
 
 /* ---------------------------------------------------------------------------------------------------- */
 
@@ -1558,6 +1558,8 @@ g_dbus_daemon_finalize (GObject *object)
   g_hash_table_destroy (daemon->clients);
   g_hash_table_destroy (daemon->names);
 
+  /* Stopping the server removes its socket, so that @tmpdir can be removed */
+  g_dbus_server_stop (daemon->server);
   g_object_unref (daemon->server);
 
   if (daemon->tmpdir)
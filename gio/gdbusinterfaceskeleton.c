@@ -53,6 +53,9 @@ struct _GDBusInterfaceSkeletonPrivate
   GSList                     *connections;   /* List of ConnectionData */
   gchar                      *object_path;   /* The object path for this skeleton */
   GDBusInterfaceVTable       *hooked_vtable;
+
+  guint                       dispatch_max_threads;
+  GDBusDispatchFlags          dispatch_flags;
 };
 
 typedef struct
@@ -312,6 +315,48 @@ g_dbus_interface_skeleton_set_flags (GDBusInterfaceSkeleton      *interface_,
     }
 }
 
+/**
+ * g_dbus_interface_skeleton_set_dispatch_thread_pool:
+ * @interface_: A #GDBusInterfaceSkeleton.
+ * @max_threads: Maximum number of method calls to handle at the same time
+ *   on each connection @interface_ is exported on, or 0 to handle them as
+ *   described by #GDBusInterfaceSkeleton:g-flags again.
+ * @flags: Flags from the #GDBusDispatchFlags enumeration.
+ *
+ * Makes @interface_ handle incoming method calls in a thread pool
+ * instead of the thread it was exported in, see
+ * g_dbus_connection_set_dispatch_thread_pool() for details. This applies to
+ * current and future exports of @interface_.
+ *
+ * The #GDBusInterfaceSkeleton::g-authorize-method signal and the method
+ * handler are both run in the pool thread, regardless of
+ * %G_DBUS_INTERFACE_SKELETON_FLAGS_HANDLE_METHOD_INVOCATIONS_IN_THREAD.
+ *
+ * Since: 2.82
+ */
+void
+g_dbus_interface_skeleton_set_dispatch_thread_pool (GDBusInterfaceSkeleton *interface_,
+                                                    guint                   max_threads,
+                                                    GDBusDispatchFlags      flags)
+{
+  GSList *l;
+
+  g_return_if_fail (G_IS_DBUS_INTERFACE_SKELETON (interface_));
+
+  g_mutex_lock (&interface_->priv->lock);
+  interface_->priv->dispatch_max_threads = max_threads;
+  interface_->priv->dispatch_flags = flags;
+  for (l = interface_->priv->connections; l != NULL; l = l->next)
+    {
+      ConnectionData *data = l->data;
+      g_dbus_connection_set_dispatch_thread_pool (data->connection,
+                                                  data->registration_id,
+                                                  max_threads,
+                                                  flags);
+    }
+  g_mutex_unlock (&interface_->priv->lock);
+}
+
 /**
  * g_dbus_interface_skeleton_get_info:
  * @interface_: A #GDBusInterfaceSkeleton.
@@ -495,25 +540,13 @@ dispatch_invoke_in_context_func (gpointer user_data)
   return FALSE;
 }
 
-static void
-dispatch_in_thread_func (GTask        *task,
-                         gpointer      source_object,
-                         gpointer      task_data,
-                         GCancellable *cancellable)
+static gboolean
+emit_authorize_method (GDBusInterfaceSkeleton *interface,
+                       GDBusObject            *object,
+                       GDBusMethodInvocation  *invocation)
 {
-  DispatchData *data = task_data;
-  GDBusInterfaceSkeleton *interface = g_task_get_source_object (task);
-  GDBusInterfaceSkeletonFlags flags;
-  GDBusObject *object;
   gboolean authorized;
 
-  g_mutex_lock (&interface->priv->lock);
-  flags = interface->priv->flags;
-  object = interface->priv->object;
-  if (object != NULL)
-    g_object_ref (object);
-  g_mutex_unlock (&interface->priv->lock);
-
   /* first check on the enclosing object (if any), then the interface */
   authorized = TRUE;
   if (object != NULL)
@@ -521,7 +554,7 @@ dispatch_in_thread_func (GTask        *task,
       g_signal_emit_by_name (object,
                              "authorize-method",
                              interface,
-                             data->invocation,
+                             invocation,
                              &authorized);
     }
   if (authorized)
@@ -529,11 +562,32 @@ dispatch_in_thread_func (GTask        *task,
       g_signal_emit (interface,
                      signals[G_AUTHORIZE_METHOD_SIGNAL],
                      0,
-                     data->invocation,
+                     invocation,
                      &authorized);
     }
 
-  if (authorized)
+  return authorized;
+}
+
+static void
+dispatch_in_thread_func (GTask        *task,
+                         gpointer      source_object,
+                         gpointer      task_data,
+                         GCancellable *cancellable)
+{
+  DispatchData *data = task_data;
+  GDBusInterfaceSkeleton *interface = g_task_get_source_object (task);
+  GDBusInterfaceSkeletonFlags flags;
+  GDBusObject *object;
+
+  g_mutex_lock (&interface->priv->lock);
+  flags = interface->priv->flags;
+  object = interface->priv->object;
+  if (object != NULL)
+    g_object_ref (object);
+  g_mutex_unlock (&interface->priv->lock);
+
+  if (emit_authorize_method (interface, object, data->invocation))
     {
       gboolean run_in_thread;
       run_in_thread = (flags & G_DBUS_INTERFACE_SKELETON_FLAGS_HANDLE_METHOD_INVOCATIONS_IN_THREAD);
@@ -579,6 +633,7 @@ g_dbus_interface_method_dispatch_helper (GDBusInterfaceSkeleton       *interface
   gboolean has_default_class_handler;
   gboolean emit_authorized_signal;
   gboolean run_in_thread;
+  gboolean in_dispatch_pool;
   GDBusInterfaceSkeletonFlags flags;
   GDBusObject *object;
 
@@ -586,6 +641,10 @@ g_dbus_interface_method_dispatch_helper (GDBusInterfaceSkeleton       *interface
   g_return_if_fail (method_call_func != NULL);
   g_return_if_fail (G_IS_DBUS_METHOD_INVOCATION (invocation));
 
+  /* the dispatch pool can be changed at any time, so ask the invocation how
+   * it was actually dispatched */
+  in_dispatch_pool = _g_dbus_method_invocation_get_in_dispatch_pool (invocation);
+
   g_mutex_lock (&interface->priv->lock);
   flags = interface->priv->flags;
   object = interface->priv->object;
@@ -613,7 +672,23 @@ g_dbus_interface_method_dispatch_helper (GDBusInterfaceSkeleton       *interface
     }
 
   run_in_thread = (flags & G_DBUS_INTERFACE_SKELETON_FLAGS_HANDLE_METHOD_INVOCATIONS_IN_THREAD);
-  if (!emit_authorized_signal && !run_in_thread)
+  if (in_dispatch_pool)
+    {
+      /* already in a thread of the dispatch pool, so there is no need to
+       * hop to another one for blocking authorization checks */
+      if (!emit_authorized_signal || emit_authorize_method (interface, object, invocation))
+        {
+          method_call_func (g_dbus_method_invocation_get_connection (invocation),
+                            g_dbus_method_invocation_get_sender (invocation),
+                            g_dbus_method_invocation_get_object_path (invocation),
+                            g_dbus_method_invocation_get_interface_name (invocation),
+                            g_dbus_method_invocation_get_method_name (invocation),
+                            g_dbus_method_invocation_get_parameters (invocation),
+                            invocation,
+                            g_dbus_method_invocation_get_user_data (invocation));
+        }
+    }
+  else if (!emit_authorized_signal && !run_in_thread)
     {
       method_call_func (g_dbus_method_invocation_get_connection (invocation),
                         g_dbus_method_invocation_get_sender (invocation),
@@ -720,6 +795,12 @@ add_connection_locked (GDBusInterfaceSkeleton *interface_,
 
   if (registration_id > 0)
     {
+      if (interface_->priv->dispatch_max_threads > 0)
+        g_dbus_connection_set_dispatch_thread_pool (connection,
+                                                    registration_id,
+                                                    interface_->priv->dispatch_max_threads,
+                                                    interface_->priv->dispatch_flags);
+
       data = new_connection (connection, registration_id);
       interface_->priv->connections = g_slist_append (interface_->priv->connections, data);
       ret = TRUE;
@@ -59,6 +59,13 @@
 #include "gunixfdlist.h"
 #endif
 
+#ifdef HAVE_MEMFD_CREATE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#endif
+
 #include "glibintl.h"
 
 /* See https://dbus.freedesktop.org/doc/dbus-specification.html#message-protocol-marshaling-signature
@@ -73,6 +80,15 @@ struct _GMemoryBuffer
   gsize pos;
   gchar *data;
   GDataStreamByteOrder byte_order;
+
+  /* Only used when serializing for the GDBusWorker, see
+   * _g_dbus_message_to_blob_with_splices() */
+  GArray *splices;  /* (nullable) (element-type GDBusMessageSplice) */
+  gsize splice_delta;  /* total size of @splices minus their filler */
+
+  /* Only used when parsing for the GDBusWorker, see
+   * _g_dbus_message_new_from_bytes() */
+  GBytes *bytes;  /* (nullable) owner of @data */
 };
 
 static gboolean
@@ -462,6 +478,35 @@ g_memory_buffer_put_string (GMemoryBuffer  *mbuf,
   return g_memory_buffer_write (mbuf, str, strlen (str));
 }
 
+/* Appends @bytes by reference instead of copying it into @mbuf. Only
+ * `size % 8` placeholder bytes are written so that the alignment of
+ * everything serialized after it stays correct; the placeholder is replaced
+ * by @bytes when the message is written out. Takes ownership of @bytes.
+ */
+static void
+g_memory_buffer_splice (GMemoryBuffer  *mbuf,
+                        GBytes         *bytes)
+{
+  GDBusMessageSplice splice;
+  gsize size;
+  gsize n;
+
+  g_assert (mbuf->splices != NULL);
+  g_assert (mbuf->pos == mbuf->valid_len);
+
+  size = g_bytes_get_size (bytes);
+
+  splice.offset = mbuf->pos;
+  splice.filler = size % 8;
+  splice.bytes = bytes;  /* steal */
+  g_array_append_val (mbuf->splices, splice);
+
+  for (n = 0; n < splice.filler; n++)
+    g_memory_buffer_put_byte (mbuf, '\0');
+
+  mbuf->splice_delta += size - splice.filler;
+}
+
 typedef struct _GDBusMessageClass GDBusMessageClass;
 
 /**
@@ -1967,7 +2012,26 @@ parse_value_from_blob (GMemoryBuffer       *buf,
               if (array_data == NULL)
                 goto fail;
 
-              ret = g_variant_new_fixed_array (element_type, array_data, array_len / fixed_size, fixed_size);
+              if (buf->bytes != NULL &&
+                  array_len >= G_DBUS_MESSAGE_MIN_SPLICE_SIZE &&
+                  array_len >= g_bytes_get_size (buf->bytes) / 4 &&
+                  !g_memory_buffer_is_byteswapped (buf))
+                {
+                  GBytes *array_bytes;
+
+                  /* Reference the data in the receive buffer rather than
+                   * copying it; any fixed-size data is valid. Arrays which
+                   * are only a small part of the buffer are copied instead,
+                   * so that keeping them alive does not pin the rest of the
+                   * message. */
+                  array_bytes = g_bytes_new_from_bytes (buf->bytes,
+                                                        (const gchar *) array_data - buf->data,
+                                                        array_len);
+                  ret = g_variant_new_from_bytes (type, array_bytes, TRUE);
+                  g_bytes_unref (array_bytes);
+                }
+              else
+                ret = g_variant_new_fixed_array (element_type, array_data, array_len / fixed_size, fixed_size);
 
               if (g_memory_buffer_is_byteswapped (buf))
                 {
@@ -2314,30 +2378,12 @@ g_dbus_message_bytes_needed (guchar  *blob,
 
 /* ---------------------------------------------------------------------------------------------------- */
 
-/**
- * g_dbus_message_new_from_blob:
- * @blob: (array length=blob_len) (element-type guint8): A blob representing a binary D-Bus message.
- * @blob_len: The length of @blob.
- * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
- * @error: Return location for error or %NULL.
- *
- * Creates a new #GDBusMessage from the data stored at @blob. The byte
- * order that the message was in can be retrieved using
- * g_dbus_message_get_byte_order().
- *
- * If the @blob cannot be parsed, contains invalid fields, or contains invalid
- * headers, %G_IO_ERROR_INVALID_ARGUMENT will be returned.
- *
- * Returns: A new #GDBusMessage or %NULL if @error is set. Free with
- * g_object_unref().
- *
- * Since: 2.26
- */
-GDBusMessage *
-g_dbus_message_new_from_blob (guchar                *blob,
-                              gsize                  blob_len,
-                              GDBusCapabilityFlags   capabilities,
-                              GError               **error)
+static GDBusMessage *
+deserialize_message (guchar                *blob,
+                     gsize                  blob_len,
+                     GBytes                *bytes,
+                     GDBusCapabilityFlags   capabilities,
+                     GError               **error)
 {
   GError *local_error = NULL;
   GMemoryBuffer mbuf;
@@ -2352,14 +2398,12 @@ g_dbus_message_new_from_blob (guchar                *blob,
 
   /* TODO: check against @capabilities */
 
-  g_return_val_if_fail (blob != NULL, NULL);
-  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
   message = g_dbus_message_new ();
 
   memset (&mbuf, 0, sizeof (mbuf));
   mbuf.data = (gchar *)blob;
   mbuf.len = mbuf.valid_len = blob_len;
+  mbuf.bytes = bytes;
 
   endianness = g_memory_buffer_read_byte (&mbuf, &local_error);
   if (local_error)
@@ -2545,6 +2589,66 @@ fail:
   return NULL;
 }
 
+/**
+ * g_dbus_message_new_from_blob:
+ * @blob: (array length=blob_len) (element-type guint8): A blob representing a binary D-Bus message.
+ * @blob_len: The length of @blob.
+ * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
+ * @error: Return location for error or %NULL.
+ *
+ * Creates a new #GDBusMessage from the data stored at @blob. The byte
+ * order that the message was in can be retrieved using
+ * g_dbus_message_get_byte_order().
+ *
+ * If the @blob cannot be parsed, contains invalid fields, or contains invalid
+ * headers, %G_IO_ERROR_INVALID_ARGUMENT will be returned.
+ *
+ * Returns: A new #GDBusMessage or %NULL if @error is set. Free with
+ * g_object_unref().
+ *
+ * Since: 2.26
+ */
+GDBusMessage *
+g_dbus_message_new_from_blob (guchar                *blob,
+                              gsize                  blob_len,
+                              GDBusCapabilityFlags   capabilities,
+                              GError               **error)
+{
+  g_return_val_if_fail (blob != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return deserialize_message (blob, blob_len, NULL, capabilities, error);
+}
+
+/*
+ * _g_dbus_message_new_from_bytes:
+ * @bytes: A #GBytes holding a binary D-Bus message.
+ * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
+ * @error: Return location for error or %NULL.
+ *
+ * Like g_dbus_message_new_from_blob(), but large fixed-size arrays in the
+ * body whose byte order matches the host are not copied out of @bytes.
+ * The values in the body of the returned message keep a reference to
+ * @bytes instead, so its contents must not be modified afterwards.
+ *
+ * Returns: A new #GDBusMessage or %NULL if @error is set.
+ */
+GDBusMessage *
+_g_dbus_message_new_from_bytes (GBytes                *bytes,
+                                GDBusCapabilityFlags   capabilities,
+                                GError               **error)
+{
+  gconstpointer blob;
+  gsize blob_len;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  blob = g_bytes_get_data (bytes, &blob_len);
+
+  return deserialize_message ((guchar *) blob, blob_len, bytes, capabilities, error);
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 static gsize
@@ -2729,6 +2833,7 @@ append_value_to_blob (GVariant            *value,
         goffset array_payload_begin_offset;
         goffset cur_offset;
         gsize array_len;
+        gsize splice_delta_begin;
         guint fixed_size;
 
         padding_added = ensure_output_padding (mbuf, 4);
@@ -2752,6 +2857,7 @@ append_value_to_blob (GVariant            *value,
              * contributes and subtract that from the array length.
              */
             array_payload_begin_offset = mbuf->valid_len;
+            splice_delta_begin = mbuf->splice_delta;
 
             element_type = g_variant_type_element (type);
             fixed_size = get_type_fixed_size (element_type);
@@ -2779,7 +2885,12 @@ append_value_to_blob (GVariant            *value,
                 array_payload_begin_offset += ensure_output_padding (mbuf, fixed_size);
 
                 array_len = g_variant_get_size (use_value);
-                g_memory_buffer_write (mbuf, g_variant_get_data (use_value), array_len);
+                if (mbuf->splices != NULL &&
+                    mbuf->splices->len < G_DBUS_MESSAGE_MAX_SPLICES &&
+                    array_len >= G_DBUS_MESSAGE_MIN_SPLICE_SIZE)
+                  g_memory_buffer_splice (mbuf, g_variant_get_data_as_bytes (use_value));
+                else
+                  g_memory_buffer_write (mbuf, g_variant_get_data (use_value), array_len);
                 g_variant_unref (use_value);
               }
             else
@@ -2810,6 +2921,7 @@ append_value_to_blob (GVariant            *value,
 
             cur_offset = mbuf->valid_len;
             array_len = cur_offset - array_payload_begin_offset;
+            array_len += mbuf->splice_delta - splice_delta_begin;
             mbuf->pos = array_len_offset;
 
             g_memory_buffer_put_uint32 (mbuf, array_len);
@@ -2934,27 +3046,20 @@ append_body_to_blob (GVariant       *value,
 
 /* ---------------------------------------------------------------------------------------------------- */
 
-/**
- * g_dbus_message_to_blob:
- * @message: A #GDBusMessage.
- * @out_size: Return location for size of generated blob.
- * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
- * @error: Return location for error.
- *
- * Serializes @message to a blob. The byte order returned by
- * g_dbus_message_get_byte_order() will be used.
- *
- * Returns: (array length=out_size) (transfer full): A pointer to a
- * valid binary D-Bus message of @out_size bytes generated by @message
- * or %NULL if @error is set. Free with g_free().
- *
- * Since: 2.26
- */
-guchar *
-g_dbus_message_to_blob (GDBusMessage          *message,
-                        gsize                 *out_size,
-                        GDBusCapabilityFlags   capabilities,
-                        GError               **error)
+static void
+clear_splice (gpointer data)
+{
+  GDBusMessageSplice *splice = data;
+
+  g_clear_pointer (&splice->bytes, g_bytes_unref);
+}
+
+static guchar *
+serialize_message (GDBusMessage          *message,
+                   gsize                 *out_size,
+                   GDBusCapabilityFlags   capabilities,
+                   GArray               **out_splices,
+                   GError               **error)
 {
   GMemoryBuffer mbuf;
   guchar *ret;
@@ -2976,10 +3081,6 @@ g_dbus_message_to_blob (GDBusMessage          *message,
 
   ret = NULL;
 
-  g_return_val_if_fail (G_IS_DBUS_MESSAGE (message), NULL);
-  g_return_val_if_fail (out_size != NULL, NULL);
-  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
   memset (&mbuf, 0, sizeof (mbuf));
   mbuf.len = MIN_ARRAY_SIZE;
   mbuf.data = g_malloc (mbuf.len);
@@ -3055,6 +3156,13 @@ g_dbus_message_to_blob (GDBusMessage          *message,
 
   body_start_offset = mbuf.valid_len;
 
+  /* Only large values in the body are worth splicing in by reference */
+  if (out_splices != NULL)
+    {
+      mbuf.splices = g_array_new (FALSE, FALSE, sizeof (GDBusMessageSplice));
+      g_array_set_clear_func (mbuf.splices, clear_splice);
+    }
+
   signature = g_dbus_message_get_header (message, G_DBUS_MESSAGE_HEADER_FIELD_SIGNATURE);
 
   if (signature != NULL && !g_variant_is_of_type (signature, G_VARIANT_TYPE_SIGNATURE))
@@ -3111,7 +3219,7 @@ g_dbus_message_to_blob (GDBusMessage          *message,
 
   /* OK, we're done writing the message - set the body length */
   size = mbuf.valid_len;
-  body_size = size - body_start_offset;
+  body_size = size - body_start_offset + mbuf.splice_delta;
 
   mbuf.pos = body_len_offset;
 
@@ -3120,13 +3228,85 @@ g_dbus_message_to_blob (GDBusMessage          *message,
   *out_size = size;
   ret = (guchar *)mbuf.data;
 
+  if (out_splices != NULL)
+    {
+      if (mbuf.splices->len > 0)
+        *out_splices = g_steal_pointer (&mbuf.splices);
+      else
+        *out_splices = NULL;
+    }
+
  out:
   if (ret == NULL)
     g_free (mbuf.data);
+  g_clear_pointer (&mbuf.splices, g_array_unref);
 
   return ret;
 }
 
+/*
+ * _g_dbus_message_to_blob_with_splices:
+ * @message: A #GDBusMessage.
+ * @out_size: Return location for size of the generated blob.
+ * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
+ * @out_splices: (out) (transfer full) (nullable) (element-type GDBusMessageSplice):
+ *   Return location for the data to splice into the blob, or %NULL if there is none.
+ * @error: Return location for error.
+ *
+ * Like g_dbus_message_to_blob(), but large fixed-size arrays in the body
+ * whose byte order matches the message are not copied into the blob.
+ * Instead, @out_splices refers to the serialized data of the body
+ * #GVariant, to be written out in place of `filler` bytes at `offset` in
+ * the blob with vectored I/O. The header is always contained in the blob.
+ *
+ * Returns: (transfer full): The blob, or %NULL if @error is set.
+ */
+guchar *
+_g_dbus_message_to_blob_with_splices (GDBusMessage          *message,
+                                      gsize                 *out_size,
+                                      GDBusCapabilityFlags   capabilities,
+                                      GArray               **out_splices,
+                                      GError               **error)
+{
+  g_return_val_if_fail (G_IS_DBUS_MESSAGE (message), NULL);
+  g_return_val_if_fail (out_size != NULL, NULL);
+  g_return_val_if_fail (out_splices != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  *out_splices = NULL;
+
+  return serialize_message (message, out_size, capabilities, out_splices, error);
+}
+
+/**
+ * g_dbus_message_to_blob:
+ * @message: A #GDBusMessage.
+ * @out_size: Return location for size of generated blob.
+ * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
+ * @error: Return location for error.
+ *
+ * Serializes @message to a blob. The byte order returned by
+ * g_dbus_message_get_byte_order() will be used.
+ *
+ * Returns: (array length=out_size) (transfer full): A pointer to a
+ * valid binary D-Bus message of @out_size bytes generated by @message
+ * or %NULL if @error is set. Free with g_free().
+ *
+ * Since: 2.26
+ */
+guchar *
+g_dbus_message_to_blob (GDBusMessage          *message,
+                        gsize                 *out_size,
+                        GDBusCapabilityFlags   capabilities,
+                        GError               **error)
+{
+  g_return_val_if_fail (G_IS_DBUS_MESSAGE (message), NULL);
+  g_return_val_if_fail (out_size != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return serialize_message (message, out_size, capabilities, NULL, error);
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 static guint32
@@ -4035,3 +4215,326 @@ g_dbus_message_copy (GDBusMessage  *message,
 #endif
   return ret;
 }
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+#ifdef HAVE_MEMFD_CREATE
+
+/* Header field GDBus peers use to say which top-level `ay` arguments of the
+ * body were replaced by an empty array and passed as a sealed memfd instead,
+ * see g_dbus_connection_set_memfd_threshold(). The value is an array of
+ * (argument index, fd index) pairs. The code is well outside the range the
+ * D-Bus specification has assigned, and message buses drop header fields
+ * they do not know. */
+#define G_DBUS_MESSAGE_HEADER_FIELD_MEMFD_ARRAYS 0x80
+
+static gint
+create_sealed_memfd (GBytes  *bytes,
+                     GError **error)
+{
+  const guchar *data;
+  gsize size;
+  gint fd;
+  gint errsv;
+
+  fd = memfd_create ("gdbus-array", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd == -1)
+    goto fail;
+
+  data = g_bytes_get_data (bytes, &size);
+  while (size > 0)
+    {
+      gssize written = write (fd, data, size);
+
+      if (written == -1)
+        {
+          if (errno == EINTR)
+            continue;
+          goto fail;
+        }
+
+      data += written;
+      size -= written;
+    }
+
+  if (fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == -1)
+    goto fail;
+
+  return fd;
+
+ fail:
+  errsv = errno;
+  if (fd != -1)
+    g_close (fd, NULL);
+  g_set_error (error,
+               G_IO_ERROR,
+               g_io_error_from_errno (errsv),
+               _("Error creating memfd for array: %s"),
+               g_strerror (errsv));
+  return -1;
+}
+
+/*
+ * _g_dbus_message_move_arrays_to_memfds:
+ * @message: a #GDBusMessage
+ * @threshold: size in bytes from which `ay` arguments are moved
+ * @error: return location for error
+ *
+ * Returns a copy of @message where each top-level `ay` argument of at
+ * least @threshold bytes is replaced by an empty array, its contents having
+ * been written to a sealed memfd appended to the fd list, for
+ * _g_dbus_message_restore_memfd_arrays() to undo on the receiving side.
+ *
+ * Returns: (transfer full) (nullable): the new message, or %NULL if @error
+ *     is set or if there is nothing to move
+ */
+GDBusMessage *
+_g_dbus_message_move_arrays_to_memfds (GDBusMessage  *message,
+                                       gsize          threshold,
+                                       GError       **error)
+{
+  GDBusMessage *ret = NULL;
+  GUnixFDList *fd_list = NULL;
+  GVariantBuilder moved;
+  GVariant **children;
+  gsize n_children;
+  gsize n;
+  gboolean have_moved = FALSE;
+
+  if (message->body == NULL ||
+      !g_variant_is_of_type (message->body, G_VARIANT_TYPE_TUPLE) ||
+      g_hash_table_contains (message->headers, GUINT_TO_POINTER (G_DBUS_MESSAGE_HEADER_FIELD_MEMFD_ARRAYS)))
+    return NULL;
+
+  n_children = g_variant_n_children (message->body);
+  children = g_new0 (GVariant *, n_children);
+  for (n = 0; n < n_children; n++)
+    {
+      children[n] = g_variant_get_child_value (message->body, n);
+      if (g_variant_is_of_type (children[n], G_VARIANT_TYPE_BYTESTRING) &&
+          g_variant_get_size (children[n]) >= threshold)
+        have_moved = TRUE;
+    }
+  if (!have_moved)
+    goto out;
+
+  ret = g_dbus_message_copy (message, error);
+  if (ret == NULL)
+    goto out;
+
+  fd_list = ret->fd_list != NULL ? g_object_ref (ret->fd_list) : g_unix_fd_list_new ();
+  g_variant_builder_init (&moved, G_VARIANT_TYPE ("a(uh)"));
+  for (n = 0; n < n_children; n++)
+    {
+      GBytes *bytes;
+      gint fd;
+      gint fd_index;
+
+      if (!g_variant_is_of_type (children[n], G_VARIANT_TYPE_BYTESTRING) ||
+          g_variant_get_size (children[n]) < threshold)
+        continue;
+
+      bytes = g_variant_get_data_as_bytes (children[n]);
+      fd = create_sealed_memfd (bytes, error);
+      g_bytes_unref (bytes);
+      if (fd == -1)
+        goto fail;
+
+      fd_index = g_unix_fd_list_append (fd_list, fd, error);
+      g_close (fd, NULL);
+      if (fd_index == -1)
+        goto fail;
+
+      g_variant_builder_add (&moved, "(uh)", (guint32) n, fd_index);
+      g_variant_unref (children[n]);
+      children[n] = g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE_BYTESTRING,
+                                                                 NULL, 0, TRUE, NULL, NULL));
+    }
+
+  g_dbus_message_set_body (ret, g_variant_new_tuple (children, n_children));
+  g_dbus_message_set_header (ret, G_DBUS_MESSAGE_HEADER_FIELD_MEMFD_ARRAYS, g_variant_builder_end (&moved));
+  g_dbus_message_set_unix_fd_list (ret, fd_list);
+  goto out;
+
+ fail:
+  g_variant_builder_clear (&moved);
+  g_clear_object (&ret);
+
+ out:
+  for (n = 0; n < n_children; n++)
+    g_variant_unref (children[n]);
+  g_free (children);
+  g_clear_object (&fd_list);
+
+  return ret;
+}
+
+typedef struct
+{
+  gpointer addr;
+  gsize    size;
+} MappedArray;
+
+static void
+mapped_array_free (gpointer user_data)
+{
+  MappedArray *mapped = user_data;
+
+  munmap (mapped->addr, mapped->size);
+  g_free (mapped);
+}
+
+static GBytes *
+bytes_from_memfd (gint     fd,
+                  GError **error)
+{
+  struct stat statbuf;
+  MappedArray *mapped;
+  gpointer addr;
+  gint seals;
+  gint errsv;
+
+  /* Only accept memfds the sender can no longer change under us, as
+   * _g_dbus_message_move_arrays_to_memfds() sends them. Anything else, such
+   * as a sparse file of arbitrary size, is not read into memory. */
+  seals = fcntl (fd, F_GET_SEALS);
+  if (seals == -1 ||
+      (seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) != (F_SEAL_SHRINK | F_SEAL_WRITE))
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_ARGUMENT,
+                           _("Array was not passed in a sealed memfd"));
+      return NULL;
+    }
+
+  if (fstat (fd, &statbuf) == -1)
+    goto fail;
+
+  if (statbuf.st_size == 0)
+    return g_bytes_new (NULL, 0);
+
+  addr = mmap (NULL, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (addr == MAP_FAILED)
+    goto fail;
+
+  mapped = g_new (MappedArray, 1);
+  mapped->addr = addr;
+  mapped->size = statbuf.st_size;
+
+  return g_bytes_new_with_free_func (addr, statbuf.st_size, mapped_array_free, mapped);
+
+ fail:
+  errsv = errno;
+  g_set_error (error,
+               G_IO_ERROR,
+               g_io_error_from_errno (errsv),
+               _("Error reading array from memfd: %s"),
+               g_strerror (errsv));
+  return NULL;
+}
+
+/*
+ * _g_dbus_message_restore_memfd_arrays:
+ * @message: a #GDBusMessage that has not been locked yet
+ * @error: return location for error
+ *
+ * Undoes _g_dbus_message_move_arrays_to_memfds() on a received message,
+ * putting the arrays back into the body as #GVariants backed by a read-only
+ * mapping of the memfds, and dropping the memfds from the fd list.
+ *
+ * Returns: %TRUE if @message had no moved arrays or they were restored,
+ *     %FALSE if @error is set
+ */
+gboolean
+_g_dbus_message_restore_memfd_arrays (GDBusMessage  *message,
+                                      GError       **error)
+{
+  GVariant *moved;
+  GVariant **children = NULL;
+  GUnixFDList *fd_list = NULL;
+  const gint *fds;
+  gint num_fds;
+  gsize n_children = 0;
+  gsize n_moved;
+  gsize n;
+  gboolean ret = FALSE;
+
+  moved = g_hash_table_lookup (message->headers,
+                               GUINT_TO_POINTER (G_DBUS_MESSAGE_HEADER_FIELD_MEMFD_ARRAYS));
+  if (moved == NULL)
+    return TRUE;
+
+  n_moved = g_variant_is_of_type (moved, G_VARIANT_TYPE ("a(uh)")) ? g_variant_n_children (moved) : 0;
+  if (n_moved == 0 ||
+      message->fd_list == NULL ||
+      message->body == NULL ||
+      !g_variant_is_of_type (message->body, G_VARIANT_TYPE_TUPLE))
+    goto invalid;
+
+  /* the memfds are always appended after the fds the sender attached */
+  fds = g_unix_fd_list_peek_fds (message->fd_list, &num_fds);
+  if (n_moved > (gsize) num_fds)
+    goto invalid;
+
+  n_children = g_variant_n_children (message->body);
+  children = g_new0 (GVariant *, n_children);
+  for (n = 0; n < n_children; n++)
+    children[n] = g_variant_get_child_value (message->body, n);
+
+  for (n = 0; n < n_moved; n++)
+    {
+      GBytes *bytes;
+      guint32 index;
+      gint32 fd_index;
+
+      g_variant_get_child (moved, n, "(uh)", &index, &fd_index);
+      if (index >= n_children ||
+          !g_variant_is_of_type (children[index], G_VARIANT_TYPE_BYTESTRING) ||
+          g_variant_get_size (children[index]) != 0 ||
+          fd_index < num_fds - (gint) n_moved ||
+          fd_index >= num_fds)
+        goto invalid;
+
+      bytes = bytes_from_memfd (fds[fd_index], error);
+      if (bytes == NULL)
+        goto out;
+
+      g_variant_unref (children[index]);
+      children[index] = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, bytes, TRUE));
+      g_bytes_unref (bytes);
+    }
+
+  if (num_fds > (gint) n_moved)
+    {
+      fd_list = g_unix_fd_list_new ();
+      for (n = 0; n < (gsize) num_fds - n_moved; n++)
+        {
+          if (g_unix_fd_list_append (fd_list, fds[n], error) == -1)
+            goto out;
+        }
+    }
+
+  g_dbus_message_set_body (message, g_variant_new_tuple (children, n_children));
+  g_dbus_message_set_header (message, G_DBUS_MESSAGE_HEADER_FIELD_MEMFD_ARRAYS, NULL);
+  g_dbus_message_set_unix_fd_list (message, fd_list);
+
+  ret = TRUE;
+  goto out;
+
+ invalid:
+  g_set_error_literal (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       _("Invalid memfd array header field"));
+
+ out:
+  for (n = 0; children != NULL && n < n_children; n++)
+    g_variant_unref (children[n]);
+  g_free (children);
+  g_clear_object (&fd_list);
+
+  return ret;
+}
+
+#endif /* HAVE_MEMFD_CREATE */
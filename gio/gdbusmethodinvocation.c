@@ -85,15 +85,42 @@ struct _GDBusMethodInvocation
   GDBusMessage    *message;
   GVariant        *parameters;
   gpointer         user_data;
+
+  /* set if statistics were enabled when the call was dispatched, and cleared
+   * once the call has been accounted for */
+  GDBusStatistics *statistics;
+  gint64           start_time;
+
+  /* set if the call is dispatched in a thread of the pool set with
+   * g_dbus_connection_set_dispatch_thread_pool() */
+  gboolean         in_dispatch_pool;
 };
 
 G_DEFINE_TYPE (GDBusMethodInvocation, g_dbus_method_invocation, G_TYPE_OBJECT)
 
+static void
+method_invocation_finish_statistics (GDBusMethodInvocation *invocation,
+                                     gboolean               failed)
+{
+  if (invocation->statistics == NULL)
+    return;
+
+  _g_dbus_statistics_call_finished (invocation->statistics, TRUE,
+                                    invocation->interface_name,
+                                    invocation->method_name,
+                                    invocation->start_time,
+                                    failed);
+  g_clear_pointer (&invocation->statistics, _g_dbus_statistics_unref);
+}
+
 static void
 g_dbus_method_invocation_finalize (GObject *object)
 {
   GDBusMethodInvocation *invocation = G_DBUS_METHOD_INVOCATION (object);
 
+  /* the method was never replied to */
+  method_invocation_finish_statistics (invocation, TRUE);
+
   g_free (invocation->sender);
   g_free (invocation->object_path);
   g_free (invocation->interface_name);
@@ -378,6 +405,35 @@ _g_dbus_method_invocation_new (const gchar             *sender,
   return invocation;
 }
 
+/* Starts accounting for @invocation in @statistics; the call is finished when
+ * it is replied to, or when @invocation is finalized without a reply. */
+void
+_g_dbus_method_invocation_set_statistics (GDBusMethodInvocation *invocation,
+                                          GDBusStatistics       *statistics)
+{
+  g_return_if_fail (invocation->statistics == NULL);
+
+  invocation->statistics = _g_dbus_statistics_ref (statistics);
+  invocation->start_time = g_get_monotonic_time ();
+  _g_dbus_statistics_call_started (statistics, TRUE,
+                                   invocation->interface_name,
+                                   invocation->method_name);
+}
+
+/* Marks @invocation as dispatched in a thread of a dispatch pool, before it
+ * is pushed to the pool. */
+void
+_g_dbus_method_invocation_set_in_dispatch_pool (GDBusMethodInvocation *invocation)
+{
+  invocation->in_dispatch_pool = TRUE;
+}
+
+gboolean
+_g_dbus_method_invocation_get_in_dispatch_pool (GDBusMethodInvocation *invocation)
+{
+  return invocation->in_dispatch_pool;
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 static void
@@ -392,7 +448,10 @@ g_dbus_method_invocation_return_value_internal (GDBusMethodInvocation *invocatio
   g_return_if_fail ((parameters == NULL) || g_variant_is_of_type (parameters, G_VARIANT_TYPE_TUPLE));
 
   if (g_dbus_message_get_flags (invocation->message) & G_DBUS_MESSAGE_FLAGS_NO_REPLY_EXPECTED)
-    goto out;
+    {
+      method_invocation_finish_statistics (invocation, FALSE);
+      goto out;
+    }
 
   if (parameters == NULL)
     parameters = g_variant_new_tuple (NULL, 0);
@@ -514,6 +573,8 @@ g_dbus_method_invocation_return_value_internal (GDBusMethodInvocation *invocatio
     }
   g_object_unref (reply);
 
+  method_invocation_finish_statistics (invocation, FALSE);
+
  out:
   if (parameters != NULL)
     {
@@ -829,5 +890,6 @@ g_dbus_method_invocation_return_dbus_error (GDBusMethodInvocation *invocation,
   g_object_unref (reply);
 
 out:
+  method_invocation_finish_statistics (invocation, TRUE);
   g_object_unref (invocation);
 }
@@ -72,8 +72,27 @@ typedef struct
   GDBusObjectManagerServer *manager;
   GHashTable *map_iface_name_to_iface;
   gboolean exported;
+
+  /* Serialized interfaces and properties (type a{sa{sv}}) for
+   * GetManagedObjects(), valid while @cached_serial matches @serial */
+  GVariant *cached_interfaces;
+  gint cached_serial;
+  gint serial;  /* (atomic) */
 } RegistrationData;
 
+/* InterfacesAdded/InterfacesRemoved signals for an object which are held
+ * back while signals are frozen, or until they are flushed */
+typedef struct
+{
+  gchar *object_path;
+  GHashTable *added;    /* (element-type utf8) interfaces to announce */
+  GHashTable *removed;  /* (element-type utf8) interfaces to retract */
+} PendingChange;
+
+/* Maximum number of objects to emit signals for in one main loop iteration
+ * when flushing, so that a large batch doesn't monopolise the connection */
+#define MAX_PENDING_CHANGES_PER_FLUSH 256
+
 static void registration_data_free (RegistrationData *data);
 
 static void export_all (GDBusObjectManagerServer *manager);
@@ -91,6 +110,12 @@ static void g_dbus_object_manager_server_emit_interfaces_removed (GDBusObjectMan
 static gboolean g_dbus_object_manager_server_unexport_unlocked (GDBusObjectManagerServer  *manager,
                                                                 const gchar               *object_path);
 
+static void pending_change_free (PendingChange *change);
+static void clear_pending_changes (GDBusObjectManagerServer *manager);
+static void flush_pending_changes (GDBusObjectManagerServer *manager,
+                                   guint                     max_changes);
+static void schedule_flush_pending_changes (GDBusObjectManagerServer *manager);
+
 struct _GDBusObjectManagerServerPrivate
 {
   GMutex lock;
@@ -99,6 +124,18 @@ struct _GDBusObjectManagerServerPrivate
   gchar *object_path_ending_in_slash;
   GHashTable *map_object_path_to_data;
   guint manager_reg_id;
+
+  /* See g_dbus_object_manager_server_freeze_signals() */
+  guint freeze_count;
+  GQueue pending_changes;  /* (element-type PendingChange) (owned) */
+  GHashTable *map_object_path_to_pending_change;  /* values unowned */
+  GSource *flush_source;
+
+  /* See g_dbus_object_manager_server_set_cache_managed_objects() */
+  gboolean cache_managed_objects;
+  GVariant *managed_objects;
+  gint managed_objects_serial;
+  gint serial;  /* (atomic) */
 };
 
 enum
@@ -127,6 +164,9 @@ g_dbus_object_manager_server_finalize (GObject *object)
       g_object_unref (manager->priv->connection);
     }
   g_hash_table_unref (manager->priv->map_object_path_to_data);
+  clear_pending_changes (manager);
+  g_hash_table_unref (manager->priv->map_object_path_to_pending_change);
+  g_clear_pointer (&manager->priv->managed_objects, g_variant_unref);
   g_free (manager->priv->object_path);
   g_free (manager->priv->object_path_ending_in_slash);
 
@@ -243,6 +283,7 @@ g_dbus_object_manager_server_init (GDBusObjectManagerServer *manager)
                                                                   g_str_equal,
                                                                   g_free,
                                                                   (GDestroyNotify) registration_data_free);
+  manager->priv->map_object_path_to_pending_change = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 /**
@@ -300,6 +341,9 @@ g_dbus_object_manager_server_set_connection (GDBusObjectManagerServer  *manager,
       manager->priv->connection = NULL;
     }
 
+  /* Signals held back for the old connection are meaningless on the new one */
+  clear_pending_changes (manager);
+
   manager->priv->connection = connection != NULL ? g_object_ref (connection) : NULL;
   if (manager->priv->connection != NULL)
     export_all (manager);
@@ -336,6 +380,72 @@ g_dbus_object_manager_server_get_connection (GDBusObjectManagerServer *manager)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Can be called from any thread, with or without the lock held */
+static void
+registration_data_invalidate (RegistrationData *data)
+{
+  g_atomic_int_inc (&data->serial);
+  g_atomic_int_inc (&data->manager->priv->serial);
+}
+
+static void
+on_interface_notify (GObject    *object,
+                     GParamSpec *pspec,
+                     gpointer    user_data)
+{
+  RegistrationData *data = user_data;
+
+  /* Properties may be set with the lock held (for instance from an
+   * ::interface-added handler), so don't take it here */
+  registration_data_invalidate (data);
+}
+
+/* must hold lock */
+static GVariant *
+registration_data_build_interfaces (RegistrationData *data)
+{
+  GVariantBuilder interfaces_builder;
+  GHashTableIter interface_iter;
+  GDBusInterfaceSkeleton *iface;
+
+  g_variant_builder_init (&interfaces_builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+  g_hash_table_iter_init (&interface_iter, data->map_iface_name_to_iface);
+  while (g_hash_table_iter_next (&interface_iter, NULL, (gpointer) &iface))
+    {
+      GVariant *properties = g_dbus_interface_skeleton_get_properties (iface);
+      g_variant_builder_add (&interfaces_builder, "{s@a{sv}}",
+                             g_dbus_interface_skeleton_get_info (iface)->name,
+                             properties);
+      g_variant_unref (properties);
+    }
+
+  return g_variant_builder_end (&interfaces_builder);
+}
+
+/* must hold lock */
+static GVariant *
+registration_data_get_interfaces (RegistrationData *data)
+{
+  gint serial;
+
+  if (!data->manager->priv->cache_managed_objects)
+    return g_variant_ref_sink (registration_data_build_interfaces (data));
+
+  /* Read the serial before serializing, so that a change racing with
+   * us invalidates the result */
+  serial = g_atomic_int_get (&data->serial);
+  if (data->cached_interfaces == NULL || data->cached_serial != serial)
+    {
+      g_clear_pointer (&data->cached_interfaces, g_variant_unref);
+      data->cached_interfaces = g_variant_ref_sink (registration_data_build_interfaces (data));
+      data->cached_serial = serial;
+    }
+
+  return g_variant_ref (data->cached_interfaces);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 static void
 registration_data_export_interface (RegistrationData        *data,
                                     GDBusInterfaceSkeleton  *interface_skeleton,
@@ -367,6 +477,10 @@ registration_data_export_interface (RegistrationData        *data,
                        info->name,
                        g_object_ref (interface_skeleton));
 
+  if (data->manager->priv->cache_managed_objects)
+    g_signal_connect (interface_skeleton, "notify", G_CALLBACK (on_interface_notify), data);
+  registration_data_invalidate (data);
+
   /* if we are already exported, then... */
   if (data->exported)
     {
@@ -392,7 +506,9 @@ registration_data_unexport_interface (RegistrationData       *data,
   if (data->manager->priv->connection != NULL)
     g_dbus_interface_skeleton_unexport (iface);
 
+  g_signal_handlers_disconnect_by_func (iface, G_CALLBACK (on_interface_notify), data);
   g_warn_if_fail (g_hash_table_remove (data->map_iface_name_to_iface, info->name));
+  registration_data_invalidate (data);
 
   /* if we are already exported, then... */
   if (data->exported)
@@ -447,12 +563,15 @@ registration_data_free (RegistrationData *data)
     {
       if (data->manager->priv->connection != NULL)
         g_dbus_interface_skeleton_unexport (iface);
+      g_signal_handlers_disconnect_by_func (iface, G_CALLBACK (on_interface_notify), data);
     }
 
   g_signal_handlers_disconnect_by_func (data->object, G_CALLBACK (on_interface_added), data);
   g_signal_handlers_disconnect_by_func (data->object, G_CALLBACK (on_interface_removed), data);
+  g_atomic_int_inc (&data->manager->priv->serial);
   g_object_unref (data->object);
   g_hash_table_destroy (data->map_iface_name_to_iface);
+  g_clear_pointer (&data->cached_interfaces, g_variant_unref);
   g_free (data);
 }
 
@@ -731,6 +850,134 @@ g_dbus_object_manager_server_unexport (GDBusObjectManagerServer  *manager,
   return ret;
 }
 
+/**
+ * g_dbus_object_manager_server_freeze_signals:
+ * @manager: A #GDBusObjectManagerServer.
+ *
+ * Holds back the `InterfacesAdded` and `InterfacesRemoved` signals
+ * emitted by @manager until g_dbus_object_manager_server_thaw_signals()
+ * is called.
+ *
+ * This is useful when exporting or unexporting many objects at once.
+ * The changes made to an object while signals are frozen are coalesced:
+ * at most one `InterfacesRemoved` and one `InterfacesAdded` signal are
+ * emitted for it, with the values its properties have at that time, and
+ * nothing is emitted for objects (or interfaces) which were added and
+ * removed again in between.
+ *
+ * Calls to this function may be nested; signals are held back until
+ * every call has been matched by a call to
+ * g_dbus_object_manager_server_thaw_signals().
+ *
+ * Since: 2.82
+ */
+void
+g_dbus_object_manager_server_freeze_signals (GDBusObjectManagerServer *manager)
+{
+  g_return_if_fail (G_IS_DBUS_OBJECT_MANAGER_SERVER (manager));
+
+  g_mutex_lock (&manager->priv->lock);
+  manager->priv->freeze_count++;
+  g_mutex_unlock (&manager->priv->lock);
+}
+
+/**
+ * g_dbus_object_manager_server_thaw_signals:
+ * @manager: A #GDBusObjectManagerServer.
+ *
+ * Reverts the effect of a previous call to
+ * g_dbus_object_manager_server_freeze_signals().
+ *
+ * Once signals are no longer frozen, the held back signals are emitted
+ * from an idle callback in the
+ * [thread-default main context][g-main-context-push-thread-default]
+ * of the calling thread, a bounded number per main loop iteration so that
+ * a large batch doesn't monopolise the connection. Signals for later
+ * changes are queued behind them, and all of them are emitted before
+ * replying to a `GetManagedObjects` call.
+ *
+ * Since: 2.82
+ */
+void
+g_dbus_object_manager_server_thaw_signals (GDBusObjectManagerServer *manager)
+{
+  g_return_if_fail (G_IS_DBUS_OBJECT_MANAGER_SERVER (manager));
+
+  g_mutex_lock (&manager->priv->lock);
+
+  if (manager->priv->freeze_count == 0)
+    {
+      g_mutex_unlock (&manager->priv->lock);
+      g_critical ("%s: signals of %p are not frozen", G_STRFUNC, manager);
+      return;
+    }
+
+  manager->priv->freeze_count--;
+  schedule_flush_pending_changes (manager);
+
+  g_mutex_unlock (&manager->priv->lock);
+}
+
+/**
+ * g_dbus_object_manager_server_set_cache_managed_objects:
+ * @manager: A #GDBusObjectManagerServer.
+ * @cache: Whether to cache the reply to `GetManagedObjects`.
+ *
+ * Sets whether @manager keeps the serialized reply to `GetManagedObjects`
+ * instead of collecting the properties of every exported interface on
+ * each call.
+ *
+ * The cache is updated incrementally: only the objects which were
+ * exported, unexported, had interfaces added or removed, or had an
+ * interface emit #GObject::notify since the last call are serialized
+ * again. This requires the interface skeletons to emit #GObject::notify
+ * whenever the value of one of their D-Bus properties changes, as the
+ * skeletons generated by `gdbus-codegen` do.
+ *
+ * Since: 2.82
+ */
+void
+g_dbus_object_manager_server_set_cache_managed_objects (GDBusObjectManagerServer *manager,
+                                                        gboolean                  cache)
+{
+  GHashTableIter iter;
+  RegistrationData *data;
+
+  g_return_if_fail (G_IS_DBUS_OBJECT_MANAGER_SERVER (manager));
+
+  cache = !!cache;
+
+  g_mutex_lock (&manager->priv->lock);
+
+  if (manager->priv->cache_managed_objects == cache)
+    goto out;
+
+  manager->priv->cache_managed_objects = cache;
+
+  g_hash_table_iter_init (&iter, manager->priv->map_object_path_to_data);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer) &data))
+    {
+      GHashTableIter iface_iter;
+      GDBusInterfaceSkeleton *iface;
+
+      g_hash_table_iter_init (&iface_iter, data->map_iface_name_to_iface);
+      while (g_hash_table_iter_next (&iface_iter, NULL, (gpointer) &iface))
+        {
+          if (cache)
+            g_signal_connect (iface, "notify", G_CALLBACK (on_interface_notify), data);
+          else
+            g_signal_handlers_disconnect_by_func (iface, G_CALLBACK (on_interface_notify), data);
+        }
+
+      g_clear_pointer (&data->cached_interfaces, g_variant_unref);
+    }
+
+  g_clear_pointer (&manager->priv->managed_objects, g_variant_unref);
+
+ out:
+  g_mutex_unlock (&manager->priv->lock);
+}
+
 
 /* ---------------------------------------------------------------------------------------------------- */
 
@@ -850,6 +1097,33 @@ static const GDBusInterfaceInfo manager_interface_info =
   (GDBusAnnotationInfo **) NULL
 };
 
+/* must hold lock */
+static GVariant *
+build_managed_objects (GDBusObjectManagerServer *manager)
+{
+  GVariantBuilder array_builder;
+  GHashTableIter object_iter;
+  RegistrationData *data;
+
+  g_variant_builder_init (&array_builder, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
+  g_hash_table_iter_init (&object_iter, manager->priv->map_object_path_to_data);
+  while (g_hash_table_iter_next (&object_iter, NULL, (gpointer) &data))
+    {
+      GVariant *interfaces;
+      const gchar *iter_object_path;
+
+      interfaces = registration_data_get_interfaces (data);
+      iter_object_path = g_dbus_object_get_object_path (G_DBUS_OBJECT (data->object));
+      g_variant_builder_add (&array_builder,
+                             "{o@a{sa{sv}}}",
+                             iter_object_path,
+                             interfaces);
+      g_variant_unref (interfaces);
+    }
+
+  return g_variant_new ("(a{oa{sa{sv}}})", &array_builder);
+}
+
 static void
 manager_method_call (GDBusConnection       *connection,
                      const gchar           *sender,
@@ -861,43 +1135,33 @@ manager_method_call (GDBusConnection       *connection,
                      gpointer               user_data)
 {
   GDBusObjectManagerServer *manager = G_DBUS_OBJECT_MANAGER_SERVER (user_data);
-  GVariantBuilder array_builder;
-  GHashTableIter object_iter;
-  RegistrationData *data;
 
   g_mutex_lock (&manager->priv->lock);
 
   if (g_strcmp0 (method_name, "GetManagedObjects") == 0)
     {
-      g_variant_builder_init (&array_builder, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
-      g_hash_table_iter_init (&object_iter, manager->priv->map_object_path_to_data);
-      while (g_hash_table_iter_next (&object_iter, NULL, (gpointer) &data))
+      /* Emit any signals we are holding back first, so that the caller
+       * doesn't receive InterfacesAdded for objects it already knows about */
+      flush_pending_changes (manager, G_MAXUINT);
+
+      if (manager->priv->cache_managed_objects)
         {
-          GVariantBuilder interfaces_builder;
-          GHashTableIter interface_iter;
-          GDBusInterfaceSkeleton *iface;
-          const gchar *iter_object_path;
-
-          g_variant_builder_init (&interfaces_builder, G_VARIANT_TYPE ("a{sa{sv}}"));
-          g_hash_table_iter_init (&interface_iter, data->map_iface_name_to_iface);
-          while (g_hash_table_iter_next (&interface_iter, NULL, (gpointer) &iface))
+          gint serial = g_atomic_int_get (&manager->priv->serial);
+
+          if (manager->priv->managed_objects == NULL ||
+              manager->priv->managed_objects_serial != serial)
             {
-              GVariant *properties = g_dbus_interface_skeleton_get_properties (iface);
-              g_variant_builder_add (&interfaces_builder, "{s@a{sv}}",
-                                     g_dbus_interface_skeleton_get_info (iface)->name,
-                                     properties);
-              g_variant_unref (properties);
+              g_clear_pointer (&manager->priv->managed_objects, g_variant_unref);
+              manager->priv->managed_objects = g_variant_ref_sink (build_managed_objects (manager));
+              manager->priv->managed_objects_serial = serial;
             }
-          iter_object_path = g_dbus_object_get_object_path (G_DBUS_OBJECT (data->object));
-          g_variant_builder_add (&array_builder,
-                                 "{oa{sa{sv}}}",
-                                 iter_object_path,
-                                 &interfaces_builder);
-        }
 
-      g_dbus_method_invocation_return_value (invocation,
-                                             g_variant_new ("(a{oa{sa{sv}}})",
-                                                            &array_builder));
+          g_dbus_method_invocation_return_value (invocation, manager->priv->managed_objects);
+        }
+      else
+        {
+          g_dbus_method_invocation_return_value (invocation, build_managed_objects (manager));
+        }
     }
   else
     {
@@ -933,18 +1197,15 @@ g_dbus_object_manager_server_constructed (GObject *object)
 }
 
 static void
-g_dbus_object_manager_server_emit_interfaces_added (GDBusObjectManagerServer *manager,
-                                                    RegistrationData   *data,
-                                                    const gchar *const *interfaces,
-                                                    const gchar *object_path)
+emit_interfaces_added_now (GDBusObjectManagerServer *manager,
+                           RegistrationData         *data,
+                           const gchar *const       *interfaces,
+                           const gchar              *object_path)
 {
   GVariantBuilder array_builder;
   GError *error;
   guint n;
 
-  if (data->manager->priv->connection == NULL)
-    goto out;
-
   g_variant_builder_init (&array_builder, G_VARIANT_TYPE ("a{sa{sv}}"));
   for (n = 0; interfaces[n] != NULL; n++)
     {
@@ -959,7 +1220,7 @@ g_dbus_object_manager_server_emit_interfaces_added (GDBusObjectManagerServer *ma
     }
 
   error = NULL;
-  g_dbus_connection_emit_signal (data->manager->priv->connection,
+  g_dbus_connection_emit_signal (manager->priv->connection,
                                  NULL, /* destination_bus_name */
                                  manager->priv->object_path,
                                  manager_interface_info.name,
@@ -974,30 +1235,23 @@ g_dbus_object_manager_server_emit_interfaces_added (GDBusObjectManagerServer *ma
         g_warning ("Couldn't emit InterfacesAdded signal: %s", error->message);
       g_error_free (error);
     }
- out:
-  ;
 }
 
 static void
-g_dbus_object_manager_server_emit_interfaces_removed (GDBusObjectManagerServer *manager,
-                                                      RegistrationData   *data,
-                                                      const gchar *const *interfaces)
+emit_interfaces_removed_now (GDBusObjectManagerServer *manager,
+                             const gchar *const       *interfaces,
+                             const gchar              *object_path)
 {
   GVariantBuilder array_builder;
   GError *error;
   guint n;
-  const gchar *object_path;
-
-  if (data->manager->priv->connection == NULL)
-    goto out;
 
   g_variant_builder_init (&array_builder, G_VARIANT_TYPE ("as"));
   for (n = 0; interfaces[n] != NULL; n++)
     g_variant_builder_add (&array_builder, "s", interfaces[n]);
 
   error = NULL;
-  object_path = g_dbus_object_get_object_path (G_DBUS_OBJECT (data->object));
-  g_dbus_connection_emit_signal (data->manager->priv->connection,
+  g_dbus_connection_emit_signal (manager->priv->connection,
                                  NULL, /* destination_bus_name */
                                  manager->priv->object_path,
                                  manager_interface_info.name,
@@ -1012,8 +1266,224 @@ g_dbus_object_manager_server_emit_interfaces_removed (GDBusObjectManagerServer *
         g_warning ("Couldn't emit InterfacesRemoved signal: %s", error->message);
       g_error_free (error);
     }
- out:
-  ;
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+static void
+pending_change_free (PendingChange *change)
+{
+  g_free (change->object_path);
+  g_hash_table_unref (change->added);
+  g_hash_table_unref (change->removed);
+  g_free (change);
+}
+
+/* must hold lock */
+static void
+clear_pending_changes (GDBusObjectManagerServer *manager)
+{
+  if (manager->priv->flush_source != NULL)
+    {
+      g_source_destroy (manager->priv->flush_source);
+      g_clear_pointer (&manager->priv->flush_source, g_source_unref);
+    }
+  g_hash_table_remove_all (manager->priv->map_object_path_to_pending_change);
+  g_queue_clear_full (&manager->priv->pending_changes, (GDestroyNotify) pending_change_free);
+}
+
+/* must hold lock; signals must be held back while frozen, and while
+ * older ones are waiting to be flushed, to keep them in order */
+static gboolean
+should_hold_back_signals (GDBusObjectManagerServer *manager)
+{
+  return manager->priv->freeze_count > 0 ||
+         !g_queue_is_empty (&manager->priv->pending_changes);
+}
+
+/* must hold lock */
+static PendingChange *
+lookup_pending_change (GDBusObjectManagerServer *manager,
+                       const gchar              *object_path)
+{
+  PendingChange *change;
+
+  change = g_hash_table_lookup (manager->priv->map_object_path_to_pending_change, object_path);
+  if (change == NULL)
+    {
+      change = g_new0 (PendingChange, 1);
+      change->object_path = g_strdup (object_path);
+      change->added = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      change->removed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      g_queue_push_tail (&manager->priv->pending_changes, change);
+      g_hash_table_insert (manager->priv->map_object_path_to_pending_change,
+                           change->object_path,
+                           change);
+    }
+
+  return change;
+}
+
+static gchar **
+string_set_to_strv (GHashTable *set)
+{
+  return (gchar **) g_hash_table_get_keys_as_array (set, NULL);
+}
+
+/* must hold lock */
+static void
+emit_pending_change (GDBusObjectManagerServer *manager,
+                     PendingChange            *change)
+{
+  if (g_hash_table_size (change->removed) > 0)
+    {
+      gchar **interfaces = string_set_to_strv (change->removed);
+      emit_interfaces_removed_now (manager, (const gchar *const *) interfaces, change->object_path);
+      g_free (interfaces);
+    }
+
+  if (g_hash_table_size (change->added) > 0)
+    {
+      RegistrationData *data;
+      GPtrArray *interfaces;
+      GHashTableIter iter;
+      const gchar *iface_name;
+
+      /* Announce the interfaces with their current properties */
+      data = g_hash_table_lookup (manager->priv->map_object_path_to_data, change->object_path);
+      if (data == NULL)
+        return;
+
+      interfaces = g_ptr_array_new ();
+      g_hash_table_iter_init (&iter, change->added);
+      while (g_hash_table_iter_next (&iter, (gpointer) &iface_name, NULL))
+        {
+          if (g_hash_table_contains (data->map_iface_name_to_iface, iface_name))
+            g_ptr_array_add (interfaces, (gpointer) iface_name);
+        }
+      g_ptr_array_add (interfaces, NULL);
+
+      if (interfaces->len > 1)
+        emit_interfaces_added_now (manager, data, (const gchar *const *) interfaces->pdata, change->object_path);
+      g_ptr_array_unref (interfaces);
+    }
+}
+
+/* must hold lock */
+static void
+flush_pending_changes (GDBusObjectManagerServer *manager,
+                       guint                     max_changes)
+{
+  PendingChange *change;
+  guint n;
+
+  for (n = 0; n < max_changes; n++)
+    {
+      change = g_queue_pop_head (&manager->priv->pending_changes);
+      if (change == NULL)
+        break;
+
+      g_hash_table_remove (manager->priv->map_object_path_to_pending_change, change->object_path);
+      if (manager->priv->connection != NULL)
+        emit_pending_change (manager, change);
+      pending_change_free (change);
+    }
+}
+
+static gboolean
+flush_pending_changes_cb (gpointer user_data)
+{
+  GDBusObjectManagerServer *manager = G_DBUS_OBJECT_MANAGER_SERVER (user_data);
+  gboolean ret = G_SOURCE_CONTINUE;
+
+  g_mutex_lock (&manager->priv->lock);
+
+  flush_pending_changes (manager, MAX_PENDING_CHANGES_PER_FLUSH);
+
+  if (manager->priv->freeze_count > 0 ||
+      g_queue_is_empty (&manager->priv->pending_changes))
+    {
+      g_clear_pointer (&manager->priv->flush_source, g_source_unref);
+      ret = G_SOURCE_REMOVE;
+    }
+
+  g_mutex_unlock (&manager->priv->lock);
+
+  return ret;
+}
+
+/* must hold lock */
+static void
+schedule_flush_pending_changes (GDBusObjectManagerServer *manager)
+{
+  if (manager->priv->flush_source != NULL ||
+      manager->priv->freeze_count > 0 ||
+      g_queue_is_empty (&manager->priv->pending_changes))
+    return;
+
+  manager->priv->flush_source = g_idle_source_new ();
+  g_source_set_priority (manager->priv->flush_source, G_PRIORITY_DEFAULT);
+  g_source_set_callback (manager->priv->flush_source,
+                         flush_pending_changes_cb,
+                         g_object_ref (manager),
+                         g_object_unref);
+  g_source_set_static_name (manager->priv->flush_source, "[gio] flush_pending_changes_cb");
+  g_source_attach (manager->priv->flush_source, g_main_context_get_thread_default ());
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+static void
+g_dbus_object_manager_server_emit_interfaces_added (GDBusObjectManagerServer *manager,
+                                                    RegistrationData   *data,
+                                                    const gchar *const *interfaces,
+                                                    const gchar *object_path)
+{
+  PendingChange *change;
+  guint n;
+
+  if (data->manager->priv->connection == NULL)
+    return;
+
+  if (!should_hold_back_signals (manager))
+    {
+      emit_interfaces_added_now (manager, data, interfaces, object_path);
+      return;
+    }
+
+  change = lookup_pending_change (manager, object_path);
+  for (n = 0; interfaces[n] != NULL; n++)
+    g_hash_table_add (change->added, g_strdup (interfaces[n]));
+}
+
+static void
+g_dbus_object_manager_server_emit_interfaces_removed (GDBusObjectManagerServer *manager,
+                                                      RegistrationData   *data,
+                                                      const gchar *const *interfaces)
+{
+  PendingChange *change;
+  const gchar *object_path;
+  guint n;
+
+  if (data->manager->priv->connection == NULL)
+    return;
+
+  object_path = g_dbus_object_get_object_path (G_DBUS_OBJECT (data->object));
+
+  if (!should_hold_back_signals (manager))
+    {
+      emit_interfaces_removed_now (manager, interfaces, object_path);
+      return;
+    }
+
+  /* An interface which was added and removed again while the signals were
+   * held back was never announced, so there is nothing to retract */
+  change = lookup_pending_change (manager, object_path);
+  for (n = 0; interfaces[n] != NULL; n++)
+    {
+      if (!g_hash_table_remove (change->added, interfaces[n]))
+        g_hash_table_add (change->removed, g_strdup (interfaces[n]));
+    }
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
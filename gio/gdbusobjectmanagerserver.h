@@ -81,6 +81,13 @@ gboolean                  g_dbus_object_manager_server_is_exported         (GDBu
 GIO_AVAILABLE_IN_ALL
 gboolean                  g_dbus_object_manager_server_unexport            (GDBusObjectManagerServer  *manager,
                                                                             const gchar               *object_path);
+GIO_AVAILABLE_IN_2_82
+void                      g_dbus_object_manager_server_freeze_signals      (GDBusObjectManagerServer  *manager);
+GIO_AVAILABLE_IN_2_82
+void                      g_dbus_object_manager_server_thaw_signals        (GDBusObjectManagerServer  *manager);
+GIO_AVAILABLE_IN_2_82
+void                      g_dbus_object_manager_server_set_cache_managed_objects (GDBusObjectManagerServer *manager,
+                                                                                  gboolean                  cache);
 
 G_END_DECLS
 
@@ -377,6 +377,9 @@ struct GDBusWorker
   GUnixFDList                        *read_fd_list;
   GSocketControlMessage             **read_ancillary_messages;
   gint                                read_num_ancillary_messages;
+  /* number of messages and bytes received, protected by read_lock */
+  guint64                             read_num_messages;
+  guint64                             read_num_bytes;
 
   /* Whether an async write, flush or close, or none of those, is pending.
    * Only the worker thread may change its value, and only with the write_lock.
@@ -390,6 +393,10 @@ struct GDBusWorker
   GQueue                             *write_queue;
   /* protected by write_lock */
   guint64                             write_num_messages_written;
+  /* number of messages popped off @write_queue but not yet written;
+   * protected by write_lock
+   */
+  guint64                             write_num_messages_in_flight;
   /* number of messages we'd written out last time we flushed;
    * protected by write_lock
    */
@@ -400,6 +407,15 @@ struct GDBusWorker
   GList                              *pending_close_attempts;
   /* no lock - only used from the worker thread */
   gboolean                            close_expected;
+  /* number of bytes written, protected by write_lock */
+  guint64                             write_num_bytes_written;
+  /* number of write batches and of sendmsg()/writev() calls, for
+   * messages-per-syscall statistics; only changed from the worker
+   * thread */
+  gsize                               write_num_batches;  /* (atomic) */
+  gsize                               write_num_calls;  /* (atomic) */
+  /* see _g_dbus_worker_set_memfd_threshold(), protected by write_lock */
+  gsize                               write_memfd_threshold;
 };
 
 static void _g_dbus_worker_unref (GDBusWorker *worker);
@@ -418,13 +434,16 @@ typedef struct
 struct _MessageToWriteData ;
 typedef struct _MessageToWriteData MessageToWriteData;
 
+struct _WriteBatch ;
+typedef struct _WriteBatch WriteBatch;
+
 static void message_to_write_data_free (MessageToWriteData *data);
 
 static void read_message_print_transport_debug (gssize bytes_read,
                                                 GDBusWorker *worker);
 
 static void write_message_print_transport_debug (gssize bytes_written,
-                                                 MessageToWriteData *data);
+                                                 WriteBatch *batch);
 
 typedef struct {
     GDBusWorker *worker;
@@ -745,18 +764,38 @@ _g_dbus_worker_do_read_cb (GInputStream  *input_stream,
       else
         {
           GDBusMessage *message;
+          GBytes *bytes = NULL;
+          const gchar *blob;
           error = NULL;
 
           /* TODO: use connection->priv->auth to decode the message */
 
-          message = g_dbus_message_new_from_blob ((guchar *) worker->read_buffer,
-                                                  worker->read_buffer_cur_size,
-                                                  worker->capabilities,
-                                                  &error);
+          /* Large messages may contain arrays which are worth referencing
+           * in place rather than copying, so hand the read buffer over to
+           * the message and allocate a new one for the next message. */
+          if (worker->read_buffer_cur_size >= G_DBUS_MESSAGE_MIN_SPLICE_SIZE)
+            {
+              bytes = g_bytes_new_take (g_steal_pointer (&worker->read_buffer),
+                                        worker->read_buffer_cur_size);
+              worker->read_buffer_allocated_size = 0;
+              blob = g_bytes_get_data (bytes, NULL);
+              message = _g_dbus_message_new_from_bytes (bytes,
+                                                        worker->capabilities,
+                                                        &error);
+            }
+          else
+            {
+              blob = worker->read_buffer;
+              message = g_dbus_message_new_from_blob ((guchar *) blob,
+                                                      worker->read_buffer_cur_size,
+                                                      worker->capabilities,
+                                                      &error);
+            }
+
           if (message == NULL)
             {
               gchar *s;
-              s = _g_dbus_hexdump (worker->read_buffer, worker->read_buffer_cur_size, 2);
+              s = _g_dbus_hexdump (blob, worker->read_buffer_cur_size, 2);
               g_warning ("Error decoding D-Bus message of %" G_GSIZE_FORMAT " bytes\n"
                          "The error is: %s\n"
                          "The payload is as follows:\n"
@@ -767,6 +806,7 @@ _g_dbus_worker_do_read_cb (GInputStream  *input_stream,
               g_free (s);
               _g_dbus_worker_emit_disconnected (worker, FALSE, error);
               g_error_free (error);
+              g_clear_pointer (&bytes, g_bytes_unref);
               goto out;
             }
 
@@ -779,6 +819,19 @@ _g_dbus_worker_do_read_cb (GInputStream  *input_stream,
             }
 #endif
 
+#ifdef HAVE_MEMFD_CREATE
+          if (!_g_dbus_message_restore_memfd_arrays (message, &error))
+            {
+              g_warning ("Error restoring arrays passed as memfds in D-Bus message: %s",
+                         error->message);
+              _g_dbus_worker_emit_disconnected (worker, FALSE, error);
+              g_error_free (error);
+              g_clear_object (&message);
+              g_clear_pointer (&bytes, g_bytes_unref);
+              goto out;
+            }
+#endif
+
           if (G_UNLIKELY (_g_dbus_debug_message ()))
             {
               gchar *s;
@@ -792,13 +845,18 @@ _g_dbus_worker_do_read_cb (GInputStream  *input_stream,
               g_free (s);
               if (G_UNLIKELY (_g_dbus_debug_payload ()))
                 {
-                  s = _g_dbus_hexdump (worker->read_buffer, worker->read_buffer_cur_size, 2);
+                  s = _g_dbus_hexdump (blob, worker->read_buffer_cur_size, 2);
                   g_print ("%s\n", s);
                   g_free (s);
                 }
               _g_dbus_debug_print_unlock ();
             }
 
+          g_clear_pointer (&bytes, g_bytes_unref);
+
+          worker->read_num_messages += 1;
+          worker->read_num_bytes += worker->read_buffer_cur_size;
+
           /* yay, got a message, go deliver it */
           _g_dbus_worker_queue_or_deliver_received_message (worker, g_steal_pointer (&message));
 
@@ -889,29 +947,214 @@ struct _MessageToWriteData
   GDBusWorker  *worker;
   GDBusMessage *message;  /* (owned) */
   gchar        *blob;
-  gsize         blob_size;
+  GArray       *splices;  /* (owned) (nullable) (element-type GDBusMessageSplice) */
+  gsize         blob_size;  /* size on the wire, including @splices */
 
-  gsize         total_written;
-  GTask        *task;  /* (owned) and (nullable) before writing starts and after g_task_return_*() is called */
+  /* @blob with @splices spliced in */
+  GOutputVector *vectors;
+  guint          n_vectors;
+
+  /* whether the message-about-to-be-sent callback has run for @message */
+  gboolean      filtered;
 };
 
+static void
+message_to_write_data_clear_blob (MessageToWriteData *data)
+{
+  g_clear_pointer (&data->blob, g_free);
+  g_clear_pointer (&data->splices, g_array_unref);
+  g_clear_pointer (&data->vectors, g_free);
+  data->n_vectors = 0;
+  data->blob_size = 0;
+}
+
+/* steals @blob and @splices */
+static void
+message_to_write_data_set_blob (MessageToWriteData *data,
+                                gchar              *blob,
+                                gsize               blob_len,
+                                GArray             *splices)
+{
+  gsize pos;
+  guint n;
+
+  message_to_write_data_clear_blob (data);
+
+  data->blob = blob;
+  data->splices = splices;
+  data->vectors = g_new (GOutputVector, 1 + (splices != NULL ? 2 * splices->len : 0));
+
+  pos = 0;
+  for (n = 0; splices != NULL && n < splices->len; n++)
+    {
+      const GDBusMessageSplice *splice = &g_array_index (splices, GDBusMessageSplice, n);
+      gsize size;
+
+      if (splice->offset > pos)
+        {
+          data->vectors[data->n_vectors].buffer = blob + pos;
+          data->vectors[data->n_vectors].size = splice->offset - pos;
+          data->blob_size += splice->offset - pos;
+          data->n_vectors++;
+        }
+
+      data->vectors[data->n_vectors].buffer = g_bytes_get_data (splice->bytes, &size);
+      data->vectors[data->n_vectors].size = size;
+      data->blob_size += size;
+      data->n_vectors++;
+
+      pos = splice->offset + splice->filler;
+    }
+
+  if (blob_len > pos)
+    {
+      data->vectors[data->n_vectors].buffer = blob + pos;
+      data->vectors[data->n_vectors].size = blob_len - pos;
+      data->blob_size += blob_len - pos;
+      data->n_vectors++;
+    }
+}
+
+/* Returns: (transfer full): the message as it is sent, for debugging */
+static gchar *
+message_to_write_data_dup_contents (MessageToWriteData *data)
+{
+  gchar *contents;
+  gsize pos;
+  guint n;
+
+  if (data->splices == NULL)
+    return g_memdup2 (data->blob, data->blob_size);
+
+  contents = g_malloc (data->blob_size);
+  for (n = 0, pos = 0; n < data->n_vectors; n++)
+    {
+      memcpy (contents + pos, data->vectors[n].buffer, data->vectors[n].size);
+      pos += data->vectors[n].size;
+    }
+
+  return contents;
+}
+
 static void
 message_to_write_data_free (MessageToWriteData *data)
 {
   _g_dbus_worker_unref (data->worker);
   g_clear_object (&data->message);
-  g_free (data->blob);
+  message_to_write_data_clear_blob (data);
+
+  g_slice_free (MessageToWriteData, data);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+/* Messages queued for writing are coalesced into batches which are written
+ * with a single sendmsg() or writev() call, rather than one call and one
+ * main loop iteration per message. A message carrying file descriptors
+ * always starts a new batch, since they are attached to its first byte.
+ */
+#define MAX_WRITE_BATCH_MESSAGES 64
+#define MAX_WRITE_BATCH_SIZE     (64 * 1024)
+#define MAX_WRITE_BATCH_VECTORS  256
+
+/* so that the first message of a batch never exceeds it on its own */
+G_STATIC_ASSERT (1 + 2 * G_DBUS_MESSAGE_MAX_SPLICES <= MAX_WRITE_BATCH_VECTORS);
+
+struct _WriteBatch
+{
+  GDBusWorker   *worker;
+  GPtrArray     *messages;  /* (owned) (element-type MessageToWriteData) */
+  gsize          size;
+
+  /* all of @messages, and scratch space for the part of them which still
+   * needs to be written */
+  GOutputVector *vectors;
+  GOutputVector *remaining_vectors;
+  guint          n_vectors;
+
+  gsize         total_written;
+  GTask        *task;  /* (owned) and (nullable) before writing starts and after g_task_return_*() is called */
+};
+
+static WriteBatch *
+write_batch_new (GDBusWorker *worker)
+{
+  WriteBatch *batch;
+
+  batch = g_slice_new0 (WriteBatch);
+  batch->worker = _g_dbus_worker_ref (worker);
+  batch->messages = g_ptr_array_new_with_free_func ((GDestroyNotify) message_to_write_data_free);
+
+  return batch;
+}
+
+/* steals @data */
+static void
+write_batch_add (WriteBatch         *batch,
+                 MessageToWriteData *data)
+{
+  g_assert (batch->vectors == NULL);
+
+  g_ptr_array_add (batch->messages, data);
+  batch->n_vectors += data->n_vectors;
+  batch->size += data->blob_size;
+}
+
+static gboolean
+write_batch_is_full (WriteBatch *batch)
+{
+  return batch->messages->len >= MAX_WRITE_BATCH_MESSAGES ||
+         batch->size >= MAX_WRITE_BATCH_SIZE;
+}
+
+static MessageToWriteData *
+write_batch_get_first (WriteBatch *batch)
+{
+  return g_ptr_array_index (batch->messages, 0);
+}
+
+static void
+write_batch_free (WriteBatch *batch)
+{
+  _g_dbus_worker_unref (batch->worker);
+  g_ptr_array_unref (batch->messages);
+  g_free (batch->vectors);
+  g_free (batch->remaining_vectors);
 
   /* The task must either not have been created, or have been created, returned
    * and finalised by now. */
-  g_assert (data->task == NULL);
+  g_assert (batch->task == NULL);
 
-  g_slice_free (MessageToWriteData, data);
+  g_slice_free (WriteBatch, batch);
+}
+
+/* Returns: (transfer none): the part of the batch not yet written */
+static GOutputVector *
+write_batch_get_remaining (WriteBatch *batch,
+                           guint      *out_n_vectors)
+{
+  gsize skip;
+  guint n;
+  guint n_remaining;
+
+  skip = batch->total_written;
+  for (n = 0; n < batch->n_vectors && skip >= batch->vectors[n].size; n++)
+    skip -= batch->vectors[n].size;
+
+  g_assert (n < batch->n_vectors);
+
+  n_remaining = batch->n_vectors - n;
+  memcpy (batch->remaining_vectors, batch->vectors + n, n_remaining * sizeof (GOutputVector));
+  batch->remaining_vectors[0].buffer = (const guint8 *) batch->remaining_vectors[0].buffer + skip;
+  batch->remaining_vectors[0].size -= skip;
+
+  *out_n_vectors = n_remaining;
+  return batch->remaining_vectors;
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
 
-static void write_message_continue_writing (MessageToWriteData *data);
+static void write_message_continue_writing (WriteBatch *batch);
 
 /* called in private thread shared by all GDBusConnection instances
  *
@@ -924,42 +1167,42 @@ write_message_async_cb (GObject      *source_object,
                         GAsyncResult *res,
                         gpointer      user_data)
 {
-  MessageToWriteData *data = g_steal_pointer (&user_data);
-  gssize bytes_written;
+  WriteBatch *batch = g_steal_pointer (&user_data);
+  gsize bytes_written;
   GError *error;
 
-  /* The ownership of @data is a bit odd in this function: it’s (transfer full)
+  /* The ownership of @batch is a bit odd in this function: it’s (transfer full)
    * when the function is called, but the code paths which call g_task_return_*()
-   * on @data->task will indirectly cause it to be freed, because @data is
+   * on @batch->task will indirectly cause it to be freed, because @batch is
    * always guaranteed to be the user_data in the #GTask. So that’s why it looks
-   * like @data is not always freed on every code path in this function. */
+   * like @batch is not always freed on every code path in this function. */
 
   error = NULL;
-  bytes_written = g_output_stream_write_finish (G_OUTPUT_STREAM (source_object),
-                                                res,
-                                                &error);
-  if (bytes_written == -1)
+  if (!g_output_stream_writev_finish (G_OUTPUT_STREAM (source_object),
+                                      res,
+                                      &bytes_written,
+                                      &error))
     {
-      GTask *task = g_steal_pointer (&data->task);
+      GTask *task = g_steal_pointer (&batch->task);
       g_task_return_error (task, error);
       g_clear_object (&task);
       goto out;
     }
   g_assert (bytes_written > 0); /* zero is never returned */
 
-  write_message_print_transport_debug (bytes_written, data);
+  write_message_print_transport_debug (bytes_written, batch);
 
-  data->total_written += bytes_written;
-  g_assert (data->total_written <= data->blob_size);
-  if (data->total_written == data->blob_size)
+  batch->total_written += bytes_written;
+  g_assert (batch->total_written <= batch->size);
+  if (batch->total_written == batch->size)
     {
-      GTask *task = g_steal_pointer (&data->task);
+      GTask *task = g_steal_pointer (&batch->task);
       g_task_return_boolean (task, TRUE);
       g_clear_object (&task);
       goto out;
     }
 
-  write_message_continue_writing (g_steal_pointer (&data));
+  write_message_continue_writing (g_steal_pointer (&batch));
 
  out:
   ;
@@ -976,8 +1219,8 @@ on_socket_ready (GSocket      *socket,
                  GIOCondition  condition,
                  gpointer      user_data)
 {
-  MessageToWriteData *data = g_steal_pointer (&user_data);
-  write_message_continue_writing (g_steal_pointer (&data));
+  WriteBatch *batch = g_steal_pointer (&user_data);
+  write_message_continue_writing (g_steal_pointer (&batch));
   return G_SOURCE_REMOVE;
 }
 #endif
@@ -986,50 +1229,52 @@ on_socket_ready (GSocket      *socket,
  *
  * write-lock is not held on entry
  * output_pending is PENDING_WRITE on entry
- * @data is (transfer full)
+ * @batch is (transfer full)
  */
 static void
-write_message_continue_writing (MessageToWriteData *data)
+write_message_continue_writing (WriteBatch *batch)
 {
   GOutputStream *ostream;
+  GOutputVector *vectors;
+  guint n_vectors;
 #ifdef G_OS_UNIX
   GUnixFDList *fd_list;
 #endif
 
-  /* The ownership of @data is a bit odd in this function: it’s (transfer full)
+  /* The ownership of @batch is a bit odd in this function: it’s (transfer full)
    * when the function is called, but the code paths which call g_task_return_*()
-   * on @data->task will indirectly cause it to be freed, because @data is
+   * on @batch->task will indirectly cause it to be freed, because @batch is
    * always guaranteed to be the user_data in the #GTask. So that’s why it looks
-   * like @data is not always freed on every code path in this function. */
+   * like @batch is not always freed on every code path in this function. */
 
-  ostream = g_io_stream_get_output_stream (data->worker->stream);
+  ostream = g_io_stream_get_output_stream (batch->worker->stream);
 #ifdef G_OS_UNIX
-  fd_list = g_dbus_message_get_unix_fd_list (data->message);
+  /* Only the first message in a batch may carry file descriptors */
+  fd_list = g_dbus_message_get_unix_fd_list (write_batch_get_first (batch)->message);
 #endif
 
   g_assert (!g_output_stream_has_pending (ostream));
-  g_assert_cmpint (data->total_written, <, data->blob_size);
+  g_assert_cmpint (batch->total_written, <, batch->size);
+
+  vectors = write_batch_get_remaining (batch, &n_vectors);
+  g_atomic_pointer_add (&batch->worker->write_num_calls, 1);
 
   if (FALSE)
     {
     }
 #ifdef G_OS_UNIX
-  else if (G_IS_SOCKET_OUTPUT_STREAM (ostream) && data->total_written == 0)
+  else if (G_IS_SOCKET_OUTPUT_STREAM (ostream) && batch->total_written == 0)
     {
-      GOutputVector vector;
       GSocketControlMessage *control_message;
       gssize bytes_written;
       GError *error;
 
-      vector.buffer = data->blob;
-      vector.size = data->blob_size;
-
       control_message = NULL;
       if (fd_list != NULL && g_unix_fd_list_get_length (fd_list) > 0)
         {
-          if (!(data->worker->capabilities & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING))
+          if (!(batch->worker->capabilities & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING))
             {
-              GTask *task = g_steal_pointer (&data->task);
+              GTask *task = g_steal_pointer (&batch->task);
               g_task_return_new_error_literal (task,
                                                G_IO_ERROR,
                                                G_IO_ERROR_FAILED,
@@ -1043,14 +1288,14 @@ write_message_continue_writing (MessageToWriteData *data)
         }
 
       error = NULL;
-      bytes_written = g_socket_send_message (data->worker->socket,
+      bytes_written = g_socket_send_message (batch->worker->socket,
                                              NULL, /* address */
-                                             &vector,
-                                             1,
+                                             vectors,
+                                             n_vectors,
                                              control_message != NULL ? &control_message : NULL,
                                              control_message != NULL ? 1 : 0,
                                              G_SOCKET_MSG_NONE,
-                                             data->worker->cancellable,
+                                             batch->worker->cancellable,
                                              &error);
       if (control_message != NULL)
         g_object_unref (control_message);
@@ -1061,12 +1306,12 @@ write_message_continue_writing (MessageToWriteData *data)
           if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
             {
               GSource *source;
-              source = g_socket_create_source (data->worker->socket,
+              source = g_socket_create_source (batch->worker->socket,
                                                G_IO_OUT | G_IO_HUP | G_IO_ERR,
-                                               data->worker->cancellable);
+                                               batch->worker->cancellable);
               g_source_set_callback (source,
                                      (GSourceFunc) on_socket_ready,
-                                     g_steal_pointer (&data),
+                                     g_steal_pointer (&batch),
                                      NULL); /* GDestroyNotify */
               g_source_attach (source, g_main_context_get_thread_default ());
               g_source_unref (source);
@@ -1075,7 +1320,7 @@ write_message_continue_writing (MessageToWriteData *data)
             }
           else
             {
-              GTask *task = g_steal_pointer (&data->task);
+              GTask *task = g_steal_pointer (&batch->task);
               g_task_return_error (task, error);
               g_clear_object (&task);
               goto out;
@@ -1083,30 +1328,30 @@ write_message_continue_writing (MessageToWriteData *data)
         }
       g_assert (bytes_written > 0); /* zero is never returned */
 
-      write_message_print_transport_debug (bytes_written, data);
+      write_message_print_transport_debug (bytes_written, batch);
 
-      data->total_written += bytes_written;
-      g_assert (data->total_written <= data->blob_size);
-      if (data->total_written == data->blob_size)
+      batch->total_written += bytes_written;
+      g_assert (batch->total_written <= batch->size);
+      if (batch->total_written == batch->size)
         {
-          GTask *task = g_steal_pointer (&data->task);
+          GTask *task = g_steal_pointer (&batch->task);
           g_task_return_boolean (task, TRUE);
           g_clear_object (&task);
           goto out;
         }
 
-      write_message_continue_writing (g_steal_pointer (&data));
+      write_message_continue_writing (g_steal_pointer (&batch));
     }
 #endif
   else
     {
 #ifdef G_OS_UNIX
-      if (data->total_written == 0 && fd_list != NULL)
+      if (batch->total_written == 0 && fd_list != NULL)
         {
           /* We were trying to write byte 0 of the message, which needs
            * the fd list to be attached to it, but this connection doesn't
            * support doing that. */
-          GTask *task = g_steal_pointer (&data->task);
+          GTask *task = g_steal_pointer (&batch->task);
           g_task_return_new_error (task,
                                    G_IO_ERROR,
                                    G_IO_ERROR_FAILED,
@@ -1117,13 +1362,13 @@ write_message_continue_writing (MessageToWriteData *data)
         }
 #endif
 
-      g_output_stream_write_async (ostream,
-                                   (const gchar *) data->blob + data->total_written,
-                                   data->blob_size - data->total_written,
-                                   G_PRIORITY_DEFAULT,
-                                   data->worker->cancellable,
-                                   write_message_async_cb,
-                                   data);  /* steal @data */
+      g_output_stream_writev_async (ostream,
+                                    vectors,
+                                    n_vectors,
+                                    G_PRIORITY_DEFAULT,
+                                    batch->worker->cancellable,
+                                    write_message_async_cb,
+                                    batch);  /* steal @batch */
     }
 #ifdef G_OS_UNIX
  out:
@@ -1138,15 +1383,30 @@ write_message_continue_writing (MessageToWriteData *data)
  */
 static void
 write_message_async (GDBusWorker         *worker,
-                     MessageToWriteData  *data,
+                     WriteBatch          *batch,
                      GAsyncReadyCallback  callback,
                      gpointer             user_data)
 {
-  data->task = g_task_new (NULL, NULL, callback, user_data);
-  g_task_set_source_tag (data->task, write_message_async);
-  g_task_set_name (data->task, "[gio] D-Bus write message");
-  data->total_written = 0;
-  write_message_continue_writing (g_steal_pointer (&data));
+  guint i;
+  guint n;
+
+  batch->vectors = g_new (GOutputVector, batch->n_vectors);
+  batch->remaining_vectors = g_new (GOutputVector, batch->n_vectors);
+  for (i = 0, n = 0; i < batch->messages->len; i++)
+    {
+      MessageToWriteData *data = g_ptr_array_index (batch->messages, i);
+
+      memcpy (batch->vectors + n, data->vectors, data->n_vectors * sizeof (GOutputVector));
+      n += data->n_vectors;
+    }
+
+  g_atomic_pointer_add (&worker->write_num_batches, 1);
+
+  batch->task = g_task_new (NULL, NULL, callback, user_data);
+  g_task_set_source_tag (batch->task, write_message_async);
+  g_task_set_name (batch->task, "[gio] D-Bus write message");
+  batch->total_written = 0;
+  write_message_continue_writing (g_steal_pointer (&batch));
 }
 
 /* called in private thread shared by all GDBusConnection instances (with write-lock held) */
@@ -1276,14 +1536,17 @@ message_written_unlocked (GDBusWorker *worker,
       g_free (s);
       if (G_UNLIKELY (_g_dbus_debug_payload ()))
         {
-          s = _g_dbus_hexdump (message_data->blob, message_data->blob_size, 2);
+          gchar *contents = message_to_write_data_dup_contents (message_data);
+          s = _g_dbus_hexdump (contents, message_data->blob_size, 2);
           g_print ("%s\n", s);
           g_free (s);
+          g_free (contents);
         }
       _g_dbus_debug_print_unlock ();
     }
 
   worker->write_num_messages_written += 1;
+  worker->write_num_bytes_written += message_data->blob_size;
 }
 
 /* called in private thread shared by all GDBusConnection instances
@@ -1306,7 +1569,8 @@ prepare_flush_unlocked (GDBusWorker *worker)
       FlushData *f = l->data;
       ll = l->next;
 
-      if (f->number_to_wait_for == worker->write_num_messages_written)
+      /* A batch may complete several messages at once */
+      if (f->number_to_wait_for <= worker->write_num_messages_written)
         {
           flushers = g_list_append (flushers, f);
           worker->write_pending_flushes = g_list_delete_link (worker->write_pending_flushes, l);
@@ -1342,32 +1606,35 @@ write_message_cb (GObject       *source_object,
                   GAsyncResult  *res,
                   gpointer       user_data)
 {
-  MessageToWriteData *data = user_data;
+  WriteBatch *batch = user_data;
   GError *error;
+  guint n;
 
-  g_mutex_lock (&data->worker->write_lock);
-  g_assert (data->worker->output_pending == PENDING_WRITE);
-  data->worker->output_pending = PENDING_NONE;
+  g_mutex_lock (&batch->worker->write_lock);
+  g_assert (batch->worker->output_pending == PENDING_WRITE);
+  batch->worker->output_pending = PENDING_NONE;
 
   error = NULL;
   if (!write_message_finish (res, &error))
     {
-      g_mutex_unlock (&data->worker->write_lock);
+      g_mutex_unlock (&batch->worker->write_lock);
 
       /* TODO: handle */
-      _g_dbus_worker_emit_disconnected (data->worker, TRUE, error);
+      _g_dbus_worker_emit_disconnected (batch->worker, TRUE, error);
       g_error_free (error);
 
-      g_mutex_lock (&data->worker->write_lock);
+      g_mutex_lock (&batch->worker->write_lock);
     }
 
-  message_written_unlocked (data->worker, data);
+  for (n = 0; n < batch->messages->len; n++)
+    message_written_unlocked (batch->worker, g_ptr_array_index (batch->messages, n));
+  batch->worker->write_num_messages_in_flight = 0;
 
-  g_mutex_unlock (&data->worker->write_lock);
+  g_mutex_unlock (&batch->worker->write_lock);
 
-  continue_writing (data->worker);
+  continue_writing (batch->worker);
 
-  message_to_write_data_free (data);
+  write_batch_free (batch);
 }
 
 /* called in private thread shared by all GDBusConnection instances
@@ -1439,6 +1706,129 @@ iostream_close_cb (GObject      *source_object,
   _g_dbus_worker_unref (worker);
 }
 
+/* called in private thread shared by all GDBusConnection instances
+ *
+ * write-lock is not held on entry
+ * output_pending is PENDING_WRITE on entry
+ *
+ * Returns: %FALSE if filters dropped the message
+ */
+static gboolean
+filter_message_to_write (GDBusWorker        *worker,
+                         MessageToWriteData *data)
+{
+  GDBusMessage *old_message;
+  guchar *new_blob;
+  gsize new_blob_size;
+  GArray *new_splices;
+  GError *error;
+
+  if (data->filtered)
+    return TRUE;
+  data->filtered = TRUE;
+
+  old_message = data->message;
+  data->message = _g_dbus_worker_emit_message_about_to_be_sent (worker, data->message);
+  if (data->message == old_message)
+    {
+      /* filters had no effect - do nothing */
+    }
+  else if (data->message == NULL)
+    {
+      /* filters dropped message */
+      return FALSE;
+    }
+  else
+    {
+      /* filters altered the message -> re-encode */
+      error = NULL;
+      new_blob = _g_dbus_message_to_blob_with_splices (data->message,
+                                                       &new_blob_size,
+                                                       worker->capabilities,
+                                                       &new_splices,
+                                                       &error);
+      if (new_blob == NULL)
+        {
+          /* if filter make the GDBusMessage unencodeable, just complain on stderr and send
+           * the old message instead
+           */
+          g_warning ("Error encoding GDBusMessage with serial %d altered by filter function: %s",
+                     g_dbus_message_get_serial (data->message),
+                     error->message);
+          g_error_free (error);
+        }
+      else
+        {
+          message_to_write_data_set_blob (data,
+                                          (gchar *) new_blob,
+                                          new_blob_size,
+                                          new_splices);
+        }
+    }
+
+#ifdef HAVE_MEMFD_CREATE
+  if (worker->capabilities & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING)
+    {
+      gsize threshold;
+
+      g_mutex_lock (&worker->write_lock);
+      threshold = worker->write_memfd_threshold;
+      g_mutex_unlock (&worker->write_lock);
+
+      if (threshold > 0)
+        {
+          GDBusMessage *memfd_message;
+
+          /* Done after the filters so they see the message as it was sent */
+          error = NULL;
+          new_blob = NULL;
+          memfd_message = _g_dbus_message_move_arrays_to_memfds (data->message, threshold, &error);
+          if (memfd_message != NULL)
+            {
+              new_blob = _g_dbus_message_to_blob_with_splices (memfd_message,
+                                                               &new_blob_size,
+                                                               worker->capabilities,
+                                                               &new_splices,
+                                                               &error);
+            }
+          if (new_blob != NULL)
+            {
+              g_dbus_message_lock (memfd_message);
+              g_object_unref (data->message);
+              data->message = g_steal_pointer (&memfd_message);
+              message_to_write_data_set_blob (data,
+                                              (gchar *) new_blob,
+                                              new_blob_size,
+                                              new_splices);
+            }
+          else if (error != NULL)
+            {
+              /* the arrays are sent inline instead */
+              g_warning ("Error passing arrays of D-Bus message with serial %d as memfds: %s",
+                         g_dbus_message_get_serial (data->message),
+                         error->message);
+              g_error_free (error);
+            }
+          g_clear_object (&memfd_message);
+        }
+    }
+#endif
+
+  return TRUE;
+}
+
+static gboolean
+message_to_write_data_has_fds (MessageToWriteData *data)
+{
+#ifdef G_OS_UNIX
+  GUnixFDList *fd_list = g_dbus_message_get_unix_fd_list (data->message);
+
+  return fd_list != NULL && g_unix_fd_list_get_length (fd_list) > 0;
+#else
+  return FALSE;
+#endif
+}
+
 /* called in private thread shared by all GDBusConnection instances
  *
  * write-lock is not held on entry
@@ -1449,6 +1839,7 @@ continue_writing (GDBusWorker *worker)
 {
   MessageToWriteData *data;
   FlushAsyncData *flush_async_data;
+  WriteBatch *batch;
 
  write_next:
   /* we mustn't try to write two things at once */
@@ -1483,7 +1874,10 @@ continue_writing (GDBusWorker *worker)
           data = g_queue_pop_head (worker->write_queue);
 
           if (data != NULL)
-            worker->output_pending = PENDING_WRITE;
+            {
+              worker->output_pending = PENDING_WRITE;
+              worker->write_num_messages_in_flight = 1;
+            }
         }
     }
 
@@ -1505,56 +1899,60 @@ continue_writing (GDBusWorker *worker)
     }
   else if (data != NULL)
     {
-      GDBusMessage *old_message;
-      guchar *new_blob;
-      gsize new_blob_size;
-      GError *error;
-
-      old_message = data->message;
-      data->message = _g_dbus_worker_emit_message_about_to_be_sent (worker, data->message);
-      if (data->message == old_message)
-        {
-          /* filters had no effect - do nothing */
-        }
-      else if (data->message == NULL)
+      if (!filter_message_to_write (worker, data))
         {
-          /* filters dropped message */
           g_mutex_lock (&worker->write_lock);
           worker->output_pending = PENDING_NONE;
+          worker->write_num_messages_in_flight = 0;
           g_mutex_unlock (&worker->write_lock);
           message_to_write_data_free (data);
           goto write_next;
         }
-      else
+
+      batch = write_batch_new (worker);
+      write_batch_add (batch, data);
+
+      /* Coalesce whatever else has been queued up in the meantime into the
+       * same write. Flushes still happen in order: any flush waiting for
+       * one of these messages is started once the whole batch is written. */
+      while (!write_batch_is_full (batch))
         {
-          /* filters altered the message -> re-encode */
-          error = NULL;
-          new_blob = g_dbus_message_to_blob (data->message,
-                                             &new_blob_size,
-                                             worker->capabilities,
-                                             &error);
-          if (new_blob == NULL)
+          g_mutex_lock (&worker->write_lock);
+          data = g_queue_pop_head (worker->write_queue);
+          if (data != NULL)
+            worker->write_num_messages_in_flight += 1;
+          g_mutex_unlock (&worker->write_lock);
+
+          if (data == NULL)
+            break;
+
+          if (!filter_message_to_write (worker, data))
             {
-              /* if filter make the GDBusMessage unencodeable, just complain on stderr and send
-               * the old message instead
-               */
-              g_warning ("Error encoding GDBusMessage with serial %d altered by filter function: %s",
-                         g_dbus_message_get_serial (data->message),
-                         error->message);
-              g_error_free (error);
+              g_mutex_lock (&worker->write_lock);
+              worker->write_num_messages_in_flight -= 1;
+              g_mutex_unlock (&worker->write_lock);
+              message_to_write_data_free (data);
+              continue;
             }
-          else
+
+          if (message_to_write_data_has_fds (data) ||
+              batch->n_vectors + data->n_vectors > MAX_WRITE_BATCH_VECTORS)
             {
-              g_free (data->blob);
-              data->blob = (gchar *) new_blob;
-              data->blob_size = new_blob_size;
+              /* put it back to start the next batch */
+              g_mutex_lock (&worker->write_lock);
+              worker->write_num_messages_in_flight -= 1;
+              g_queue_push_head (worker->write_queue, data);
+              g_mutex_unlock (&worker->write_lock);
+              break;
             }
+
+          write_batch_add (batch, data);
         }
 
       write_message_async (worker,
-                           data,
+                           batch,
                            write_message_cb,
-                           data);  /* takes ownership of @data as user_data */
+                           batch);  /* takes ownership of @batch as user_data */
     }
 }
 
@@ -1636,7 +2034,7 @@ schedule_pending_close (GDBusWorker *worker)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
-/* can be called from any thread - steals blob
+/* can be called from any thread - steals blob and splices
  *
  * write_lock is not held on entry
  * output_pending may be anything
@@ -1645,7 +2043,8 @@ void
 _g_dbus_worker_send_message (GDBusWorker    *worker,
                              GDBusMessage   *message,
                              gchar          *blob,
-                             gsize           blob_len)
+                             gsize           blob_len,
+                             GArray         *splices)
 {
   MessageToWriteData *data;
 
@@ -1656,8 +2055,7 @@ _g_dbus_worker_send_message (GDBusWorker    *worker,
   data = g_slice_new0 (MessageToWriteData);
   data->worker = _g_dbus_worker_ref (worker);
   data->message = g_object_ref (message);
-  data->blob = blob; /* steal! */
-  data->blob_size = blob_len;
+  message_to_write_data_set_blob (data, blob, blob_len, splices); /* steal! */
 
   g_mutex_lock (&worker->write_lock);
   schedule_writing_unlocked (worker, data, NULL, NULL);
@@ -1747,6 +2145,48 @@ _g_dbus_worker_close (GDBusWorker         *worker,
   g_mutex_unlock (&worker->write_lock);
 }
 
+/* can be called from any thread */
+void
+_g_dbus_worker_set_memfd_threshold (GDBusWorker *worker,
+                                    gsize        threshold)
+{
+  g_mutex_lock (&worker->write_lock);
+  worker->write_memfd_threshold = threshold;
+  g_mutex_unlock (&worker->write_lock);
+}
+
+/* can be called from any thread */
+void
+_g_dbus_worker_add_statistics (GDBusWorker     *worker,
+                               GVariantBuilder *builder)
+{
+  guint64 messages_received, bytes_received;
+  guint64 messages_sent, bytes_sent;
+  guint64 queue_length, batches, calls;
+
+  g_mutex_lock (&worker->read_lock);
+  messages_received = worker->read_num_messages;
+  bytes_received = worker->read_num_bytes;
+  g_mutex_unlock (&worker->read_lock);
+
+  g_mutex_lock (&worker->write_lock);
+  messages_sent = worker->write_num_messages_written;
+  bytes_sent = worker->write_num_bytes_written;
+  queue_length = g_queue_get_length (worker->write_queue) + worker->write_num_messages_in_flight;
+  g_mutex_unlock (&worker->write_lock);
+
+  batches = g_atomic_pointer_get (&worker->write_num_batches);
+  calls = g_atomic_pointer_get (&worker->write_num_calls);
+
+  g_variant_builder_add (builder, "{sv}", "messages-received", g_variant_new_uint64 (messages_received));
+  g_variant_builder_add (builder, "{sv}", "bytes-received", g_variant_new_uint64 (bytes_received));
+  g_variant_builder_add (builder, "{sv}", "messages-sent", g_variant_new_uint64 (messages_sent));
+  g_variant_builder_add (builder, "{sv}", "bytes-sent", g_variant_new_uint64 (bytes_sent));
+  g_variant_builder_add (builder, "{sv}", "write-queue-length", g_variant_new_uint64 (queue_length));
+  g_variant_builder_add (builder, "{sv}", "write-batches", g_variant_new_uint64 (batches));
+  g_variant_builder_add (builder, "{sv}", "write-calls", g_variant_new_uint64 (calls));
+}
+
 /* This can be called from any thread - frees worker. Note that
  * callbacks might still happen if called from another thread than the
  * worker - use your own synchronization primitive in the callbacks.
@@ -1803,7 +2243,7 @@ _g_dbus_worker_flush_sync (GDBusWorker    *worker,
    * flush operation that follows it
    */
   if (worker->output_pending == PENDING_WRITE)
-    pending_writes += 1;
+    pending_writes += MAX (worker->write_num_messages_in_flight, 1);
 
   if (pending_writes > 0 ||
       worker->write_num_messages_written != worker->write_num_messages_flushed)
@@ -2525,21 +2965,28 @@ _g_dbus_enum_to_string (GType enum_type, gint value)
 
 static void
 write_message_print_transport_debug (gssize bytes_written,
-                                     MessageToWriteData *data)
+                                     WriteBatch *batch)
 {
+  GDBusWorker *worker = batch->worker;
+
   if (G_LIKELY (!_g_dbus_debug_transport ()))
     goto out;
 
   _g_dbus_debug_print_lock ();
   g_print ("========================================================================\n"
            "GDBus-debug:Transport:\n"
-           "  >>>> WROTE %" G_GSSIZE_FORMAT " bytes of message with serial %d and\n"
-           "       size %" G_GSIZE_FORMAT " from offset %" G_GSIZE_FORMAT " on a %s\n",
+           "  >>>> WROTE %" G_GSSIZE_FORMAT " bytes of %u message(s) starting with serial %d and\n"
+           "       size %" G_GSIZE_FORMAT " from offset %" G_GSIZE_FORMAT " on a %s\n"
+           "       (%" G_GUINT64_FORMAT " messages in %" G_GSIZE_FORMAT " batches and %" G_GSIZE_FORMAT " writes so far)\n",
            bytes_written,
-           g_dbus_message_get_serial (data->message),
-           data->blob_size,
-           data->total_written,
-           g_type_name (G_TYPE_FROM_INSTANCE (g_io_stream_get_output_stream (data->worker->stream))));
+           batch->messages->len,
+           g_dbus_message_get_serial (write_batch_get_first (batch)->message),
+           batch->size,
+           batch->total_written,
+           g_type_name (G_TYPE_FROM_INSTANCE (g_io_stream_get_output_stream (worker->stream))),
+           worker->write_num_messages_written,
+           (gsize) g_atomic_pointer_get (&worker->write_num_batches),
+           (gsize) g_atomic_pointer_get (&worker->write_num_calls));
   _g_dbus_debug_print_unlock ();
  out:
   ;
@@ -2648,3 +3095,181 @@ _g_dbus_hexencode (const gchar *str,
 
   return g_string_free (s, FALSE);
 }
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+/* Latencies are bucketed by powers of two of microseconds: bucket n holds
+ * calls which took [2^n, 2^(n+1)) µs, with the last bucket open-ended
+ * (2^23 µs is a bit more than 8 seconds). */
+#define N_LATENCY_BUCKETS 24
+
+typedef struct
+{
+  gchar   *interface_name;  /* (nullable) */
+  gchar   *member;
+  guint    calls;
+  guint    errors;
+  guint    outstanding;
+  guint64  total_latency;  /* in µs */
+  guint64  latency_histogram[N_LATENCY_BUCKETS];
+} MethodStatistics;
+
+struct _GDBusStatistics
+{
+  gint        ref_count;  /* (atomic) */
+  GMutex      lock;
+  /* "interface\nmember" -> MethodStatistics, protected by @lock */
+  GHashTable *incoming;
+  GHashTable *outgoing;
+};
+
+static void
+method_statistics_free (MethodStatistics *method)
+{
+  g_free (method->interface_name);
+  g_free (method->member);
+  g_free (method);
+}
+
+GDBusStatistics *
+_g_dbus_statistics_new (void)
+{
+  GDBusStatistics *statistics;
+
+  statistics = g_new0 (GDBusStatistics, 1);
+  statistics->ref_count = 1;
+  g_mutex_init (&statistics->lock);
+  statistics->incoming = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, (GDestroyNotify) method_statistics_free);
+  statistics->outgoing = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, (GDestroyNotify) method_statistics_free);
+  return statistics;
+}
+
+GDBusStatistics *
+_g_dbus_statistics_ref (GDBusStatistics *statistics)
+{
+  g_atomic_int_inc (&statistics->ref_count);
+  return statistics;
+}
+
+void
+_g_dbus_statistics_unref (GDBusStatistics *statistics)
+{
+  if (g_atomic_int_dec_and_test (&statistics->ref_count))
+    {
+      g_hash_table_unref (statistics->incoming);
+      g_hash_table_unref (statistics->outgoing);
+      g_mutex_clear (&statistics->lock);
+      g_free (statistics);
+    }
+}
+
+/* called with @statistics->lock held */
+static MethodStatistics *
+statistics_lookup_method (GDBusStatistics *statistics,
+                          gboolean         incoming,
+                          const gchar     *interface_name,
+                          const gchar     *member)
+{
+  GHashTable *table = incoming ? statistics->incoming : statistics->outgoing;
+  MethodStatistics *method;
+  gchar *key;
+
+  key = g_strconcat (interface_name != NULL ? interface_name : "", "\n", member, NULL);
+  method = g_hash_table_lookup (table, key);
+  if (method == NULL)
+    {
+      method = g_new0 (MethodStatistics, 1);
+      method->interface_name = g_strdup (interface_name);
+      method->member = g_strdup (member);
+      g_hash_table_insert (table, g_steal_pointer (&key), method);
+    }
+  g_free (key);
+
+  return method;
+}
+
+void
+_g_dbus_statistics_call_started (GDBusStatistics *statistics,
+                                 gboolean         incoming,
+                                 const gchar     *interface_name,
+                                 const gchar     *member)
+{
+  MethodStatistics *method;
+
+  g_mutex_lock (&statistics->lock);
+  method = statistics_lookup_method (statistics, incoming, interface_name, member);
+  method->calls += 1;
+  method->outstanding += 1;
+  g_mutex_unlock (&statistics->lock);
+}
+
+void
+_g_dbus_statistics_call_finished (GDBusStatistics *statistics,
+                                  gboolean         incoming,
+                                  const gchar     *interface_name,
+                                  const gchar     *member,
+                                  gint64           start_time,
+                                  gboolean         failed)
+{
+  MethodStatistics *method;
+  guint64 latency;
+  guint bucket;
+
+  latency = MAX (g_get_monotonic_time () - start_time, 1);
+  bucket = MIN (g_bit_storage (latency) - 1, N_LATENCY_BUCKETS - 1);
+
+  g_mutex_lock (&statistics->lock);
+  method = statistics_lookup_method (statistics, incoming, interface_name, member);
+  if (method->outstanding > 0)
+    method->outstanding -= 1;
+  if (failed)
+    method->errors += 1;
+  method->total_latency += latency;
+  method->latency_histogram[bucket] += 1;
+  g_mutex_unlock (&statistics->lock);
+}
+
+/* called with @statistics->lock held */
+static GVariant *
+statistics_table_to_variant (GHashTable *table)
+{
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  MethodStatistics *method;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &method))
+    {
+      g_variant_builder_open (&builder, G_VARIANT_TYPE_VARDICT);
+      if (method->interface_name != NULL)
+        g_variant_builder_add (&builder, "{sv}", "interface", g_variant_new_string (method->interface_name));
+      g_variant_builder_add (&builder, "{sv}", "member", g_variant_new_string (method->member));
+      g_variant_builder_add (&builder, "{sv}", "calls", g_variant_new_uint32 (method->calls));
+      g_variant_builder_add (&builder, "{sv}", "errors", g_variant_new_uint32 (method->errors));
+      g_variant_builder_add (&builder, "{sv}", "outstanding", g_variant_new_uint32 (method->outstanding));
+      g_variant_builder_add (&builder, "{sv}", "total-latency", g_variant_new_uint64 (method->total_latency));
+      g_variant_builder_add (&builder, "{sv}", "latency-histogram",
+                             g_variant_new_fixed_array (G_VARIANT_TYPE_UINT64,
+                                                        method->latency_histogram,
+                                                        N_LATENCY_BUCKETS,
+                                                        sizeof (guint64)));
+      g_variant_builder_close (&builder);
+    }
+
+  return g_variant_builder_end (&builder);
+}
+
+void
+_g_dbus_statistics_add_to_builder (GDBusStatistics *statistics,
+                                   GVariantBuilder *builder)
+{
+  g_mutex_lock (&statistics->lock);
+  g_variant_builder_add (builder, "{sv}", "incoming-calls",
+                         statistics_table_to_variant (statistics->incoming));
+  g_variant_builder_add (builder, "{sv}", "outgoing-calls",
+                         statistics_table_to_variant (statistics->outgoing));
+  g_mutex_unlock (&statistics->lock);
+}
@@ -96,11 +96,20 @@ GDBusWorker *_g_dbus_worker_new          (GIOStream                          *st
                                           GDBusWorkerDisconnectedCallback     disconnected_callback,
                                           gpointer                            user_data);
 
-/* can be called from any thread - steals blob */
+/* can be called from any thread - steals blob and splices */
 void         _g_dbus_worker_send_message (GDBusWorker    *worker,
                                           GDBusMessage   *message,
                                           gchar          *blob,
-                                          gsize           blob_len);
+                                          gsize           blob_len,
+                                          GArray         *splices);
+
+/* can be called from any thread */
+void         _g_dbus_worker_set_memfd_threshold (GDBusWorker *worker,
+                                                 gsize        threshold);
+
+/* can be called from any thread; adds a{sv} entries to @builder */
+void         _g_dbus_worker_add_statistics (GDBusWorker     *worker,
+                                            GVariantBuilder *builder);
 
 /* can be called from any thread */
 void         _g_dbus_worker_stop         (GDBusWorker    *worker);
@@ -167,6 +176,28 @@ gchar *_g_dbus_enum_to_string (GType enum_type, gint value);
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Per-method call statistics, see g_dbus_connection_set_statistics_enabled();
+ * all functions can be called from any thread */
+typedef struct _GDBusStatistics GDBusStatistics;
+
+GDBusStatistics *_g_dbus_statistics_new           (void);
+GDBusStatistics *_g_dbus_statistics_ref           (GDBusStatistics *statistics);
+void             _g_dbus_statistics_unref         (GDBusStatistics *statistics);
+void             _g_dbus_statistics_call_started  (GDBusStatistics *statistics,
+                                                   gboolean         incoming,
+                                                   const gchar     *interface_name,
+                                                   const gchar     *member);
+void             _g_dbus_statistics_call_finished (GDBusStatistics *statistics,
+                                                   gboolean         incoming,
+                                                   const gchar     *interface_name,
+                                                   const gchar     *member,
+                                                   gint64           start_time,
+                                                   gboolean         failed);
+void             _g_dbus_statistics_add_to_builder (GDBusStatistics *statistics,
+                                                    GVariantBuilder *builder);
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 GDBusMethodInvocation *_g_dbus_method_invocation_new (const gchar             *sender,
                                                       const gchar             *object_path,
                                                       const gchar             *interface_name,
@@ -178,6 +209,12 @@ GDBusMethodInvocation *_g_dbus_method_invocation_new (const gchar             *s
                                                       GVariant                *parameters,
                                                       gpointer                 user_data);
 
+void _g_dbus_method_invocation_set_statistics (GDBusMethodInvocation *invocation,
+                                               GDBusStatistics       *statistics);
+
+void     _g_dbus_method_invocation_set_in_dispatch_pool (GDBusMethodInvocation *invocation);
+gboolean _g_dbus_method_invocation_get_in_dispatch_pool (GDBusMethodInvocation *invocation);
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 gboolean _g_signal_accumulator_false_handled (GSignalInvocationHint *ihint,
@@ -195,6 +232,44 @@ void _g_dbus_object_proxy_remove_interface (GDBusObjectProxy *proxy,
 gchar *_g_dbus_hexencode (const gchar *str,
                           gsize        str_len);
 
+/* Fixed-size arrays in message bodies at least this large are referenced
+ * rather than copied when serializing for, or parsing in, the GDBusWorker;
+ * below it an extra iovec or GBytes costs more than the memcpy() it saves.
+ * When parsing, arrays must also be at least a quarter of the message. */
+#define G_DBUS_MESSAGE_MIN_SPLICE_SIZE 4096
+
+/* Each spliced array takes two iovecs when the message is written out, so
+ * only this many are spliced per message and any further arrays are copied;
+ * this keeps a single message well within IOV_MAX (at least 1024 on all
+ * platforms we write vectors on) and within the batch vector limit. */
+#define G_DBUS_MESSAGE_MAX_SPLICES 64
+
+/* Data written out in place of @filler bytes at @offset of a serialized
+ * message, see _g_dbus_message_to_blob_with_splices() */
+typedef struct
+{
+  gsize   offset;
+  gsize   filler;
+  GBytes *bytes;  /* (owned) */
+} GDBusMessageSplice;
+
+/* Implemented in gdbusmessage.c */
+guchar *_g_dbus_message_to_blob_with_splices (GDBusMessage          *message,
+                                              gsize                 *out_size,
+                                              GDBusCapabilityFlags   capabilities,
+                                              GArray               **out_splices,
+                                              GError               **error);
+GDBusMessage *_g_dbus_message_new_from_bytes (GBytes                *bytes,
+                                              GDBusCapabilityFlags   capabilities,
+                                              GError               **error);
+#ifdef HAVE_MEMFD_CREATE
+GDBusMessage *_g_dbus_message_move_arrays_to_memfds (GDBusMessage  *message,
+                                                     gsize          threshold,
+                                                     GError       **error);
+gboolean      _g_dbus_message_restore_memfd_arrays  (GDBusMessage  *message,
+                                                     GError       **error);
+#endif
+
 /* Implemented in gdbusconnection.c */
 GDBusConnection *_g_bus_get_singleton_if_exists (GBusType bus_type);
 void             _g_bus_forget_singleton        (GBusType bus_type);
@@ -154,6 +154,20 @@ struct _GDBusProxyPrivate
 
   /* mutable, protected by properties_lock */
   GDBusObject *object;
+
+  /* gchar* set of the properties to cache, or %NULL to cache all of them;
+   * protected by properties_lock */
+  GHashTable *tracked_properties;
+
+  /* The following are only used with G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND */
+  GMainContext *context;  /* (owned) (nullable) */
+  /* gchar* set of the properties queued, being fetched, or that failed to
+   * load; protected by properties_lock */
+  GHashTable *requested_properties;
+  /* gchar* array of the properties to fetch in the next batch, and the idle
+   * source that fetches them; protected by properties_lock */
+  GPtrArray *queued_properties;
+  GSource *fetch_source;
 };
 
 enum
@@ -182,6 +196,8 @@ static guint signals[LAST_SIGNAL] = {0};
 static void dbus_interface_iface_init (GDBusInterfaceIface *dbus_interface_iface);
 static void initable_iface_init       (GInitableIface *initable_iface);
 static void async_initable_iface_init (GAsyncInitableIface *async_initable_iface);
+static void request_property          (GDBusProxy  *proxy,
+                                       const gchar *property_name);
 
 G_DEFINE_TYPE_WITH_CODE (GDBusProxy, g_dbus_proxy, G_TYPE_OBJECT,
                          G_ADD_PRIVATE (GDBusProxy)
@@ -226,6 +242,16 @@ g_dbus_proxy_finalize (GObject *object)
   if (proxy->priv->object != NULL)
     g_object_remove_weak_pointer (G_OBJECT (proxy->priv->object), (gpointer *) &proxy->priv->object);
 
+  if (proxy->priv->fetch_source != NULL)
+    {
+      g_source_destroy (proxy->priv->fetch_source);
+      g_source_unref (proxy->priv->fetch_source);
+    }
+  g_clear_pointer (&proxy->priv->queued_properties, g_ptr_array_unref);
+  g_clear_pointer (&proxy->priv->requested_properties, g_hash_table_unref);
+  g_clear_pointer (&proxy->priv->context, g_main_context_unref);
+  g_clear_pointer (&proxy->priv->tracked_properties, g_hash_table_unref);
+
   G_OBJECT_CLASS (g_dbus_proxy_parent_class)->finalize (object);
 }
 
@@ -685,6 +711,11 @@ lookup_property_info (GDBusProxy  *proxy,
  * Looks up the value for a property from the cache. This call does no
  * blocking IO.
  *
+ * If @proxy was constructed with
+ * %G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND and the value is not in the
+ * cache yet, %NULL is returned and the value is fetched in the background;
+ * #GDBusProxy::g-properties-changed is emitted once it is available.
+ *
  * If @proxy has an expected interface (see
  * #GDBusProxy:g-interface-info) and @property_name is referenced by
  * it, then @value is checked against the type of the property.
@@ -709,7 +740,11 @@ g_dbus_proxy_get_cached_property (GDBusProxy   *proxy,
 
   value = g_hash_table_lookup (proxy->priv->properties, property_name);
   if (value == NULL)
-    goto out;
+    {
+      if (proxy->priv->flags & G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND)
+        request_property (proxy, property_name);
+      goto out;
+    }
 
   info = lookup_property_info (proxy, property_name);
   if (info != NULL)
@@ -816,6 +851,57 @@ g_dbus_proxy_set_cached_property (GDBusProxy   *proxy,
   G_UNLOCK (properties_lock);
 }
 
+/**
+ * g_dbus_proxy_set_tracked_properties:
+ * @proxy: A #GDBusProxy
+ * @property_names: (nullable) (array zero-terminated=1): A %NULL-terminated
+ *   array of property names, or %NULL to track all properties.
+ *
+ * Restricts the properties cached by @proxy to @property_names.
+ *
+ * Values of other properties are dropped from the cache (without
+ * #GDBusProxy::g-properties-changed being emitted) and changes to
+ * them are ignored, so they no longer cost memory or signal emissions.
+ * This is useful for proxies to objects with many properties of which
+ * only a few are of interest.
+ *
+ * Since: 2.82
+ */
+void
+g_dbus_proxy_set_tracked_properties (GDBusProxy         *proxy,
+                                     const gchar * const *property_names)
+{
+  GHashTableIter iter;
+  const gchar *key;
+  guint n;
+
+  g_return_if_fail (G_IS_DBUS_PROXY (proxy));
+
+  G_LOCK (properties_lock);
+
+  g_clear_pointer (&proxy->priv->tracked_properties, g_hash_table_unref);
+  /* let properties be requested again, whether they are tracked now or not */
+  g_clear_pointer (&proxy->priv->queued_properties, g_ptr_array_unref);
+  g_clear_pointer (&proxy->priv->requested_properties, g_hash_table_unref);
+
+  if (property_names == NULL)
+    goto out;
+
+  proxy->priv->tracked_properties = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  for (n = 0; property_names[n] != NULL; n++)
+    g_hash_table_add (proxy->priv->tracked_properties, g_strdup (property_names[n]));
+
+  g_hash_table_iter_init (&iter, proxy->priv->properties);
+  while (g_hash_table_iter_next (&iter, (gpointer) &key, NULL))
+    {
+      if (!g_hash_table_contains (proxy->priv->tracked_properties, key))
+        g_hash_table_iter_remove (&iter);
+    }
+
+ out:
+  G_UNLOCK (properties_lock);
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 static void
@@ -884,12 +970,63 @@ on_signal_received (GDBusConnection *connection,
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* must hold properties_lock */
+static gboolean
+is_property_tracked (GDBusProxy  *proxy,
+                     const gchar *property_name)
+{
+  return proxy->priv->tracked_properties == NULL ||
+         g_hash_table_contains (proxy->priv->tracked_properties, property_name);
+}
+
+/* must hold properties_lock; consumes @changed_properties */
+static GVariant *
+filter_untracked_changed_properties (GDBusProxy *proxy,
+                                     GVariant   *changed_properties)
+{
+  GVariantBuilder builder;
+  GVariantIter iter;
+  const gchar *key;
+  GVariant *value;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  g_variant_iter_init (&iter, changed_properties);
+  while (g_variant_iter_next (&iter, "{&sv}", &key, &value))
+    {
+      if (is_property_tracked (proxy, key))
+        g_variant_builder_add (&builder, "{sv}", key, value);
+      g_variant_unref (value);
+    }
+  g_variant_unref (changed_properties);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/* must hold properties_lock; filters the %NULL-terminated
+ * @invalidated_properties in place */
+static void
+filter_untracked_invalidated_properties (GDBusProxy   *proxy,
+                                         const gchar **invalidated_properties)
+{
+  guint n, m;
+
+  for (n = 0, m = 0; invalidated_properties[n] != NULL; n++)
+    {
+      if (is_property_tracked (proxy, invalidated_properties[n]))
+        invalidated_properties[m++] = invalidated_properties[n];
+    }
+  invalidated_properties[m] = NULL;
+}
+
 /* must hold properties_lock */
 static void
 insert_property_checked (GDBusProxy  *proxy,
 			 gchar *property_name,
 			 GVariant *value)
 {
+  if (!is_property_tracked (proxy, property_name))
+    goto invalid;
+
   if (proxy->priv->expected_interface != NULL)
     {
       const GDBusPropertyInfo *info;
@@ -1036,9 +1173,22 @@ on_properties_changed (GDBusConnection *connection,
       goto out;
     }
 
+  if (proxy->priv->tracked_properties != NULL)
+    {
+      changed_properties = filter_untracked_changed_properties (proxy, changed_properties);
+      filter_untracked_invalidated_properties (proxy, (const gchar **) invalidated_properties);
+      if (g_variant_n_children (changed_properties) == 0 && invalidated_properties[0] == NULL)
+        {
+          G_UNLOCK (properties_lock);
+          goto out;
+        }
+    }
+
   g_variant_iter_init (&iter, changed_properties);
   while (g_variant_iter_next (&iter, "{sv}", &key, &value))
     {
+      if (proxy->priv->requested_properties != NULL)
+        g_hash_table_remove (proxy->priv->requested_properties, key);
       insert_property_checked (proxy,
 			       key, /* adopts string */
 			       value); /* adopts value */
@@ -1076,6 +1226,9 @@ on_properties_changed (GDBusConnection *connection,
       for (n = 0; invalidated_properties[n] != NULL; n++)
         {
           g_hash_table_remove (proxy->priv->properties, invalidated_properties[n]);
+          /* allow fetching it again on demand */
+          if (proxy->priv->requested_properties != NULL)
+            g_hash_table_remove (proxy->priv->requested_properties, invalidated_properties[n]);
         }
     }
 
@@ -1136,6 +1289,10 @@ process_get_all_reply (GDBusProxy *proxy,
       g_variant_get (result,
                      "(@a{sv})",
                      &changed_properties);
+      G_LOCK (properties_lock);
+      if (proxy->priv->tracked_properties != NULL)
+        changed_properties = filter_untracked_changed_properties (proxy, changed_properties);
+      G_UNLOCK (properties_lock);
       g_signal_emit (proxy, signals[PROPERTIES_CHANGED_SIGNAL],
                      0,
                      changed_properties,
@@ -1147,6 +1304,256 @@ process_get_all_reply (GDBusProxy *proxy,
   ;
 }
 
+/* ---------------------------------------------------------------------------------------------------- */
+
+typedef struct
+{
+  GDBusProxy *proxy;
+  gchar *name_owner;
+  GPtrArray *property_names;  /* (element-type utf8) (owned) */
+} FetchPropertiesData;
+
+static void
+fetch_properties_data_free (FetchPropertiesData *data)
+{
+  g_object_unref (data->proxy);
+  g_free (data->name_owner);
+  g_ptr_array_unref (data->property_names);
+  g_free (data);
+}
+
+static void
+fetch_properties_cb (GDBusConnection *connection,
+                     GAsyncResult    *res,
+                     gpointer         user_data)
+{
+  FetchPropertiesData *data = user_data;
+  GDBusProxy *proxy = data->proxy;
+  GVariant *result;
+  GVariant *fetched = NULL;
+  GVariant *changed_properties;
+  GVariantBuilder builder;
+  const gchar *invalidated_properties[1] = {NULL};
+  GError *error;
+  guint n;
+
+  error = NULL;
+  result = g_dbus_connection_call_finish (connection,
+                                          res,
+                                          &error);
+  if (result == NULL)
+    {
+      /* Leave the properties in requested_properties so we don't keep
+       * asking for properties the object doesn't have or won't give us;
+       * they are requested again once invalidated or the owner changes.
+       */
+      if (G_UNLIKELY (_g_dbus_debug_proxy ()))
+        {
+          g_debug ("error: %d %d %s",
+                   error->domain,
+                   error->code,
+                   error->message);
+        }
+      g_error_free (error);
+      goto out;
+    }
+
+  if (data->property_names->len == 1)
+    {
+      GVariant *value;
+
+      g_variant_get (result, "(v)", &value);
+      g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+      g_variant_builder_add (&builder, "{sv}", data->property_names->pdata[0], value);
+      fetched = g_variant_ref_sink (g_variant_builder_end (&builder));
+      g_variant_unref (value);
+    }
+  else
+    {
+      g_variant_get (result, "(@a{sv})", &fetched);
+    }
+
+  G_LOCK (properties_lock);
+
+  /* Ignore replies from a previous owner of the name */
+  if (g_strcmp0 (data->name_owner, proxy->priv->name_owner) != 0)
+    {
+      G_UNLOCK (properties_lock);
+      goto out;
+    }
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  for (n = 0; n < data->property_names->len; n++)
+    {
+      const gchar *property_name = data->property_names->pdata[n];
+      GVariant *value;
+
+      /* Skip properties that were changed, invalidated or untracked while
+       * we were waiting for the reply */
+      if (proxy->priv->requested_properties == NULL ||
+          !g_hash_table_contains (proxy->priv->requested_properties, property_name) ||
+          g_hash_table_contains (proxy->priv->properties, property_name))
+        continue;
+
+      value = g_variant_lookup_value (fetched, property_name, NULL);
+      if (value == NULL)
+        continue;
+
+      insert_property_checked (proxy,
+                               g_strdup (property_name), /* adopts string */
+                               g_variant_ref (value)); /* adopts value */
+      if (g_hash_table_contains (proxy->priv->properties, property_name))
+        {
+          g_hash_table_remove (proxy->priv->requested_properties, property_name);
+          g_variant_builder_add (&builder, "{sv}", property_name, value);
+        }
+      g_variant_unref (value);
+    }
+
+  G_UNLOCK (properties_lock);
+
+  changed_properties = g_variant_ref_sink (g_variant_builder_end (&builder));
+  if (g_variant_n_children (changed_properties) > 0)
+    {
+      g_signal_emit (proxy, signals[PROPERTIES_CHANGED_SIGNAL],
+                     0,
+                     changed_properties,
+                     invalidated_properties);
+    }
+  g_variant_unref (changed_properties);
+
+ out:
+  g_clear_pointer (&fetched, g_variant_unref);
+  g_clear_pointer (&result, g_variant_unref);
+  fetch_properties_data_free (data);
+}
+
+static gboolean
+fetch_queued_properties_cb (gpointer user_data)
+{
+  GWeakRef *proxy_weak = user_data;
+  GDBusProxy *proxy;
+  GPtrArray *property_names;
+  gchar *name_owner;
+  FetchPropertiesData *data;
+
+  proxy = G_DBUS_PROXY (g_weak_ref_get (proxy_weak));
+  if (proxy == NULL)
+    return G_SOURCE_REMOVE;
+
+  G_LOCK (properties_lock);
+  g_clear_pointer (&proxy->priv->fetch_source, g_source_unref);
+  property_names = g_steal_pointer (&proxy->priv->queued_properties);
+  name_owner = g_strdup (proxy->priv->name_owner);
+  G_UNLOCK (properties_lock);
+
+  /* The queue is dropped if the name owner changed in the meantime */
+  if (property_names == NULL)
+    goto out;
+
+  data = g_new0 (FetchPropertiesData, 1);
+  data->proxy = g_object_ref (proxy);
+  data->name_owner = g_steal_pointer (&name_owner);
+  data->property_names = g_steal_pointer (&property_names);
+
+  /* A single property is fetched with Get(), anything more is batched into
+   * one GetAll() round-trip */
+  if (data->property_names->len == 1)
+    {
+      g_dbus_connection_call (proxy->priv->connection,
+                              data->name_owner,
+                              proxy->priv->object_path,
+                              DBUS_INTERFACE_PROPERTIES,
+                              "Get",
+                              g_variant_new ("(ss)",
+                                             proxy->priv->interface_name,
+                                             data->property_names->pdata[0]),
+                              G_VARIANT_TYPE ("(v)"),
+                              G_DBUS_CALL_FLAGS_NONE,
+                              -1,           /* timeout */
+                              NULL,         /* GCancellable */
+                              (GAsyncReadyCallback) fetch_properties_cb,
+                              data);
+    }
+  else
+    {
+      g_dbus_connection_call (proxy->priv->connection,
+                              data->name_owner,
+                              proxy->priv->object_path,
+                              DBUS_INTERFACE_PROPERTIES,
+                              "GetAll",
+                              g_variant_new ("(s)", proxy->priv->interface_name),
+                              G_VARIANT_TYPE ("(a{sv})"),
+                              G_DBUS_CALL_FLAGS_NONE,
+                              -1,           /* timeout */
+                              NULL,         /* GCancellable */
+                              (GAsyncReadyCallback) fetch_properties_cb,
+                              data);
+    }
+
+ out:
+  g_free (name_owner);
+  g_object_unref (proxy);
+  return G_SOURCE_REMOVE;
+}
+
+/* must hold properties_lock */
+static void
+request_property (GDBusProxy  *proxy,
+                  const gchar *property_name)
+{
+  const GDBusPropertyInfo *info;
+
+  if (!proxy->priv->initialized)
+    return;
+
+  /* Nobody to ask */
+  if (proxy->priv->name_owner == NULL && proxy->priv->name != NULL)
+    return;
+
+  if (!is_property_tracked (proxy, property_name))
+    return;
+
+  info = lookup_property_info (proxy, property_name);
+  if (info != NULL && !(info->flags & G_DBUS_PROPERTY_INFO_FLAGS_READABLE))
+    return;
+
+  if (proxy->priv->requested_properties == NULL)
+    proxy->priv->requested_properties = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  else if (g_hash_table_contains (proxy->priv->requested_properties, property_name))
+    return;
+
+  g_hash_table_add (proxy->priv->requested_properties, g_strdup (property_name));
+
+  if (proxy->priv->queued_properties == NULL)
+    proxy->priv->queued_properties = g_ptr_array_new_with_free_func (g_free);
+  g_ptr_array_add (proxy->priv->queued_properties, g_strdup (property_name));
+
+  /* Batch all the properties requested in this main loop iteration */
+  if (proxy->priv->fetch_source == NULL)
+    {
+      proxy->priv->fetch_source = g_idle_source_new ();
+      g_source_set_priority (proxy->priv->fetch_source, G_PRIORITY_DEFAULT);
+      g_source_set_callback (proxy->priv->fetch_source,
+                             fetch_queued_properties_cb,
+                             weak_ref_new (G_OBJECT (proxy)),
+                             (GDestroyNotify) weak_ref_free);
+      g_source_set_static_name (proxy->priv->fetch_source, "[gio] fetch_queued_properties_cb");
+      g_source_attach (proxy->priv->fetch_source, proxy->priv->context);
+    }
+}
+
+/* must hold properties_lock */
+static void
+clear_requested_properties (GDBusProxy *proxy)
+{
+  g_clear_pointer (&proxy->priv->queued_properties, g_ptr_array_unref);
+  if (proxy->priv->requested_properties != NULL)
+    g_hash_table_remove_all (proxy->priv->requested_properties);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 typedef struct
 {
   GDBusProxy *proxy;
@@ -1253,6 +1660,7 @@ on_name_owner_changed (GDBusConnection *connection,
       G_LOCK (properties_lock);
       g_free (proxy->priv->name_owner);
       proxy->priv->name_owner = NULL;
+      clear_requested_properties (proxy);
 
       /* Synthesize ::g-properties-changed changed */
       if (!(proxy->priv->flags & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES) &&
@@ -1301,12 +1709,14 @@ on_name_owner_changed (GDBusConnection *connection,
           goto out;
         }
 
-      if (proxy->priv->flags & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES)
+      if (proxy->priv->flags & (G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                                G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND))
         {
           g_free (proxy->priv->name_owner);
           proxy->priv->name_owner = g_strdup (new_owner);
 
           g_hash_table_remove_all (proxy->priv->properties);
+          clear_requested_properties (proxy);
           G_UNLOCK (properties_lock);
           g_object_notify (G_OBJECT (proxy), "g-name-owner");
         }
@@ -1403,9 +1813,11 @@ async_init_data_set_name_owner (GTask       *task,
 
   get_all = TRUE;
 
-  if (proxy->priv->flags & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES)
+  if (proxy->priv->flags & (G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                            G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND))
     {
-      /* Don't load properties if the API user doesn't want them */
+      /* Don't load properties if the API user doesn't want them, or only
+       * wants them when they are looked up */
       get_all = FALSE;
     }
   else if (name_owner == NULL && proxy->priv->name != NULL)
@@ -1682,6 +2094,10 @@ async_initable_init_first (GAsyncInitable *initable)
   if (proxy->priv->flags & G_DBUS_PROXY_FLAGS_NO_MATCH_RULE)
     signal_flags |= G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE;
 
+  /* properties requested on demand are fetched from this context */
+  if (proxy->priv->flags & G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND)
+    proxy->priv->context = g_main_context_ref_thread_default ();
+
   if (!(proxy->priv->flags & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES))
     {
       /* subscribe to PropertiesChanged() */
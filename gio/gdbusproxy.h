@@ -155,6 +155,9 @@ void             g_dbus_proxy_set_cached_property       (GDBusProxy          *pr
                                                          GVariant            *value);
 GIO_AVAILABLE_IN_ALL
 gchar          **g_dbus_proxy_get_cached_property_names (GDBusProxy          *proxy);
+GIO_AVAILABLE_IN_2_82
+void             g_dbus_proxy_set_tracked_properties    (GDBusProxy          *proxy,
+                                                         const gchar * const *property_names);
 GIO_AVAILABLE_IN_ALL
 void             g_dbus_proxy_call                      (GDBusProxy          *proxy,
                                                          const gchar         *method_name,
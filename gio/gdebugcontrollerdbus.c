@@ -54,6 +54,14 @@
  * information in its debug output. You may want to restrict the ability to
  * enable debug output to privileged users or processes.
  *
+ * Since GLib 2.82, `org.gtk.Debugging.GetStatistics()` returns the D-Bus
+ * traffic statistics of [property@Gio.DebugControllerDBus:connection], as
+ * returned by [method@Gio.DBusConnection.get_statistics]. It returns an empty
+ * dictionary unless statistics have been enabled on the connection with
+ * [method@Gio.DBusConnection.set_statistics_enabled]. As the statistics reveal
+ * which methods the process calls and serves, calls to it are authorized in
+ * the same way as calls to `SetDebugEnabled()`.
+ *
  * One option is to install a D-Bus security policy which restricts access to
  * `SetDebugEnabled()`, installing something like the following in
  * `$datadir/dbus-1/system.d/`:
@@ -154,6 +162,9 @@ static const gchar org_gtk_Debugging_xml[] =
       "<method name='SetDebugEnabled'>"
         "<arg type='b' name='debug-enabled' direction='in'/>"
       "</method>"
+      "<method name='GetStatistics'>"
+        "<arg type='a{sv}' name='statistics' direction='out'/>"
+      "</method>"
     "</interface>"
   "</node>";
 
@@ -345,10 +356,11 @@ authorize_cb (GObject      *object,
               gpointer      user_data)
 {
   GDebugControllerDBus *self = G_DEBUG_CONTROLLER_DBUS (object);
-  GDebugControllerDBusPrivate *priv G_GNUC_UNUSED  /* when compiling with G_DISABLE_ASSERT */;
+  GDebugControllerDBusPrivate *priv;
   GTask *task = G_TASK (result);
   GDBusMethodInvocation *invocation = g_task_get_task_data (task);
   GVariant *parameters = g_dbus_method_invocation_get_parameters (invocation);
+  const gchar *method_name = g_dbus_method_invocation_get_method_name (invocation);
   gboolean enabled = FALSE;
   gboolean authorized;
 
@@ -357,10 +369,27 @@ authorize_cb (GObject      *object,
 
   if (!authorized)
     {
-      GError *local_error = g_error_new (G_DBUS_ERROR, G_DBUS_ERROR_ACCESS_DENIED,
-                                         _("Not authorized to change debug settings"));
+      const gchar *message;
+      GError *local_error;
+
+      if (g_str_equal (method_name, "GetStatistics"))
+        message = _("Not authorized to get statistics");
+      else
+        message = _("Not authorized to change debug settings");
+
+      local_error = g_error_new_literal (G_DBUS_ERROR, G_DBUS_ERROR_ACCESS_DENIED, message);
       g_dbus_method_invocation_take_error (invocation, g_steal_pointer (&local_error));
     }
+  else if (g_str_equal (method_name, "GetStatistics"))
+    {
+      GVariant *statistics = g_dbus_connection_get_statistics (priv->connection);
+
+      if (statistics == NULL)
+        statistics = g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
+
+      g_dbus_method_invocation_return_value (invocation,
+                                             g_variant_new_tuple (&statistics, 1));
+    }
   else
     {
       /* Update the property value. */
@@ -392,7 +421,8 @@ dbus_method_call (GDBusConnection       *connection,
   GDebugControllerDBusClass *klass = G_DEBUG_CONTROLLER_DBUS_GET_CLASS (self);
 
   /* Only on the org.gtk.Debugging interface */
-  if (g_str_equal (method_name, "SetDebugEnabled"))
+  if (g_str_equal (method_name, "SetDebugEnabled") ||
+      g_str_equal (method_name, "GetStatistics"))
     {
       GTask *task = NULL;
 
@@ -576,8 +606,9 @@ g_debug_controller_dbus_class_init (GDebugControllerDBusClass *klass)
    * @controller: The #GDebugControllerDBus emitting the signal.
    * @invocation: A #GDBusMethodInvocation.
    *
-   * Emitted when a D-Bus peer is trying to change the debug settings and used
-   * to determine if that is authorized.
+   * Emitted when a D-Bus peer is trying to change the debug settings, or
+   * (since 2.82) to read the D-Bus statistics, and used to determine if that
+   * is authorized.
    *
    * This signal is emitted in a dedicated worker thread, so handlers are
    * allowed to perform blocking I/O. This means that, for example, it is
@@ -37,6 +37,7 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(GAsyncResult, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GBufferedInputStream, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GBufferedOutputStream, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GBytesIcon, g_object_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GCachingResolver, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GCancellable, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GCharsetConverter, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GConverter, g_object_unref)
@@ -150,6 +151,7 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(GTlsFileDatabase, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GTlsInteraction, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GTlsPassword, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GTlsServerConnection, g_object_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GUdpSegmentMessage, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GVfs, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GVolume, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GVolumeMonitor, g_object_unref)
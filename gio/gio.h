@@ -39,6 +39,7 @@
 #include <gio/gbufferedinputstream.h>
 #include <gio/gbufferedoutputstream.h>
 #include <gio/gbytesicon.h>
+#include <gio/gcachingresolver.h>
 #include <gio/gcancellable.h>
 #include <gio/gcharsetconverter.h>
 #include <gio/gcontenttype.h>
@@ -169,6 +170,7 @@
 #include <gio/gtlsinteraction.h>
 #include <gio/gtlspassword.h>
 #include <gio/gtlsserverconnection.h>
+#include <gio/gudpsegmentmessage.h>
 #include <gio/gunixconnection.h>
 #include <gio/gunixcredentialsmessage.h>
 #include <gio/gunixfdlist.h>
@@ -796,6 +796,9 @@ typedef enum {
  * GResourceFlags:
  * @G_RESOURCE_FLAGS_NONE: No flags set.
  * @G_RESOURCE_FLAGS_COMPRESSED: The file is compressed.
+ * @G_RESOURCE_FLAGS_COMPRESSED_LZ4: The file is compressed using LZ4 rather
+ *   than zlib. This is always set together with %G_RESOURCE_FLAGS_COMPRESSED.
+ *   Since: 2.82
  *
  * GResourceFlags give information about a particular file inside a resource
  * bundle.
@@ -804,7 +807,8 @@ typedef enum {
  **/
 typedef enum {
   G_RESOURCE_FLAGS_NONE       = 0,
-  G_RESOURCE_FLAGS_COMPRESSED = (1<<0)
+  G_RESOURCE_FLAGS_COMPRESSED = (1<<0),
+  G_RESOURCE_FLAGS_COMPRESSED_LZ4 GIO_AVAILABLE_ENUMERATOR_IN_2_82 = (1<<1)
 } GResourceFlags;
 
 /**
@@ -869,6 +873,11 @@ typedef enum
  *     the queue.
  * @G_SOCKET_MSG_DONTROUTE: Don't use a gateway to send out the packet,
  *     only send to hosts on directly connected networks.
+ * @G_SOCKET_MSG_ZEROCOPY: Send the data without copying it into the kernel,
+ *     if possible. The socket must have `SO_ZEROCOPY` enabled, the buffers
+ *     must not be modified until the kernel reports completion (see
+ *     g_socket_create_zerocopy_source()). Only supported on Linux; it is
+ *     zero on other platforms. Since: 2.82
  *
  * Flags used in g_socket_receive_message() and g_socket_send_message().
  * The flags listed in the enum are some commonly available flags, but the
@@ -883,7 +892,8 @@ typedef enum /*< flags >*/
   G_SOCKET_MSG_NONE,
   G_SOCKET_MSG_OOB = GLIB_SYSDEF_MSG_OOB,
   G_SOCKET_MSG_PEEK = GLIB_SYSDEF_MSG_PEEK,
-  G_SOCKET_MSG_DONTROUTE = GLIB_SYSDEF_MSG_DONTROUTE
+  G_SOCKET_MSG_DONTROUTE = GLIB_SYSDEF_MSG_DONTROUTE,
+  G_SOCKET_MSG_ZEROCOPY GIO_AVAILABLE_ENUMERATOR_IN_2_82 = GLIB_SYSDEF_MSG_ZEROCOPY
 } GSocketMsgFlags;
 
 /**
@@ -1037,6 +1047,12 @@ typedef enum
  * @G_DBUS_PROXY_FLAGS_NO_MATCH_RULE: Don't actually send the AddMatch D-Bus
  *    call for this signal subscription. This gives you more control
  *    over which match rules you add (but you must add them manually). (Since: 2.72)
+ * @G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND: Don't load properties at
+ *    construction time or when the name owner changes; instead fetch each
+ *    property the first time g_dbus_proxy_get_cached_property() misses it,
+ *    batching the requests made in one main loop iteration, and emit
+ *    #GDBusProxy::g-properties-changed when the values arrive. Changes are
+ *    still tracked through the `PropertiesChanged` signal. (Since: 2.82)
  *
  * Flags used when constructing an instance of a #GDBusProxy derived class.
  *
@@ -1050,7 +1066,8 @@ typedef enum
   G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START = (1<<2),
   G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES = (1<<3),
   G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START_AT_CONSTRUCTION = (1<<4),
-  G_DBUS_PROXY_FLAGS_NO_MATCH_RULE GIO_AVAILABLE_ENUMERATOR_IN_2_72 = (1<<5)
+  G_DBUS_PROXY_FLAGS_NO_MATCH_RULE GIO_AVAILABLE_ENUMERATOR_IN_2_72 = (1<<5),
+  G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND GIO_AVAILABLE_ENUMERATOR_IN_2_82 = (1<<6)
 } GDBusProxyFlags;
 
 /**
@@ -1387,6 +1404,23 @@ typedef enum
   G_DBUS_SUBTREE_FLAGS_DISPATCH_TO_UNENUMERATED_NODES = (1<<0)
 } GDBusSubtreeFlags;
 
+/**
+ * GDBusDispatchFlags:
+ * @G_DBUS_DISPATCH_FLAGS_NONE: No flags set.
+ * @G_DBUS_DISPATCH_FLAGS_ORDER_PER_SENDER: Method calls from the same sender
+ *   are handled one at a time, in the order they were received.
+ *
+ * Flags passed to g_dbus_connection_set_dispatch_thread_pool() and
+ * g_dbus_interface_skeleton_set_dispatch_thread_pool().
+ *
+ * Since: 2.82
+ */
+typedef enum /*< flags >*/
+{
+  G_DBUS_DISPATCH_FLAGS_NONE = 0,
+  G_DBUS_DISPATCH_FLAGS_ORDER_PER_SENDER = (1<<0)
+} GDBusDispatchFlags;
+
 /**
  * GDBusServerFlags:
  * @G_DBUS_SERVER_FLAGS_NONE: No flags set.
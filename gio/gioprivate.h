@@ -37,6 +37,8 @@ gboolean g_output_stream_async_close_is_via_threads (GOutputStream *stream);
 void g_socket_connection_set_cached_remote_address (GSocketConnection *connection,
                                                     GSocketAddress    *address);
 
+void _g_resources_trim_cache (void);
+
 /* POSIX defines IOV_MAX/UIO_MAXIOV as the maximum number of iovecs that can
  * be sent in one go. We define our own version of it here as there are two
  * possible names, and also define a fall-back value if none of the constants
@@ -316,6 +316,29 @@ typedef gboolean (*GSocketSourceFunc) (GSocket *socket,
 				       GIOCondition condition,
 				       gpointer data);
 
+/**
+ * GSocketZerocopyFunc:
+ * @socket: the #GSocket
+ * @first_id: the sequence number of the first completed zerocopy send
+ * @last_id: the sequence number of the last completed zerocopy send
+ * @copied: %TRUE if the kernel fell back to copying the data
+ * @data: data passed in by the user.
+ *
+ * This is the function type of the callback used for the #GSource
+ * returned by g_socket_create_zerocopy_source(). It is called once for
+ * each range of completed sends; the buffers of those sends may be
+ * reused once it has been called.
+ *
+ * Returns: it should return %FALSE if the source should be removed.
+ *
+ * Since: 2.82
+ */
+typedef gboolean (*GSocketZerocopyFunc) (GSocket  *socket,
+                                         guint32   first_id,
+                                         guint32   last_id,
+                                         gboolean  copied,
+                                         gpointer  data);
+
 /**
  * GDatagramBasedSourceFunc:
  * @datagram_based: the #GDatagramBased
@@ -53,7 +53,8 @@ typedef enum {
   PROP_FILENAME = 1,
   PROP_ROOT_PATH,
   PROP_ROOT_GROUP,
-  PROP_DEFAULTS_DIR
+  PROP_DEFAULTS_DIR,
+  PROP_WRITE_DELAY
 } GKeyfileSettingsBackendProperty;
 
 typedef struct
@@ -75,8 +76,15 @@ typedef struct
   GFile             *file;
   GFileMonitor      *file_monitor;
   guint8             digest[32];
+  gchar             *file_id;  /* (nullable) of the file as we last wrote it */
   GFile             *dir;
   GFileMonitor      *dir_monitor;
+
+  /* write-behind, if write_delay is non-zero */
+  guint              write_delay;
+  GMainContext      *main_context;
+  GSource           *write_source;
+  GHashTable        *pending_keys; /* Used as a set, owning the strings it contains */
 } GKeyfileSettingsBackend;
 
 #ifdef G_OS_WIN32
@@ -107,26 +115,122 @@ compute_checksum (guint8        *digest,
   g_assert (len == 32);
 }
 
+/* Identifies the current version of @file by its etag (the modification
+ * time), inode and size, so that a rewrite within the timestamp granularity
+ * is still noticed. If @etag is given, the file must also still have it. */
+static gchar *
+query_file_id (GFile       *file,
+               const gchar *etag)
+{
+  GFileInfo *info;
+  gchar *file_id = NULL;
+
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_ETAG_VALUE ","
+                            G_FILE_ATTRIBUTE_UNIX_INODE ","
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                            G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  if (info == NULL)
+    return NULL;
+
+  if (g_file_info_get_etag (info) != NULL &&
+      (etag == NULL || strcmp (g_file_info_get_etag (info), etag) == 0))
+    file_id = g_strdup_printf ("%s:%" G_GUINT64_FORMAT ":%" G_GOFFSET_FORMAT,
+                               g_file_info_get_etag (info),
+                               g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE),
+                               g_file_info_get_size (info));
+  g_object_unref (info);
+
+  return file_id;
+}
+
 static gboolean
 g_keyfile_settings_backend_keyfile_write (GKeyfileSettingsBackend  *kfsb,
                                           GError                  **error)
 {
   gchar *contents;
   gsize length;
+  gchar *etag = NULL;
   gboolean success;
 
   contents = g_key_file_to_data (kfsb->keyfile, &length, NULL);
+  g_clear_pointer (&kfsb->file_id, g_free);
   success = g_file_replace_contents (kfsb->file, contents, length, NULL, FALSE,
                                      G_FILE_CREATE_REPLACE_DESTINATION |
                                      G_FILE_CREATE_PRIVATE,
-                                     NULL, NULL, error);
+                                     &etag, NULL, error);
+
+  /* Checking the etag makes sure that this is still our own write */
+  if (success)
+    kfsb->file_id = query_file_id (kfsb->file, etag);
 
   compute_checksum (kfsb->digest, contents, length);
   g_free (contents);
+  g_free (etag);
 
   return success;
 }
 
+static gboolean
+g_keyfile_settings_backend_keyfile_save (GKeyfileSettingsBackend *kfsb)
+{
+  GError *error = NULL;
+  gboolean success;
+
+  success = g_keyfile_settings_backend_keyfile_write (kfsb, &error);
+  if (error)
+    {
+      g_warning ("Failed to write keyfile to %s: %s", g_file_peek_path (kfsb->file), error->message);
+      g_error_free (error);
+    }
+
+  return success;
+}
+
+/* Writes out any changes that are waiting for the write-delay to expire */
+static void
+g_keyfile_settings_backend_flush (GKeyfileSettingsBackend *kfsb)
+{
+  if (kfsb->write_source == NULL)
+    return;
+
+  g_source_destroy (kfsb->write_source);
+  g_clear_pointer (&kfsb->write_source, g_source_unref);
+  g_hash_table_remove_all (kfsb->pending_keys);
+
+  g_keyfile_settings_backend_keyfile_save (kfsb);
+}
+
+static gboolean
+write_timeout_cb (gpointer user_data)
+{
+  GKeyfileSettingsBackend *kfsb = user_data;
+
+  g_keyfile_settings_backend_flush (kfsb);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Called after kfsb->keyfile was modified.  Without a write-delay the
+ * file is rewritten straight away.  Otherwise, all the changes made
+ * until the delay expires are written out together. */
+static gboolean
+g_keyfile_settings_backend_keyfile_changed (GKeyfileSettingsBackend *kfsb)
+{
+  if (kfsb->write_delay == 0)
+    return g_keyfile_settings_backend_keyfile_save (kfsb);
+
+  if (kfsb->write_source == NULL)
+    {
+      kfsb->write_source = g_timeout_source_new (kfsb->write_delay);
+      g_source_set_callback (kfsb->write_source, write_timeout_cb, kfsb, NULL);
+      g_source_set_static_name (kfsb->write_source, "[gio] keyfile settings write");
+      g_source_attach (kfsb->write_source, kfsb->main_context);
+    }
+
+  return TRUE;
+}
+
 static gboolean
 group_name_matches (const gchar *group_name,
                     const gchar *prefix)
@@ -291,6 +395,10 @@ set_to_keyfile (GKeyfileSettingsBackend *kfsb,
 
   if (convert_path (kfsb, key, &group, &name))
     {
+      /* remembered so that they survive a reload before the write */
+      if (kfsb->write_delay != 0)
+        g_hash_table_add (kfsb->pending_keys, g_strdup (key));
+
       if (value)
         {
           gchar *str = g_variant_print (value, FALSE);
@@ -378,7 +486,6 @@ g_keyfile_settings_backend_write_tree (GSettingsBackend *backend,
 {
   WriteManyData data = { G_KEYFILE_SETTINGS_BACKEND (backend), 0 };
   gboolean success;
-  GError *error = NULL;
 
   if (!data.kfsb->writable)
     return FALSE;
@@ -389,12 +496,7 @@ g_keyfile_settings_backend_write_tree (GSettingsBackend *backend,
     return FALSE;
 
   g_tree_foreach (tree, g_keyfile_settings_backend_write_one, &data);
-  success = g_keyfile_settings_backend_keyfile_write (data.kfsb, &error);
-  if (error)
-    {
-      g_warning ("Failed to write keyfile to %s: %s", g_file_peek_path (data.kfsb->file), error->message);
-      g_error_free (error);
-    }
+  success = g_keyfile_settings_backend_keyfile_changed (data.kfsb);
 
   g_settings_backend_changed_tree (backend, tree, origin_tag);
 
@@ -409,7 +511,6 @@ g_keyfile_settings_backend_write (GSettingsBackend *backend,
 {
   GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (backend);
   gboolean success;
-  GError *error = NULL;
 
   if (!kfsb->writable)
     return FALSE;
@@ -419,12 +520,7 @@ g_keyfile_settings_backend_write (GSettingsBackend *backend,
   if (success)
     {
       g_settings_backend_changed (backend, key, origin_tag);
-      success = g_keyfile_settings_backend_keyfile_write (kfsb, &error);
-      if (error)
-        {
-          g_warning ("Failed to write keyfile to %s: %s", g_file_peek_path (kfsb->file), error->message);
-          g_error_free (error);
-        }
+      success = g_keyfile_settings_backend_keyfile_changed (kfsb);
     }
 
   return success;
@@ -436,21 +532,19 @@ g_keyfile_settings_backend_reset (GSettingsBackend *backend,
                                   gpointer          origin_tag)
 {
   GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (backend);
-  GError *error = NULL;
 
   if (set_to_keyfile (kfsb, key, NULL))
-    {
-      g_keyfile_settings_backend_keyfile_write (kfsb, &error);
-      if (error)
-        {
-          g_warning ("Failed to write keyfile to %s: %s", g_file_peek_path (kfsb->file), error->message);
-          g_error_free (error);
-        }
-    }
+    g_keyfile_settings_backend_keyfile_changed (kfsb);
 
   g_settings_backend_changed (backend, key, origin_tag);
 }
 
+static void
+g_keyfile_settings_backend_sync (GSettingsBackend *backend)
+{
+  g_keyfile_settings_backend_flush (G_KEYFILE_SETTINGS_BACKEND (backend));
+}
+
 static gboolean
 g_keyfile_settings_backend_get_writable (GSettingsBackend *backend,
                                          const gchar      *name)
@@ -528,6 +622,60 @@ keyfile_to_tree (GKeyfileSettingsBackend *kfsb,
   g_strfreev (groups);
 }
 
+/* Carries the changes that have not been written out yet over from
+ * @old_keyfile to the freshly loaded @new_keyfile */
+static void
+keyfile_merge_pending (GKeyfileSettingsBackend *kfsb,
+                       GKeyFile                *old_keyfile,
+                       GKeyFile                *new_keyfile)
+{
+  GHashTableIter iter;
+  const gchar *key;
+  gchar *group, *name;
+
+  /* Resets of whole paths first, so that keys written after them are
+   * not lost */
+  g_hash_table_iter_init (&iter, kfsb->pending_keys);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &key, NULL))
+    if (convert_path (kfsb, key, &group, &name))
+      {
+        if (*name == '\0')
+          {
+            gchar **groups;
+            gint i;
+
+            groups = g_key_file_get_groups (new_keyfile, NULL);
+            for (i = 0; groups[i]; i++)
+              if (group_name_matches (groups[i], group))
+                g_key_file_remove_group (new_keyfile, groups[i], NULL);
+            g_strfreev (groups);
+          }
+
+        g_free (group);
+        g_free (name);
+      }
+
+  g_hash_table_iter_init (&iter, kfsb->pending_keys);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &key, NULL))
+    if (convert_path (kfsb, key, &group, &name))
+      {
+        if (*name != '\0')
+          {
+            gchar *value;
+
+            value = g_key_file_get_value (old_keyfile, group, name, NULL);
+            if (value)
+              g_key_file_set_value (new_keyfile, group, name, value);
+            else
+              g_key_file_remove_key (new_keyfile, group, name, NULL);
+            g_free (value);
+          }
+
+        g_free (group);
+        g_free (name);
+      }
+}
+
 static void
 g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
 {
@@ -535,6 +683,21 @@ g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
   gchar *contents;
   gsize length;
 
+  /* Avoid reading the file back in if it is still the one that we
+   * wrote last */
+  if (kfsb->file_id != NULL)
+    {
+      gchar *file_id;
+      gboolean unchanged;
+
+      file_id = query_file_id (kfsb->file, NULL);
+      unchanged = g_strcmp0 (file_id, kfsb->file_id) == 0;
+      g_free (file_id);
+
+      if (unchanged)
+        return;
+    }
+
   contents = NULL;
   length = 0;
 
@@ -557,6 +720,9 @@ g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
                                    G_KEY_FILE_KEEP_COMMENTS |
                                    G_KEY_FILE_KEEP_TRANSLATIONS, NULL);
 
+      if (g_hash_table_size (kfsb->pending_keys) > 0)
+        keyfile_merge_pending (kfsb, keyfiles[0], keyfiles[1]);
+
       keyfile_to_tree (kfsb, tree, keyfiles[0], FALSE);
       keyfile_to_tree (kfsb, tree, keyfiles[1], TRUE);
       g_key_file_free (keyfiles[0]);
@@ -603,6 +769,11 @@ g_keyfile_settings_backend_finalize (GObject *object)
 {
   GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (object);
 
+  g_keyfile_settings_backend_flush (kfsb);
+  g_hash_table_unref (kfsb->pending_keys);
+  g_main_context_unref (kfsb->main_context);
+  g_free (kfsb->file_id);
+
   g_key_file_free (kfsb->keyfile);
   g_object_unref (kfsb->permission);
   g_key_file_unref (kfsb->system_keyfile);
@@ -751,8 +922,18 @@ g_keyfile_settings_backend_constructed (GObject *object)
       kfsb->prefix_len = 1;
     }
   
+  if (kfsb->write_delay == 0)
+    {
+      const gchar *env = g_getenv ("GSETTINGS_KEYFILE_WRITE_DELAY");
+
+      if (env != NULL)
+        kfsb->write_delay = (guint) MIN (g_ascii_strtoull (env, NULL, 10), G_MAXUINT);
+    }
+
   kfsb->keyfile = g_key_file_new ();
   kfsb->permission = g_simple_permission_new (TRUE);
+  kfsb->main_context = g_main_context_ref_thread_default ();
+  kfsb->pending_keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
   kfsb->dir = g_file_get_parent (kfsb->file);
   path = g_file_peek_path (kfsb->dir);
@@ -830,6 +1011,11 @@ g_keyfile_settings_backend_set_property (GObject      *object,
       kfsb->defaults_dir = g_value_dup_string (value);
       break;
 
+    case PROP_WRITE_DELAY:
+      /* Construct only. */
+      kfsb->write_delay = g_value_get_uint (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -862,6 +1048,10 @@ g_keyfile_settings_backend_get_property (GObject    *object,
       g_value_set_string (value, kfsb->defaults_dir);
       break;
 
+    case PROP_WRITE_DELAY:
+      g_value_set_uint (value, kfsb->write_delay);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -884,6 +1074,7 @@ g_keyfile_settings_backend_class_init (GKeyfileSettingsBackendClass *class)
   class->reset = g_keyfile_settings_backend_reset;
   class->get_writable = g_keyfile_settings_backend_get_writable;
   class->get_permission = g_keyfile_settings_backend_get_permission;
+  class->sync = g_keyfile_settings_backend_sync;
   /* No need to implement subscribed/unsubscribe: the only point would be to
    * stop monitoring the file when there's no GSettings anymore, which is no
    * big win.
@@ -947,6 +1138,29 @@ g_keyfile_settings_backend_class_init (GKeyfileSettingsBackendClass *class)
                                                         NULL,
                                                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GKeyfileSettingsBackend:write-delay:
+   *
+   * The time, in milliseconds, to wait before writing changes to disk.
+   *
+   * All the changes made during that time are written out at once, when
+   * it expires, when g_settings_sync() is called, or when the backend is
+   * destroyed. If the file is changed by someone else in the meantime,
+   * the pending changes are applied on top of the new contents.
+   *
+   * If 0, changes are written immediately. Defaults to the value of the
+   * `GSETTINGS_KEYFILE_WRITE_DELAY` environment variable, or 0 if it is
+   * unset.
+   *
+   * Since: 2.82
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_WRITE_DELAY,
+                                   g_param_spec_uint ("write-delay", NULL, NULL,
+                                                      0, G_MAXUINT, 0,
+                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
 }
 
 /**
@@ -43,6 +43,7 @@
 
 #include <glib.h>
 #include "gvdb/gvdb-builder.h"
+#include "glz4.h"
 
 #include "gconstructor_as_data.h"
 #include "glib/glib-private.h"
@@ -54,6 +55,11 @@ typedef struct
   gsize content_size;
   gsize size;
   guint32 flags;
+
+  /* How to process the file, see process_file() */
+  guint preprocess;  /* PreprocessFlags */
+  gboolean compressed;
+  gboolean compression_lz4;
 } FileData;
 
 typedef struct
@@ -68,6 +74,7 @@ typedef struct
   /* per file */
   char *alias;
   gboolean compressed;
+  gboolean compression_lz4;
   char *preproc_options;
 
   GString *string;  /* non-NULL when accepting text */
@@ -77,6 +84,8 @@ static gchar **sourcedirs = NULL;
 static gchar *xmllint = NULL;
 static gchar *jsonformat = NULL;
 static gchar *gdk_pixbuf_pixdata = NULL;
+static gchar *cache_dir = NULL;
+static gint n_jobs = 0;
 
 static void
 file_data_free (FileData *data)
@@ -129,9 +138,32 @@ start_element (GMarkupParseContext  *context,
     {
       if (strcmp (element_name, "file") == 0)
 	{
-	  COLLECT (OPTIONAL | STRDUP, "alias", &state->alias,
-		   OPTIONAL | BOOL, "compressed", &state->compressed,
-                   OPTIONAL | STRDUP, "preprocess", &state->preproc_options);
+	  const gchar *compression = NULL;
+
+	  if (!COLLECT (OPTIONAL | STRDUP, "alias", &state->alias,
+		        OPTIONAL | BOOL, "compressed", &state->compressed,
+		        OPTIONAL | STRING, "compression", &compression,
+		        OPTIONAL | STRDUP, "preprocess", &state->preproc_options))
+	    return;
+
+	  if (compression != NULL && !state->compressed)
+	    {
+	      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+			   _("The “compression” attribute requires compressed=\"true\""));
+	      return;
+	    }
+
+	  if (compression == NULL || strcmp (compression, "zlib") == 0)
+	    state->compression_lz4 = FALSE;
+	  else if (strcmp (compression, "lz4") == 0)
+	    state->compression_lz4 = TRUE;
+	  else
+	    {
+	      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+			   _("Unknown compression “%s”"), compression);
+	      return;
+	    }
+
 	  state->string = g_string_new ("");
 	  return;
 	}
@@ -197,6 +229,13 @@ find_file (const gchar *filename)
     return NULL;
 }
 
+typedef enum
+{
+  PREPROCESS_XML_STRIPBLANKS = (1 << 0),
+  PREPROCESS_JSON_STRIPBLANKS = (1 << 1),
+  PREPROCESS_TO_PIXDATA = (1 << 2),
+} PreprocessFlags;
+
 static void
 end_element (GMarkupParseContext  *context,
 	     const gchar          *element_name,
@@ -204,7 +243,6 @@ end_element (GMarkupParseContext  *context,
 	     GError              **error)
 {
   ParseState *state = user_data;
-  GError *my_error = NULL;
 
   if (strcmp (element_name, "gresource") == 0)
     {
@@ -218,7 +256,6 @@ end_element (GMarkupParseContext  *context,
       gchar *real_file = NULL;
       gchar *key;
       FileData *data = NULL;
-      char *tmp_file = NULL;
 
       file = state->string->str;
       key = file;
@@ -272,20 +309,17 @@ end_element (GMarkupParseContext  *context,
         {
           gchar **options;
           guint i;
-          gboolean xml_stripblanks = FALSE;
-          gboolean json_stripblanks = FALSE;
-          gboolean to_pixdata = FALSE;
 
           options = g_strsplit (state->preproc_options, ",", -1);
 
           for (i = 0; options[i]; i++)
             {
               if (!strcmp (options[i], "xml-stripblanks"))
-                xml_stripblanks = TRUE;
+                data->preprocess |= PREPROCESS_XML_STRIPBLANKS;
               else if (!strcmp (options[i], "to-pixdata"))
-                to_pixdata = TRUE;
+                data->preprocess |= PREPROCESS_TO_PIXDATA;
               else if (!strcmp (options[i], "json-stripblanks"))
-                json_stripblanks = TRUE;
+                data->preprocess |= PREPROCESS_JSON_STRIPBLANKS;
               else
                 {
                   g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
@@ -296,204 +330,78 @@ end_element (GMarkupParseContext  *context,
             }
           g_strfreev (options);
 
-          if (xml_stripblanks)
+          /* This is not fatal: pretty-printed XML is still valid XML */
+          if ((data->preprocess & PREPROCESS_XML_STRIPBLANKS) && xmllint == NULL)
             {
-              /* This is not fatal: pretty-printed XML is still valid XML */
-              if (xmllint == NULL)
-                {
-                  static gboolean xmllint_warned = FALSE;
-
-                  if (!xmllint_warned)
-                    {
-                      /* Translators: the first %s is a gresource XML attribute,
-                       * the second %s is an environment variable, and the third
-                       * %s is a command line tool
-                       */
-                      char *warn = g_strdup_printf (_("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
-                                                    "xml-stripblanks",
-                                                    "XMLLINT",
-                                                    "xmllint");
-                      g_printerr ("%s\n", warn);
-                      g_free (warn);
-
-                      /* Only warn once */
-                      xmllint_warned = TRUE;
-                    }
-                }
-              else
-                {
-                  GSubprocess *proc;
-                  int fd;
-
-                  fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
-                  if (fd < 0)
-                    goto cleanup;
-
-                  close (fd);
-
-                  proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
-                                           xmllint, "--nonet", "--noblanks", "--output", tmp_file, real_file, NULL);
-                  g_free (real_file);
-                  real_file = NULL;
-
-                  if (!proc)
-                    goto cleanup;
+              static gboolean xmllint_warned = FALSE;
 
-                  if (!g_subprocess_wait_check (proc, NULL, error))
-                    {
-                      g_object_unref (proc);
-                      goto cleanup;
-                    }
-
-                  g_object_unref (proc);
-
-                  real_file = g_strdup (tmp_file);
-                }
-            }
-
-          if (json_stripblanks)
-            {
-              /* As above, this is not fatal: pretty-printed JSON is still
-               * valid JSON
-               */
-              if (jsonformat == NULL)
+              if (!xmllint_warned)
                 {
-                  static gboolean jsonformat_warned = FALSE;
-
-                  if (!jsonformat_warned)
-                    {
-                      /* Translators: the first %s is a gresource XML attribute,
-                       * the second %s is an environment variable, and the third
-                       * %s is a command line tool
-                       */
-                      char *warn = g_strdup_printf (_("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
-                                                    "json-stripblanks",
-                                                    "JSON_GLIB_FORMAT",
-                                                    "json-glib-format");
-                      g_printerr ("%s\n", warn);
-                      g_free (warn);
-
-                      /* Only warn once */
-                      jsonformat_warned = TRUE;
-                    }
+                  /* Translators: the first %s is a gresource XML attribute,
+                   * the second %s is an environment variable, and the third
+                   * %s is a command line tool
+                   */
+                  char *warn = g_strdup_printf (_("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
+                                                "xml-stripblanks",
+                                                "XMLLINT",
+                                                "xmllint");
+                  g_printerr ("%s\n", warn);
+                  g_free (warn);
+
+                  /* Only warn once */
+                  xmllint_warned = TRUE;
                 }
-              else
-                {
-                  GSubprocess *proc;
-                  int fd;
 
-                  fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
-                  if (fd < 0)
-                    goto cleanup;
-
-                  close (fd);
-
-                  proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
-                                           jsonformat, "--output", tmp_file, real_file, NULL);
-                  g_free (real_file);
-                  real_file = NULL;
-
-                  if (!proc)
-                    goto cleanup;
-
-                  if (!g_subprocess_wait_check (proc, NULL, error))
-                    {
-                      g_object_unref (proc);
-                      goto cleanup;
-                    }
-
-                  g_object_unref (proc);
-
-                  real_file = g_strdup (tmp_file);
-                }
+              data->preprocess &= ~PREPROCESS_XML_STRIPBLANKS;
             }
 
-          if (to_pixdata)
+          /* As above, this is not fatal: pretty-printed JSON is still
+           * valid JSON
+           */
+          if ((data->preprocess & PREPROCESS_JSON_STRIPBLANKS) && jsonformat == NULL)
             {
-	      GSubprocess *proc;
-              int fd;
+              static gboolean jsonformat_warned = FALSE;
 
-              /* This is a fatal error: if to-pixdata is used it means that
-               * the code loading the GResource expects a specific data format
-               */
-              if (gdk_pixbuf_pixdata == NULL)
+              if (!jsonformat_warned)
                 {
                   /* Translators: the first %s is a gresource XML attribute,
                    * the second %s is an environment variable, and the third
                    * %s is a command line tool
                    */
-                  g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
-                               _("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
-                               "to-pixdata",
-                               "GDK_PIXBUF_PIXDATA",
-                               "gdk-pixbuf-pixdata");
-                  goto cleanup;
+                  char *warn = g_strdup_printf (_("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
+                                                "json-stripblanks",
+                                                "JSON_GLIB_FORMAT",
+                                                "json-glib-format");
+                  g_printerr ("%s\n", warn);
+                  g_free (warn);
+
+                  /* Only warn once */
+                  jsonformat_warned = TRUE;
                 }
 
-              fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
-              if (fd < 0)
-                goto cleanup;
-
-              close (fd);
-
-              proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
-                                       gdk_pixbuf_pixdata, real_file, tmp_file, NULL);
-              g_free (real_file);
-              real_file = NULL;
-
-	      if (!g_subprocess_wait_check (proc, NULL, error))
-		{
-		  g_object_unref (proc);
-                  goto cleanup;
-		}
-
-	      g_object_unref (proc);
-
-              real_file = g_strdup (tmp_file);
+              data->preprocess &= ~PREPROCESS_JSON_STRIPBLANKS;
             }
-	}
-
-      if (!g_file_get_contents (real_file, &data->content, &data->size, &my_error))
-	{
-	  g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
-		       _("Error reading file %s: %s"),
-		       real_file, my_error->message);
-	  g_clear_error (&my_error);
-	  goto cleanup;
-	}
-      /* Include zero termination in content_size for uncompressed files (but not in size) */
-      data->content_size = data->size + 1;
 
-      if (state->compressed)
-	{
-	  GOutputStream *out = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
-	  GZlibCompressor *compressor =
-	    g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9);
-	  GOutputStream *out2 = g_converter_output_stream_new (out, G_CONVERTER (compressor));
-
-	  if (!g_output_stream_write_all (out2, data->content, data->size,
-					  NULL, NULL, NULL) ||
-	      !g_output_stream_close (out2, NULL, NULL))
-	    {
-	      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
-			   _("Error compressing file %s"),
-			   real_file);
-              g_object_unref (compressor);
-              g_object_unref (out);
-              g_object_unref (out2);
+          /* This is a fatal error: if to-pixdata is used it means that
+           * the code loading the GResource expects a specific data format
+           */
+          if ((data->preprocess & PREPROCESS_TO_PIXDATA) && gdk_pixbuf_pixdata == NULL)
+            {
+              /* Translators: the first %s is a gresource XML attribute,
+               * the second %s is an environment variable, and the third
+               * %s is a command line tool
+               */
+              g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                           _("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
+                           "to-pixdata",
+                           "GDK_PIXBUF_PIXDATA",
+                           "gdk-pixbuf-pixdata");
               goto cleanup;
-	    }
-
-	  g_free (data->content);
-	  data->content_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (out));
-	  data->content = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (out));
+            }
+        }
 
-	  g_object_unref (compressor);
-	  g_object_unref (out);
-	  g_object_unref (out2);
-
-	  data->flags |= G_RESOURCE_FLAGS_COMPRESSED;
-	}
+      data->compressed = state->compressed;
+      data->compression_lz4 = state->compression_lz4;
 
 done:
       g_hash_table_insert (state->table, key, data);
@@ -511,15 +419,405 @@ done:
 
       g_free (real_file);
 
-      if (tmp_file)
+      if (data != NULL)
+        file_data_free (data);
+    }
+}
+
+/* Runs a preprocessor. The element of @argv at @output_index is set to a
+ * new temporary file, which replaces @tmp_file and, on success, becomes the
+ * new @real_file. */
+static gboolean
+run_preprocessor (const gchar  **argv,
+                  gsize          output_index,
+                  gchar        **real_file,
+                  gchar        **tmp_file,
+                  GError       **error)
+{
+  GSubprocess *proc;
+  gchar *output_file = NULL;
+  gboolean success = FALSE;
+  int fd;
+
+  fd = g_file_open_tmp ("resource-XXXXXXXX", &output_file, error);
+  if (fd < 0)
+    return FALSE;
+
+  close (fd);
+
+  argv[output_index] = output_file;
+
+  proc = g_subprocess_newv (argv, G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error);
+  if (proc != NULL)
+    {
+      success = g_subprocess_wait_check (proc, NULL, error);
+      g_object_unref (proc);
+    }
+
+  /* The output of the previous preprocessor is no longer needed */
+  if (*tmp_file)
+    {
+      unlink (*tmp_file);
+      g_free (*tmp_file);
+    }
+  *tmp_file = output_file;
+
+  if (success)
+    {
+      g_free (*real_file);
+      *real_file = g_strdup (output_file);
+    }
+
+  return success;
+}
+
+/* Returns the name of the file in the cache directory which holds the
+ * processed contents of @data, given the original @contents. Everything
+ * which affects the output is part of the hash, so stale entries are
+ * never used. */
+static gchar *
+get_cache_file (FileData    *data,
+                const gchar *contents,
+                gsize        size)
+{
+  GChecksum *checksum;
+  gchar *cache_file;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+#define CHECKSUM_ADD_STRING(s) \
+  g_checksum_update (checksum, (const guchar *) ((s) ? (s) : ""), -1); \
+  g_checksum_update (checksum, (const guchar *) "", 1)
+
+  CHECKSUM_ADD_STRING (PACKAGE_VERSION);
+  CHECKSUM_ADD_STRING ((data->preprocess & PREPROCESS_XML_STRIPBLANKS) ? xmllint : NULL);
+  CHECKSUM_ADD_STRING ((data->preprocess & PREPROCESS_JSON_STRIPBLANKS) ? jsonformat : NULL);
+  CHECKSUM_ADD_STRING ((data->preprocess & PREPROCESS_TO_PIXDATA) ? gdk_pixbuf_pixdata : NULL);
+  CHECKSUM_ADD_STRING (!data->compressed ? "none" : data->compression_lz4 ? "lz4" : "zlib");
+
+#undef CHECKSUM_ADD_STRING
+
+  g_checksum_update (checksum, (const guchar *) contents, size);
+
+  cache_file = g_build_filename (cache_dir, g_checksum_get_string (checksum), NULL);
+  g_checksum_free (checksum);
+
+  return cache_file;
+}
+
+/* Cache entries are serialised (uuayay) values: the size and flags as
+ * stored in the resource, a SHA-256 digest of the content, and the content.
+ * An entry which does not match its digest, or which has different flags
+ * than processing the file would give, is treated as a cache miss. */
+static gboolean
+load_cache_file (FileData    *data,
+                 const gchar *cache_file)
+{
+  gchar *contents;
+  gsize length;
+  GBytes *bytes;
+  GVariant *value, *digest, *array;
+  guint32 size, flags, expected_flags;
+  gconstpointer content;
+  guint8 computed[32];
+  gsize computed_len = sizeof (computed);
+  GChecksum *checksum;
+  gboolean valid;
+
+  if (!g_file_get_contents (cache_file, &contents, &length, NULL))
+    return FALSE;
+
+  bytes = g_bytes_new_take (contents, length);
+  value = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("(uuayay)"), bytes, FALSE));
+  g_bytes_unref (bytes);
+
+  if (!g_variant_is_normal_form (value))
+    {
+      g_variant_unref (value);
+      return FALSE;
+    }
+
+  g_variant_get (value, "(uu@ay@ay)", &size, &flags, &digest, &array);
+  content = g_variant_get_fixed_array (array, &length, 1);
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, content, length);
+  g_checksum_get_digest (checksum, computed, &computed_len);
+  g_checksum_free (checksum);
+
+  expected_flags = data->flags;
+  if (data->compressed)
+    expected_flags |= G_RESOURCE_FLAGS_COMPRESSED;
+  if (data->compressed && data->compression_lz4)
+    expected_flags |= G_RESOURCE_FLAGS_COMPRESSED_LZ4;
+
+  valid = g_variant_get_size (digest) == computed_len &&
+          memcmp (g_variant_get_data (digest), computed, computed_len) == 0 &&
+          flags == expected_flags &&
+          (data->compressed || (length == (gsize) size + 1 &&
+                                ((const gchar *) content)[size] == '\0'));
+
+  if (valid)
+    {
+      g_free (data->content);
+      data->size = size;
+      data->flags = flags;
+      data->content_size = length;
+      data->content = g_memdup2 (content, length);
+    }
+
+  g_variant_unref (array);
+  g_variant_unref (digest);
+  g_variant_unref (value);
+
+  return valid;
+}
+
+static void
+save_cache_file (FileData    *data,
+                 const gchar *cache_file)
+{
+  GVariant *value;
+  GChecksum *checksum;
+  guint8 digest[32];
+  gsize digest_len = sizeof (digest);
+  GError *local_error = NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) data->content, data->content_size);
+  g_checksum_get_digest (checksum, digest, &digest_len);
+  g_checksum_free (checksum);
+
+  value = g_variant_ref_sink (g_variant_new ("(uu@ay@ay)",
+                                             (guint32) data->size,
+                                             data->flags,
+                                             g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+                                                                        digest,
+                                                                        digest_len,
+                                                                        1),
+                                             g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+                                                                        data->content,
+                                                                        data->content_size,
+                                                                        1)));
+
+  /* Failing to populate the cache is not fatal */
+  if (g_mkdir_with_parents (cache_dir, 0755) != 0 ||
+      !g_file_set_contents (cache_file, g_variant_get_data (value),
+                            g_variant_get_size (value), &local_error))
+    {
+      g_printerr (_("Failed to write cache file %s: %s\n"), cache_file,
+                  local_error ? local_error->message : g_strerror (errno));
+      g_clear_error (&local_error);
+    }
+
+  g_variant_unref (value);
+}
+
+/* Preprocesses and compresses a single file as requested in the XML. This
+ * is run in parallel for all files, so it must not touch any shared state. */
+static gboolean
+process_file (FileData  *data,
+              GError   **error)
+{
+  GError *my_error = NULL;
+  gchar *real_file = NULL;
+  gchar *tmp_file = NULL;
+  gchar *cache_file = NULL;
+  gboolean success = FALSE;
+
+  if (!g_file_get_contents (data->filename, &data->content, &data->size, &my_error))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                   _("Error reading file %s: %s"),
+                   data->filename, my_error->message);
+      g_clear_error (&my_error);
+      return FALSE;
+    }
+
+  if (cache_dir != NULL && (data->preprocess != 0 || data->compressed))
+    {
+      cache_file = get_cache_file (data, data->content, data->size);
+
+      if (load_cache_file (data, cache_file))
         {
-          unlink (tmp_file);
-          g_free (tmp_file);
+          g_free (cache_file);
+          return TRUE;
         }
+    }
 
-      if (data != NULL)
-        file_data_free (data);
+  real_file = g_strdup (data->filename);
+
+  if (data->preprocess != 0)
+    {
+      g_clear_pointer (&data->content, g_free);
+
+      if (data->preprocess & PREPROCESS_XML_STRIPBLANKS)
+        {
+          const gchar *argv[] = { xmllint, "--nonet", "--noblanks", "--output", NULL, real_file, NULL };
+
+          if (!run_preprocessor (argv, 4, &real_file, &tmp_file, error))
+            goto cleanup;
+        }
+
+      if (data->preprocess & PREPROCESS_JSON_STRIPBLANKS)
+        {
+          const gchar *argv[] = { jsonformat, "--output", NULL, real_file, NULL };
+
+          if (!run_preprocessor (argv, 2, &real_file, &tmp_file, error))
+            goto cleanup;
+        }
+
+      if (data->preprocess & PREPROCESS_TO_PIXDATA)
+        {
+          const gchar *argv[] = { gdk_pixbuf_pixdata, real_file, NULL, NULL };
+
+          if (!run_preprocessor (argv, 2, &real_file, &tmp_file, error))
+            goto cleanup;
+        }
+    }
+
+  if (data->content == NULL &&
+      !g_file_get_contents (real_file, &data->content, &data->size, &my_error))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                   _("Error reading file %s: %s"),
+                   real_file, my_error->message);
+      g_clear_error (&my_error);
+      goto cleanup;
+    }
+  /* Include zero termination in content_size for uncompressed files (but not in size) */
+  data->content_size = data->size + 1;
+
+  if (data->compressed && data->compression_lz4)
+    {
+      gsize bound = _g_lz4_compress_bound (data->size);
+      char *compressed;
+
+      if (data->size > G_MAXUINT32)
+        {
+          g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                       _("Error compressing file %s"),
+                       real_file);
+          goto cleanup;
+        }
+
+      compressed = g_malloc (bound);
+      data->content_size = _g_lz4_compress ((const guint8 *) data->content, data->size,
+                                            (guint8 *) compressed, bound);
+      g_free (data->content);
+      data->content = compressed;
+
+      data->flags |= G_RESOURCE_FLAGS_COMPRESSED | G_RESOURCE_FLAGS_COMPRESSED_LZ4;
+    }
+  else if (data->compressed)
+    {
+      GOutputStream *out = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+      GZlibCompressor *compressor =
+        g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9);
+      GOutputStream *out2 = g_converter_output_stream_new (out, G_CONVERTER (compressor));
+
+      if (!g_output_stream_write_all (out2, data->content, data->size,
+                                      NULL, NULL, NULL) ||
+          !g_output_stream_close (out2, NULL, NULL))
+        {
+          g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                       _("Error compressing file %s"),
+                       real_file);
+          g_object_unref (compressor);
+          g_object_unref (out);
+          g_object_unref (out2);
+          goto cleanup;
+        }
+
+      g_free (data->content);
+      data->content_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (out));
+      data->content = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (out));
+
+      g_object_unref (compressor);
+      g_object_unref (out);
+      g_object_unref (out2);
+
+      data->flags |= G_RESOURCE_FLAGS_COMPRESSED;
+    }
+
+  if (cache_file != NULL)
+    save_cache_file (data, cache_file);
+
+  success = TRUE;
+
+cleanup:
+  g_free (real_file);
+  g_free (cache_file);
+
+  if (tmp_file)
+    {
+      unlink (tmp_file);
+      g_free (tmp_file);
     }
+
+  return success;
+}
+
+typedef struct
+{
+  GMutex lock;
+  GError *error;  /* (nullable) (owned): the first error, protected by lock */
+} ProcessState;
+
+static void
+process_file_func (gpointer data,
+                   gpointer user_data)
+{
+  ProcessState *state = user_data;
+  GError *local_error = NULL;
+  gboolean failed;
+
+  /* Don’t bother with the remaining files once one has failed */
+  g_mutex_lock (&state->lock);
+  failed = state->error != NULL;
+  g_mutex_unlock (&state->lock);
+
+  if (failed || process_file (data, &local_error))
+    return;
+
+  g_mutex_lock (&state->lock);
+  if (state->error == NULL)
+    state->error = g_steal_pointer (&local_error);
+  g_mutex_unlock (&state->lock);
+
+  g_clear_error (&local_error);
+}
+
+/* Processes all the files in @files, using up to @n_jobs threads */
+static gboolean
+process_files (GHashTable  *files,
+               GError     **error)
+{
+  ProcessState state = { 0, };
+  GThreadPool *pool;
+  GHashTableIter iter;
+  FileData *data;
+
+  g_mutex_init (&state.lock);
+
+  pool = g_thread_pool_new (process_file_func, &state,
+                            n_jobs > 0 ? n_jobs : (gint) g_get_num_processors (),
+                            FALSE, NULL);
+
+  g_hash_table_iter_init (&iter, files);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &data))
+    g_thread_pool_push (pool, data, NULL);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_mutex_clear (&state.lock);
+
+  if (state.error != NULL)
+    {
+      g_propagate_error (error, state.error);
+      return FALSE;
+    }
+
+  return TRUE;
 }
 
 static void
@@ -576,7 +874,8 @@ parse_resource_file (const gchar *filename,
 					&state, NULL);
 
   if (!g_markup_parse_context_parse (context, contents, size, &error) ||
-      !g_markup_parse_context_end_parse (context, &error))
+      !g_markup_parse_context_end_parse (context, &error) ||
+      (collect_data && !process_files (state.table, &error)))
     {
       g_printerr ("%s: %s.\n", filename, error->message);
       g_clear_error (&error);
@@ -832,6 +1131,8 @@ main (int argc, char **argv)
     { "external-data", 0, 0, G_OPTION_ARG_NONE, &external_data, N_("Don’t embed resource data in the C file; assume it's linked externally instead"), NULL },
     { "c-name", 0, 0, G_OPTION_ARG_STRING, &c_name, N_("C identifier name used for the generated source code"), N_("IDENTIFIER") },
     { "compiler", 'C', 0, G_OPTION_ARG_STRING, &compiler, N_("The target C compiler (default: the CC environment variable)"), N_("COMMAND") },
+    { "jobs", 'j', 0, G_OPTION_ARG_INT, &n_jobs, N_("Number of files to process in parallel (default: the number of processors)"), N_("N") },
+    { "cache-dir", 0, 0, G_OPTION_ARG_FILENAME, &cache_dir, N_("Directory in which to cache preprocessed and compressed files"), N_("DIRECTORY") },
     G_OPTION_ENTRY_NULL
   };
 
@@ -1326,6 +1627,7 @@ main (int argc, char **argv)
   g_hash_table_destroy (table);
   g_free (xmllint);
   g_free (jsonformat);
+  g_free (cache_dir);
   g_free (c_name);
   g_hash_table_unref (files);
 
@@ -2155,6 +2155,275 @@ set_overrides (GHashTable  *schema_table,
   return TRUE;
 }
 
+/* Incremental compilation {{{1 */
+
+/* With --incremental, a manifest of the inputs is kept next to the output.
+ * It records the options which change the result, the size, modification
+ * time and checksum of every input file, and the checksum of the output that
+ * was compiled from them. When none of these has changed and the output is
+ * still the one we wrote, there is nothing to do.
+ *
+ * Schema files can refer to enums and schemas from other files, and override
+ * files modify keys from any file, so the result of parsing one file depends
+ * on the others. The manifest therefore covers the set of inputs as a whole,
+ * which guarantees the output is identical to a full build.
+ */
+#define MANIFEST_TYPE "(sua(sxxs)s)"
+
+/* Options recorded in the manifest: --strict turns errors which would skip a
+ * file into a failure, and --allow-any-name accepts more key names */
+typedef enum
+{
+  MANIFEST_OPTIONS_NONE = 0,
+  MANIFEST_OPTIONS_STRICT = (1 << 0),
+  MANIFEST_OPTIONS_ALLOW_ANY_NAME = (1 << 1),
+} ManifestOptions;
+
+typedef struct
+{
+  const gchar *filename;
+  gint64 size;
+  gint64 mtime;
+  gchar *checksum;  /* (nullable) (owned) */
+} InputFile;
+
+static gchar *
+compute_checksum (const gchar *filename)
+{
+  gchar *contents;
+  gsize size;
+  gchar *checksum;
+
+  if (!g_file_get_contents (filename, &contents, &size, NULL))
+    return NULL;
+
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (const guchar *) contents, size);
+  g_free (contents);
+
+  return checksum;
+}
+
+static void
+compute_checksum_func (gpointer data,
+                       gpointer user_data)
+{
+  InputFile *input = data;
+
+  input->checksum = compute_checksum (input->filename);
+}
+
+/* Modification time in nanoseconds, or 0 if @filename can’t be accessed */
+static gint64
+get_mtime (const gchar *filename,
+           gint64      *size)
+{
+  GStatBuf buf;
+  gint64 mtime;
+
+  if (g_stat (filename, &buf) != 0)
+    return 0;
+
+  mtime = (gint64) buf.st_mtime * G_GINT64_CONSTANT (1000000000);
+#if defined (HAVE_STRUCT_STAT_ST_MTIMENSEC)
+  mtime += buf.st_mtimensec;
+#elif defined (HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC)
+  mtime += buf.st_mtim.tv_nsec;
+#endif
+
+  if (size != NULL)
+    *size = buf.st_size;
+
+  return mtime;
+}
+
+static void
+manifest_add_files (gchar       **files,
+                    GVariant     *old_entries,
+                    gint64        old_mtime,
+                    gsize        *index,
+                    GThreadPool  *pool,
+                    GPtrArray    *inputs)
+{
+  for (; files != NULL && *files != NULL; files++, (*index)++)
+    {
+      InputFile *input;
+
+      input = g_new0 (InputFile, 1);
+      input->filename = *files;
+      input->mtime = get_mtime (input->filename, &input->size);
+
+      /* Only files whose size or modification time changed are read again.
+       * As in other build tools, files modified around the time the old
+       * manifest was written could have changed again within the timestamp
+       * granularity, so they are always checked. */
+      if (old_entries != NULL && *index < g_variant_n_children (old_entries) &&
+          input->mtime != 0 && input->mtime < old_mtime - G_GINT64_CONSTANT (1000000000))
+        {
+          const gchar *filename, *checksum;
+          gint64 size, mtime;
+
+          g_variant_get_child (old_entries, *index, "(&sxx&s)",
+                               &filename, &size, &mtime, &checksum);
+
+          if (strcmp (filename, input->filename) == 0 &&
+              size == input->size && mtime == input->mtime)
+            input->checksum = g_strdup (checksum);
+        }
+
+      if (input->checksum == NULL)
+        g_thread_pool_push (pool, input, NULL);
+
+      g_ptr_array_add (inputs, input);
+    }
+}
+
+/* Returns: (transfer full): a manifest describing @options, the current
+ *   inputs and @output_checksum, reusing checksums from @old_manifest where
+ *   possible */
+static GVariant *
+manifest_new (ManifestOptions   options,
+              gchar           **schema_files,
+              gchar           **override_files,
+              GVariant         *old_manifest,
+              gint64            old_mtime,
+              const gchar      *output_checksum)
+{
+  GVariantBuilder builder;
+  GVariant *old_entries = NULL;
+  GThreadPool *pool;
+  GPtrArray *inputs;
+  gsize index = 0;
+  guint i;
+
+  if (old_manifest != NULL)
+    old_entries = g_variant_get_child_value (old_manifest, 2);
+
+  pool = g_thread_pool_new (compute_checksum_func, NULL,
+                            g_get_num_processors (), FALSE, NULL);
+  inputs = g_ptr_array_new_with_free_func (g_free);
+
+  manifest_add_files (schema_files, old_entries, old_mtime, &index, pool, inputs);
+  manifest_add_files (override_files, old_entries, old_mtime, &index, pool, inputs);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_clear_pointer (&old_entries, g_variant_unref);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (MANIFEST_TYPE));
+  g_variant_builder_add (&builder, "s", PACKAGE_VERSION);
+  g_variant_builder_add (&builder, "u", (guint32) options);
+  g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(sxxs)"));
+
+  for (i = 0; i < inputs->len; i++)
+    {
+      InputFile *input = g_ptr_array_index (inputs, i);
+
+      g_variant_builder_add (&builder, "(sxxs)", input->filename,
+                             input->size, input->mtime,
+                             input->checksum ? input->checksum : "");
+      g_free (input->checksum);
+    }
+
+  g_variant_builder_close (&builder);
+  g_variant_builder_add (&builder, "s", output_checksum ? output_checksum : "");
+
+  g_ptr_array_unref (inputs);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/* Whether the two manifests describe the same options, inputs and output;
+ * file sizes and modification times are only used to avoid reading files */
+static gboolean
+manifest_equal (GVariant *a,
+                GVariant *b)
+{
+  GVariant *a_entries, *b_entries;
+  const gchar *a_version, *b_version, *a_output, *b_output;
+  guint32 a_options, b_options;
+  gboolean equal;
+  gsize i, n;
+
+  g_variant_get (a, "(&su@a(sxxs)&s)", &a_version, &a_options, &a_entries, &a_output);
+  g_variant_get (b, "(&su@a(sxxs)&s)", &b_version, &b_options, &b_entries, &b_output);
+
+  n = g_variant_n_children (a_entries);
+  equal = (strcmp (a_version, b_version) == 0 &&
+           a_options == b_options &&
+           strcmp (a_output, b_output) == 0 &&
+           n == g_variant_n_children (b_entries));
+
+  for (i = 0; equal && i < n; i++)
+    {
+      const gchar *a_filename, *a_checksum, *b_filename, *b_checksum;
+
+      g_variant_get_child (a_entries, i, "(&sxx&s)", &a_filename, NULL, NULL, &a_checksum);
+      g_variant_get_child (b_entries, i, "(&sxx&s)", &b_filename, NULL, NULL, &b_checksum);
+
+      equal = (strcmp (a_filename, b_filename) == 0 &&
+               strcmp (a_checksum, b_checksum) == 0);
+    }
+
+  g_variant_unref (a_entries);
+  g_variant_unref (b_entries);
+
+  return equal;
+}
+
+/* Returns: (transfer full): @manifest with the output checksum replaced */
+static GVariant *
+manifest_set_output (GVariant    *manifest,
+                     const gchar *output_checksum)
+{
+  const gchar *version;
+  guint32 options;
+  GVariant *entries;
+  GVariant *result;
+
+  g_variant_get (manifest, "(&su@a(sxxs)&s)", &version, &options, &entries, NULL);
+  result = g_variant_new ("(su@a(sxxs)s)", version, options, entries,
+                          output_checksum ? output_checksum : "");
+  g_variant_unref (entries);
+
+  return g_variant_ref_sink (result);
+}
+
+static GVariant *
+manifest_load (const gchar *filename)
+{
+  gchar *contents;
+  gsize size;
+  GBytes *bytes;
+  GVariant *manifest;
+
+  if (!g_file_get_contents (filename, &contents, &size, NULL))
+    return NULL;
+
+  bytes = g_bytes_new_take (contents, size);
+  manifest = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (MANIFEST_TYPE),
+                                                           bytes, FALSE));
+  g_bytes_unref (bytes);
+
+  if (!g_variant_is_normal_form (manifest))
+    g_clear_pointer (&manifest, g_variant_unref);
+
+  return manifest;
+}
+
+static void
+manifest_save (GVariant    *manifest,
+               const gchar *filename)
+{
+  GError *error = NULL;
+
+  /* The manifest is only an optimisation, so failing to write it is not fatal */
+  if (!g_file_set_contents (filename, g_variant_get_data (manifest),
+                            g_variant_get_size (manifest), &error))
+    {
+      fprintf (stderr, "%s\n", error->message);
+      g_clear_error (&error);
+    }
+}
+
 int
 main (int argc, char **argv)
 {
@@ -2170,6 +2439,10 @@ main (int argc, char **argv)
   gboolean strict = FALSE;
   gchar **schema_files = NULL;
   gchar **override_files = NULL;
+  gboolean incremental = FALSE;
+  gchar *manifest_file = NULL;
+  GVariant *old_manifest = NULL;
+  GVariant *manifest = NULL;
   GOptionContext *context = NULL;
   gint retval;
   GOptionEntry entries[] = {
@@ -2178,6 +2451,7 @@ main (int argc, char **argv)
     { "strict", 0, 0, G_OPTION_ARG_NONE, &strict, N_("Abort on any errors in schemas"), NULL },
     { "dry-run", 0, 0, G_OPTION_ARG_NONE, &dry_run, N_("Do not write the gschema.compiled file"), NULL },
     { "allow-any-name", 0, 0, G_OPTION_ARG_NONE, &allow_any_name, N_("Do not enforce key name restrictions"), NULL },
+    { "incremental", 0, 0, G_OPTION_ARG_NONE, &incremental, N_("Do nothing if no schema files changed since the last run"), NULL },
 
     /* These options are only for use in the gschema-compile tests */
     { "schema-file", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_FILENAME_ARRAY, &schema_files, NULL, NULL },
@@ -2290,6 +2564,12 @@ main (int argc, char **argv)
           else
             fprintf (stdout, "%s\n", _("No schema files found: removed existing output file."));
 
+          if (incremental)
+            {
+              manifest_file = g_strconcat (target, ".manifest", NULL);
+              g_unlink (manifest_file);
+            }
+
           g_ptr_array_unref (files);
           g_ptr_array_unref (overrides);
 
@@ -2306,6 +2586,39 @@ main (int argc, char **argv)
       override_files = (gchar **) g_ptr_array_free (overrides, FALSE);
     }
 
+  if (incremental && !dry_run)
+    {
+      ManifestOptions options = MANIFEST_OPTIONS_NONE;
+      gint64 manifest_mtime;
+      gchar *output_checksum;
+
+      if (strict)
+        options |= MANIFEST_OPTIONS_STRICT;
+      if (allow_any_name)
+        options |= MANIFEST_OPTIONS_ALLOW_ANY_NAME;
+
+      manifest_file = g_strconcat (target, ".manifest", NULL);
+      manifest_mtime = get_mtime (manifest_file, NULL);
+      old_manifest = manifest_load (manifest_file);
+
+      output_checksum = compute_checksum (target);
+      manifest = manifest_new (options, schema_files, override_files,
+                               old_manifest, manifest_mtime,
+                               output_checksum);
+      g_free (output_checksum);
+
+      if (old_manifest != NULL && manifest_equal (old_manifest, manifest))
+        {
+          /* Nothing changed, but record any new modification times so that
+           * the files are not read again next time */
+          if (!g_variant_equal (old_manifest, manifest))
+            manifest_save (manifest, manifest_file);
+
+          retval = 0;
+          goto done;
+        }
+    }
+
   if ((table = parse_gschema_files (schema_files, strict)) == NULL)
     {
       retval = 1;
@@ -2326,6 +2639,18 @@ main (int argc, char **argv)
       goto done;
     }
 
+  if (manifest != NULL)
+    {
+      GVariant *new_manifest;
+      gchar *output_checksum;
+
+      output_checksum = compute_checksum (target);
+      new_manifest = manifest_set_output (manifest, output_checksum);
+      manifest_save (new_manifest, manifest_file);
+      g_variant_unref (new_manifest);
+      g_free (output_checksum);
+    }
+
   /* Success. */
   retval = 0;
 
@@ -2333,6 +2658,9 @@ done:
   g_clear_error (&error);
   g_clear_pointer (&table, g_hash_table_unref);
   g_clear_pointer (&dir, g_dir_close);
+  g_clear_pointer (&manifest, g_variant_unref);
+  g_clear_pointer (&old_manifest, g_variant_unref);
+  g_free (manifest_file);
   g_free (targetdir);
   g_free (target);
   g_strfreev (schema_files);
@@ -0,0 +1,295 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2024 GNOME Foundation, Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "glz4.h"
+
+/* See https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+ *
+ * A block is a series of sequences. Each sequence starts with a token
+ * whose high nibble is the number of literals and whose low nibble is the
+ * match length minus MIN_MATCH; a nibble of 15 is followed by further
+ * length bytes. The literals follow, then a little-endian 16-bit offset
+ * back into the output. The last sequence only contains literals.
+ *
+ * The compressor below is a simple greedy one with a single hash table.
+ * It does not compress as well as the reference implementation at high
+ * levels, but the output can be decoded by any LZ4 block decoder. */
+
+#define MIN_MATCH 4
+#define MFLIMIT 12
+#define LAST_LITERALS 5
+#define MAX_DISTANCE 65535
+#define HASH_LOG 14
+#define RUN_MASK 15
+
+static inline guint32
+read32 (const guint8 *p)
+{
+  guint32 v;
+
+  memcpy (&v, p, sizeof (v));
+  return v;
+}
+
+static inline guint
+hash32 (guint32 v)
+{
+  return (v * 2654435761U) >> (32 - HASH_LOG);
+}
+
+static guint8 *
+write_length (guint8 *op,
+              gsize   length)
+{
+  while (length >= 255)
+    {
+      *op++ = 255;
+      length -= 255;
+    }
+  *op++ = (guint8) length;
+
+  return op;
+}
+
+static guint8 *
+write_sequence (guint8       *op,
+                const guint8 *literals,
+                gsize         n_literals,
+                gsize         offset,
+                gsize         match_length)
+{
+  guint8 *token = op++;
+
+  *token = MIN (n_literals, RUN_MASK) << 4;
+  if (n_literals >= RUN_MASK)
+    op = write_length (op, n_literals - RUN_MASK);
+
+  memcpy (op, literals, n_literals);
+  op += n_literals;
+
+  /* The last sequence has no match part */
+  if (match_length == 0)
+    return op;
+
+  *op++ = offset & 0xff;
+  *op++ = offset >> 8;
+
+  match_length -= MIN_MATCH;
+  *token |= MIN (match_length, RUN_MASK);
+  if (match_length >= RUN_MASK)
+    op = write_length (op, match_length - RUN_MASK);
+
+  return op;
+}
+
+/*< internal >
+ * _g_lz4_compress_bound:
+ * @src_size: the size of the data to compress
+ *
+ * Returns: the largest size _g_lz4_compress() can produce for @src_size
+ *   bytes of input
+ */
+gsize
+_g_lz4_compress_bound (gsize src_size)
+{
+  return src_size + src_size / 255 + 16;
+}
+
+/*< internal >
+ * _g_lz4_compress:
+ * @src: the data to compress
+ * @src_size: the size of @src, at most %G_MAXUINT32
+ * @dst: the output buffer
+ * @dst_size: the size of @dst, at least _g_lz4_compress_bound (@src_size)
+ *
+ * Compresses @src into a single LZ4 block.
+ *
+ * Returns: the number of bytes written to @dst, or 0 if @dst is too small
+ */
+gsize
+_g_lz4_compress (const guint8 *src,
+                 gsize         src_size,
+                 guint8       *dst,
+                 gsize         dst_size)
+{
+  const guint8 *ip = src;
+  const guint8 *anchor = src;
+  const guint8 *iend = src + src_size;
+  guint8 *op = dst;
+
+  g_return_val_if_fail (src_size <= G_MAXUINT32, 0);
+
+  if (dst_size < _g_lz4_compress_bound (src_size))
+    return 0;
+
+  if (src_size > MFLIMIT)
+    {
+      const guint8 *mflimit = iend - MFLIMIT;
+      const guint8 *matchlimit = iend - LAST_LITERALS;
+      guint32 *table;
+
+      /* Positions are stored relative to @src; 0 is a valid position,
+       * and stale or unset entries are weeded out by comparing bytes. */
+      table = g_new0 (guint32, 1 << HASH_LOG);
+
+      for (ip = src + 1; ip <= mflimit; )
+        {
+          guint32 sequence = read32 (ip);
+          guint h = hash32 (sequence);
+          const guint8 *ref = src + table[h];
+          gsize length;
+
+          table[h] = ip - src;
+
+          if (ref >= ip || ip - ref > MAX_DISTANCE || read32 (ref) != sequence)
+            {
+              ip++;
+              continue;
+            }
+
+          while (ip > anchor && ref > src && ip[-1] == ref[-1])
+            {
+              ip--;
+              ref--;
+            }
+
+          length = MIN_MATCH;
+          while (ip + length < matchlimit && ip[length] == ref[length])
+            length++;
+
+          op = write_sequence (op, anchor, ip - anchor, ip - ref, length);
+
+          ip += length;
+          anchor = ip;
+
+          if (ip <= mflimit)
+            table[hash32 (read32 (ip - 2))] = ip - 2 - src;
+        }
+
+      g_free (table);
+    }
+
+  op = write_sequence (op, anchor, iend - anchor, 0, 0);
+
+  return op - dst;
+}
+
+static gboolean
+read_length (const guint8 **ip,
+             const guint8  *iend,
+             gsize         *length)
+{
+  guint8 b;
+
+  do
+    {
+      if (*ip >= iend || *length > G_MAXSIZE - 255)
+        return FALSE;
+
+      b = *(*ip)++;
+      *length += b;
+    }
+  while (b == 255);
+
+  return TRUE;
+}
+
+/*< internal >
+ * _g_lz4_decompress:
+ * @src: a compressed LZ4 block
+ * @src_size: the size of @src
+ * @dst: the output buffer
+ * @dst_size: the expected size of the uncompressed data
+ *
+ * Decompresses a block produced by _g_lz4_compress() or any other LZ4
+ * block encoder. All reads and writes are bounds checked, so it is safe
+ * to call this on untrusted input.
+ *
+ * Returns: %TRUE if @src was valid and decompressed to exactly @dst_size
+ *   bytes
+ */
+gboolean
+_g_lz4_decompress (const guint8 *src,
+                   gsize         src_size,
+                   guint8       *dst,
+                   gsize         dst_size)
+{
+  const guint8 *ip = src;
+  const guint8 *iend = src + src_size;
+  guint8 *op = dst;
+  guint8 *oend = dst + dst_size;
+
+  while (ip < iend)
+    {
+      guint token = *ip++;
+      gsize length, offset;
+      const guint8 *match;
+
+      length = token >> 4;
+      if (length == RUN_MASK && !read_length (&ip, iend, &length))
+        return FALSE;
+
+      if (length > (gsize) (iend - ip) || length > (gsize) (oend - op))
+        return FALSE;
+
+      memcpy (op, ip, length);
+      ip += length;
+      op += length;
+
+      if (ip == iend)
+        break;
+
+      if (iend - ip < 2)
+        return FALSE;
+
+      offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+
+      if (offset == 0 || offset > (gsize) (op - dst))
+        return FALSE;
+
+      length = token & RUN_MASK;
+      if (length == RUN_MASK && !read_length (&ip, iend, &length))
+        return FALSE;
+      length += MIN_MATCH;
+
+      if (length > (gsize) (oend - op))
+        return FALSE;
+
+      match = op - offset;
+      if (offset >= length)
+        {
+          memcpy (op, match, length);
+          op += length;
+        }
+      else
+        {
+          /* Overlapping copy, used to encode runs */
+          while (length-- > 0)
+            *op++ = *match++;
+        }
+    }
+
+  return op == oend;
+}
@@ -0,0 +1,47 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2024 GNOME Foundation, Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_LZ4_H__
+#define __G_LZ4_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* A minimal implementation of the LZ4 block format, used for resources
+ * compiled with `compression="lz4"`. Only the raw block format is
+ * supported; the uncompressed size must be stored out of band (as
+ * GResource does). */
+
+gsize    _g_lz4_compress_bound (gsize         src_size);
+
+gsize    _g_lz4_compress       (const guint8 *src,
+                                gsize         src_size,
+                                guint8       *dst,
+                                gsize         dst_size);
+
+gboolean _g_lz4_decompress     (const guint8 *src,
+                                gsize         src_size,
+                                guint8       *dst,
+                                gsize         dst_size);
+
+G_END_DECLS
+
+#endif /* __G_LZ4_H__ */
@@ -28,6 +28,7 @@
 #include "ginitable.h"
 #include "gioenumtypes.h"
 #include "giomodule-priv.h"
+#include "gioprivate.h"
 #include "gtask.h"
 
 /**
@@ -123,6 +124,18 @@ g_memory_monitor_dup_default (void)
                                                  NULL));
 }
 
+static gboolean
+low_memory_warning_hook (GSignalInvocationHint *ihint,
+                         guint                  n_param_values,
+                         const GValue          *param_values,
+                         gpointer               user_data)
+{
+  /* Caches which GIO can cheaply rebuild are dropped at any warning level */
+  _g_resources_trim_cache ();
+
+  return TRUE;
+}
+
 static void
 g_memory_monitor_default_init (GMemoryMonitorInterface *iface)
 {
@@ -147,4 +160,7 @@ g_memory_monitor_default_init (GMemoryMonitorInterface *iface)
                   NULL,
                   G_TYPE_NONE, 1,
                   G_TYPE_MEMORY_MONITOR_WARNING_LEVEL);
+
+  g_signal_add_emission_hook (signals[LOW_MEMORY_WARNING], 0,
+                              low_memory_warning_hook, NULL, NULL);
 }
@@ -35,14 +35,36 @@
 #include <gio/gconverterinputstream.h>
 
 #include "glib-private.h"
+#include "gioprivate.h"
+#include "glz4.h"
 
 struct _GResource
 {
   int ref_count;
 
   GvdbTable *table;
+  GHashTable *cache;  /* (nullable) (owned): path → CacheEntry, protected by cache_lock */
 };
 
+/* Decompressed data of compressed files is kept in a small LRU cache shared
+ * by all resources, so that files which are looked up repeatedly are only
+ * decompressed once. Large files are not cached, as they would evict
+ * everything else. */
+#define CACHE_MAX_SIZE (4 * 1024 * 1024)
+#define CACHE_MAX_ENTRY_SIZE (CACHE_MAX_SIZE / 4)
+
+typedef struct
+{
+  GList link;  /* in cache_lru, link.data points to the entry */
+  GResource *resource;  /* (unowned) */
+  gchar *path;  /* (owned) */
+  GBytes *bytes;  /* (owned) */
+} CacheEntry;
+
+static GMutex cache_lock;
+static GQueue cache_lru = G_QUEUE_INIT;  /* most recently used first */
+static gsize cache_size;
+
 static void register_lazy_static_resources (void);
 
 G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
@@ -72,6 +94,14 @@ G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
  * uncompressed when the resource is used. This is very useful e.g. for larger
  * text files that are parsed once (or rarely) and then thrown away.
  *
+ * By default compressed files use zlib. Since GLib 2.82, setting the
+ * `compression` attribute to `lz4` selects LZ4 instead, which compresses
+ * less well but decompresses several times faster. Such resources can only
+ * be read by GLib 2.82 or later. The `compression` attribute is an error
+ * unless `compressed="true"` is also set. Recently used decompressed data is kept in
+ * a small cache, which is dropped when [signal@Gio.MemoryMonitor::low-memory-warning]
+ * is emitted.
+ *
  * Resource files can also be marked to be preprocessed, by setting the value of the
  * `preprocess` attribute to a comma-separated list of preprocessing options.
  * The only options currently supported are:
@@ -120,6 +150,7 @@ G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
  *   <gresource prefix="/org/gtk/Example">
  *     <file>data/splashscreen.png</file>
  *     <file compressed="true">dialog.ui</file>
+ *     <file compressed="true" compression="lz4">data/large.css</file>
  *     <file preprocess="xml-stripblanks">menumarkup.xml</file>
  *     <file alias="example.css">data/example.css</file>
  *   </gresource>
@@ -130,6 +161,7 @@ G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
  * ```
  * /org/gtk/Example/data/splashscreen.png
  * /org/gtk/Example/dialog.ui
+ * /org/gtk/Example/data/large.css
  * /org/gtk/Example/menumarkup.xml
  * /org/gtk/Example/example.css
  * ```
@@ -517,6 +549,138 @@ g_resource_find_overlay (const gchar    *path,
  */
 G_DEFINE_QUARK (g-resource-error-quark, g_resource_error)
 
+static void
+cache_entry_free (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  g_bytes_unref (entry->bytes);
+  g_free (entry->path);
+  g_free (entry);
+}
+
+/* Must be called with cache_lock held */
+static void
+cache_entry_remove_unlocked (CacheEntry *entry)
+{
+  g_queue_unlink (&cache_lru, &entry->link);
+  cache_size -= g_bytes_get_size (entry->bytes);
+  g_hash_table_remove (entry->resource->cache, entry->path);
+}
+
+/* Returns: (transfer full) (nullable): the cached data for @path, if any */
+static GBytes *
+resource_cache_lookup (GResource   *resource,
+                       const gchar *path)
+{
+  CacheEntry *entry = NULL;
+  GBytes *bytes = NULL;
+
+  g_mutex_lock (&cache_lock);
+
+  if (resource->cache != NULL)
+    entry = g_hash_table_lookup (resource->cache, path);
+
+  if (entry != NULL)
+    {
+      g_queue_unlink (&cache_lru, &entry->link);
+      g_queue_push_head_link (&cache_lru, &entry->link);
+      bytes = g_bytes_ref (entry->bytes);
+    }
+
+  g_mutex_unlock (&cache_lock);
+
+  return bytes;
+}
+
+/* Returns: (transfer full): @bytes, or the data cached for @path by another
+ * thread in the meantime, so that all callers share the same copy */
+static GBytes *
+resource_cache_insert (GResource   *resource,
+                       const gchar *path,
+                       GBytes      *bytes  /* (transfer full) */)
+{
+  CacheEntry *entry;
+  gsize size = g_bytes_get_size (bytes);
+
+  if (size > CACHE_MAX_ENTRY_SIZE)
+    return bytes;
+
+  g_mutex_lock (&cache_lock);
+
+  if (resource->cache == NULL)
+    resource->cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             NULL, cache_entry_free);
+
+  entry = g_hash_table_lookup (resource->cache, path);
+  if (entry != NULL)
+    {
+      g_bytes_unref (bytes);
+      bytes = g_bytes_ref (entry->bytes);
+      g_mutex_unlock (&cache_lock);
+
+      return bytes;
+    }
+
+  entry = g_new0 (CacheEntry, 1);
+  entry->link.data = entry;
+  entry->resource = resource;
+  entry->path = g_strdup (path);
+  entry->bytes = g_bytes_ref (bytes);
+
+  g_hash_table_insert (resource->cache, entry->path, entry);
+  g_queue_push_head_link (&cache_lru, &entry->link);
+  cache_size += size;
+
+  while (cache_size > CACHE_MAX_SIZE)
+    cache_entry_remove_unlocked (g_queue_peek_tail (&cache_lru));
+
+  g_mutex_unlock (&cache_lock);
+
+  return bytes;
+}
+
+static void
+resource_cache_clear (GResource *resource)
+{
+  GHashTableIter iter;
+  CacheEntry *entry;
+
+  g_mutex_lock (&cache_lock);
+
+  if (resource->cache != NULL)
+    {
+      g_hash_table_iter_init (&iter, resource->cache);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry))
+        {
+          g_queue_unlink (&cache_lru, &entry->link);
+          cache_size -= g_bytes_get_size (entry->bytes);
+        }
+
+      g_clear_pointer (&resource->cache, g_hash_table_unref);
+    }
+
+  g_mutex_unlock (&cache_lock);
+}
+
+/*< internal >
+ * _g_resources_trim_cache:
+ *
+ * Drops all cached decompressed resource data. This is called when the
+ * system is low on memory; data which is still in use by callers is only
+ * freed once they release it.
+ */
+void
+_g_resources_trim_cache (void)
+{
+  g_mutex_lock (&cache_lock);
+
+  while (!g_queue_is_empty (&cache_lru))
+    cache_entry_remove_unlocked (g_queue_peek_tail (&cache_lru));
+
+  g_mutex_unlock (&cache_lock);
+}
+
 /**
  * g_resource_ref:
  * @resource: A #GResource
@@ -551,6 +715,7 @@ g_resource_unref (GResource *resource)
 {
   if (g_atomic_int_dec_and_test (&resource->ref_count))
     {
+      resource_cache_clear (resource);
       gvdb_table_free (resource->table);
       g_free (resource);
     }
@@ -570,6 +735,7 @@ g_resource_new_from_table (GvdbTable *table)
   resource = g_new (GResource, 1);
   resource->ref_count = 1;
   resource->table = table;
+  resource->cache = NULL;
 
   return resource;
 }
@@ -743,6 +909,80 @@ do_lookup (GResource             *resource,
   return res;
 }
 
+static GBytes *
+decompress_data (const gchar  *path,
+                 guint32       flags,
+                 const void   *data,
+                 gsize         data_size,
+                 gsize         size,
+                 GError      **error)
+{
+  char *uncompressed, *d;
+  const char *s;
+  GConverterResult res;
+  gsize d_size, s_size;
+  gsize bytes_read, bytes_written;
+  GZlibDecompressor *decompressor;
+
+  uncompressed = g_malloc (size + 1);
+
+  if (flags & G_RESOURCE_FLAGS_COMPRESSED_LZ4)
+    {
+      if (!_g_lz4_decompress (data, data_size, (guint8 *) uncompressed, size))
+        {
+          g_free (uncompressed);
+          g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
+                       _("The resource at “%s” failed to decompress"),
+                       path);
+          return NULL;
+        }
+
+      uncompressed[size] = 0; /* Zero terminate */
+
+      return g_bytes_new_take (uncompressed, size);
+    }
+
+  decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
+
+  s = data;
+  s_size = data_size;
+  d = uncompressed;
+  d_size = size;
+
+  do
+    {
+      res = g_converter_convert (G_CONVERTER (decompressor),
+                                 s, s_size,
+                                 d, d_size,
+                                 G_CONVERTER_INPUT_AT_END,
+                                 &bytes_read,
+                                 &bytes_written,
+                                 NULL);
+      if (res == G_CONVERTER_ERROR)
+        {
+          g_free (uncompressed);
+          g_object_unref (decompressor);
+
+          g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
+                       _("The resource at “%s” failed to decompress"),
+                       path);
+          return NULL;
+
+        }
+      s += bytes_read;
+      s_size -= bytes_read;
+      d += bytes_written;
+      d_size -= bytes_written;
+    }
+  while (res != G_CONVERTER_FINISHED);
+
+  uncompressed[size] = 0; /* Zero terminate */
+
+  g_object_unref (decompressor);
+
+  return g_bytes_new_take (uncompressed, size);
+}
+
 /**
  * g_resource_open_stream:
  * @resource: A #GResource
@@ -774,6 +1014,27 @@ g_resource_open_stream (GResource             *resource,
   if (!do_lookup (resource, path, lookup_flags, NULL, &flags, &data, &data_size, error))
     return NULL;
 
+  /* LZ4 data can only be decompressed in one go, and there is no point in
+   * decompressing zlib data again if it is already cached. */
+  if (flags & G_RESOURCE_FLAGS_COMPRESSED)
+    {
+      GBytes *bytes = NULL;
+
+      if (flags & G_RESOURCE_FLAGS_COMPRESSED_LZ4)
+        bytes = g_resource_lookup_data (resource, path, lookup_flags, error);
+      else
+        bytes = resource_cache_lookup (resource, path);
+
+      if (bytes != NULL)
+        {
+          stream = g_memory_input_stream_new_from_bytes (bytes);
+          g_bytes_unref (bytes);
+          return stream;
+        }
+      else if (flags & G_RESOURCE_FLAGS_COMPRESSED_LZ4)
+        return NULL;
+    }
+
   stream = g_memory_input_stream_new_from_data (data, data_size, NULL);
   g_object_set_data_full (G_OBJECT (stream), "g-resource",
                           g_resource_ref (resource),
@@ -811,7 +1072,9 @@ g_resource_open_stream (GResource             *resource,
  * For uncompressed resource files this is a pointer directly into
  * the resource bundle, which is typically in some readonly data section
  * in the program binary. For compressed files we allocate memory on
- * the heap and automatically uncompress the data.
+ * the heap and automatically uncompress the data. Since GLib 2.82,
+ * recently used uncompressed data is cached, so repeated lookups of the
+ * same compressed file may return the same memory.
  *
  * @lookup_flags controls the behaviour of the lookup.
  *
@@ -838,55 +1101,17 @@ g_resource_lookup_data (GResource             *resource,
     return g_bytes_new_with_free_func ("", 0, (GDestroyNotify) g_resource_unref, g_resource_ref (resource));
   else if (flags & G_RESOURCE_FLAGS_COMPRESSED)
     {
-      char *uncompressed, *d;
-      const char *s;
-      GConverterResult res;
-      gsize d_size, s_size;
-      gsize bytes_read, bytes_written;
-
-
-      GZlibDecompressor *decompressor =
-        g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
-
-      uncompressed = g_malloc (size + 1);
-
-      s = data;
-      s_size = data_size;
-      d = uncompressed;
-      d_size = size;
+      GBytes *bytes;
 
-      do
-        {
-          res = g_converter_convert (G_CONVERTER (decompressor),
-                                     s, s_size,
-                                     d, d_size,
-                                     G_CONVERTER_INPUT_AT_END,
-                                     &bytes_read,
-                                     &bytes_written,
-                                     NULL);
-          if (res == G_CONVERTER_ERROR)
-            {
-              g_free (uncompressed);
-              g_object_unref (decompressor);
+      bytes = resource_cache_lookup (resource, path);
+      if (bytes != NULL)
+        return bytes;
 
-              g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
-                           _("The resource at “%s” failed to decompress"),
-                           path);
-              return NULL;
-
-            }
-          s += bytes_read;
-          s_size -= bytes_read;
-          d += bytes_written;
-          d_size -= bytes_written;
-        }
-      while (res != G_CONVERTER_FINISHED);
-
-      uncompressed[size] = 0; /* Zero terminate */
+      bytes = decompress_data (path, flags, data, data_size, size, error);
+      if (bytes == NULL)
+        return NULL;
 
-      g_object_unref (decompressor);
-
-      return g_bytes_new_take (uncompressed, size);
+      return resource_cache_insert (resource, path, g_steal_pointer (&bytes));
     }
   else
     return g_bytes_new_with_free_func (data, data_size, (GDestroyNotify)g_resource_unref, g_resource_ref (resource));
@@ -1016,6 +1241,121 @@ g_resource_enumerate_children (GResource             *resource,
 static GRWLock resources_lock;
 static GList *registered_resources;
 
+/* Merged index of the paths in all registered resources, so that global
+ * lookups are a single hash table probe instead of one per registered
+ * resource. It is built lazily by the first lookup after registered_resources
+ * changes, and protected by resources_lock. */
+typedef struct
+{
+  /* file path -> (unowned) GResource, the first registered resource
+   * containing it, which is the one a lookup returns */
+  GHashTable *files;
+  /* directory path with a trailing slash -> (unowned) GPtrArray of
+   * (unowned) GResource, all the registered resources containing it */
+  GHashTable *directories;
+} ResourcesIndex;
+
+static ResourcesIndex *resources_index;
+
+static ResourcesIndex *
+resources_index_new (GList *resources)
+{
+  ResourcesIndex *index;
+  GList *l;
+
+  index = g_new (ResourcesIndex, 1);
+  index->files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  index->directories = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify) g_ptr_array_unref);
+
+  for (l = resources; l != NULL; l = l->next)
+    {
+      GResource *resource = l->data;
+      gchar **names;
+      gsize n_names, i;
+
+      names = gvdb_table_get_names (resource->table, &n_names);
+      for (i = 0; i < n_names; i++)
+        {
+          gchar *name = names[i];
+          gsize name_len;
+
+          if (name == NULL)
+            continue;
+
+          name_len = strlen (name);
+          if (name_len > 0 && name[name_len - 1] == '/')
+            {
+              GPtrArray *owners = g_hash_table_lookup (index->directories, name);
+
+              if (owners == NULL)
+                {
+                  owners = g_ptr_array_new ();
+                  g_hash_table_insert (index->directories, name, owners);
+                }
+              else
+                g_free (name);
+
+              g_ptr_array_add (owners, resource);
+            }
+          else if (!g_hash_table_contains (index->files, name))
+            g_hash_table_insert (index->files, name, resource);
+          else
+            g_free (name);
+        }
+      g_free (names);
+    }
+
+  return index;
+}
+
+static void
+resources_index_free (ResourcesIndex *index)
+{
+  g_hash_table_unref (index->files);
+  g_hash_table_unref (index->directories);
+  g_free (index);
+}
+
+/* Takes the reader lock, making sure resources_index is up to date */
+static void
+resources_reader_lock (void)
+{
+  g_rw_lock_reader_lock (&resources_lock);
+
+  while (G_UNLIKELY (resources_index == NULL))
+    {
+      g_rw_lock_reader_unlock (&resources_lock);
+
+      g_rw_lock_writer_lock (&resources_lock);
+      if (resources_index == NULL)
+        resources_index = resources_index_new (registered_resources);
+      g_rw_lock_writer_unlock (&resources_lock);
+
+      g_rw_lock_reader_lock (&resources_lock);
+    }
+}
+
+/* Called with the reader lock held, see resources_reader_lock().
+ * Like do_lookup(), ignores a trailing slash in @path. */
+static GResource *
+resources_index_lookup_file (const gchar *path)
+{
+  GResource *resource;
+  gsize path_len;
+  gchar *free_path;
+
+  path_len = strlen (path);
+  if (G_LIKELY (path_len == 0 || path[path_len - 1] != '/'))
+    return g_hash_table_lookup (resources_index->files, path);
+
+  free_path = g_strndup (path, path_len - 1);
+  resource = g_hash_table_lookup (resources_index->files, free_path);
+  g_free (free_path);
+
+  return resource;
+}
+
 /* This is updated atomically, so we can append to it and check for NULL outside the
    lock, but all other accesses are done under the write lock */
 static GStaticResource *lazy_register_resources;
@@ -1024,6 +1364,7 @@ static void
 g_resources_register_unlocked (GResource *resource)
 {
   registered_resources = g_list_prepend (registered_resources, g_resource_ref (resource));
+  g_clear_pointer (&resources_index, resources_index_free);
 }
 
 static void
@@ -1039,6 +1380,7 @@ g_resources_unregister_unlocked (GResource *resource)
     {
       g_resource_unref (resource_link->data);
       registered_resources = g_list_delete_link (registered_resources, resource_link);
+      g_clear_pointer (&resources_index, resources_index_free);
     }
 }
 
@@ -1099,37 +1441,19 @@ g_resources_open_stream (const gchar           *path,
                          GError               **error)
 {
   GInputStream *res = NULL;
-  GList *l;
-  GInputStream *stream;
+  GResource *r;
 
   if (g_resource_find_overlay (path, open_overlay_stream, &res))
     return res;
 
   register_lazy_static_resources ();
 
-  g_rw_lock_reader_lock (&resources_lock);
-
-  for (l = registered_resources; l != NULL; l = l->next)
-    {
-      GResource *r = l->data;
-      GError *my_error = NULL;
-
-      stream = g_resource_open_stream (r, path, lookup_flags, &my_error);
-      if (stream == NULL &&
-          g_error_matches (my_error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND))
-        {
-          g_clear_error (&my_error);
-        }
-      else
-        {
-          if (stream == NULL)
-            g_propagate_error (error, my_error);
-          res = stream;
-          break;
-        }
-    }
+  resources_reader_lock ();
 
-  if (l == NULL)
+  r = resources_index_lookup_file (path);
+  if (r != NULL)
+    res = g_resource_open_stream (r, path, lookup_flags, error);
+  else
     g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND,
                  _("The resource at “%s” does not exist"),
                  path);
@@ -1156,7 +1480,9 @@ g_resources_open_stream (const gchar           *path,
  * For uncompressed resource files this is a pointer directly into
  * the resource bundle, which is typically in some readonly data section
  * in the program binary. For compressed files we allocate memory on
- * the heap and automatically uncompress the data.
+ * the heap and automatically uncompress the data. Since GLib 2.82,
+ * recently used uncompressed data is cached, so repeated lookups of the
+ * same compressed file may return the same memory.
  *
  * @lookup_flags controls the behaviour of the lookup.
  *
@@ -1171,37 +1497,19 @@ g_resources_lookup_data (const gchar           *path,
                          GError               **error)
 {
   GBytes *res = NULL;
-  GList *l;
-  GBytes *data;
+  GResource *r;
 
   if (g_resource_find_overlay (path, get_overlay_bytes, &res))
     return res;
 
   register_lazy_static_resources ();
 
-  g_rw_lock_reader_lock (&resources_lock);
+  resources_reader_lock ();
 
-  for (l = registered_resources; l != NULL; l = l->next)
-    {
-      GResource *r = l->data;
-      GError *my_error = NULL;
-
-      data = g_resource_lookup_data (r, path, lookup_flags, &my_error);
-      if (data == NULL &&
-          g_error_matches (my_error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND))
-        {
-          g_clear_error (&my_error);
-        }
-      else
-        {
-          if (data == NULL)
-            g_propagate_error (error, my_error);
-          res = data;
-          break;
-        }
-    }
-
-  if (l == NULL)
+  r = resources_index_lookup_file (path);
+  if (r != NULL)
+    res = g_resource_lookup_data (r, path, lookup_flags, error);
+  else
     g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND,
                  _("The resource at “%s” does not exist"),
                  path);
@@ -1234,9 +1542,11 @@ g_resources_enumerate_children (const gchar           *path,
                                 GError               **error)
 {
   GHashTable *hash = NULL;
-  GList *l;
+  GPtrArray *owners;
   char **children;
-  int i;
+  const gchar *path_with_slash;
+  gchar *free_path = NULL;
+  guint i, j;
 
   /* This will enumerate actual files found in overlay directories but
    * will not enumerate the overlays themselves.  For example, if we
@@ -1249,13 +1559,21 @@ g_resources_enumerate_children (const gchar           *path,
    */
   g_resource_find_overlay (path, enumerate_overlay_dir, &hash);
 
+  /* Directories are indexed with a trailing slash */
+  if (*path != 0 && !g_str_has_suffix (path, "/"))
+    path_with_slash = free_path = g_strconcat (path, "/", NULL);
+  else
+    path_with_slash = path;
+
   register_lazy_static_resources ();
 
-  g_rw_lock_reader_lock (&resources_lock);
+  resources_reader_lock ();
 
-  for (l = registered_resources; l != NULL; l = l->next)
+  owners = g_hash_table_lookup (resources_index->directories, path_with_slash);
+
+  for (i = 0; owners != NULL && i < owners->len; i++)
     {
-      GResource *r = l->data;
+      GResource *r = g_ptr_array_index (owners, i);
 
       children = g_resource_enumerate_children (r, path, 0, NULL);
 
@@ -1265,14 +1583,16 @@ g_resources_enumerate_children (const gchar           *path,
             /* note: keep in sync with same line above */
             hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
-          for (i = 0; children[i] != NULL; i++)
-            g_hash_table_add (hash, children[i]);
+          for (j = 0; children[j] != NULL; j++)
+            g_hash_table_add (hash, children[j]);
           g_free (children);
         }
     }
 
   g_rw_lock_reader_unlock (&resources_lock);
 
+  g_free (free_path);
+
   if (hash == NULL)
     {
       if (error)
@@ -1318,8 +1638,7 @@ g_resources_get_info (const gchar           *path,
                       GError               **error)
 {
   gboolean res = FALSE;
-  GList *l;
-  gboolean r_res;
+  GResource *r;
   InfoData info;
 
   if (g_resource_find_overlay (path, get_overlay_info, &info))
@@ -1334,29 +1653,12 @@ g_resources_get_info (const gchar           *path,
 
   register_lazy_static_resources ();
 
-  g_rw_lock_reader_lock (&resources_lock);
-
-  for (l = registered_resources; l != NULL; l = l->next)
-    {
-      GResource *r = l->data;
-      GError *my_error = NULL;
-
-      r_res = g_resource_get_info (r, path, lookup_flags, size, flags, &my_error);
-      if (!r_res &&
-          g_error_matches (my_error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND))
-        {
-          g_clear_error (&my_error);
-        }
-      else
-        {
-          if (!r_res)
-            g_propagate_error (error, my_error);
-          res = r_res;
-          break;
-        }
-    }
+  resources_reader_lock ();
 
-  if (l == NULL)
+  r = resources_index_lookup_file (path);
+  if (r != NULL)
+    res = g_resource_get_info (r, path, lookup_flags, size, flags, error);
+  else
     g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND,
                  _("The resource at “%s” does not exist"),
                  path);
@@ -338,6 +338,12 @@ struct _GSettingsPrivate
   GSettingsBackend *backend;
   GSettingsSchema *schema;
   gchar *path;
+
+  /* see "Per-instance caches" below */
+  GMutex cache_lock;
+  GHashTable *keys;
+  GHashTable *values;
+  guint cache_generation;
 };
 
 enum
@@ -533,6 +539,195 @@ settings_backend_path_writable_changed (GObject          *target,
                    0, (GQuark) 0, &ignore_this);
 }
 
+/* Per-instance caches {{{1 */
+/* Each GSettings keeps the GSettingsSchemaKey for every key that has
+ * been looked up so far, so that the schema does not need to be parsed
+ * again on every access.  Keys are immutable once created and are only
+ * freed along with the GSettings.
+ *
+ * It also caches the last value read from the backend for each key
+ * (or the absence of a user value, stored as %NULL).  This cache is
+ * invalidated from a second backend watch that has no main context, so
+ * it runs synchronously in whichever thread the change happened in and
+ * before the watch that emits #GSettings::changed.  A read that raced
+ * with an invalidation is detected using @cache_generation and is not
+ * stored.
+ *
+ * Both tables are keyed by the interned key name.
+ */
+static GSettingsSchemaKey *
+g_settings_lookup_key (GSettings   *settings,
+                       const gchar *name)
+{
+  GSettingsPrivate *priv = settings->priv;
+  GSettingsSchemaKey *key;
+  GSettingsSchemaKey *existing;
+
+  g_mutex_lock (&priv->cache_lock);
+  key = g_hash_table_lookup (priv->keys, name);
+  g_mutex_unlock (&priv->cache_lock);
+
+  if (key != NULL)
+    return key;
+
+  key = g_new (GSettingsSchemaKey, 1);
+  g_settings_schema_key_init (key, priv->schema, name);
+
+  g_mutex_lock (&priv->cache_lock);
+  existing = g_hash_table_lookup (priv->keys, name);
+  if (existing == NULL)
+    g_hash_table_insert (priv->keys, (gpointer) key->name, key);
+  g_mutex_unlock (&priv->cache_lock);
+
+  if (existing != NULL)
+    {
+      /* lost a race with another thread */
+      g_settings_schema_key_clear (key);
+      g_free (key);
+      key = existing;
+    }
+
+  return key;
+}
+
+static void
+g_settings_key_free (gpointer data)
+{
+  GSettingsSchemaKey *key = data;
+
+  g_settings_schema_key_clear (key);
+  g_free (key);
+}
+
+static void
+g_settings_cached_value_free (gpointer data)
+{
+  if (data != NULL)
+    g_variant_unref (data);
+}
+
+static gboolean
+g_settings_lookup_cached_value (GSettings           *settings,
+                                GSettingsSchemaKey  *key,
+                                GVariant           **value,
+                                guint               *generation)
+{
+  GSettingsPrivate *priv = settings->priv;
+  gpointer cached;
+  gboolean found;
+
+  g_mutex_lock (&priv->cache_lock);
+  found = g_hash_table_lookup_extended (priv->values, key->name, NULL, &cached);
+  if (found)
+    *value = cached ? g_variant_ref (cached) : NULL;
+  *generation = priv->cache_generation;
+  g_mutex_unlock (&priv->cache_lock);
+
+  return found;
+}
+
+static void
+g_settings_store_cached_value (GSettings          *settings,
+                               GSettingsSchemaKey *key,
+                               GVariant           *value,
+                               guint               generation)
+{
+  GSettingsPrivate *priv = settings->priv;
+
+  g_mutex_lock (&priv->cache_lock);
+  if (generation == priv->cache_generation)
+    g_hash_table_insert (priv->values, (gpointer) key->name,
+                         value ? g_variant_ref (value) : NULL);
+  g_mutex_unlock (&priv->cache_lock);
+}
+
+static void
+g_settings_invalidate_key (GSettings   *settings,
+                           const gchar *key)
+{
+  GSettingsPrivate *priv = settings->priv;
+
+  if (!g_str_has_prefix (key, priv->path))
+    return;
+
+  g_mutex_lock (&priv->cache_lock);
+  priv->cache_generation++;
+  g_hash_table_remove (priv->values, key + strlen (priv->path));
+  g_mutex_unlock (&priv->cache_lock);
+}
+
+static void
+g_settings_invalidate_all (GSettings *settings)
+{
+  GSettingsPrivate *priv = settings->priv;
+
+  g_mutex_lock (&priv->cache_lock);
+  priv->cache_generation++;
+  g_hash_table_remove_all (priv->values);
+  g_mutex_unlock (&priv->cache_lock);
+}
+
+static void
+settings_cache_changed (GObject          *target,
+                        GSettingsBackend *backend,
+                        const gchar      *key,
+                        gpointer          origin_tag)
+{
+  g_settings_invalidate_key (G_SETTINGS (target), key);
+}
+
+static void
+settings_cache_path_changed (GObject          *target,
+                             GSettingsBackend *backend,
+                             const gchar      *path,
+                             gpointer          origin_tag)
+{
+  GSettings *settings = G_SETTINGS (target);
+
+  if (g_str_has_prefix (settings->priv->path, path))
+    g_settings_invalidate_all (settings);
+}
+
+static void
+settings_cache_keys_changed (GObject             *target,
+                             GSettingsBackend    *backend,
+                             const gchar         *path,
+                             gpointer             origin_tag,
+                             const gchar * const *items)
+{
+  GSettings *settings = G_SETTINGS (target);
+  gint i;
+
+  for (i = 0; items[i]; i++)
+    {
+      gchar *key;
+
+      key = g_strconcat (path, items[i], NULL);
+      g_settings_invalidate_key (settings, key);
+      g_free (key);
+    }
+}
+
+static void
+settings_cache_writable_changed (GObject          *target,
+                                 GSettingsBackend *backend,
+                                 const gchar      *key)
+{
+  /* a lock can change the effective value of a key */
+  g_settings_invalidate_key (G_SETTINGS (target), key);
+}
+
+static void
+settings_cache_path_writable_changed (GObject          *target,
+                                      GSettingsBackend *backend,
+                                      const gchar      *path)
+{
+  GSettings *settings = G_SETTINGS (target);
+
+  if (g_str_has_prefix (settings->priv->path, path))
+    g_settings_invalidate_all (settings);
+}
+
 /* Properties, Construction, Destruction {{{1 */
 static void
 g_settings_set_property (GObject      *object,
@@ -651,6 +846,34 @@ static const GSettingsListenerVTable listener_vtable = {
   settings_backend_path_writable_changed
 };
 
+static const GSettingsListenerVTable cache_vtable = {
+  settings_cache_changed,
+  settings_cache_path_changed,
+  settings_cache_keys_changed,
+  settings_cache_writable_changed,
+  settings_cache_path_writable_changed
+};
+
+/* Watches are dispatched in the order they were added, so the cache is
+ * always invalidated before the signals are emitted. */
+static void
+g_settings_watch_backend (GSettings *settings)
+{
+  g_settings_backend_watch (settings->priv->backend,
+                            &cache_vtable, G_OBJECT (settings), NULL);
+  g_settings_backend_watch (settings->priv->backend,
+                            &listener_vtable, G_OBJECT (settings),
+                            settings->priv->main_context);
+}
+
+static void
+g_settings_unwatch_backend (GSettings *settings)
+{
+  /* each call removes one of the two watches */
+  g_settings_backend_unwatch (settings->priv->backend, G_OBJECT (settings));
+  g_settings_backend_unwatch (settings->priv->backend, G_OBJECT (settings));
+}
+
 static void
 g_settings_constructed (GObject *object)
 {
@@ -675,9 +898,7 @@ g_settings_constructed (GObject *object)
   if (settings->priv->backend == NULL)
     settings->priv->backend = g_settings_backend_get_default ();
 
-  g_settings_backend_watch (settings->priv->backend,
-                            &listener_vtable, G_OBJECT (settings),
-                            settings->priv->main_context);
+  g_settings_watch_backend (settings);
   g_settings_backend_subscribe (settings->priv->backend,
                                 settings->priv->path);
 }
@@ -693,6 +914,9 @@ g_settings_finalize (GObject *object)
   g_object_unref (settings->priv->backend);
   g_settings_schema_unref (settings->priv->schema);
   g_free (settings->priv->path);
+  g_hash_table_unref (settings->priv->values);
+  g_hash_table_unref (settings->priv->keys);
+  g_mutex_clear (&settings->priv->cache_lock);
 
   G_OBJECT_CLASS (g_settings_parent_class)->finalize (object);
 }
@@ -702,6 +926,12 @@ g_settings_init (GSettings *settings)
 {
   settings->priv = g_settings_get_instance_private (settings);
   settings->priv->main_context = g_main_context_ref_thread_default ();
+
+  g_mutex_init (&settings->priv->cache_lock);
+  settings->priv->keys = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                NULL, g_settings_key_free);
+  settings->priv->values = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                  NULL, g_settings_cached_value_free);
 }
 
 static void
@@ -1156,6 +1386,14 @@ g_settings_read_from_backend (GSettings          *settings,
   GVariant *value;
   GVariant *fixup;
   gchar *path;
+  gboolean cacheable;
+  guint generation = 0;
+
+  /* only the plain "effective value" reads are cached */
+  cacheable = !user_value_only && !default_value;
+  if (cacheable &&
+      g_settings_lookup_cached_value (settings, key, &fixup, &generation))
+    return fixup;
 
   path = g_strconcat (settings->priv->path, key->name, NULL);
   if (user_value_only)
@@ -1172,6 +1410,9 @@ g_settings_read_from_backend (GSettings          *settings,
   else
     fixup = NULL;
 
+  if (cacheable)
+    g_settings_store_cached_value (settings, key, fixup, generation);
+
   return fixup;
 }
 
@@ -1194,19 +1435,17 @@ GVariant *
 g_settings_get_value (GSettings   *settings,
                       const gchar *key)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *value;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), NULL);
   g_return_val_if_fail (key != NULL, NULL);
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
-  value = g_settings_read_from_backend (settings, &skey, FALSE, FALSE);
+  skey = g_settings_lookup_key (settings, key);
+  value = g_settings_read_from_backend (settings, skey, FALSE, FALSE);
 
   if (value == NULL)
-    value = g_settings_schema_key_get_default_value (&skey);
-
-  g_settings_schema_key_clear (&skey);
+    value = g_settings_schema_key_get_default_value (skey);
 
   return value;
 }
@@ -1243,15 +1482,14 @@ GVariant *
 g_settings_get_user_value (GSettings   *settings,
                            const gchar *key)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *value;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), NULL);
   g_return_val_if_fail (key != NULL, NULL);
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
-  value = g_settings_read_from_backend (settings, &skey, TRUE, FALSE);
-  g_settings_schema_key_clear (&skey);
+  skey = g_settings_lookup_key (settings, key);
+  value = g_settings_read_from_backend (settings, skey, TRUE, FALSE);
 
   return value;
 }
@@ -1291,19 +1529,17 @@ GVariant *
 g_settings_get_default_value (GSettings   *settings,
                               const gchar *key)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *value;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), NULL);
   g_return_val_if_fail (key != NULL, NULL);
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
-  value = g_settings_read_from_backend (settings, &skey, FALSE, TRUE);
+  skey = g_settings_lookup_key (settings, key);
+  value = g_settings_read_from_backend (settings, skey, FALSE, TRUE);
 
   if (value == NULL)
-    value = g_settings_schema_key_get_default_value (&skey);
-
-  g_settings_schema_key_clear (&skey);
+    value = g_settings_schema_key_get_default_value (skey);
 
   return value;
 }
@@ -1334,30 +1570,28 @@ gint
 g_settings_get_enum (GSettings   *settings,
                      const gchar *key)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *value;
   gint result;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), -1);
   g_return_val_if_fail (key != NULL, -1);
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
+  skey = g_settings_lookup_key (settings, key);
 
-  if (!skey.is_enum)
+  if (!skey->is_enum)
     {
       g_critical ("g_settings_get_enum() called on key '%s' which is not "
-                  "associated with an enumerated type", skey.name);
-      g_settings_schema_key_clear (&skey);
+                  "associated with an enumerated type", skey->name);
       return -1;
     }
 
-  value = g_settings_read_from_backend (settings, &skey, FALSE, FALSE);
+  value = g_settings_read_from_backend (settings, skey, FALSE, FALSE);
 
   if (value == NULL)
-    value = g_settings_schema_key_get_default_value (&skey);
+    value = g_settings_schema_key_get_default_value (skey);
 
-  result = g_settings_schema_key_to_enum (&skey, value);
-  g_settings_schema_key_clear (&skey);
+  result = g_settings_schema_key_to_enum (skey, value);
   g_variant_unref (value);
 
   return result;
@@ -1387,33 +1621,31 @@ g_settings_set_enum (GSettings   *settings,
                      const gchar *key,
                      gint         value)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *variant;
   gboolean success;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), FALSE);
   g_return_val_if_fail (key != NULL, FALSE);
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
+  skey = g_settings_lookup_key (settings, key);
 
-  if (!skey.is_enum)
+  if (!skey->is_enum)
     {
       g_critical ("g_settings_set_enum() called on key '%s' which is not "
-                  "associated with an enumerated type", skey.name);
+                  "associated with an enumerated type", skey->name);
       return FALSE;
     }
 
-  if (!(variant = g_settings_schema_key_from_enum (&skey, value)))
+  if (!(variant = g_settings_schema_key_from_enum (skey, value)))
     {
       g_critical ("g_settings_set_enum(): invalid enum value %d for key '%s' "
-                  "in schema '%s'.  Doing nothing.", value, skey.name,
-                  g_settings_schema_get_id (skey.schema));
-      g_settings_schema_key_clear (&skey);
+                  "in schema '%s'.  Doing nothing.", value, skey->name,
+                  g_settings_schema_get_id (skey->schema));
       return FALSE;
     }
 
-  success = g_settings_write_to_backend (settings, &skey, g_steal_pointer (&variant));
-  g_settings_schema_key_clear (&skey);
+  success = g_settings_write_to_backend (settings, skey, g_steal_pointer (&variant));
 
   return success;
 }
@@ -1444,30 +1676,28 @@ guint
 g_settings_get_flags (GSettings   *settings,
                       const gchar *key)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *value;
   guint result;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), -1);
   g_return_val_if_fail (key != NULL, -1);
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
+  skey = g_settings_lookup_key (settings, key);
 
-  if (!skey.is_flags)
+  if (!skey->is_flags)
     {
       g_critical ("g_settings_get_flags() called on key '%s' which is not "
-                  "associated with a flags type", skey.name);
-      g_settings_schema_key_clear (&skey);
+                  "associated with a flags type", skey->name);
       return -1;
     }
 
-  value = g_settings_read_from_backend (settings, &skey, FALSE, FALSE);
+  value = g_settings_read_from_backend (settings, skey, FALSE, FALSE);
 
   if (value == NULL)
-    value = g_settings_schema_key_get_default_value (&skey);
+    value = g_settings_schema_key_get_default_value (skey);
 
-  result = g_settings_schema_key_to_flags (&skey, value);
-  g_settings_schema_key_clear (&skey);
+  result = g_settings_schema_key_to_flags (skey, value);
   g_variant_unref (value);
 
   return result;
@@ -1498,33 +1728,31 @@ g_settings_set_flags (GSettings   *settings,
                       const gchar *key,
                       guint        value)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *variant;
   gboolean success;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), FALSE);
   g_return_val_if_fail (key != NULL, FALSE);
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
+  skey = g_settings_lookup_key (settings, key);
 
-  if (!skey.is_flags)
+  if (!skey->is_flags)
     {
       g_critical ("g_settings_set_flags() called on key '%s' which is not "
-                  "associated with a flags type", skey.name);
+                  "associated with a flags type", skey->name);
       return FALSE;
     }
 
-  if (!(variant = g_settings_schema_key_from_flags (&skey, value)))
+  if (!(variant = g_settings_schema_key_from_flags (skey, value)))
     {
       g_critical ("g_settings_set_flags(): invalid flags value 0x%08x "
                   "for key '%s' in schema '%s'.  Doing nothing.",
-                  value, skey.name, g_settings_schema_get_id (skey.schema));
-      g_settings_schema_key_clear (&skey);
+                  value, skey->name, g_settings_schema_get_id (skey->schema));
       return FALSE;
     }
 
-  success = g_settings_write_to_backend (settings, &skey, g_steal_pointer (&variant));
-  g_settings_schema_key_clear (&skey);
+  success = g_settings_write_to_backend (settings, skey, g_steal_pointer (&variant));
 
   return success;
 }
@@ -1553,25 +1781,25 @@ g_settings_set_value (GSettings   *settings,
                       const gchar *key,
                       GVariant    *value)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   gboolean success;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), FALSE);
   g_return_val_if_fail (key != NULL, FALSE);
 
   g_variant_ref_sink (value);
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
+  skey = g_settings_lookup_key (settings, key);
 
-  if (!g_settings_schema_key_type_check (&skey, value))
+  if (!g_settings_schema_key_type_check (skey, value))
     {
       g_critical ("g_settings_set_value: key '%s' in '%s' expects type '%s', but a GVariant of type '%s' was given",
                   key,
                   g_settings_schema_get_id (settings->priv->schema),
-                  g_variant_type_peek_string (skey.type),
+                  g_variant_type_peek_string (skey->type),
                   g_variant_get_type_string (value));
       success = FALSE;
     }
-  else if (!g_settings_schema_key_range_check (&skey, value))
+  else if (!g_settings_schema_key_range_check (skey, value))
     {
       g_warning ("g_settings_set_value: value for key '%s' in schema '%s' "
                  "is outside of valid range",
@@ -1581,10 +1809,9 @@ g_settings_set_value (GSettings   *settings,
     }
   else
     {
-      success = g_settings_write_to_backend (settings, &skey, value);
+      success = g_settings_write_to_backend (settings, skey, value);
     }
 
-  g_settings_schema_key_clear (&skey);
   g_variant_unref (value);
 
   return success;
@@ -1715,7 +1942,7 @@ g_settings_get_mapped (GSettings           *settings,
                        gpointer             user_data)
 {
   gpointer result = NULL;
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *value;
   gboolean okay;
 
@@ -1723,30 +1950,30 @@ g_settings_get_mapped (GSettings           *settings,
   g_return_val_if_fail (key != NULL, NULL);
   g_return_val_if_fail (mapping != NULL, NULL);
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
+  skey = g_settings_lookup_key (settings, key);
 
-  if ((value = g_settings_read_from_backend (settings, &skey, FALSE, FALSE)))
+  if ((value = g_settings_read_from_backend (settings, skey, FALSE, FALSE)))
     {
       okay = mapping (value, &result, user_data);
       g_variant_unref (value);
       if (okay) goto okay;
     }
 
-  if ((value = g_settings_schema_key_get_translated_default (&skey)))
+  if ((value = g_settings_schema_key_get_translated_default (skey)))
     {
       okay = mapping (value, &result, user_data);
       g_variant_unref (value);
       if (okay) goto okay;
     }
 
-  if ((value = g_settings_schema_key_get_per_desktop_default (&skey)))
+  if ((value = g_settings_schema_key_get_per_desktop_default (skey)))
     {
       okay = mapping (value, &result, user_data);
       g_variant_unref (value);
       if (okay) goto okay;
     }
 
-  if (mapping (skey.default_value, &result, user_data))
+  if (mapping (skey->default_value, &result, user_data))
     goto okay;
 
   if (!mapping (NULL, &result, user_data))
@@ -1755,7 +1982,6 @@ g_settings_get_mapped (GSettings           *settings,
              key, g_settings_schema_get_id (settings->priv->schema));
 
  okay:
-  g_settings_schema_key_clear (&skey);
 
   return result;
 }
@@ -2245,13 +2471,16 @@ g_settings_delay (GSettings *settings)
   delayed = g_delayed_settings_backend_new (settings->priv->backend,
                                             settings,
                                             settings->priv->main_context);
-  g_settings_backend_unwatch (settings->priv->backend, G_OBJECT (settings));
+  g_settings_unwatch_backend (settings);
   g_object_unref (settings->priv->backend);
 
+  /* The delayed backend watches the underlying backend without a main
+   * context and forwards changes (including lock changes) synchronously,
+   * so the value cache is still invalidated before any read can see a
+   * stale value. */
   settings->priv->backend = G_SETTINGS_BACKEND (delayed);
-  g_settings_backend_watch (settings->priv->backend,
-                            &listener_vtable, G_OBJECT (settings),
-                            settings->priv->main_context);
+  g_settings_invalidate_all (settings);
+  g_settings_watch_backend (settings);
 
   g_object_notify (G_OBJECT (settings), "delay-apply");
 }
@@ -2502,12 +2731,11 @@ GVariant *
 g_settings_get_range (GSettings   *settings,
                       const gchar *key)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   GVariant *range;
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
-  range = g_settings_schema_key_get_range (&skey);
-  g_settings_schema_key_clear (&skey);
+  skey = g_settings_lookup_key (settings, key);
+  range = g_settings_schema_key_get_range (skey);
 
   return range;
 }
@@ -2532,12 +2760,11 @@ g_settings_range_check (GSettings   *settings,
                         const gchar *key,
                         GVariant    *value)
 {
-  GSettingsSchemaKey skey;
+  GSettingsSchemaKey *skey;
   gboolean good;
 
-  g_settings_schema_key_init (&skey, settings->priv->schema, key);
-  good = g_settings_schema_key_range_check (&skey, value);
-  g_settings_schema_key_clear (&skey);
+  skey = g_settings_lookup_key (settings, key);
+  good = g_settings_schema_key_range_check (skey, value);
 
   return good;
 }
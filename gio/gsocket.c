@@ -54,6 +54,10 @@
 # include <sys/filio.h>
 #endif
 
+#ifdef HAVE_LINUX_ERRQUEUE_H
+# include <linux/errqueue.h>
+#endif
+
 #ifdef G_OS_UNIX
 #include <sys/uio.h>
 #endif
@@ -2266,10 +2270,15 @@ g_socket_bind (GSocket         *socket,
 
   /* Ignore errors here, the only likely error is "not supported", and
    * this is a "best effort" thing mainly.
+   *
+   * SO_REUSEPORT is never cleared here, as it is off by default and callers
+   * (such as sharded #GSocketListeners) may have deliberately enabled it on
+   * stream sockets before binding them.
    */
   g_socket_set_option (socket, SOL_SOCKET, SO_REUSEADDR, so_reuseaddr, NULL);
 #ifdef SO_REUSEPORT
-  g_socket_set_option (socket, SOL_SOCKET, SO_REUSEPORT, so_reuseport, NULL);
+  if (so_reuseport)
+    g_socket_set_option (socket, SOL_SOCKET, SO_REUSEPORT, TRUE, NULL);
 #endif
 
   if (bind (socket->priv->fd, &addr.sa,
@@ -4433,6 +4442,218 @@ g_socket_create_source (GSocket      *socket,
   return socket_source_new (socket, condition, cancellable);
 }
 
+/**
+ * g_socket_receive_zerocopy_completion:
+ * @socket: a #GSocket
+ * @first_id: (out) (optional): return location for the sequence number of
+ *   the first completed send
+ * @last_id: (out) (optional): return location for the sequence number of
+ *   the last completed send
+ * @copied: (out) (optional): return location for whether the kernel fell
+ *   back to copying the data
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Reads one zerocopy completion notification from the error queue of
+ * @socket, without blocking.
+ *
+ * Every successful send with %G_SOCKET_MSG_ZEROCOPY on a socket is
+ * assigned a sequence number, starting from zero. A notification covers
+ * the inclusive range of sends from @first_id to @last_id; once it has
+ * been received, the buffers passed to those sends may be modified or
+ * freed again. If @copied is %TRUE, the kernel copied the data anyway
+ * (for example on the loopback interface), and it may be worth not
+ * requesting zerocopy for further sends to the same destination.
+ *
+ * Entries in the error queue which are not zerocopy notifications are
+ * discarded.
+ *
+ * If no notification is pending, this fails with
+ * %G_IO_ERROR_WOULD_BLOCK. Use g_socket_create_zerocopy_source() to be
+ * notified when one is. On platforms without `MSG_ZEROCOPY` support this
+ * always fails with %G_IO_ERROR_NOT_SUPPORTED.
+ *
+ * Returns: %TRUE if a notification was read, %FALSE on error
+ *
+ * Since: 2.82
+ */
+gboolean
+g_socket_receive_zerocopy_completion (GSocket   *socket,
+                                      guint32   *first_id,
+                                      guint32   *last_id,
+                                      gboolean  *copied,
+                                      GError   **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  if (!check_socket (socket, error))
+    return FALSE;
+
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(SO_EE_ORIGIN_ZEROCOPY)
+  while (TRUE)
+    {
+      struct msghdr msg = { 0 };
+      struct cmsghdr *cmsg;
+      union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE (sizeof (struct sock_extended_err) + sizeof (struct sockaddr_in6))];
+      } control;
+      gssize ret;
+
+      msg.msg_control = control.buf;
+      msg.msg_controllen = sizeof (control.buf);
+
+      ret = recvmsg (socket->priv->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+      if (ret < 0)
+        {
+          int errsv = get_socket_errno ();
+
+          if (errsv == EINTR)
+            continue;
+
+          socket_set_error_lazy (error, errsv, _("Error receiving message: %s"));
+          return FALSE;
+        }
+
+      for (cmsg = CMSG_FIRSTHDR (&msg); cmsg != NULL; cmsg = CMSG_NXTHDR (&msg, cmsg))
+        {
+          struct sock_extended_err serr;
+
+          if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)))
+            continue;
+
+          memcpy (&serr, CMSG_DATA (cmsg), sizeof (serr));
+          if (serr.ee_errno != 0 || serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+            continue;
+
+          if (first_id)
+            *first_id = serr.ee_info;
+          if (last_id)
+            *last_id = serr.ee_data;
+          if (copied)
+            *copied = (serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+
+          return TRUE;
+        }
+    }
+#else
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       _("Zerocopy sends are not supported on this platform"));
+  return FALSE;
+#endif
+}
+
+typedef struct {
+  GSource  source;
+  GSocket *socket;
+} GSocketZerocopySource;
+
+static gboolean
+socket_zerocopy_source_dispatch (GSource     *source,
+                                 GSourceFunc  callback,
+                                 gpointer     user_data)
+{
+  GSocketZerocopyFunc func = (GSocketZerocopyFunc) callback;
+  GSocket *socket = ((GSocketZerocopySource *) source)->socket;
+  guint32 first_id, last_id;
+  gboolean copied;
+  gboolean cleared_error = FALSE;
+  GError *error = NULL;
+
+  while (TRUE)
+    {
+      GIOCondition condition;
+      gint value;
+
+      while (g_socket_receive_zerocopy_completion (socket, &first_id, &last_id, &copied, &error))
+        {
+          if (!(*func) (socket, first_id, last_id, copied, user_data))
+            return G_SOURCE_REMOVE;
+        }
+
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+        break;
+      g_clear_error (&error);
+
+      /* Nothing more can be reported once the socket has hung up. */
+      condition = g_socket_condition_check (socket, G_IO_ERR | G_IO_HUP);
+      if (condition & G_IO_HUP)
+        return G_SOURCE_REMOVE;
+      if (condition == 0)
+        return G_SOURCE_CONTINUE;
+
+      /* G_IO_ERR with an empty error queue is a pending socket error, for
+       * example from an ICMP message, which would otherwise keep the source
+       * firing. Reading SO_ERROR clears it; if that does not help, give up
+       * rather than spin. */
+      if (cleared_error ||
+          !g_socket_get_option (socket, SOL_SOCKET, SO_ERROR, &value, NULL))
+        return G_SOURCE_REMOVE;
+      cleared_error = TRUE;
+    }
+
+  g_error_free (error);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+socket_zerocopy_source_finalize (GSource *source)
+{
+  g_object_unref (((GSocketZerocopySource *) source)->socket);
+}
+
+static GSourceFuncs socket_zerocopy_source_funcs =
+{
+  NULL,
+  NULL,
+  socket_zerocopy_source_dispatch,
+  socket_zerocopy_source_finalize,
+  NULL,
+  NULL,
+};
+
+/**
+ * g_socket_create_zerocopy_source: (skip)
+ * @socket: a #GSocket
+ *
+ * Creates a #GSource that is dispatched whenever the kernel reports the
+ * completion of sends done with %G_SOCKET_MSG_ZEROCOPY on @socket. The
+ * #GSource keeps a reference to the @socket.
+ *
+ * The callback on the source is of the #GSocketZerocopyFunc type, and is
+ * called once for each notification, as returned by
+ * g_socket_receive_zerocopy_completion(). The source is removed when the
+ * callback returns %FALSE, or when no more notifications can arrive
+ * because the socket was closed, hung up or failed.
+ *
+ * Returns: (transfer full): a newly allocated %GSource, free with g_source_unref().
+ *
+ * Since: 2.82
+ */
+GSource *
+g_socket_create_zerocopy_source (GSocket *socket)
+{
+  GSource *source;
+
+  g_return_val_if_fail (G_IS_SOCKET (socket), NULL);
+
+  source = g_source_new (&socket_zerocopy_source_funcs, sizeof (GSocketZerocopySource));
+  g_source_set_static_name (source, "GSocket zerocopy");
+  ((GSocketZerocopySource *) source)->socket = g_object_ref (socket);
+
+  /* Completions are signalled through the error queue, so only G_IO_ERR is
+   * of interest. A plain socket source is not used as it would interfere
+   * with the socket timeout. */
+#ifdef G_OS_UNIX
+  if (check_socket (socket, NULL))
+    g_source_add_unix_fd (source, socket->priv->fd, G_IO_ERR | G_IO_HUP);
+#endif
+
+  return source;
+}
+
 /**
  * g_socket_condition_check:
  * @socket: a #GSocket
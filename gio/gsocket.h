@@ -293,6 +293,14 @@ GIO_AVAILABLE_IN_ALL
 GSource *              g_socket_create_source           (GSocket                 *socket,
 							 GIOCondition             condition,
 							 GCancellable            *cancellable);
+GIO_AVAILABLE_IN_2_82
+GSource *              g_socket_create_zerocopy_source  (GSocket                 *socket);
+GIO_AVAILABLE_IN_2_82
+gboolean               g_socket_receive_zerocopy_completion (GSocket             *socket,
+							 guint32                 *first_id,
+							 guint32                 *last_id,
+							 gboolean                *copied,
+							 GError                 **error);
 GIO_AVAILABLE_IN_ALL
 gboolean               g_socket_speaks_ipv4             (GSocket                 *socket);
 GIO_AVAILABLE_IN_ALL
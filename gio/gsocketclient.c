@@ -56,6 +56,7 @@
 #include <gio/gtlsclientconnection.h>
 #include <gio/ginetaddress.h>
 #include "glibintl.h"
+#include "glib-private.h"
 #include "gmarshal-internal.h"
 
 /* As recommended by RFC 8305 this is the time it waits
@@ -82,6 +83,25 @@
  * As `GSocketClient` is a lightweight object, you don't need to cache it. You
  * can just create a new one any time you need one.
  *
+ * ## Connection pooling
+ *
+ * Since GLib 2.82, a `GSocketClient` can keep idle connections around and
+ * hand them out again, saving the cost of resolving, connecting and doing the
+ * proxy and TLS handshakes for every request to the same host. This is
+ * disabled by default; enable it by setting
+ * [property@Gio.SocketClient:max-idle-connections-per-host] to a non-zero
+ * value, and give connections which can be reused (for example, HTTP/1.1
+ * keep-alive connections at the end of a response) back to the client with
+ * [method@Gio.SocketClient.release_connection] rather than closing them.
+ *
+ * Idle connections are kept per connectable and connection settings, so a
+ * connection is only reused for the same connectable and with the same
+ * family, socket type, protocol, local address, proxy and TLS settings it was
+ * created with. They are closed after
+ * [property@Gio.SocketClient:idle-timeout] seconds, and are checked for
+ * liveness before being reused: a connection which the peer has closed is
+ * never returned.
+ *
  * Since: 2.22
  */
 
@@ -105,9 +125,35 @@ enum
   PROP_ENABLE_PROXY,
   PROP_TLS,
   PROP_TLS_VALIDATION_FLAGS,
-  PROP_PROXY_RESOLVER
+  PROP_PROXY_RESOLVER,
+  PROP_MAX_IDLE_CONNECTIONS_PER_HOST,
+  PROP_IDLE_TIMEOUT
 };
 
+/* Idle connections kept by a #GSocketClient. This is refcounted separately
+ * from the client, as idle connections are expired from the GLib worker
+ * thread. */
+typedef struct
+{
+  gatomicrefcount ref_count;
+  guint id;  /* unique for the lifetime of the process; immutable */
+
+  GMutex lock;
+  GHashTable *idle;  /* (owned) (element-type utf8 GQueue<IdleConnection>), protected by @lock */
+  guint n_idle;  /* protected by @lock */
+  guint max_idle_per_host;  /* protected by @lock */
+  guint idle_timeout;  /* seconds, or 0 for none; protected by @lock */
+  GSource *expiry_source;  /* (owned) (nullable), protected by @lock */
+  guint64 n_hits;  /* protected by @lock */
+  guint64 n_misses;  /* protected by @lock */
+} SocketClientPool;
+
+typedef struct
+{
+  GSocketConnection *connection;  /* (owned) */
+  gint64 idle_since;  /* monotonic time */
+} IdleConnection;
+
 struct _GSocketClientPrivate
 {
   GSocketFamily family;
@@ -120,10 +166,356 @@ struct _GSocketClientPrivate
   gboolean tls;
   GTlsCertificateFlags tls_validation_flags;
   GProxyResolver *proxy_resolver;
+  guint proxy_resolver_serial;  /* incremented whenever @proxy_resolver is set */
+  SocketClientPool *pool;  /* (owned) */
 };
 
+/* Tag on the connections made by a #GSocketClient with pooling enabled, so
+ * they can be released without passing their connectable again, and only
+ * to the client which made them. */
+typedef struct
+{
+  guint pool_id;
+  gchar *key;  /* (owned) */
+} PoolTag;
+
 G_DEFINE_TYPE_WITH_PRIVATE (GSocketClient, g_socket_client, G_TYPE_OBJECT)
 
+static GQuark
+pool_tag_quark (void)
+{
+  return g_quark_from_static_string ("g-socket-client-pool-tag");
+}
+
+static void
+pool_tag_free (PoolTag *tag)
+{
+  g_free (tag->key);
+  g_free (tag);
+}
+
+static void
+idle_connection_free (IdleConnection *idle)
+{
+  g_object_unref (idle->connection);
+  g_free (idle);
+}
+
+static void
+idle_queue_free (GQueue *queue)
+{
+  g_queue_free_full (queue, (GDestroyNotify) idle_connection_free);
+}
+
+static SocketClientPool *
+socket_client_pool_new (void)
+{
+  static gint next_id = 0;
+  SocketClientPool *pool = g_new0 (SocketClientPool, 1);
+
+  g_atomic_ref_count_init (&pool->ref_count);
+  pool->id = (guint) g_atomic_int_add (&next_id, 1);
+  g_mutex_init (&pool->lock);
+  pool->idle = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                      g_free, (GDestroyNotify) idle_queue_free);
+  pool->idle_timeout = 60;
+
+  return pool;
+}
+
+static SocketClientPool *
+socket_client_pool_ref (SocketClientPool *pool)
+{
+  g_atomic_ref_count_inc (&pool->ref_count);
+  return pool;
+}
+
+static void
+socket_client_pool_unref (SocketClientPool *pool)
+{
+  if (!g_atomic_ref_count_dec (&pool->ref_count))
+    return;
+
+  g_assert (pool->expiry_source == NULL);
+
+  g_hash_table_unref (pool->idle);
+  g_mutex_clear (&pool->lock);
+  g_free (pool);
+}
+
+/* Moves the idle connections which have been idle for longer than the idle
+ * timeout (or all of them, if @all is set) to @dead, so they can be dropped
+ * without holding the lock. */
+static void
+socket_client_pool_expire_unlocked (SocketClientPool *pool,
+                                    gboolean          all,
+                                    GSList          **dead)
+{
+  GHashTableIter iter;
+  GQueue *queue;
+  gint64 deadline;
+
+  deadline = g_get_monotonic_time () - (gint64) pool->idle_timeout * G_USEC_PER_SEC;
+
+  g_hash_table_iter_init (&iter, pool->idle);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &queue))
+    {
+      IdleConnection *idle;
+
+      /* The oldest connections are at the tail. */
+      while ((idle = g_queue_peek_tail (queue)) != NULL &&
+             (all || (pool->idle_timeout != 0 && idle->idle_since <= deadline)))
+        {
+          *dead = g_slist_prepend (*dead, g_queue_pop_tail (queue));
+          pool->n_idle--;
+        }
+
+      if (g_queue_is_empty (queue))
+        g_hash_table_iter_remove (&iter);
+    }
+}
+
+static void socket_client_pool_update_expiry_unlocked (SocketClientPool *pool);
+
+static gboolean
+socket_client_pool_expire_cb (gpointer user_data)
+{
+  SocketClientPool *pool = user_data;
+  GSList *dead = NULL;
+
+  g_mutex_lock (&pool->lock);
+  socket_client_pool_expire_unlocked (pool, FALSE, &dead);
+  socket_client_pool_update_expiry_unlocked (pool);
+  g_mutex_unlock (&pool->lock);
+
+  g_slist_free_full (dead, (GDestroyNotify) idle_connection_free);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* Idle connections are expired from the GLib worker thread, as there may not
+ * be any main loop running in the thread which released them. */
+static void
+socket_client_pool_update_expiry_unlocked (SocketClientPool *pool)
+{
+  gboolean needed = (pool->n_idle > 0 && pool->idle_timeout != 0);
+
+  if (pool->expiry_source != NULL && !needed)
+    {
+      g_source_destroy (pool->expiry_source);
+      g_clear_pointer (&pool->expiry_source, g_source_unref);
+    }
+  else if (pool->expiry_source == NULL && needed)
+    {
+      pool->expiry_source = g_timeout_source_new_seconds (MAX (pool->idle_timeout / 2, 1));
+      g_source_set_static_name (pool->expiry_source, "[gio] socket client pool expiry");
+      g_source_set_callback (pool->expiry_source, socket_client_pool_expire_cb,
+                             socket_client_pool_ref (pool),
+                             (GDestroyNotify) socket_client_pool_unref);
+      g_source_attach (pool->expiry_source, GLIB_PRIVATE_CALL (g_get_worker_context) ());
+    }
+}
+
+static void
+socket_client_pool_flush (SocketClientPool *pool)
+{
+  GSList *dead = NULL;
+
+  g_mutex_lock (&pool->lock);
+  socket_client_pool_expire_unlocked (pool, TRUE, &dead);
+  socket_client_pool_update_expiry_unlocked (pool);
+  g_mutex_unlock (&pool->lock);
+
+  g_slist_free_full (dead, (GDestroyNotify) idle_connection_free);
+}
+
+/* Checks that an idle connection can be handed out again without the caller
+ * noticing it was ever idle: it must still be open, and the peer must not
+ * have closed it or sent anything while it was idle. */
+static gboolean
+connection_is_reusable (GSocketConnection *connection)
+{
+  GSocket *socket;
+  GIOCondition condition;
+
+  if (g_io_stream_is_closed (G_IO_STREAM (connection)))
+    return FALSE;
+
+  socket = g_socket_connection_get_socket (connection);
+  if (g_socket_is_closed (socket) || !g_socket_is_connected (socket))
+    return FALSE;
+
+  condition = g_socket_condition_check (socket, G_IO_IN | G_IO_ERR | G_IO_HUP);
+  if (condition & (G_IO_ERR | G_IO_HUP))
+    return FALSE;
+
+  if (condition & G_IO_IN)
+    {
+      gchar byte;
+      GInputVector vector = { &byte, 1 };
+      gint flags = G_SOCKET_MSG_PEEK;
+      gssize n_read;
+
+      n_read = g_socket_receive_message (socket, NULL, &vector, 1,
+                                         NULL, NULL, &flags, NULL, NULL);
+
+      /* A readable socket with nothing to read has been closed by the peer.
+       * Pending data is only expected below a TLS or proxy layer, for
+       * example TLS 1.3 session tickets; anywhere else it would leave the
+       * next user of the connection out of step with the peer. */
+      if (n_read <= 0 || !G_IS_TCP_WRAPPER_CONNECTION (connection))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static GSocketConnection *
+socket_client_pool_checkout (SocketClientPool *pool,
+                             const gchar      *key)
+{
+  GSocketConnection *connection = NULL;
+  GSList *dead = NULL;
+  GQueue *queue;
+  gint64 deadline;
+
+  g_mutex_lock (&pool->lock);
+
+  deadline = g_get_monotonic_time () - (gint64) pool->idle_timeout * G_USEC_PER_SEC;
+  queue = g_hash_table_lookup (pool->idle, key);
+
+  while (connection == NULL && queue != NULL && !g_queue_is_empty (queue))
+    {
+      /* Most recently released first, as it is the most likely to still be
+       * alive. */
+      IdleConnection *idle = g_queue_pop_head (queue);
+
+      pool->n_idle--;
+
+      if ((pool->idle_timeout == 0 || idle->idle_since > deadline) &&
+          connection_is_reusable (idle->connection))
+        {
+          connection = g_steal_pointer (&idle->connection);
+          g_free (idle);
+        }
+      else
+        dead = g_slist_prepend (dead, idle);
+    }
+
+  if (queue != NULL && g_queue_is_empty (queue))
+    g_hash_table_remove (pool->idle, key);
+
+  if (connection != NULL)
+    pool->n_hits++;
+  else
+    pool->n_misses++;
+
+  socket_client_pool_update_expiry_unlocked (pool);
+
+  g_mutex_unlock (&pool->lock);
+
+  g_slist_free_full (dead, (GDestroyNotify) idle_connection_free);
+
+  return connection;
+}
+
+static void
+socket_client_pool_release (SocketClientPool  *pool,
+                            const gchar       *key,
+                            GSocketConnection *connection)
+{
+  GSList *dead = NULL;
+  IdleConnection *idle;
+  GQueue *queue;
+
+  g_mutex_lock (&pool->lock);
+
+  if (pool->max_idle_per_host == 0)
+    {
+      g_mutex_unlock (&pool->lock);
+      g_object_unref (connection);
+      return;
+    }
+
+  queue = g_hash_table_lookup (pool->idle, key);
+  if (queue == NULL)
+    {
+      queue = g_queue_new ();
+      g_hash_table_insert (pool->idle, g_strdup (key), queue);
+    }
+
+  idle = g_new0 (IdleConnection, 1);
+  idle->connection = connection;
+  idle->idle_since = g_get_monotonic_time ();
+  g_queue_push_head (queue, idle);
+  pool->n_idle++;
+
+  while (g_queue_get_length (queue) > pool->max_idle_per_host)
+    {
+      dead = g_slist_prepend (dead, g_queue_pop_tail (queue));
+      pool->n_idle--;
+    }
+
+  socket_client_pool_update_expiry_unlocked (pool);
+
+  g_mutex_unlock (&pool->lock);
+
+  g_slist_free_full (dead, (GDestroyNotify) idle_connection_free);
+}
+
+/* Returns the key under which connections to @connectable made with the
+ * current settings of @client are pooled, or %NULL if pooling is disabled or
+ * @connectable cannot be told apart from other connectables. The proxy
+ * resolver is identified by a serial rather than its address, which could be
+ * reused by a different resolver once the old one is freed. */
+static gchar *
+pool_key_for_connectable (GSocketClient      *client,
+                          GSocketConnectable *connectable)
+{
+  GSocketClientPrivate *priv = client->priv;
+  gchar *connectable_str, *local_str = NULL, *key;
+  gboolean enabled;
+
+  g_mutex_lock (&priv->pool->lock);
+  enabled = (priv->pool->max_idle_per_host > 0);
+  g_mutex_unlock (&priv->pool->lock);
+
+  if (!enabled || G_SOCKET_CONNECTABLE_GET_IFACE (connectable)->to_string == NULL)
+    return NULL;
+
+  connectable_str = g_socket_connectable_to_string (connectable);
+  if (priv->local_address != NULL)
+    local_str = g_socket_connectable_to_string (G_SOCKET_CONNECTABLE (priv->local_address));
+
+  key = g_strdup_printf ("%s|%d|%d|%d|%s|%d|%u|%d|%u",
+                         connectable_str,
+                         priv->family, priv->type, priv->protocol,
+                         local_str ? local_str : "",
+                         priv->enable_proxy, priv->proxy_resolver_serial,
+                         priv->tls, priv->tls_validation_flags);
+
+  g_free (local_str);
+  g_free (connectable_str);
+
+  return key;
+}
+
+/* Marks @connection as made by @client, to be pooled under @key */
+static void
+tag_connection (GSocketClient *client,
+                GIOStream     *connection,
+                gchar         *key)
+{
+  PoolTag *tag;
+
+  tag = g_new0 (PoolTag, 1);
+  tag->pool_id = client->priv->pool->id;
+  tag->key = key;
+
+  g_object_set_qdata_full (G_OBJECT (connection), pool_tag_quark (),
+                           tag, (GDestroyNotify) pool_tag_free);
+}
+
 static GSocket *
 create_socket (GSocketClient  *client,
 	       GSocketAddress *dest_address,
@@ -220,6 +612,7 @@ g_socket_client_init (GSocketClient *client)
 						     g_str_equal,
 						     g_free,
 						     NULL);
+  client->priv->pool = socket_client_pool_new ();
 }
 
 /**
@@ -246,6 +639,9 @@ g_socket_client_finalize (GObject *object)
   g_clear_object (&client->priv->local_address);
   g_clear_object (&client->priv->proxy_resolver);
 
+  socket_client_pool_flush (client->priv->pool);
+  g_clear_pointer (&client->priv->pool, socket_client_pool_unref);
+
   G_OBJECT_CLASS (g_socket_client_parent_class)->finalize (object);
 
   g_hash_table_unref (client->priv->app_proxies);
@@ -299,6 +695,14 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 	g_value_set_object (value, g_socket_client_get_proxy_resolver (client));
 	break;
 
+      case PROP_MAX_IDLE_CONNECTIONS_PER_HOST:
+	g_value_set_uint (value, g_socket_client_get_max_idle_connections_per_host (client));
+	break;
+
+      case PROP_IDLE_TIMEOUT:
+	g_value_set_uint (value, g_socket_client_get_idle_timeout (client));
+	break;
+
       default:
 	G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -352,6 +756,14 @@ G_GNUC_END_IGNORE_DEPRECATIONS
       g_socket_client_set_proxy_resolver (client, g_value_get_object (value));
       break;
 
+    case PROP_MAX_IDLE_CONNECTIONS_PER_HOST:
+      g_socket_client_set_max_idle_connections_per_host (client, g_value_get_uint (value));
+      break;
+
+    case PROP_IDLE_TIMEOUT:
+      g_socket_client_set_idle_timeout (client, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -780,11 +1192,273 @@ g_socket_client_set_proxy_resolver (GSocketClient  *client,
     g_object_unref (client->priv->proxy_resolver);
 
   client->priv->proxy_resolver = proxy_resolver;
+  client->priv->proxy_resolver_serial++;
 
   if (client->priv->proxy_resolver)
     g_object_ref (client->priv->proxy_resolver);
 }
 
+/**
+ * g_socket_client_get_max_idle_connections_per_host:
+ * @client: a #GSocketClient.
+ *
+ * Gets the maximum number of idle connections @client keeps per host.
+ *
+ * See g_socket_client_set_max_idle_connections_per_host() for details.
+ *
+ * Returns: the maximum number of idle connections per host
+ *
+ * Since: 2.82
+ */
+guint
+g_socket_client_get_max_idle_connections_per_host (GSocketClient *client)
+{
+  guint max_idle_per_host;
+
+  g_return_val_if_fail (G_IS_SOCKET_CLIENT (client), 0);
+
+  g_mutex_lock (&client->priv->pool->lock);
+  max_idle_per_host = client->priv->pool->max_idle_per_host;
+  g_mutex_unlock (&client->priv->pool->lock);
+
+  return max_idle_per_host;
+}
+
+/**
+ * g_socket_client_set_max_idle_connections_per_host:
+ * @client: a #GSocketClient.
+ * @max_idle: the maximum number of idle connections per host
+ *
+ * Sets the maximum number of idle connections @client keeps for each host,
+ * which enables connection pooling if non-zero.
+ *
+ * Connections given back to @client with
+ * g_socket_client_release_connection() are kept, up to @max_idle of them
+ * for each connectable, and the connect functions return one of them
+ * instead of making a new connection if possible. If there are already
+ * @max_idle idle connections for a connectable, the least recently released
+ * one is closed.
+ *
+ * If @max_idle is `0` (the default), connection pooling is disabled and all
+ * idle connections are closed.
+ *
+ * Since: 2.82
+ */
+void
+g_socket_client_set_max_idle_connections_per_host (GSocketClient *client,
+                                                   guint          max_idle)
+{
+  SocketClientPool *pool;
+  GSList *dead = NULL;
+  GHashTableIter iter;
+  GQueue *queue;
+
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  pool = client->priv->pool;
+
+  g_mutex_lock (&pool->lock);
+
+  if (pool->max_idle_per_host == max_idle)
+    {
+      g_mutex_unlock (&pool->lock);
+      return;
+    }
+
+  pool->max_idle_per_host = max_idle;
+
+  g_hash_table_iter_init (&iter, pool->idle);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &queue))
+    {
+      while (g_queue_get_length (queue) > max_idle)
+        {
+          dead = g_slist_prepend (dead, g_queue_pop_tail (queue));
+          pool->n_idle--;
+        }
+
+      if (g_queue_is_empty (queue))
+        g_hash_table_iter_remove (&iter);
+    }
+
+  socket_client_pool_update_expiry_unlocked (pool);
+
+  g_mutex_unlock (&pool->lock);
+
+  g_slist_free_full (dead, (GDestroyNotify) idle_connection_free);
+
+  g_object_notify (G_OBJECT (client), "max-idle-connections-per-host");
+}
+
+/**
+ * g_socket_client_get_idle_timeout:
+ * @client: a #GSocketClient.
+ *
+ * Gets how long @client keeps idle connections, in seconds.
+ *
+ * See g_socket_client_set_idle_timeout() for details.
+ *
+ * Returns: the idle timeout, in seconds
+ *
+ * Since: 2.82
+ */
+guint
+g_socket_client_get_idle_timeout (GSocketClient *client)
+{
+  guint idle_timeout;
+
+  g_return_val_if_fail (G_IS_SOCKET_CLIENT (client), 0);
+
+  g_mutex_lock (&client->priv->pool->lock);
+  idle_timeout = client->priv->pool->idle_timeout;
+  g_mutex_unlock (&client->priv->pool->lock);
+
+  return idle_timeout;
+}
+
+/**
+ * g_socket_client_set_idle_timeout:
+ * @client: a #GSocketClient.
+ * @idle_timeout: the idle timeout, in seconds
+ *
+ * Sets how long @client keeps connections given back with
+ * g_socket_client_release_connection() before closing them, in seconds.
+ * This should be lower than the time after which the servers close idle
+ * connections.
+ *
+ * If @idle_timeout is `0`, idle connections are kept until they are
+ * reused or the peer closes them. The default is 60 seconds.
+ *
+ * Since: 2.82
+ */
+void
+g_socket_client_set_idle_timeout (GSocketClient *client,
+                                  guint          idle_timeout)
+{
+  SocketClientPool *pool;
+
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  pool = client->priv->pool;
+
+  g_mutex_lock (&pool->lock);
+
+  if (pool->idle_timeout == idle_timeout)
+    {
+      g_mutex_unlock (&pool->lock);
+      return;
+    }
+
+  pool->idle_timeout = idle_timeout;
+
+  /* Restart the expiry timer with the new interval. */
+  if (pool->expiry_source != NULL)
+    {
+      g_source_destroy (pool->expiry_source);
+      g_clear_pointer (&pool->expiry_source, g_source_unref);
+    }
+  socket_client_pool_update_expiry_unlocked (pool);
+
+  g_mutex_unlock (&pool->lock);
+
+  g_object_notify (G_OBJECT (client), "idle-timeout");
+}
+
+/**
+ * g_socket_client_release_connection:
+ * @client: a #GSocketClient.
+ * @connection: (transfer full): a #GSocketConnection returned by @client
+ *
+ * Gives a connection back to @client so it can be reused by a later connect
+ * call for the same connectable.
+ *
+ * The connection must be in a state where it can be used again from
+ * scratch, for example at the end of a complete request and response. The
+ * caller must not use it anymore after calling this function, as it may be
+ * handed to another caller or closed at any time.
+ *
+ * If connection pooling is disabled (see
+ * g_socket_client_set_max_idle_connections_per_host()), or if @connection
+ * was not made by @client with pooling enabled, or cannot be reused, it is
+ * closed.
+ *
+ * Since: 2.82
+ */
+void
+g_socket_client_release_connection (GSocketClient     *client,
+                                    GSocketConnection *connection)
+{
+  const PoolTag *tag;
+
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+  g_return_if_fail (G_IS_SOCKET_CONNECTION (connection));
+
+  tag = g_object_get_qdata (G_OBJECT (connection), pool_tag_quark ());
+
+  if (tag == NULL || tag->pool_id != client->priv->pool->id ||
+      !connection_is_reusable (connection))
+    {
+      g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+      g_object_unref (connection);
+      return;
+    }
+
+  socket_client_pool_release (client->priv->pool, tag->key, connection);
+}
+
+/**
+ * g_socket_client_flush_idle_connections:
+ * @client: a #GSocketClient.
+ *
+ * Closes all the idle connections kept by @client, for example because the
+ * network configuration changed.
+ *
+ * Since: 2.82
+ */
+void
+g_socket_client_flush_idle_connections (GSocketClient *client)
+{
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  socket_client_pool_flush (client->priv->pool);
+}
+
+/**
+ * g_socket_client_get_pool_statistics:
+ * @client: a #GSocketClient.
+ * @n_hits: (out) (optional): return location for the number of connect calls
+ *   which reused an idle connection
+ * @n_misses: (out) (optional): return location for the number of connect
+ *   calls which had to make a new connection
+ * @n_idle: (out) (optional): return location for the number of idle
+ *   connections currently kept
+ *
+ * Gets statistics about the connection pool of @client. Connect calls are
+ * only counted while connection pooling is enabled.
+ *
+ * Since: 2.82
+ */
+void
+g_socket_client_get_pool_statistics (GSocketClient *client,
+                                     guint64       *n_hits,
+                                     guint64       *n_misses,
+                                     guint         *n_idle)
+{
+  SocketClientPool *pool;
+
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  pool = client->priv->pool;
+
+  g_mutex_lock (&pool->lock);
+  if (n_hits != NULL)
+    *n_hits = pool->n_hits;
+  if (n_misses != NULL)
+    *n_misses = pool->n_misses;
+  if (n_idle != NULL)
+    *n_idle = pool->n_idle;
+  g_mutex_unlock (&pool->lock);
+}
+
 static void
 g_socket_client_class_init (GSocketClientClass *class)
 {
@@ -1013,6 +1687,40 @@ g_socket_client_class_init (GSocketClientClass *class)
                                                         G_PARAM_CONSTRUCT |
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketClient:max-idle-connections-per-host:
+   *
+   * The maximum number of idle connections to keep for each host, or `0` to
+   * disable connection pooling.
+   *
+   * See g_socket_client_set_max_idle_connections_per_host().
+   *
+   * Since: 2.82
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_IDLE_CONNECTIONS_PER_HOST,
+                                   g_param_spec_uint ("max-idle-connections-per-host", NULL, NULL,
+                                                      0, G_MAXUINT, 0,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS |
+                                                      G_PARAM_EXPLICIT_NOTIFY));
+
+  /**
+   * GSocketClient:idle-timeout:
+   *
+   * How long to keep idle connections, in seconds, or `0` to keep them
+   * until they are reused.
+   *
+   * See g_socket_client_set_idle_timeout().
+   *
+   * Since: 2.82
+   */
+  g_object_class_install_property (gobject_class, PROP_IDLE_TIMEOUT,
+                                   g_param_spec_uint ("idle-timeout", NULL, NULL,
+                                                      0, G_MAXUINT, 60,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS |
+                                                      G_PARAM_EXPLICIT_NOTIFY));
 }
 
 static void
@@ -1131,6 +1839,21 @@ g_socket_client_connect (GSocketClient       *client,
   GSocketAddressEnumerator *enumerator = NULL;
   SocketClientErrorInfo *error_info;
   gboolean ever_resolved = FALSE;
+  gchar *pool_key;
+
+  pool_key = pool_key_for_connectable (client, connectable);
+  if (pool_key != NULL)
+    {
+      GSocketConnection *pooled;
+
+      pooled = socket_client_pool_checkout (client->priv->pool, pool_key);
+      if (pooled != NULL)
+        {
+          g_free (pool_key);
+          g_socket_client_emit_event (client, G_SOCKET_CLIENT_COMPLETE, connectable, G_IO_STREAM (pooled));
+          return pooled;
+        }
+    }
 
   error_info = socket_client_error_info_new ();
 
@@ -1320,7 +2043,10 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 
   if (!connection)
     g_propagate_error (error, g_steal_pointer (&error_info->best_error));
+  else if (pool_key != NULL)
+    tag_connection (client, connection, g_steal_pointer (&pool_key));
   socket_client_error_info_free (error_info);
+  g_free (pool_key);
 
   g_socket_client_emit_event (client, G_SOCKET_CLIENT_COMPLETE, connectable, connection);
   return G_SOCKET_CONNECTION (connection);
@@ -1510,6 +2236,8 @@ typedef struct
   gboolean enumeration_completed;
   gboolean connection_in_progress;
   gboolean completed;
+
+  gchar *pool_key;  /* (owned) (nullable) */
 } GSocketClientAsyncConnectData;
 
 static void connection_attempt_unref (gpointer attempt);
@@ -1530,6 +2258,7 @@ g_socket_client_async_connect_data_free (GSocketClientAsyncConnectData *data)
   g_slist_free_full (data->successful_connections, connection_attempt_unref);
 
   g_clear_pointer (&data->error_info, socket_client_error_info_free);
+  g_free (data->pool_key);
 
   g_slice_free (GSocketClientAsyncConnectData, data);
 }
@@ -1647,6 +2376,9 @@ g_socket_client_async_connect_complete (ConnectionAttempt *attempt)
   else
     {
       g_debug ("GSocketClient: Connection successful!");
+      if (data->pool_key != NULL)
+        tag_connection (data->client, attempt->connection,
+                        g_steal_pointer (&data->pool_key));
       g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_COMPLETE, data->connectable, attempt->connection);
       g_task_return_pointer (data->task, g_steal_pointer (&attempt->connection), g_object_unref);
     }
@@ -2147,13 +2879,37 @@ g_socket_client_connect_async (GSocketClient       *client,
 			       gpointer             user_data)
 {
   GSocketClientAsyncConnectData *data;
+  gchar *pool_key;
 
   g_return_if_fail (G_IS_SOCKET_CLIENT (client));
 
+  pool_key = pool_key_for_connectable (client, connectable);
+  if (pool_key != NULL)
+    {
+      GSocketConnection *pooled;
+
+      pooled = socket_client_pool_checkout (client->priv->pool, pool_key);
+      if (pooled != NULL)
+        {
+          GTask *task;
+
+          g_debug ("GSocketClient: Reusing idle connection %p", pooled);
+
+          task = g_task_new (client, cancellable, callback, user_data);
+          g_task_set_source_tag (task, g_socket_client_connect_async);
+          g_socket_client_emit_event (client, G_SOCKET_CLIENT_COMPLETE, connectable, G_IO_STREAM (pooled));
+          g_task_return_pointer (task, pooled, g_object_unref);
+          g_object_unref (task);
+          g_free (pool_key);
+          return;
+        }
+    }
+
   data = g_slice_new0 (GSocketClientAsyncConnectData);
   data->client = client;
   data->connectable = g_object_ref (connectable);
   data->error_info = socket_client_error_info_new ();
+  data->pool_key = g_steal_pointer (&pool_key);
 
   if (can_use_proxy (client))
     {
@@ -123,6 +123,27 @@ GIO_AVAILABLE_IN_2_36
 void                    g_socket_client_set_proxy_resolver              (GSocketClient        *client,
                                                                          GProxyResolver       *proxy_resolver);
 
+GIO_AVAILABLE_IN_2_82
+guint                   g_socket_client_get_max_idle_connections_per_host (GSocketClient      *client);
+GIO_AVAILABLE_IN_2_82
+void                    g_socket_client_set_max_idle_connections_per_host (GSocketClient      *client,
+                                                                           guint               max_idle);
+GIO_AVAILABLE_IN_2_82
+guint                   g_socket_client_get_idle_timeout                (GSocketClient        *client);
+GIO_AVAILABLE_IN_2_82
+void                    g_socket_client_set_idle_timeout                (GSocketClient        *client,
+                                                                         guint                 idle_timeout);
+GIO_AVAILABLE_IN_2_82
+void                    g_socket_client_release_connection              (GSocketClient        *client,
+                                                                         GSocketConnection    *connection);
+GIO_AVAILABLE_IN_2_82
+void                    g_socket_client_flush_idle_connections          (GSocketClient        *client);
+GIO_AVAILABLE_IN_2_82
+void                    g_socket_client_get_pool_statistics             (GSocketClient        *client,
+                                                                         guint64              *n_hits,
+                                                                         guint64              *n_misses,
+                                                                         guint                *n_idle);
+
 GIO_AVAILABLE_IN_ALL
 GSocketConnection *     g_socket_client_connect                         (GSocketClient        *client,
                                                                          GSocketConnectable   *connectable,
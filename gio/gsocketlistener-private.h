@@ -0,0 +1,37 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright © 2024 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_SOCKET_LISTENER_PRIVATE_H__
+#define __G_SOCKET_LISTENER_PRIVATE_H__
+
+#include "gsocketlistener.h"
+
+G_BEGIN_DECLS
+
+void       g_socket_listener_set_n_shards              (GSocketListener *listener,
+                                                        guint            n_shards);
+GPtrArray *g_socket_listener_dup_shard_sockets         (GSocketListener *listener,
+                                                        guint            shard);
+GObject   *g_socket_listener_get_socket_source_object  (GSocketListener *listener,
+                                                        GSocket         *socket);
+
+G_END_DECLS
+
+#endif /* __G_SOCKET_LISTENER_PRIVATE_H__ */
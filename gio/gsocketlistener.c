@@ -27,6 +27,7 @@
 
 #include "config.h"
 #include "gsocketlistener.h"
+#include "gsocketlistener-private.h"
 
 #include <gio/gioenumtypes.h>
 #include <gio/gtask.h>
@@ -37,6 +38,7 @@
 #include <gio/gsocket.h>
 #include <gio/gsocketconnection.h>
 #include <gio/ginetsocketaddress.h>
+#include "gnetworkingprivate.h"
 #include "glibintl.h"
 #include "gmarshal-internal.h"
 
@@ -85,6 +87,10 @@ struct _GSocketListenerPrivate
   GMainContext        *main_context;
   int                 listen_backlog;
   guint               closed : 1;
+
+  /* Only used by sharded #GSocketService instances */
+  guint               n_shards;
+  GHashTable          *shard_sockets;  /* (owned) (nullable) (element-type GSocket GPtrArray<GSocket>) */
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GSocketListener, g_socket_listener, G_TYPE_OBJECT)
@@ -103,6 +109,7 @@ g_socket_listener_finalize (GObject *object)
    * g_socket_listener_add_socket() was used).
    */
   g_ptr_array_free (listener->priv->sockets, TRUE);
+  g_clear_pointer (&listener->priv->shard_sockets, g_hash_table_unref);
 
   G_OBJECT_CLASS (g_socket_listener_parent_class)
     ->finalize (object);
@@ -239,6 +246,182 @@ check_listener (GSocketListener *listener,
   return TRUE;
 }
 
+/* Sharded #GSocketService instances accept connections on several threads.
+ * Every listening socket which has `SO_REUSEPORT` set gets `n_shards - 1`
+ * siblings bound to the same address, so that the kernel can distribute
+ * incoming connections between the shards. Any other socket is shared by
+ * all the shards. */
+static void
+prepare_shard_socket (GSocketListener *listener,
+                      GSocket         *socket)
+{
+#ifdef SO_REUSEPORT
+  if (listener->priv->n_shards > 1)
+    g_socket_set_option (socket, SOL_SOCKET, SO_REUSEPORT, TRUE, NULL);
+#endif
+}
+
+static void
+add_shard_sockets (GSocketListener *listener,
+                   GSocket         *socket)
+{
+#ifdef SO_REUSEPORT
+  GSocketAddress *address;
+  GPtrArray *siblings;
+  GObject *source_object;
+  GError *local_error = NULL;
+  gint reuse_port = 0;
+  guint i;
+
+  if (listener->priv->n_shards < 2 ||
+      !g_socket_get_option (socket, SOL_SOCKET, SO_REUSEPORT, &reuse_port, NULL) ||
+      !reuse_port)
+    return;
+
+  address = g_socket_get_local_address (socket, NULL);
+  if (address == NULL)
+    return;
+
+  source_object = g_object_get_qdata (G_OBJECT (socket), source_quark);
+  siblings = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+
+  for (i = 1; i < listener->priv->n_shards; i++)
+    {
+      GSocket *sibling;
+
+      sibling = g_socket_new (g_socket_get_family (socket),
+                              g_socket_get_socket_type (socket),
+                              g_socket_get_protocol (socket),
+                              &local_error);
+      if (sibling == NULL)
+        break;
+
+      g_ptr_array_add (siblings, sibling);
+      g_socket_set_listen_backlog (sibling, listener->priv->listen_backlog);
+      g_socket_set_option (sibling, SOL_SOCKET, SO_REUSEPORT, TRUE, NULL);
+
+      g_signal_emit (listener, signals[EVENT], 0,
+                     G_SOCKET_LISTENER_BINDING, sibling);
+
+      if (!g_socket_bind (sibling, address, TRUE, &local_error))
+        break;
+
+      g_signal_emit (listener, signals[EVENT], 0,
+                     G_SOCKET_LISTENER_BOUND, sibling);
+      g_signal_emit (listener, signals[EVENT], 0,
+                     G_SOCKET_LISTENER_LISTENING, sibling);
+
+      if (!g_socket_listen (sibling, &local_error))
+        break;
+
+      g_signal_emit (listener, signals[EVENT], 0,
+                     G_SOCKET_LISTENER_LISTENED, sibling);
+
+      if (source_object)
+        g_object_set_qdata_full (G_OBJECT (sibling), source_quark,
+                                 g_object_ref (source_object), g_object_unref);
+    }
+
+  g_object_unref (address);
+
+  if (local_error != NULL)
+    {
+      /* Not fatal: all the shards will accept from @socket instead. */
+      g_debug ("Failed to create a shard socket, sharing the listening socket: %s",
+               local_error->message);
+      g_error_free (local_error);
+
+      for (i = 0; i < siblings->len; i++)
+        g_socket_close (siblings->pdata[i], NULL);
+      g_ptr_array_unref (siblings);
+      return;
+    }
+
+  if (listener->priv->shard_sockets == NULL)
+    listener->priv->shard_sockets =
+      g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+
+  g_hash_table_insert (listener->priv->shard_sockets, socket, siblings);
+#endif
+}
+
+/*< private >
+ * g_socket_listener_set_n_shards:
+ * @listener: a #GSocketListener
+ * @n_shards: number of shards which will accept connections from @listener
+ *
+ * Prepares @listener for accepting connections from @n_shards threads. This
+ * must be called before any sockets are added to @listener.
+ */
+void
+g_socket_listener_set_n_shards (GSocketListener *listener,
+                                guint            n_shards)
+{
+  g_return_if_fail (G_IS_SOCKET_LISTENER (listener));
+  g_return_if_fail (listener->priv->sockets->len == 0);
+
+  listener->priv->n_shards = n_shards;
+}
+
+/*< private >
+ * g_socket_listener_dup_shard_sockets:
+ * @listener: a #GSocketListener
+ * @shard: index of the shard, less than the number of shards
+ *
+ * Gets the open listening sockets which the given shard should accept
+ * connections from. Sockets which could not be duplicated for each shard are
+ * returned for all of them.
+ *
+ * Returns: (transfer full) (element-type GSocket): the sockets of @shard
+ */
+GPtrArray *
+g_socket_listener_dup_shard_sockets (GSocketListener *listener,
+                                     guint            shard)
+{
+  GPtrArray *sockets;
+  guint i;
+
+  g_return_val_if_fail (G_IS_SOCKET_LISTENER (listener), NULL);
+
+  sockets = g_ptr_array_new_full (listener->priv->sockets->len,
+                                  (GDestroyNotify) g_object_unref);
+
+  for (i = 0; i < listener->priv->sockets->len; i++)
+    {
+      GSocket *socket = listener->priv->sockets->pdata[i];
+      GPtrArray *siblings = NULL;
+
+      if (shard > 0 && listener->priv->shard_sockets != NULL)
+        siblings = g_hash_table_lookup (listener->priv->shard_sockets, socket);
+      if (siblings != NULL && shard - 1 < siblings->len)
+        socket = siblings->pdata[shard - 1];
+
+      if (!g_socket_is_closed (socket))
+        g_ptr_array_add (sockets, g_object_ref (socket));
+    }
+
+  return sockets;
+}
+
+/*< private >
+ * g_socket_listener_get_socket_source_object:
+ * @listener: a #GSocketListener
+ * @socket: one of the sockets returned by g_socket_listener_dup_shard_sockets()
+ *
+ * Gets the source object which was passed when @socket was added.
+ *
+ * Returns: (transfer none) (nullable): the source object of @socket
+ */
+GObject *
+g_socket_listener_get_socket_source_object (GSocketListener *listener,
+                                            GSocket         *socket)
+{
+  g_return_val_if_fail (G_IS_SOCKET_LISTENER (listener), NULL);
+  g_return_val_if_fail (G_IS_SOCKET (socket), NULL);
+
+  return g_object_get_qdata (G_OBJECT (socket), source_quark);
+}
+
 /**
  * g_socket_listener_add_socket:
  * @listener: a #GSocketListener
@@ -289,6 +472,7 @@ g_socket_listener_add_socket (GSocketListener  *listener,
     g_object_set_qdata_full (G_OBJECT (socket), source_quark,
 			     g_object_ref (source_object), g_object_unref);
 
+  add_shard_sockets (listener, socket);
 
   if (G_SOCKET_LISTENER_GET_CLASS (listener)->changed)
     G_SOCKET_LISTENER_GET_CLASS (listener)->changed (listener);
@@ -360,6 +544,8 @@ g_socket_listener_add_address (GSocketListener  *listener,
   g_signal_emit (listener, signals[EVENT], 0,
                  G_SOCKET_LISTENER_BINDING, socket);
 
+  prepare_shard_socket (listener, socket);
+
   if (!g_socket_bind (socket, address, TRUE, error))
     {
       g_object_unref (socket);
@@ -473,6 +659,8 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_BINDING, socket6);
 
+      prepare_shard_socket (listener, socket6);
+
       if (!g_socket_bind (socket6, address, TRUE, error))
         {
           g_object_unref (address);
@@ -540,6 +728,8 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
           g_signal_emit (listener, signals[EVENT], 0,
                          G_SOCKET_LISTENER_BINDING, socket4);
 
+          prepare_shard_socket (listener, socket4);
+
           if (!g_socket_bind (socket4, address, TRUE, error))
             {
               g_object_unref (address);
@@ -590,10 +780,16 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
   g_assert (socket6 != NULL || socket4 != NULL);
 
   if (socket6 != NULL)
-    g_ptr_array_add (listener->priv->sockets, socket6);
+    {
+      g_ptr_array_add (listener->priv->sockets, socket6);
+      add_shard_sockets (listener, socket6);
+    }
 
   if (socket4 != NULL)
-    g_ptr_array_add (listener->priv->sockets, socket4);
+    {
+      g_ptr_array_add (listener->priv->sockets, socket4);
+      add_shard_sockets (listener, socket4);
+    }
 
   if (G_SOCKET_LISTENER_GET_CLASS (listener)->changed)
     G_SOCKET_LISTENER_GET_CLASS (listener)->changed (listener);
@@ -820,6 +1016,11 @@ accept_ready (GSocket      *accept_socket,
 	g_object_set_qdata_full (G_OBJECT (task),
 				 source_quark,
 				 g_object_ref (source_object), g_object_unref);
+
+      /* The connection has been accepted, so it would be lost if a
+       * cancellation racing with this (for example, from
+       * g_socket_service_stop() in another thread) turned it into an error. */
+      g_task_set_check_cancellable (task, FALSE);
       g_task_return_pointer (task, socket, g_object_unref);
     }
   else
@@ -870,13 +1071,21 @@ g_socket_listener_accept_socket_async (GSocketListener     *listener,
 
   data = g_new0 (AcceptSocketAsyncData, 1);
   data->returned_yet = FALSE;
+  g_task_set_task_data (task, data,
+                        (GDestroyNotify) accept_socket_async_data_free);
+
+  /* The sources may be dispatched, and drop their reference to @task, before
+   * add_sources() returns if the context is being iterated in another thread
+   * (for example, when a #GThreadedSocketService restarts accepting from one
+   * of its worker threads). So the task data must already be set, and stay
+   * alive until the sources have been stored in it. */
+  g_object_ref (task);
   data->sources = add_sources (listener,
 			 accept_ready,
 			 task,
 			 cancellable,
 			 g_main_context_get_thread_default ());
-  g_task_set_task_data (task, g_steal_pointer (&data),
-                        (GDestroyNotify) accept_socket_async_data_free);
+  g_object_unref (task);
 }
 
 /**
@@ -1026,7 +1235,27 @@ g_socket_listener_close (GSocketListener *listener)
       socket = listener->priv->sockets->pdata[i];
       g_socket_close (socket, NULL);
     }
+
+  if (listener->priv->shard_sockets != NULL)
+    {
+      GHashTableIter iter;
+      GPtrArray *siblings;
+
+      g_hash_table_iter_init (&iter, listener->priv->shard_sockets);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &siblings))
+        {
+          for (i = 0; i < siblings->len; i++)
+            g_socket_close (siblings->pdata[i], NULL);
+        }
+    }
+
   listener->priv->closed = TRUE;
+
+  /* Shards poll their sockets from other threads, so they must be told to
+   * stop doing that. */
+  if (listener->priv->n_shards > 0 &&
+      G_SOCKET_LISTENER_GET_CLASS (listener)->changed)
+    G_SOCKET_LISTENER_GET_CLASS (listener)->changed (listener);
 }
 
 /**
@@ -1096,6 +1325,8 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
           g_signal_emit (listener, signals[EVENT], 0,
                          G_SOCKET_LISTENER_BINDING, socket6);
 
+          prepare_shard_socket (listener, socket6);
+
           result = g_socket_bind (socket6, address, TRUE, error);
           g_object_unref (address);
 
@@ -1142,6 +1373,8 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_BINDING, socket4);
 
+      prepare_shard_socket (listener, socket4);
+
       /* a note on the 'error' clause below:
        *
        * if candidate_port is 0 then we report the error right away
@@ -1249,6 +1482,7 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
                                  g_object_unref);
 
       g_ptr_array_add (listener->priv->sockets, socket6);
+      add_shard_sockets (listener, socket6);
     }
 
    if (socket4 != NULL)
@@ -1276,6 +1510,7 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
                                  g_object_unref);
 
       g_ptr_array_add (listener->priv->sockets, socket4);
+      add_shard_sockets (listener, socket4);
     }
 
   if ((socket4 != NULL || socket6 != NULL) &&
@@ -45,6 +45,16 @@
  * If you are interested in writing connection handlers that contain
  * blocking code then see [class@Gio.ThreadedSocketService].
  *
+ * A service created with [ctor@Gio.SocketService.new_sharded] accepts
+ * connections on several worker threads instead, each running its own
+ * [struct@GLib.MainContext]. Where the platform supports `SO_REUSEPORT`, each
+ * worker listens on its own copy of every socket added by the
+ * [class@Gio.SocketListener] APIs, so that the kernel distributes incoming
+ * connections between the workers. Other sockets are shared by all the
+ * workers. The [signal@Gio.SocketService::incoming] signal is then emitted
+ * on the worker thread which accepted the connection, with the worker’s
+ * context as the thread-default main context.
+ *
  * The socket service runs on the main loop of the 
  * thread-default context (see
  * [method@GLib.MainContext.push_thread_default]) of the thread it is
@@ -60,15 +70,30 @@
 
 #include <gio/gio.h>
 #include "gsocketlistener.h"
+#include "gsocketlistener-private.h"
 #include "gsocketconnection.h"
 #include "glibintl.h"
 #include "gmarshal-internal.h"
 
+typedef struct
+{
+  GWeakRef service;  /* (element-type GSocketService) */
+  GMainContext *context;  /* (owned) */
+  GThread *thread;  /* (owned by the service) */
+  gint stopping;  /* (atomic) */
+  GPtrArray *sources;  /* (owned) (element-type GSource); only used in @thread */
+} ShardWorker;
+
 struct _GSocketServicePrivate
 {
   GCancellable *cancellable;
   guint active : 1;
   guint outstanding_accept : 1;
+
+  /* Only set for sharded services */
+  guint n_workers;
+  ShardWorker **workers;  /* (array length=n_workers) (owned) */
+  GPtrArray **worker_sockets;  /* (array length=n_workers) (owned) (element-type GSocket); protected by active lock */
 };
 
 static guint g_socket_service_incoming_signal;
@@ -80,7 +105,8 @@ G_DEFINE_TYPE_WITH_PRIVATE (GSocketService, g_socket_service, G_TYPE_SOCKET_LIST
 enum
 {
   PROP_0,
-  PROP_ACTIVE
+  PROP_ACTIVE,
+  PROP_N_WORKERS
 };
 
 static void g_socket_service_ready (GObject      *object,
@@ -103,11 +129,222 @@ g_socket_service_init (GSocketService *service)
   service->priv->active = TRUE;
 }
 
+static gboolean g_socket_service_incoming (GSocketService    *service,
+                                           GSocketConnection *connection,
+                                           GObject           *source_object);
+
+static void
+destroy_and_unref_source (GSource *source)
+{
+  g_source_destroy (source);
+  g_source_unref (source);
+}
+
+static gboolean
+shard_worker_accept_cb (GSocket      *accept_socket,
+                        GIOCondition  condition,
+                        gpointer      user_data)
+{
+  ShardWorker *worker = user_data;
+  GSocketService *service;
+  GSocket *socket;
+  GError *error = NULL;
+  gboolean ret = G_SOURCE_CONTINUE;
+
+  service = g_weak_ref_get (&worker->service);
+  if (service == NULL)
+    return G_SOURCE_REMOVE;
+
+  socket = g_socket_accept (accept_socket, NULL, &error);
+  if (socket == NULL)
+    {
+      /* %G_IO_ERROR_WOULD_BLOCK means another worker sharing @accept_socket
+       * accepted the connection first. */
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CLOSED))
+        ret = G_SOURCE_REMOVE;
+      else if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+        g_warning ("fail: %s", error->message);
+      g_error_free (error);
+    }
+  else
+    {
+      GSocketConnection *connection;
+      GObject *source_object;
+
+      connection = g_socket_connection_factory_create_connection (socket);
+      source_object = g_socket_listener_get_socket_source_object (G_SOCKET_LISTENER (service),
+                                                                  accept_socket);
+      g_socket_service_incoming (service, connection, source_object);
+      g_object_unref (connection);
+      g_object_unref (socket);
+    }
+
+  /* This may finalize the service, which is fine from a worker thread. */
+  g_object_unref (service);
+
+  return ret;
+}
+
+typedef struct
+{
+  ShardWorker *worker;  /* (unowned) */
+  GPtrArray *sockets;  /* (owned) (nullable) (element-type GSocket) */
+} ShardUpdate;
+
+static void
+shard_update_free (ShardUpdate *update)
+{
+  g_clear_pointer (&update->sockets, g_ptr_array_unref);
+  g_free (update);
+}
+
+/* Runs in the worker thread, replacing its accept sources. */
+static gboolean
+shard_worker_update_cb (gpointer user_data)
+{
+  ShardUpdate *update = user_data;
+  ShardWorker *worker = update->worker;
+  guint i;
+
+  g_ptr_array_set_size (worker->sources, 0);
+
+  for (i = 0; update->sockets != NULL && i < update->sockets->len; i++)
+    {
+      GSocket *socket = update->sockets->pdata[i];
+      GSource *source;
+
+      /* The listener may have been closed since this update was queued; a
+       * further update without its sockets will follow. */
+      if (g_socket_is_closed (socket))
+        continue;
+
+      source = g_socket_create_source (socket, G_IO_IN, NULL);
+      g_source_set_callback (source, (GSourceFunc) shard_worker_accept_cb,
+                             worker, NULL);
+      g_source_set_static_name (source, "GSocketService shard");
+      g_source_attach (source, worker->context);
+      g_ptr_array_add (worker->sources, source);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+shard_worker_thread_func (gpointer user_data)
+{
+  ShardWorker *worker = user_data;
+
+  g_main_context_push_thread_default (worker->context);
+
+  while (!g_atomic_int_get (&worker->stopping))
+    g_main_context_iteration (worker->context, TRUE);
+
+  g_ptr_array_unref (worker->sources);
+  g_main_context_pop_thread_default (worker->context);
+
+  /* Any pending updates are freed along with the context. */
+  g_main_context_unref (worker->context);
+  g_weak_ref_clear (&worker->service);
+  g_free (worker);
+
+  return NULL;
+}
+
+static void
+start_workers (GSocketService *service)
+{
+  GSocketServicePrivate *priv = service->priv;
+  guint i;
+
+  g_socket_listener_set_n_shards (G_SOCKET_LISTENER (service), priv->n_workers);
+
+  priv->workers = g_new0 (ShardWorker *, priv->n_workers);
+  priv->worker_sockets = g_new0 (GPtrArray *, priv->n_workers);
+
+  for (i = 0; i < priv->n_workers; i++)
+    {
+      ShardWorker *worker = g_new0 (ShardWorker, 1);
+
+      g_weak_ref_init (&worker->service, service);
+      worker->context = g_main_context_new ();
+      worker->sources = g_ptr_array_new_with_free_func ((GDestroyNotify) destroy_and_unref_source);
+      worker->thread = g_thread_new ("gsocketservice", shard_worker_thread_func, worker);
+
+      priv->workers[i] = worker;
+    }
+}
+
+static void
+stop_workers (GSocketService *service)
+{
+  GSocketServicePrivate *priv = service->priv;
+  guint i;
+
+  for (i = 0; i < priv->n_workers; i++)
+    {
+      ShardWorker *worker = priv->workers[i];
+      GThread *thread = worker->thread;
+      GMainContext *context = g_main_context_ref (worker->context);
+
+      /* @worker is freed by its thread as soon as it sees this. */
+      g_atomic_int_set (&worker->stopping, TRUE);
+      g_main_context_wakeup (context);
+      g_main_context_unref (context);
+
+      /* The last reference to the service may have been dropped from one of
+       * its own workers, which cannot join itself. */
+      if (thread == g_thread_self ())
+        g_thread_unref (thread);
+      else
+        g_thread_join (thread);
+
+      g_clear_pointer (&priv->worker_sockets[i], g_ptr_array_unref);
+    }
+
+  g_clear_pointer (&priv->workers, g_free);
+  g_clear_pointer (&priv->worker_sockets, g_free);
+}
+
+/* Must be called with the active lock held. */
+static void
+update_workers_unlocked (GSocketService *service)
+{
+  GSocketServicePrivate *priv = service->priv;
+  guint i;
+
+  for (i = 0; i < priv->n_workers; i++)
+    {
+      ShardUpdate *update = g_new0 (ShardUpdate, 1);
+
+      update->worker = priv->workers[i];
+      if (priv->active && priv->worker_sockets[i] != NULL)
+        update->sockets = g_ptr_array_ref (priv->worker_sockets[i]);
+
+      g_main_context_invoke_full (update->worker->context, G_PRIORITY_DEFAULT,
+                                  shard_worker_update_cb, update,
+                                  (GDestroyNotify) shard_update_free);
+    }
+}
+
+static void
+g_socket_service_constructed (GObject *object)
+{
+  GSocketService *service = G_SOCKET_SERVICE (object);
+
+  G_OBJECT_CLASS (g_socket_service_parent_class)->constructed (object);
+
+  if (service->priv->n_workers > 0)
+    start_workers (service);
+}
+
 static void
 g_socket_service_finalize (GObject *object)
 {
   GSocketService *service = G_SOCKET_SERVICE (object);
 
+  if (service->priv->workers != NULL)
+    stop_workers (service);
+
   g_object_unref (service->priv->cancellable);
 
   G_OBJECT_CLASS (g_socket_service_parent_class)
@@ -117,6 +354,12 @@ g_socket_service_finalize (GObject *object)
 static void
 do_accept (GSocketService  *service)
 {
+  /* Use a fresh cancellable for each accept rather than resetting the old
+   * one: set_active() may cancel from any thread, and the sources of the
+   * previous accept can still be connected to the old cancellable. */
+  g_clear_object (&service->priv->cancellable);
+  service->priv->cancellable = g_cancellable_new ();
+
   g_socket_listener_accept_async (G_SOCKET_LISTENER (service),
 				  service->priv->cancellable,
 				  g_socket_service_ready, NULL);
@@ -149,7 +392,13 @@ set_active (GSocketService *service, gboolean active)
       service->priv->active = active;
       notify = TRUE;
 
-      if (active)
+      if (service->priv->n_workers > 0)
+        {
+          /* The workers are only started once construction is complete. */
+          if (service->priv->workers != NULL)
+            update_workers_unlocked (service);
+        }
+      else if (active)
         {
           if (service->priv->outstanding_accept)
             g_cancellable_cancel (service->priv->cancellable);
@@ -182,6 +431,9 @@ g_socket_service_get_property (GObject    *object,
     case PROP_ACTIVE:
       g_value_set_boolean (value, get_active (service));
       break;
+    case PROP_N_WORKERS:
+      g_value_set_uint (value, service->priv->n_workers);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -201,6 +453,9 @@ g_socket_service_set_property (GObject      *object,
     case PROP_ACTIVE:
       set_active (service, g_value_get_boolean (value));
       break;
+    case PROP_N_WORKERS:
+      service->priv->n_workers = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -214,7 +469,29 @@ g_socket_service_changed (GSocketListener *listener)
 
   G_LOCK (active);
 
-  if (service->priv->active)
+  if (service->priv->n_workers > 0)
+    {
+      guint i;
+
+      for (i = 0; i < service->priv->n_workers; i++)
+        {
+          GPtrArray *sockets;
+          guint j;
+
+          sockets = g_socket_listener_dup_shard_sockets (listener, i);
+
+          /* Sockets may be shared between workers, and a worker which loses
+           * the race for a connection must not block in g_socket_accept(). */
+          for (j = 0; j < sockets->len; j++)
+            g_socket_set_blocking (sockets->pdata[j], FALSE);
+
+          g_clear_pointer (&service->priv->worker_sockets[i], g_ptr_array_unref);
+          service->priv->worker_sockets[i] = sockets;
+        }
+
+      update_workers_unlocked (service);
+    }
+  else if (service->priv->active)
     {
       if (service->priv->outstanding_accept)
 	g_cancellable_cancel (service->priv->cancellable);
@@ -316,6 +593,7 @@ g_socket_service_class_init (GSocketServiceClass *class)
   GObjectClass *gobject_class = G_OBJECT_CLASS (class);
   GSocketListenerClass *listener_class = G_SOCKET_LISTENER_CLASS (class);
 
+  gobject_class->constructed = g_socket_service_constructed;
   gobject_class->finalize = g_socket_service_finalize;
   gobject_class->set_property = g_socket_service_set_property;
   gobject_class->get_property = g_socket_service_get_property;
@@ -337,6 +615,10 @@ g_socket_service_class_init (GSocketServiceClass *class)
    * @connection will be unreffed once the signal handler returns,
    * so you need to ref it yourself if you are planning to use it.
    *
+   * For services with [property@Gio.SocketService:n-workers] set, this is
+   * emitted on the worker thread which accepted @connection, so handlers
+   * must be thread-safe.
+   *
    * Returns: %TRUE to stop other handlers from being called
    *
    * Since: 2.22
@@ -363,6 +645,22 @@ g_socket_service_class_init (GSocketServiceClass *class)
                                    g_param_spec_boolean ("active", NULL, NULL,
                                                          TRUE,
                                                          G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketService:n-workers:
+   *
+   * The number of worker threads accepting connections, or zero to accept
+   * them on the thread-default main context of the thread the service was
+   * created in.
+   *
+   * See [ctor@Gio.SocketService.new_sharded].
+   *
+   * Since: 2.82
+   */
+  g_object_class_install_property (gobject_class, PROP_N_WORKERS,
+                                   g_param_spec_uint ("n-workers", NULL, NULL,
+                                                      0, G_MAXINT, 0,
+                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -391,8 +689,6 @@ g_socket_service_ready (GObject      *object,
 
   G_LOCK (active);
 
-  g_cancellable_reset (service->priv->cancellable);
-
   /* requeue */
   service->priv->outstanding_accept = FALSE;
   if (service->priv->active)
@@ -421,3 +717,56 @@ g_socket_service_new (void)
 {
   return g_object_new (G_TYPE_SOCKET_SERVICE, NULL);
 }
+
+/**
+ * g_socket_service_new_sharded:
+ * @n_workers: the number of worker threads, or 0 for one per processor
+ *
+ * Creates a new #GSocketService with no sockets to listen for, which accepts
+ * connections on @n_workers threads, each with its own #GMainContext.
+ *
+ * Sockets added afterwards with g_socket_listener_add_address(),
+ * g_socket_listener_add_inet_port() or g_socket_listener_add_any_inet_port()
+ * are duplicated for each worker using `SO_REUSEPORT` where supported, so that
+ * the kernel distributes incoming connections between the workers. Sockets
+ * added with g_socket_listener_add_socket() are duplicated only if
+ * `SO_REUSEPORT` was already enabled on them before binding; otherwise, all
+ * workers accept from the same socket. All listening sockets are put in
+ * non-blocking mode.
+ *
+ * The #GSocketService::incoming signal is emitted on the worker thread which
+ * accepted the connection, with the worker’s main context as the
+ * thread-default one, so asynchronous operations started from the handler
+ * complete on that same worker.
+ *
+ * Returns: a new #GSocketService.
+ *
+ * Since: 2.82
+ */
+GSocketService *
+g_socket_service_new_sharded (guint n_workers)
+{
+  if (n_workers == 0)
+    n_workers = g_get_num_processors ();
+
+  return g_object_new (G_TYPE_SOCKET_SERVICE, "n-workers", n_workers, NULL);
+}
+
+/**
+ * g_socket_service_get_n_workers:
+ * @service: a #GSocketService
+ *
+ * Gets the number of worker threads accepting connections for @service.
+ * See [property@Gio.SocketService:n-workers].
+ *
+ * Returns: the number of workers, or 0 if @service is not sharded
+ *
+ * Since: 2.82
+ */
+guint
+g_socket_service_get_n_workers (GSocketService *service)
+{
+  g_return_val_if_fail (G_IS_SOCKET_SERVICE (service), 0);
+
+  return service->priv->n_workers;
+}
@@ -82,12 +82,16 @@ GType           g_socket_service_get_type  (void);
 
 GIO_AVAILABLE_IN_ALL
 GSocketService *g_socket_service_new       (void);
+GIO_AVAILABLE_IN_2_82
+GSocketService *g_socket_service_new_sharded (guint n_workers);
 GIO_AVAILABLE_IN_ALL
 void            g_socket_service_start     (GSocketService *service);
 GIO_AVAILABLE_IN_ALL
 void            g_socket_service_stop      (GSocketService *service);
 GIO_AVAILABLE_IN_ALL
 gboolean        g_socket_service_is_active (GSocketService *service);
+GIO_AVAILABLE_IN_2_82
+guint           g_socket_service_get_n_workers (GSocketService *service);
 
 
 G_END_DECLS
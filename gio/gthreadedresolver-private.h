@@ -23,9 +23,18 @@
 
 #include <gio/gio.h>
 #include <gio/gresolver.h>
+#include "gthreadedresolver.h"
 
 G_BEGIN_DECLS
 
+GList   *g_threaded_resolver_lookup_records_with_ttl (GThreadedResolver    *self,
+                                                      const gchar          *rrname,
+                                                      GResolverRecordType   record_type,
+                                                      guint32              *ttl,
+                                                      GCancellable         *cancellable,
+                                                      GError              **error);
+guint32  g_threaded_resolver_get_records_ttl         (GAsyncResult         *result);
+
 /* Used for a private test API */
 #ifdef G_OS_UNIX
 /*< private >*/
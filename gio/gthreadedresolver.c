@@ -157,6 +157,7 @@ typedef struct {
     struct {
       char *rrname;
       GResolverRecordType record_type;
+      guint32 ttl;  /* set by the worker thread before the task returns */
     } lookup_records;
   };
 
@@ -217,6 +218,7 @@ lookup_data_new_records (const gchar         *rrname,
   g_mutex_init (&data->lock);
   data->lookup_records.rrname = g_strdup (rrname);
   data->lookup_records.record_type = record_type;
+  data->lookup_records.ttl = G_MAXUINT32;
   return g_steal_pointer (&data);
 }
 
@@ -934,18 +936,20 @@ g_resolver_record_type_to_rrtype (GResolverRecordType type)
   g_return_val_if_reached (-1);
 }
 
-GList *
-g_resolver_records_from_res_query (const gchar      *rrname,
-                                   gint              rrtype,
-                                   const guint8     *answer,
-                                   gssize            len,
-                                   gint              herr,
-                                   GError          **error)
+static GList *
+records_from_res_query (const gchar      *rrname,
+                        gint              rrtype,
+                        const guint8     *answer,
+                        gssize            len,
+                        gint              herr,
+                        guint32          *ttl_out,
+                        GError          **error)
 {
   uint16_t count;
   gchar namebuf[1024];
   const guint8 *end, *p;
   guint16 type, qclass, rdlength;
+  guint32 ttl, min_ttl = G_MAXUINT32;
   const HEADER *header;
   GList *records;
   GVariant *record;
@@ -1037,7 +1041,7 @@ g_resolver_records_from_res_query (const gchar      *rrname,
       p += expand_result;
       GETSHORT (type, p);
       GETSHORT (qclass, p);
-      p += 4; /* ignore the ttl (type=long) value */
+      GETLONG (ttl, p);
       GETSHORT (rdlength, p);
 
       if (end - p < rdlength)
@@ -1079,7 +1083,10 @@ g_resolver_records_from_res_query (const gchar      *rrname,
         }
 
       if (record != NULL)
-        records = g_list_prepend (records, g_variant_ref_sink (record));
+        {
+          records = g_list_prepend (records, g_variant_ref_sink (record));
+          min_ttl = MIN (min_ttl, ttl);
+        }
 
       if (parsing_error != NULL)
         break;
@@ -1099,7 +1106,22 @@ g_resolver_records_from_res_query (const gchar      *rrname,
       return NULL;
     }
   else
-    return records;
+    {
+      if (ttl_out != NULL)
+        *ttl_out = min_ttl;
+      return records;
+    }
+}
+
+GList *
+g_resolver_records_from_res_query (const gchar      *rrname,
+                                   gint              rrtype,
+                                   const guint8     *answer,
+                                   gssize            len,
+                                   gint              herr,
+                                   GError          **error)
+{
+  return records_from_res_query (rrname, rrtype, answer, len, herr, NULL, error);
 }
 
 #elif defined(G_OS_WIN32)
@@ -1181,11 +1203,13 @@ g_resolver_records_from_DnsQuery (const gchar  *rrname,
                                   WORD          dnstype,
                                   DNS_STATUS    status,
                                   DNS_RECORDA  *results,
+                                  guint32      *ttl_out,
                                   GError      **error)
 {
   DNS_RECORDA *rec;
   gpointer record;
   GList *records;
+  guint32 min_ttl = G_MAXUINT32;
 
   if (status != ERROR_SUCCESS)
     {
@@ -1236,7 +1260,10 @@ g_resolver_records_from_DnsQuery (const gchar  *rrname,
           break;
         }
       if (record != NULL)
-        records = g_list_prepend (records, g_variant_ref_sink (record));
+        {
+          records = g_list_prepend (records, g_variant_ref_sink (record));
+          min_ttl = MIN (min_ttl, rec->dwTtl);
+        }
     }
 
   if (records == NULL)
@@ -1247,7 +1274,11 @@ g_resolver_records_from_DnsQuery (const gchar  *rrname,
       return NULL;
     }
   else
-    return records;
+    {
+      if (ttl_out != NULL)
+        *ttl_out = min_ttl;
+      return records;
+    }
 }
 
 #endif
@@ -1270,6 +1301,7 @@ int res_query(const char *, int, int, u_char *, int);
 static GList *
 do_lookup_records (const gchar          *rrname,
                    GResolverRecordType   record_type,
+                   guint32              *ttl,
                    GCancellable         *cancellable,
                    GError              **error)
 {
@@ -1325,7 +1357,7 @@ do_lookup_records (const gchar          *rrname,
     }
 
   herr = h_errno;
-  records = g_resolver_records_from_res_query (rrname, rrtype, answer->data, len, herr, error);
+  records = records_from_res_query (rrname, rrtype, answer->data, len, herr, ttl, error);
   g_byte_array_free (answer, TRUE);
 
 #ifdef HAVE_RES_NQUERY
@@ -1355,7 +1387,7 @@ do_lookup_records (const gchar          *rrname,
 
   dnstype = g_resolver_record_type_to_dnstype (record_type);
   status = DnsQuery_UTF8 (rrname, dnstype, DNS_QUERY_STANDARD, NULL, (PDNS_RECORD_UTF8_*)&results, NULL);
-  records = g_resolver_records_from_DnsQuery (rrname, dnstype, status, results, error);
+  records = g_resolver_records_from_DnsQuery (rrname, dnstype, status, results, ttl, error);
   if (results != NULL)
     DnsRecordListFree (results, DnsFreeRecordList);
 
@@ -1364,33 +1396,47 @@ do_lookup_records (const gchar          *rrname,
   return g_steal_pointer (&records);
 }
 
-static GList *
-lookup_records (GResolver              *resolver,
-                const gchar            *rrname,
-                GResolverRecordType     record_type,
-                GCancellable           *cancellable,
-                GError                **error)
+GList *
+g_threaded_resolver_lookup_records_with_ttl (GThreadedResolver    *self,
+                                             const gchar          *rrname,
+                                             GResolverRecordType   record_type,
+                                             guint32              *ttl,
+                                             GCancellable         *cancellable,
+                                             GError              **error)
 {
-  GThreadedResolver *self = G_THREADED_RESOLVER (resolver);
   GTask *task;
   GList *records;
   LookupData *data = NULL;
 
-  task = g_task_new (resolver, cancellable, NULL, NULL);
-  g_task_set_source_tag (task, lookup_records);
+  task = g_task_new (self, cancellable, NULL, NULL);
+  g_task_set_source_tag (task, g_threaded_resolver_lookup_records_with_ttl);
   g_task_set_name (task, "[gio] resolver lookup records");
 
   data = lookup_data_new_records (rrname, record_type);
-  g_task_set_task_data (task, g_steal_pointer (&data), (GDestroyNotify) lookup_data_free);
+  g_task_set_task_data (task, data, (GDestroyNotify) lookup_data_free);
 
   run_task_in_thread_pool_sync (self, task);
 
   records = g_task_propagate_pointer (task, error);
+  if (records != NULL && ttl != NULL)
+    *ttl = data->lookup_records.ttl;
   g_object_unref (task);
 
   return records;
 }
 
+static GList *
+lookup_records (GResolver              *resolver,
+                const gchar            *rrname,
+                GResolverRecordType     record_type,
+                GCancellable           *cancellable,
+                GError                **error)
+{
+  return g_threaded_resolver_lookup_records_with_ttl (G_THREADED_RESOLVER (resolver),
+                                                      rrname, record_type, NULL,
+                                                      cancellable, error);
+}
+
 static void
 lookup_records_async (GResolver           *resolver,
                       const char          *rrname,
@@ -1425,6 +1471,22 @@ lookup_records_finish (GResolver     *resolver,
   return g_task_propagate_pointer (G_TASK (result), error);
 }
 
+/* Returns the smallest TTL of the records returned by a successful
+ * lookup_records_async() call, or %G_MAXUINT32 if it is not known. */
+guint32
+g_threaded_resolver_get_records_ttl (GAsyncResult *result)
+{
+  LookupData *data;
+
+  if (!G_IS_TASK (result) ||
+      !g_async_result_is_tagged (result, lookup_records_async))
+    return G_MAXUINT32;
+
+  data = g_task_get_task_data (G_TASK (result));
+
+  return data->lookup_records.ttl;
+}
+
 /* Will be called in the GLib worker thread, so must lock all accesses to shared
  * data. */
 static gboolean
@@ -1622,6 +1684,7 @@ threaded_resolver_worker_cb (gpointer task_data,
     {
       GList *records = do_lookup_records (data->lookup_records.rrname,
                                           data->lookup_records.record_type,
+                                          &data->lookup_records.ttl,
                                           cancellable,
                                           &local_error);
 
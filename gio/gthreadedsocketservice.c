@@ -42,12 +42,22 @@
  * [signal@Gio.ThreadedSocketService::run], or subclass and override the default
  * handler.
  *
+ * Handlers for protocols with long-lived but mostly idle connections can
+ * avoid tying up a thread for each of them by calling
+ * [method@Gio.ThreadedSocketService.park_connection] and returning once they
+ * have processed all the data which is currently available. The service then
+ * watches the connection without using a thread, and emits
+ * [signal@Gio.ThreadedSocketService::run] again on a worker thread when more
+ * data arrives, or when [method@Gio.ThreadedSocketService.resume_connection]
+ * is called because the application has queued work for it.
+ *
  * Since: 2.22
  */
 
 #include "config.h"
 #include "gsocketconnection.h"
 #include "gthreadedsocketservice.h"
+#include "glib-private.h"
 #include "glibintl.h"
 #include "gmarshal-internal.h"
 
@@ -56,6 +66,10 @@ struct _GThreadedSocketServicePrivate
   GThreadPool *thread_pool;
   int max_threads;
   gint job_count;
+
+  GMutex parked_lock;
+  GHashTable *parked;  /* (owned) (nullable) (element-type GSocketConnection ParkedEntry); protected by parked_lock */
+  GHashTable *running;  /* (owned) (element-type GSocketConnection); connections in ::run, protected by parked_lock */
 };
 
 static guint g_threaded_socket_service_run_signal;
@@ -71,6 +85,8 @@ typedef enum
 
 G_LOCK_DEFINE_STATIC(job_count);
 
+static GQuark source_object_quark = 0;
+
 typedef struct
 {
   GThreadedSocketService *service;  /* (owned) */
@@ -78,6 +94,27 @@ typedef struct
   GObject *source_object;  /* (owned) (nullable) */
 } GThreadedSocketServiceData;
 
+/* A connection parked by g_threaded_socket_service_park_connection(). Its
+ * source is only attached once ::run has returned for it, so that it is
+ * never dispatched twice at the same time. */
+typedef struct
+{
+  GSource *source;  /* (owned) */
+  gboolean resume;  /* resumed before ::run returned */
+} ParkedEntry;
+
+static void
+parked_entry_free (ParkedEntry *entry)
+{
+  g_source_destroy (entry->source);
+  g_source_unref (entry->source);
+  g_free (entry);
+}
+
+static void g_threaded_socket_service_dispatch (GThreadedSocketService *threaded,
+                                                GSocketConnection      *connection,
+                                                GObject                *source_object);
+
 static void
 g_threaded_socket_service_data_free (GThreadedSocketServiceData *data)
 {
@@ -92,11 +129,37 @@ g_threaded_socket_service_func (gpointer job_data,
                                 gpointer user_data)
 {
   GThreadedSocketServiceData *data = job_data;
+  GThreadedSocketServicePrivate *priv = data->service->priv;
+  ParkedEntry *entry = NULL;
+  gboolean resume = FALSE;
   gboolean result;
 
+  g_mutex_lock (&priv->parked_lock);
+  g_hash_table_add (priv->running, data->connection);
+  g_mutex_unlock (&priv->parked_lock);
+
   g_signal_emit (data->service, g_threaded_socket_service_run_signal,
                  0, data->connection, data->source_object, &result);
 
+  /* Now that ::run is over, start watching the connection if it was parked,
+   * or run it again straight away if it was resumed meanwhile. */
+  g_mutex_lock (&priv->parked_lock);
+  g_hash_table_remove (priv->running, data->connection);
+  if (priv->parked != NULL)
+    entry = g_hash_table_lookup (priv->parked, data->connection);
+  if (entry != NULL && entry->resume)
+    {
+      g_hash_table_remove (priv->parked, data->connection);
+      resume = TRUE;
+    }
+  else if (entry != NULL)
+    g_source_attach (entry->source, GLIB_PRIVATE_CALL (g_get_worker_context) ());
+  g_mutex_unlock (&priv->parked_lock);
+
+  if (resume)
+    g_threaded_socket_service_dispatch (data->service, data->connection,
+                                        data->source_object);
+
   G_LOCK (job_count);
   if (data->service->priv->job_count-- == data->service->priv->max_threads)
     g_socket_service_start (G_SOCKET_SERVICE (data->service));
@@ -105,17 +168,15 @@ g_threaded_socket_service_func (gpointer job_data,
   g_threaded_socket_service_data_free (data);
 }
 
-static gboolean
-g_threaded_socket_service_incoming (GSocketService    *service,
-                                    GSocketConnection *connection,
-                                    GObject           *source_object)
+/* Queues a job emitting ::run for @connection on the thread pool. */
+static void
+g_threaded_socket_service_dispatch (GThreadedSocketService *threaded,
+                                    GSocketConnection      *connection,
+                                    GObject                *source_object)
 {
-  GThreadedSocketService *threaded;
   GThreadedSocketServiceData *data;
   GError *local_error = NULL;
 
-  threaded = G_THREADED_SOCKET_SERVICE (service);
-
   data = g_slice_new0 (GThreadedSocketServiceData);
   data->service = g_object_ref (threaded);
   data->connection = g_object_ref (connection);
@@ -123,7 +184,7 @@ g_threaded_socket_service_incoming (GSocketService    *service,
 
   G_LOCK (job_count);
   if (++threaded->priv->job_count == threaded->priv->max_threads)
-    g_socket_service_stop (service);
+    g_socket_service_stop (G_SOCKET_SERVICE (threaded));
   G_UNLOCK (job_count);
 
   if (!g_thread_pool_push (threaded->priv->thread_pool, data, &local_error))
@@ -133,15 +194,82 @@ g_threaded_socket_service_incoming (GSocketService    *service,
     }
 
   g_clear_error (&local_error);
+}
+
+static gboolean
+g_threaded_socket_service_incoming (GSocketService    *service,
+                                    GSocketConnection *connection,
+                                    GObject           *source_object)
+{
+  /* Remembered in case the connection gets parked and dispatched again */
+  if (source_object != NULL)
+    g_object_set_qdata_full (G_OBJECT (connection), source_object_quark,
+                             g_object_ref (source_object), g_object_unref);
+
+  g_threaded_socket_service_dispatch (G_THREADED_SOCKET_SERVICE (service),
+                                      connection, source_object);
 
   return FALSE;
 }
 
+typedef struct
+{
+  GWeakRef service;  /* (element-type GThreadedSocketService) */
+  GSocketConnection *connection;  /* (owned) */
+} ParkedConnection;
+
+static void
+parked_connection_free (ParkedConnection *parked)
+{
+  g_weak_ref_clear (&parked->service);
+  g_clear_object (&parked->connection);
+  g_free (parked);
+}
+
+/* Runs in the GLib worker thread. */
+static gboolean
+parked_connection_ready_cb (GSocket      *socket,
+                            GIOCondition  condition,
+                            gpointer      user_data)
+{
+  ParkedConnection *parked = user_data;
+  GThreadedSocketService *service;
+  ParkedEntry *entry;
+  gboolean still_parked = FALSE;
+
+  service = g_weak_ref_get (&parked->service);
+  if (service == NULL)
+    return G_SOURCE_REMOVE;
+
+  /* The connection may have been resumed concurrently, in which case its
+   * source has been destroyed already. */
+  g_mutex_lock (&service->priv->parked_lock);
+  entry = (service->priv->parked != NULL) ?
+    g_hash_table_lookup (service->priv->parked, parked->connection) : NULL;
+  if (entry != NULL && entry->source == g_main_current_source ())
+    {
+      g_hash_table_remove (service->priv->parked, parked->connection);
+      still_parked = TRUE;
+    }
+  g_mutex_unlock (&service->priv->parked_lock);
+
+  if (still_parked)
+    g_threaded_socket_service_dispatch (service, parked->connection,
+                                        g_object_get_qdata (G_OBJECT (parked->connection),
+                                                            source_object_quark));
+
+  g_object_unref (service);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 g_threaded_socket_service_init (GThreadedSocketService *service)
 {
   service->priv = g_threaded_socket_service_get_instance_private (service);
   service->priv->max_threads = 10;
+  g_mutex_init (&service->priv->parked_lock);
+  service->priv->running = g_hash_table_new (NULL, NULL);
 }
 
 static void
@@ -167,6 +295,14 @@ g_threaded_socket_service_finalize (GObject *object)
    * this should only be called once the pool is empty: */
   g_thread_pool_free (service->priv->thread_pool, FALSE, FALSE);
 
+  /* Parked connections do not hold a reference to the service, and are
+   * dropped with it. */
+  g_mutex_lock (&service->priv->parked_lock);
+  g_clear_pointer (&service->priv->parked, g_hash_table_unref);
+  g_clear_pointer (&service->priv->running, g_hash_table_unref);
+  g_mutex_unlock (&service->priv->parked_lock);
+  g_mutex_clear (&service->priv->parked_lock);
+
   G_OBJECT_CLASS (g_threaded_socket_service_parent_class)
     ->finalize (object);
 }
@@ -234,6 +370,11 @@ g_threaded_socket_service_class_init (GThreadedSocketServiceClass *class)
    * @connection and may perform blocking IO. The signal handler need
    * not return until the connection is closed.
    *
+   * Alternatively, the handler may call
+   * g_threaded_socket_service_park_connection() and return as soon as it
+   * has nothing left to do, in which case ::run is emitted again for
+   * @connection once it becomes readable.
+   *
    * Returns: %TRUE to stop further signal handlers from being called
    */
   g_threaded_socket_service_run_signal =
@@ -247,6 +388,8 @@ g_threaded_socket_service_class_init (GThreadedSocketServiceClass *class)
 			      G_TYPE_FROM_CLASS (class),
 			      _g_cclosure_marshal_BOOLEAN__OBJECT_OBJECTv);
 
+  source_object_quark = g_quark_from_static_string ("g-threaded-socket-service-source-object");
+
   /**
    * GThreadedSocketService:max-threads:
    *
@@ -281,3 +424,126 @@ g_threaded_socket_service_new (int max_threads)
 		       "max-threads", max_threads,
 		       NULL);
 }
+
+/**
+ * g_threaded_socket_service_park_connection:
+ * @service: a #GThreadedSocketService
+ * @connection: a #GSocketConnection accepted by @service
+ *
+ * Hands @connection back to @service until it has data to read, so that the
+ * [signal@Gio.ThreadedSocketService::run] handler for it can return without
+ * closing it, and the worker thread can serve other connections meanwhile.
+ *
+ * Once the socket of @connection becomes readable (including when the peer
+ * closes it), or g_threaded_socket_service_resume_connection() is called,
+ * [signal@Gio.ThreadedSocketService::run] is emitted again for @connection
+ * on a worker thread. That handler should read everything available, and
+ * then either park @connection again or close it.
+ *
+ * This is typically called by the [signal@Gio.ThreadedSocketService::run]
+ * handler just before it returns. If it is called from within
+ * [signal@Gio.ThreadedSocketService::run], @connection is only watched once
+ * all the handlers have returned, so it is never handled twice at the same
+ * time. Parked connections do not count towards
+ * [property@Gio.ThreadedSocketService:max-threads], and are dropped if
+ * @service is finalized.
+ *
+ * Since: 2.82
+ */
+void
+g_threaded_socket_service_park_connection (GThreadedSocketService *service,
+                                           GSocketConnection      *connection)
+{
+  ParkedConnection *parked;
+  ParkedEntry *entry;
+  GSource *source;
+
+  g_return_if_fail (G_IS_THREADED_SOCKET_SERVICE (service));
+  g_return_if_fail (G_IS_SOCKET_CONNECTION (connection));
+
+  parked = g_new0 (ParkedConnection, 1);
+  g_weak_ref_init (&parked->service, service);
+  parked->connection = g_object_ref (connection);
+
+  source = g_socket_create_source (g_socket_connection_get_socket (connection),
+                                   G_IO_IN | G_IO_HUP | G_IO_ERR, NULL);
+  g_source_set_callback (source, (GSourceFunc) parked_connection_ready_cb,
+                         parked, (GDestroyNotify) parked_connection_free);
+  g_source_set_static_name (source, "GThreadedSocketService parked connection");
+
+  g_mutex_lock (&service->priv->parked_lock);
+
+  if (service->priv->parked == NULL)
+    service->priv->parked = g_hash_table_new_full (NULL, NULL, NULL,
+                                                   (GDestroyNotify) parked_entry_free);
+
+  if (g_hash_table_contains (service->priv->parked, connection))
+    {
+      g_mutex_unlock (&service->priv->parked_lock);
+      g_critical ("%s: connection %p is already parked", G_STRFUNC, connection);
+      g_source_unref (source);
+      return;
+    }
+
+  entry = g_new0 (ParkedEntry, 1);
+  entry->source = source;
+  g_hash_table_insert (service->priv->parked, connection, entry);
+
+  /* Otherwise the source is attached once ::run has returned */
+  if (!g_hash_table_contains (service->priv->running, connection))
+    g_source_attach (source, GLIB_PRIVATE_CALL (g_get_worker_context) ());
+
+  g_mutex_unlock (&service->priv->parked_lock);
+}
+
+/**
+ * g_threaded_socket_service_resume_connection:
+ * @service: a #GThreadedSocketService
+ * @connection: a #GSocketConnection
+ *
+ * Emits [signal@Gio.ThreadedSocketService::run] for @connection on a worker
+ * thread as soon as possible, if it is currently parked by
+ * g_threaded_socket_service_park_connection(), without waiting for it to
+ * become readable. This is useful when the application has queued work for
+ * @connection, such as data to send.
+ *
+ * Returns: %TRUE if @connection was parked, %FALSE otherwise
+ *
+ * Since: 2.82
+ */
+gboolean
+g_threaded_socket_service_resume_connection (GThreadedSocketService *service,
+                                             GSocketConnection      *connection)
+{
+  ParkedEntry *entry = NULL;
+  gboolean was_parked = FALSE;
+  gboolean dispatch = FALSE;
+
+  g_return_val_if_fail (G_IS_THREADED_SOCKET_SERVICE (service), FALSE);
+  g_return_val_if_fail (G_IS_SOCKET_CONNECTION (connection), FALSE);
+
+  g_mutex_lock (&service->priv->parked_lock);
+  if (service->priv->parked != NULL)
+    entry = g_hash_table_lookup (service->priv->parked, connection);
+  if (entry != NULL)
+    {
+      was_parked = TRUE;
+
+      /* If ::run is still in progress, it is emitted again once it returns */
+      if (g_hash_table_contains (service->priv->running, connection))
+        entry->resume = TRUE;
+      else
+        {
+          g_hash_table_remove (service->priv->parked, connection);
+          dispatch = TRUE;
+        }
+    }
+  g_mutex_unlock (&service->priv->parked_lock);
+
+  if (dispatch)
+    g_threaded_socket_service_dispatch (service, connection,
+                                        g_object_get_qdata (G_OBJECT (connection),
+                                                            source_object_quark));
+
+  return was_parked;
+}
@@ -78,6 +78,13 @@ GType                   g_threaded_socket_service_get_type              (void);
 GIO_AVAILABLE_IN_ALL
 GSocketService *        g_threaded_socket_service_new                   (int max_threads);
 
+GIO_AVAILABLE_IN_2_82
+void                    g_threaded_socket_service_park_connection       (GThreadedSocketService *service,
+                                                                         GSocketConnection      *connection);
+GIO_AVAILABLE_IN_2_82
+gboolean                g_threaded_socket_service_resume_connection     (GThreadedSocketService *service,
+                                                                         GSocketConnection      *connection);
+
 G_END_DECLS
 
 #endif /* __G_THREADED_SOCKET_SERVICE_H__ */
@@ -0,0 +1,290 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2024 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * GUdpSegmentMessage:
+ *
+ * This [class@Gio.SocketControlMessage] carries the segment size used for
+ * UDP segmentation offload (GSO) and receive coalescing (GRO).
+ *
+ * When sent with [method@Gio.Socket.send_message] or
+ * [method@Gio.Socket.send_messages] on a UDP socket, the data of the message
+ * is split by the kernel (or the network card) into datagrams of
+ * [property@Gio.UdpSegmentMessage:segment-size] bytes each, the last one
+ * possibly being shorter. This allows sending many datagrams to the same
+ * destination with a single system call.
+ *
+ * Conversely, if the `UDP_GRO` option is enabled on a UDP socket with
+ * [method@Gio.Socket.set_option], the kernel may coalesce several received
+ * datagrams into one buffer. Such buffers are returned by
+ * [method@Gio.Socket.receive_message] along with a `GUdpSegmentMessage`
+ * giving the size of the original datagrams.
+ *
+ * This is currently only supported on Linux; see
+ * [func@Gio.UdpSegmentMessage.is_supported].
+ *
+ * Since: 2.82
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gudpsegmentmessage.h"
+#include "gnetworking.h"
+
+#ifdef __linux__
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#define G_UDP_SEGMENT_MESSAGE_SUPPORTED 1
+#else
+#define G_UDP_SEGMENT_MESSAGE_SUPPORTED 0
+#endif
+
+struct _GUdpSegmentMessage
+{
+  GSocketControlMessage parent_instance;
+
+  guint segment_size;
+};
+
+typedef GSocketControlMessageClass GUdpSegmentMessageClass;
+
+enum
+{
+  PROP_0,
+  PROP_SEGMENT_SIZE
+};
+
+G_DEFINE_TYPE (GUdpSegmentMessage, g_udp_segment_message, G_TYPE_SOCKET_CONTROL_MESSAGE)
+
+static gsize
+g_udp_segment_message_get_size (GSocketControlMessage *message)
+{
+#if G_UDP_SEGMENT_MESSAGE_SUPPORTED
+  return sizeof (guint16);
+#else
+  return 0;
+#endif
+}
+
+static int
+g_udp_segment_message_get_level (GSocketControlMessage *message)
+{
+#if G_UDP_SEGMENT_MESSAGE_SUPPORTED
+  return IPPROTO_UDP;
+#else
+  return 0;
+#endif
+}
+
+static int
+g_udp_segment_message_get_msg_type (GSocketControlMessage *message)
+{
+#if G_UDP_SEGMENT_MESSAGE_SUPPORTED
+  return UDP_SEGMENT;
+#else
+  return 0;
+#endif
+}
+
+static GSocketControlMessage *
+g_udp_segment_message_deserialize (gint     level,
+                                   gint     type,
+                                   gsize    size,
+                                   gpointer data)
+{
+#if G_UDP_SEGMENT_MESSAGE_SUPPORTED
+  if (level != IPPROTO_UDP)
+    return NULL;
+
+  /* The kernel reports coalesced datagrams with an int, while the
+   * segment size is passed to it as a 16-bit value. */
+  if (type == UDP_GRO && size == sizeof (int))
+    {
+      int segment_size;
+
+      memcpy (&segment_size, data, sizeof (segment_size));
+      if (segment_size > 0)
+        return g_udp_segment_message_new (segment_size);
+    }
+  else if (type == UDP_SEGMENT && size == sizeof (guint16))
+    {
+      guint16 segment_size;
+
+      memcpy (&segment_size, data, sizeof (segment_size));
+      if (segment_size > 0)
+        return g_udp_segment_message_new (segment_size);
+    }
+#endif
+
+  return NULL;
+}
+
+static void
+g_udp_segment_message_serialize (GSocketControlMessage *_message,
+                                 gpointer               data)
+{
+#if G_UDP_SEGMENT_MESSAGE_SUPPORTED
+  GUdpSegmentMessage *message = G_UDP_SEGMENT_MESSAGE (_message);
+  guint16 segment_size = message->segment_size;
+
+  memcpy (data, &segment_size, sizeof (segment_size));
+#endif
+}
+
+static void
+g_udp_segment_message_init (GUdpSegmentMessage *message)
+{
+}
+
+static void
+g_udp_segment_message_get_property (GObject    *object,
+                                    guint       prop_id,
+                                    GValue     *value,
+                                    GParamSpec *pspec)
+{
+  GUdpSegmentMessage *message = G_UDP_SEGMENT_MESSAGE (object);
+
+  switch (prop_id)
+    {
+    case PROP_SEGMENT_SIZE:
+      g_value_set_uint (value, message->segment_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+g_udp_segment_message_set_property (GObject      *object,
+                                    guint         prop_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  GUdpSegmentMessage *message = G_UDP_SEGMENT_MESSAGE (object);
+
+  switch (prop_id)
+    {
+    case PROP_SEGMENT_SIZE:
+      message->segment_size = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+g_udp_segment_message_class_init (GUdpSegmentMessageClass *class)
+{
+  GSocketControlMessageClass *scm_class;
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (class);
+  gobject_class->get_property = g_udp_segment_message_get_property;
+  gobject_class->set_property = g_udp_segment_message_set_property;
+
+  scm_class = G_SOCKET_CONTROL_MESSAGE_CLASS (class);
+  scm_class->get_size = g_udp_segment_message_get_size;
+  scm_class->get_level = g_udp_segment_message_get_level;
+  scm_class->get_type = g_udp_segment_message_get_msg_type;
+  scm_class->serialize = g_udp_segment_message_serialize;
+  scm_class->deserialize = g_udp_segment_message_deserialize;
+
+  /**
+   * GUdpSegmentMessage:segment-size:
+   *
+   * The size of each datagram, in bytes.
+   *
+   * Since: 2.82
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_SEGMENT_SIZE,
+                                   g_param_spec_uint ("segment-size", NULL, NULL,
+                                                      1, G_MAXUINT16, 1,
+                                                      G_PARAM_READABLE |
+                                                      G_PARAM_WRITABLE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
+}
+
+/**
+ * g_udp_segment_message_is_supported:
+ *
+ * Checks if UDP segmentation offload is supported on this platform. Even
+ * if it is, the running kernel may still reject it, in which case sending
+ * fails.
+ *
+ * Returns: %TRUE if supported, %FALSE otherwise
+ *
+ * Since: 2.82
+ */
+gboolean
+g_udp_segment_message_is_supported (void)
+{
+  return G_UDP_SEGMENT_MESSAGE_SUPPORTED;
+}
+
+/**
+ * g_udp_segment_message_new:
+ * @segment_size: the size of each datagram, in bytes
+ *
+ * Creates a new #GUdpSegmentMessage asking for the data it is sent with to
+ * be split into datagrams of @segment_size bytes.
+ *
+ * Returns: (transfer full): a new #GUdpSegmentMessage
+ *
+ * Since: 2.82
+ */
+GSocketControlMessage *
+g_udp_segment_message_new (guint segment_size)
+{
+  g_return_val_if_fail (segment_size > 0 && segment_size <= G_MAXUINT16, NULL);
+
+  return g_object_new (G_TYPE_UDP_SEGMENT_MESSAGE,
+                       "segment-size", segment_size,
+                       NULL);
+}
+
+/**
+ * g_udp_segment_message_get_segment_size:
+ * @message: a #GUdpSegmentMessage
+ *
+ * Gets the size of each datagram covered by @message.
+ *
+ * Returns: the segment size, in bytes
+ *
+ * Since: 2.82
+ */
+guint
+g_udp_segment_message_get_segment_size (GUdpSegmentMessage *message)
+{
+  g_return_val_if_fail (G_IS_UDP_SEGMENT_MESSAGE (message), 0);
+
+  return message->segment_size;
+}
@@ -0,0 +1,398 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2024 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "mock-resolver.h"
+
+#include <gio/gio.h>
+
+typedef struct {
+  MockResolver *mock;
+  GResolver *resolver;
+} Fixture;
+
+static void
+setup (Fixture       *fixture,
+       gconstpointer  user_data)
+{
+  GInetAddress *address;
+  GList *results;
+
+  fixture->mock = mock_resolver_new ();
+  fixture->resolver = g_caching_resolver_new (G_RESOLVER (fixture->mock));
+
+  address = g_inet_address_new_from_string ("192.0.2.1");
+  results = g_list_append (NULL, address);
+  mock_resolver_set_ipv4_results (fixture->mock, results);
+  g_resolver_free_addresses (results);
+}
+
+static void
+teardown (Fixture       *fixture,
+          gconstpointer  user_data)
+{
+  g_assert_finalize_object (fixture->resolver);
+  g_assert_finalize_object (fixture->mock);
+}
+
+static void
+assert_address (GList *addresses)
+{
+  gchar *str;
+
+  g_assert_cmpuint (g_list_length (addresses), ==, 1);
+  str = g_inet_address_to_string (addresses->data);
+  g_assert_cmpstr (str, ==, "192.0.2.1");
+  g_free (str);
+}
+
+static GList *
+lookup_sync (Fixture     *fixture,
+             const gchar *hostname)
+{
+  GError *error = NULL;
+  GList *addresses;
+
+  addresses = g_resolver_lookup_by_name (fixture->resolver, hostname, NULL, &error);
+  g_assert_no_error (error);
+  assert_address (addresses);
+
+  return addresses;
+}
+
+static void
+test_sync (Fixture       *fixture,
+           gconstpointer  user_data)
+{
+  g_assert_true (g_caching_resolver_get_base_resolver (G_CACHING_RESOLVER (fixture->resolver)) ==
+                 G_RESOLVER (fixture->mock));
+
+  g_resolver_free_addresses (lookup_sync (fixture, "example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 1);
+
+  /* Names are case-insensitive. */
+  g_resolver_free_addresses (lookup_sync (fixture, "example.com"));
+  g_resolver_free_addresses (lookup_sync (fixture, "EXAMPLE.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 1);
+
+  g_resolver_free_addresses (lookup_sync (fixture, "example.org"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 2);
+
+  g_caching_resolver_clear (G_CACHING_RESOLVER (fixture->resolver));
+  g_resolver_free_addresses (lookup_sync (fixture, "example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 3);
+
+  /* Reloading the base resolver invalidates the cache too. */
+  g_signal_emit_by_name (fixture->mock, "reload");
+  g_resolver_free_addresses (lookup_sync (fixture, "example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 4);
+}
+
+static void
+test_max_entries (Fixture       *fixture,
+                  gconstpointer  user_data)
+{
+  g_object_set (fixture->resolver, "max-entries", 2, NULL);
+
+  g_resolver_free_addresses (lookup_sync (fixture, "a.example.com"));
+  g_resolver_free_addresses (lookup_sync (fixture, "b.example.com"));
+  g_resolver_free_addresses (lookup_sync (fixture, "a.example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 2);
+
+  /* b is the least recently used, so it is dropped. */
+  g_resolver_free_addresses (lookup_sync (fixture, "c.example.com"));
+  g_resolver_free_addresses (lookup_sync (fixture, "a.example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 3);
+  g_resolver_free_addresses (lookup_sync (fixture, "b.example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 4);
+
+  g_object_set (fixture->resolver, "max-entries", 0, NULL);
+  g_resolver_free_addresses (lookup_sync (fixture, "b.example.com"));
+  g_resolver_free_addresses (lookup_sync (fixture, "b.example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 6);
+}
+
+static void
+lookup_cb (GObject      *source_object,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  GAsyncResult **result_out = user_data;
+
+  g_assert_null (*result_out);
+  *result_out = g_object_ref (result);
+  g_main_context_wakeup (NULL);
+}
+
+static GList *
+lookup_finish (GResolver     *resolver,
+               GAsyncResult **result,
+               GError       **error)
+{
+  GList *addresses;
+
+  while (*result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  addresses = g_resolver_lookup_by_name_with_flags_finish (resolver, *result, error);
+  g_clear_object (result);
+
+  return addresses;
+}
+
+static void
+test_async_coalesce (Fixture       *fixture,
+                     gconstpointer  user_data)
+{
+  GAsyncResult *results[3] = { NULL, };
+  GCancellable *cancellable;
+  GError *error = NULL;
+  GList *addresses;
+  gsize i;
+
+  mock_resolver_set_ipv4_delay_ms (fixture->mock, 50);
+  cancellable = g_cancellable_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (results); i++)
+    g_resolver_lookup_by_name_with_flags_async (fixture->resolver, "example.com",
+                                                G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                                (i == 0) ? cancellable : NULL,
+                                                lookup_cb, &results[i]);
+
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 1);
+
+  /* Cancelling one of the lookups does not affect the others. */
+  g_cancellable_cancel (cancellable);
+  addresses = lookup_finish (fixture->resolver, &results[0], &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_null (addresses);
+  g_clear_error (&error);
+
+  for (i = 1; i < G_N_ELEMENTS (results); i++)
+    {
+      addresses = lookup_finish (fixture->resolver, &results[i], &error);
+      g_assert_no_error (error);
+      assert_address (addresses);
+      g_resolver_free_addresses (addresses);
+    }
+
+  /* The result was cached. */
+  g_resolver_lookup_by_name_with_flags_async (fixture->resolver, "example.com",
+                                              G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                              NULL, lookup_cb, &results[0]);
+  addresses = lookup_finish (fixture->resolver, &results[0], &error);
+  g_assert_no_error (error);
+  assert_address (addresses);
+  g_resolver_free_addresses (addresses);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 1);
+
+  /* Different flags are a different query. */
+  g_resolver_lookup_by_name_async (fixture->resolver, "example.com",
+                                   NULL, lookup_cb, &results[0]);
+  while (results[0] == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  addresses = g_resolver_lookup_by_name_finish (fixture->resolver, results[0], &error);
+  g_assert_no_error (error);
+  assert_address (addresses);
+  g_resolver_free_addresses (addresses);
+  g_clear_object (&results[0]);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 2);
+
+  g_object_unref (cancellable);
+}
+
+static void
+test_clear_in_flight (Fixture       *fixture,
+                      gconstpointer  user_data)
+{
+  GAsyncResult *results[2] = { NULL, };
+  GError *error = NULL;
+  GList *addresses;
+  gsize i;
+
+  mock_resolver_set_ipv4_delay_ms (fixture->mock, 50);
+
+  /* A lookup started before the cache is cleared is not cached. */
+  g_resolver_lookup_by_name_with_flags_async (fixture->resolver, "example.com",
+                                              G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                              NULL, lookup_cb, &results[0]);
+  g_caching_resolver_clear (G_CACHING_RESOLVER (fixture->resolver));
+  addresses = lookup_finish (fixture->resolver, &results[0], &error);
+  g_assert_no_error (error);
+  assert_address (addresses);
+  g_resolver_free_addresses (addresses);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 1);
+
+  g_resolver_lookup_by_name_with_flags_async (fixture->resolver, "example.com",
+                                              G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                              NULL, lookup_cb, &results[0]);
+  addresses = lookup_finish (fixture->resolver, &results[0], &error);
+  g_assert_no_error (error);
+  g_resolver_free_addresses (addresses);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 2);
+
+  /* Nor does a lookup started after it wait for one started before. */
+  g_caching_resolver_clear (G_CACHING_RESOLVER (fixture->resolver));
+  g_resolver_lookup_by_name_with_flags_async (fixture->resolver, "example.com",
+                                              G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                              NULL, lookup_cb, &results[0]);
+  g_caching_resolver_clear (G_CACHING_RESOLVER (fixture->resolver));
+  g_resolver_lookup_by_name_with_flags_async (fixture->resolver, "example.com",
+                                              G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                              NULL, lookup_cb, &results[1]);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 4);
+
+  for (i = 0; i < G_N_ELEMENTS (results); i++)
+    {
+      addresses = lookup_finish (fixture->resolver, &results[i], &error);
+      g_assert_no_error (error);
+      assert_address (addresses);
+      g_resolver_free_addresses (addresses);
+    }
+
+  /* The second one was cached. */
+  g_resolver_free_addresses (g_resolver_lookup_by_name_with_flags (fixture->resolver, "example.com",
+                                                                   G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                                                   NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 4);
+}
+
+static void
+test_default_base_resolver (void)
+{
+  GResolver *default_resolver;
+  GResolver *resolver;
+
+  default_resolver = g_resolver_get_default ();
+  resolver = g_object_new (G_TYPE_CACHING_RESOLVER, NULL);
+  g_assert_true (g_caching_resolver_get_base_resolver (G_CACHING_RESOLVER (resolver)) ==
+                 default_resolver);
+
+  g_assert_finalize_object (resolver);
+  g_object_unref (default_resolver);
+}
+
+static void
+assert_lookup_error (Fixture     *fixture,
+                     const gchar *hostname,
+                     GQuark       domain,
+                     gint         code)
+{
+  GAsyncResult *result = NULL;
+  GError *error = NULL;
+  GList *addresses;
+
+  g_resolver_lookup_by_name_with_flags_async (fixture->resolver, hostname,
+                                              G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                              NULL, lookup_cb, &result);
+  addresses = lookup_finish (fixture->resolver, &result, &error);
+  g_assert_error (error, domain, code);
+  g_assert_null (addresses);
+  g_clear_error (&error);
+}
+
+static void
+test_negative (Fixture       *fixture,
+               gconstpointer  user_data)
+{
+  GError *error;
+
+  error = g_error_new_literal (G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND, "Not found");
+  mock_resolver_set_ipv4_error (fixture->mock, error);
+  g_clear_error (&error);
+
+  assert_lookup_error (fixture, "example.com", G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+  assert_lookup_error (fixture, "example.com", G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 1);
+
+  /* Other errors are not cached. */
+  error = g_error_new_literal (G_RESOLVER_ERROR, G_RESOLVER_ERROR_TEMPORARY_FAILURE, "Try again");
+  mock_resolver_set_ipv4_error (fixture->mock, error);
+  g_clear_error (&error);
+
+  assert_lookup_error (fixture, "example.org", G_RESOLVER_ERROR, G_RESOLVER_ERROR_TEMPORARY_FAILURE);
+  assert_lookup_error (fixture, "example.org", G_RESOLVER_ERROR, G_RESOLVER_ERROR_TEMPORARY_FAILURE);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 3);
+
+  /* Nor is anything if the negative TTL is zero. */
+  g_object_set (fixture->resolver, "negative-ttl", 0, NULL);
+  error = g_error_new_literal (G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND, "Not found");
+  mock_resolver_set_ipv4_error (fixture->mock, error);
+  g_clear_error (&error);
+
+  assert_lookup_error (fixture, "example.net", G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+  assert_lookup_error (fixture, "example.net", G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 5);
+}
+
+static void
+test_ttl (Fixture       *fixture,
+          gconstpointer  user_data)
+{
+  GError *error;
+
+  /* The mock resolver does not report a TTL, so the default one applies. */
+  g_object_set (fixture->resolver, "default-ttl", 1, "negative-ttl", 1, NULL);
+
+  g_resolver_free_addresses (lookup_sync (fixture, "example.com"));
+  g_resolver_free_addresses (lookup_sync (fixture, "example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 1);
+
+  g_usleep (1100 * G_TIME_SPAN_MILLISECOND);
+
+  /* The entry has expired, so the base resolver is asked again. */
+  g_resolver_free_addresses (lookup_sync (fixture, "example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 2);
+  g_resolver_free_addresses (lookup_sync (fixture, "example.com"));
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 2);
+
+  /* The same goes for negative entries. */
+  error = g_error_new_literal (G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND, "Not found");
+  mock_resolver_set_ipv4_error (fixture->mock, error);
+  g_clear_error (&error);
+
+  assert_lookup_error (fixture, "example.org", G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+  assert_lookup_error (fixture, "example.org", G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 3);
+
+  g_usleep (1100 * G_TIME_SPAN_MILLISECOND);
+
+  assert_lookup_error (fixture, "example.org", G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 4);
+  assert_lookup_error (fixture, "example.org", G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+  g_assert_cmpuint (mock_resolver_get_n_lookups (fixture->mock), ==, 4);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add ("/caching-resolver/sync", Fixture, NULL, setup, test_sync, teardown);
+  g_test_add ("/caching-resolver/max-entries", Fixture, NULL, setup, test_max_entries, teardown);
+  g_test_add ("/caching-resolver/async-coalesce", Fixture, NULL, setup, test_async_coalesce, teardown);
+  g_test_add ("/caching-resolver/negative", Fixture, NULL, setup, test_negative, teardown);
+  g_test_add ("/caching-resolver/ttl", Fixture, NULL, setup, test_ttl, teardown);
+  g_test_add ("/caching-resolver/clear-in-flight", Fixture, NULL, setup, test_clear_in_flight, teardown);
+  g_test_add_func ("/caching-resolver/default-base-resolver", test_default_base_resolver);
+
+  return g_test_run ();
+}
@@ -390,6 +390,173 @@ test_dbus_properties (void)
   g_clear_object (&bus);
 }
 
+static GVariant *
+get_statistics_remotely (GDBusConnection  *remote_connection,
+                         GDBusConnection  *controller_connection,
+                         GError          **error)
+{
+  GAsyncResult *result = NULL;
+  GVariant *reply;
+  GVariant *statistics = NULL;
+
+  g_dbus_connection_call (remote_connection,
+                          g_dbus_connection_get_unique_name (controller_connection),
+                          "/org/gtk/Debugging",
+                          "org.gtk.Debugging",
+                          "GetStatistics",
+                          NULL,
+                          G_VARIANT_TYPE ("(a{sv})"),
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL,
+                          async_result_cb,
+                          &result);
+
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  reply = g_dbus_connection_call_finish (remote_connection, result, error);
+  g_clear_object (&result);
+
+  if (reply != NULL)
+    {
+      g_variant_get (reply, "(@a{sv})", &statistics);
+      g_variant_unref (reply);
+    }
+
+  return statistics;
+}
+
+static void
+test_dbus_statistics (void)
+{
+  GTestDBus *bus;
+  GDBusConnection *controller_connection = NULL;
+  GDBusConnection *remote_connection = NULL;
+  GDebugControllerDBus *controller = NULL;
+  GVariant *statistics = NULL;
+  GVariant *calls = NULL;
+  GVariant *histogram = NULL;
+  GVariantIter iter;
+  GVariant *entry;
+  const guint64 *buckets;
+  gsize n_buckets, i;
+  guint64 histogram_total = 0;
+  guint64 bytes_received = 0;
+  guint32 n_calls = 0, outstanding = 0, errors = 0;
+  gboolean found = FALSE;
+  GError *local_error = NULL;
+  gulong handler_id;
+
+  g_test_summary ("Test reading D-Bus statistics through a #GDebugControllerDBus.");
+
+  bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+  g_test_dbus_up (bus);
+
+  controller_connection = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &local_error);
+  g_assert_no_error (local_error);
+
+  remote_connection = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (bus),
+                                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                              G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                              NULL,
+                                                              NULL,
+                                                              &local_error);
+  g_assert_no_error (local_error);
+
+  controller = g_debug_controller_dbus_new (controller_connection, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_nonnull (controller);
+
+  g_assert_null (g_dbus_connection_get_statistics (controller_connection));
+
+  /* Reading the statistics is denied without an authorisation handler. */
+  statistics = get_statistics_remotely (remote_connection, controller_connection, &local_error);
+  g_assert_error (local_error, G_DBUS_ERROR, G_DBUS_ERROR_ACCESS_DENIED);
+  g_assert_null (statistics);
+  g_dbus_error_strip_remote_error (local_error);
+  g_assert_cmpstr (local_error->message, ==, "Not authorized to get statistics");
+  g_clear_error (&local_error);
+
+  handler_id = g_signal_connect (controller, "authorize", G_CALLBACK (authorize_true_cb), NULL);
+
+  /* Statistics are disabled, so the dictionary is empty. */
+  statistics = get_statistics_remotely (remote_connection, controller_connection, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpuint (g_variant_n_children (statistics), ==, 0);
+  g_clear_pointer (&statistics, g_variant_unref);
+
+  g_dbus_connection_set_statistics_enabled (controller_connection, TRUE);
+
+  /* The first call is finished by the time of the second one, which is still
+   * outstanding when the statistics are gathered. */
+  statistics = get_statistics_remotely (remote_connection, controller_connection, &local_error);
+  g_assert_no_error (local_error);
+  g_clear_pointer (&statistics, g_variant_unref);
+
+  statistics = get_statistics_remotely (remote_connection, controller_connection, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_nonnull (statistics);
+
+  g_assert_true (g_variant_lookup (statistics, "bytes-received", "t", &bytes_received));
+  g_assert_cmpuint (bytes_received, >, 0);
+
+  calls = g_variant_lookup_value (statistics, "incoming-calls", G_VARIANT_TYPE ("aa{sv}"));
+  g_assert_nonnull (calls);
+
+  g_variant_iter_init (&iter, calls);
+  while ((entry = g_variant_iter_next_value (&iter)) != NULL)
+    {
+      const gchar *interface_name = NULL, *member = NULL;
+
+      g_variant_lookup (entry, "interface", "&s", &interface_name);
+      g_variant_lookup (entry, "member", "&s", &member);
+
+      if (g_strcmp0 (interface_name, "org.gtk.Debugging") == 0 &&
+          g_strcmp0 (member, "GetStatistics") == 0)
+        {
+          g_assert_false (found);
+          found = TRUE;
+
+          g_assert_true (g_variant_lookup (entry, "calls", "u", &n_calls));
+          g_assert_true (g_variant_lookup (entry, "outstanding", "u", &outstanding));
+          g_assert_true (g_variant_lookup (entry, "errors", "u", &errors));
+          histogram = g_variant_lookup_value (entry, "latency-histogram", G_VARIANT_TYPE ("at"));
+        }
+
+      g_variant_unref (entry);
+    }
+
+  g_assert_true (found);
+  g_assert_cmpuint (n_calls, ==, 2);
+  g_assert_cmpuint (outstanding, ==, 1);
+  g_assert_cmpuint (errors, ==, 0);
+
+  g_assert_nonnull (histogram);
+  buckets = g_variant_get_fixed_array (histogram, &n_buckets, sizeof (guint64));
+  for (i = 0; i < n_buckets; i++)
+    histogram_total += buckets[i];
+  g_assert_cmpuint (histogram_total, ==, 1);
+
+  g_clear_pointer (&histogram, g_variant_unref);
+  g_clear_pointer (&calls, g_variant_unref);
+  g_clear_pointer (&statistics, g_variant_unref);
+
+  g_dbus_connection_set_statistics_enabled (controller_connection, FALSE);
+  g_assert_null (g_dbus_connection_get_statistics (controller_connection));
+
+  g_signal_handler_disconnect (controller, handler_id);
+
+  g_debug_controller_dbus_stop (controller);
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_finalize_object (controller);
+  g_clear_object (&controller_connection);
+  g_clear_object (&remote_connection);
+
+  g_test_dbus_down (bus);
+  g_clear_object (&bus);
+}
+
 static GLogWriterOutput
 noop_log_writer_cb (GLogLevelFlags   log_level,
                     const GLogField *fields,
@@ -413,6 +580,7 @@ main (int   argc,
   g_test_add_func ("/debug-controller/dbus/basic", test_dbus_basic);
   g_test_add_func ("/debug-controller/dbus/duplicate", test_dbus_duplicate);
   g_test_add_func ("/debug-controller/dbus/properties", test_dbus_properties);
+  g_test_add_func ("/debug-controller/dbus/statistics", test_dbus_statistics);
 
   return g_test_run ();
 }
@@ -891,6 +891,358 @@ test_connection_signal_match_rules (void)
   session_bus_down ();
 }
 
+static void
+test_signal_index_handler (GDBusConnection *connection,
+                           const gchar     *sender_name,
+                           const gchar     *object_path,
+                           const gchar     *interface_name,
+                           const gchar     *signal_name,
+                           GVariant        *parameters,
+                           gpointer         user_data)
+{
+  GString *received = g_object_get_data (G_OBJECT (connection), "received");
+
+  g_string_append_c (received, (gchar) GPOINTER_TO_INT (user_data));
+}
+
+static void
+assert_signal_index_delivery (GDBusConnection *connection,
+                              const gchar     *object_path,
+                              const gchar     *member,
+                              const gchar     *arg0,
+                              const gchar     *expected)
+{
+  GString *received = g_object_get_data (G_OBJECT (connection), "received");
+  GError *error = NULL;
+
+  g_string_truncate (received, 0);
+
+  g_dbus_connection_emit_signal (connection,
+                                 NULL, object_path, "org.gtk.ExampleInterface",
+                                 member, g_variant_new ("(s)", arg0),
+                                 &error);
+  g_assert_no_error (error);
+
+  /* synchronously ping a non-existent method to make sure the signals are dispatched */
+  g_dbus_connection_call_sync (connection, "org.gtk.ExampleInterface", "/", "org.gtk.ExampleInterface",
+                               "Bar", g_variant_new ("()"), G_VARIANT_TYPE_UNIT, G_DBUS_CALL_FLAGS_NONE,
+                               -1, NULL, NULL);
+
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+
+  g_assert_cmpstr (received->str, ==, expected);
+}
+
+/* Subscriptions are indexed by object path, member and arg0. Check that
+ * wildcards and arg0 namespaces still match, and that signals are delivered
+ * in subscription order whichever index bucket the subscriptions are in. */
+static void
+test_connection_signal_index (void)
+{
+  const struct
+    {
+      gchar id;
+      const gchar *object_path;
+      const gchar *member;
+      const gchar *arg0;
+      GDBusSignalFlags flags;
+    }
+  subscriptions[] =
+    {
+      { 'a', "/a", "Foo", NULL, G_DBUS_SIGNAL_FLAGS_NONE },
+      { 'b', NULL, "Foo", "x", G_DBUS_SIGNAL_FLAGS_NONE },
+      { 'c', "/a", NULL, NULL, G_DBUS_SIGNAL_FLAGS_NONE },
+      { 'd', NULL, NULL, "org.gtk", G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE },
+      { 'e', "/b", "Foo", NULL, G_DBUS_SIGNAL_FLAGS_NONE },
+      { 'f', "/a", "Foo", "x", G_DBUS_SIGNAL_FLAGS_NONE },
+      { 'g', NULL, NULL, NULL, G_DBUS_SIGNAL_FLAGS_NONE },
+    };
+  GDBusConnection *con;
+  GString *received;
+  guint ids[G_N_ELEMENTS (subscriptions)];
+  guint unrelated_ids[100];
+  gsize i;
+
+  session_bus_up ();
+  con = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+  received = g_string_new ("");
+  g_object_set_data (G_OBJECT (con), "received", received);
+
+  for (i = 0; i < G_N_ELEMENTS (unrelated_ids); i++)
+    {
+      gchar *object_path = g_strdup_printf ("/unrelated/%" G_GSIZE_FORMAT, i);
+
+      unrelated_ids[i] = g_dbus_connection_signal_subscribe (con,
+                                                             NULL, "org.gtk.ExampleInterface", "Foo", object_path,
+                                                             (i % 2) ? "x" : NULL,
+                                                             G_DBUS_SIGNAL_FLAGS_NONE,
+                                                             test_signal_index_handler,
+                                                             GINT_TO_POINTER ('!'), NULL);
+      g_free (object_path);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (subscriptions); i++)
+    ids[i] = g_dbus_connection_signal_subscribe (con,
+                                                 NULL, "org.gtk.ExampleInterface",
+                                                 subscriptions[i].member,
+                                                 subscriptions[i].object_path,
+                                                 subscriptions[i].arg0,
+                                                 subscriptions[i].flags,
+                                                 test_signal_index_handler,
+                                                 GINT_TO_POINTER (subscriptions[i].id), NULL);
+
+  assert_signal_index_delivery (con, "/a", "Foo", "x", "abcfg");
+  assert_signal_index_delivery (con, "/a", "Foo", "org.gtk.Example", "acdg");
+  assert_signal_index_delivery (con, "/b", "Foo", "x", "beg");
+  assert_signal_index_delivery (con, "/b", "Baz", "y", "g");
+  assert_signal_index_delivery (con, "/c", "Baz", "org.gtk", "dg");
+
+  /* Unsubscribing removes exactly that subscription from its bucket. */
+  g_dbus_connection_signal_unsubscribe (con, ids[0]);
+  g_dbus_connection_signal_unsubscribe (con, ids[5]);
+  assert_signal_index_delivery (con, "/a", "Foo", "x", "bcg");
+
+  for (i = 0; i < G_N_ELEMENTS (ids); i++)
+    if (i != 0 && i != 5)
+      g_dbus_connection_signal_unsubscribe (con, ids[i]);
+  for (i = 0; i < G_N_ELEMENTS (unrelated_ids); i++)
+    g_dbus_connection_signal_unsubscribe (con, unrelated_ids[i]);
+
+  assert_signal_index_delivery (con, "/a", "Foo", "x", "");
+
+  g_object_set_data (G_OBJECT (con), "received", NULL);
+  g_string_free (received, TRUE);
+  g_object_unref (con);
+  session_bus_down ();
+}
+
+static void
+test_large_arrays_handler (GDBusConnection *connection,
+                           const gchar     *sender_name,
+                           const gchar     *object_path,
+                           const gchar     *interface_name,
+                           const gchar     *signal_name,
+                           GVariant        *parameters,
+                           gpointer         user_data)
+{
+  GPtrArray *received = user_data;
+
+  g_ptr_array_add (received, g_variant_ref (parameters));
+}
+
+static GVariant *
+new_large_fixed_array (const GVariantType *element_type,
+                       gsize               element_size,
+                       gsize               n_elements)
+{
+  GVariantType *array_type;
+  GVariant *value;
+  guint8 *data;
+  gsize i;
+
+  data = g_malloc (element_size * n_elements);
+  for (i = 0; i < element_size * n_elements; i++)
+    data[i] = (guint8) (i * 7 + 1);
+
+  array_type = g_variant_type_new_array (element_type);
+  value = g_variant_new_from_data (array_type,
+                                   data, element_size * n_elements, TRUE,
+                                   g_free, data);
+  g_variant_type_free (array_type);
+
+  return value;
+}
+
+/* Large fixed-size arrays are written out by reference to the serialized
+ * body instead of being copied into the message blob, and parsed by
+ * reference to the receive buffer. Check that what arrives is the same, in
+ * both byte orders and with values of every alignment following (and
+ * nesting) the spliced arrays. */
+static void
+test_connection_large_arrays (void)
+{
+  const GDBusMessageByteOrder byte_orders[] =
+    {
+      G_DBUS_MESSAGE_BYTE_ORDER_LITTLE_ENDIAN,
+      G_DBUS_MESSAGE_BYTE_ORDER_BIG_ENDIAN,
+    };
+  GDBusConnection *con;
+  GPtrArray *received;
+  GVariant *body;
+  GVariantBuilder nested;
+  guint subscription_id;
+  gsize i;
+
+  session_bus_up ();
+  con = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+  received = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+
+  subscription_id = g_dbus_connection_signal_subscribe (con,
+                                                        NULL, "org.gtk.ExampleInterface", "Large", "/",
+                                                        NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+                                                        test_large_arrays_handler,
+                                                        received, NULL);
+
+  g_variant_builder_init (&nested, G_VARIANT_TYPE ("aay"));
+  g_variant_builder_add_value (&nested, new_large_fixed_array (G_VARIANT_TYPE_BYTE, 1, 3));
+  g_variant_builder_add_value (&nested, new_large_fixed_array (G_VARIANT_TYPE_BYTE, 1, 10001));
+  g_variant_builder_add_value (&nested, new_large_fixed_array (G_VARIANT_TYPE_BYTE, 1, 5));
+
+  body = g_variant_new ("(@ayu@axs@aay@aqy@at)",
+                        new_large_fixed_array (G_VARIANT_TYPE_BYTE, 1, 256 * 1024 + 3),
+                        42,
+                        new_large_fixed_array (G_VARIANT_TYPE_INT64, 8, 1001),
+                        "after the arrays",
+                        g_variant_builder_end (&nested),
+                        new_large_fixed_array (G_VARIANT_TYPE_UINT16, 2, 4097),
+                        'z',
+                        new_large_fixed_array (G_VARIANT_TYPE_UINT64, 8, 3));
+  g_variant_ref_sink (body);
+
+  for (i = 0; i < G_N_ELEMENTS (byte_orders); i++)
+    {
+      GDBusMessage *message;
+      GError *error = NULL;
+
+      message = g_dbus_message_new_signal ("/", "org.gtk.ExampleInterface", "Large");
+      g_dbus_message_set_byte_order (message, byte_orders[i]);
+      g_dbus_message_set_body (message, body);
+      g_dbus_connection_send_message (con, message, G_DBUS_SEND_MESSAGE_FLAGS_NONE, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (message);
+    }
+
+  while (received->len < G_N_ELEMENTS (byte_orders))
+    g_main_context_iteration (NULL, TRUE);
+
+  for (i = 0; i < received->len; i++)
+    g_assert_true (g_variant_equal (g_ptr_array_index (received, i), body));
+
+  g_dbus_connection_signal_unsubscribe (con, subscription_id);
+  g_ptr_array_unref (received);
+  g_variant_unref (body);
+  g_object_unref (con);
+  session_bus_down ();
+}
+
+/* Every spliced array takes two iovecs; check that a message with far more
+ * large arrays than IOV_MAX / 2 is still written out (by copying the ones
+ * past the splice limit) rather than failing with EMSGSIZE. */
+static void
+test_connection_many_large_arrays (void)
+{
+  GDBusConnection *con;
+  GPtrArray *received;
+  GVariant *body;
+  GVariantBuilder builder;
+  GDBusMessage *message;
+  guint subscription_id;
+  GError *error = NULL;
+  gsize i;
+
+  session_bus_up ();
+  con = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+  received = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+
+  subscription_id = g_dbus_connection_signal_subscribe (con,
+                                                        NULL, "org.gtk.ExampleInterface", "Large", "/",
+                                                        NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+                                                        test_large_arrays_handler,
+                                                        received, NULL);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("aay"));
+  for (i = 0; i < 1200; i++)
+    g_variant_builder_add_value (&builder, new_large_fixed_array (G_VARIANT_TYPE_BYTE, 1, 4096 + i % 3));
+  body = g_variant_ref_sink (g_variant_new ("(@aay)", g_variant_builder_end (&builder)));
+
+  message = g_dbus_message_new_signal ("/", "org.gtk.ExampleInterface", "Large");
+  g_dbus_message_set_body (message, body);
+  g_dbus_connection_send_message (con, message, G_DBUS_SEND_MESSAGE_FLAGS_NONE, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (message);
+
+  while (received->len < 1 && !g_dbus_connection_is_closed (con))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_false (g_dbus_connection_is_closed (con));
+  g_assert_cmpuint (received->len, ==, 1);
+  g_assert_true (g_variant_equal (g_ptr_array_index (received, 0), body));
+
+  g_dbus_connection_signal_unsubscribe (con, subscription_id);
+  g_ptr_array_unref (received);
+  g_variant_unref (body);
+  g_object_unref (con);
+  session_bus_down ();
+}
+
+static void
+test_write_burst_handler (GDBusConnection *connection,
+                          const gchar     *sender_name,
+                          const gchar     *object_path,
+                          const gchar     *interface_name,
+                          const gchar     *signal_name,
+                          GVariant        *parameters,
+                          gpointer         user_data)
+{
+  GArray *received = user_data;
+  guint32 n;
+
+  g_variant_get (parameters, "(u&s)", &n, NULL);
+  g_array_append_val (received, n);
+}
+
+/* Messages queued while a write is in progress are coalesced into a single
+ * write. Check that a burst of them arrives complete and in order, and that
+ * flushing waits for all of them. */
+static void
+test_connection_write_burst (void)
+{
+  const guint32 n_signals = 1000;
+  GDBusConnection *con;
+  GArray *received;
+  guint subscription_id;
+  GError *error = NULL;
+  guint32 n;
+
+  session_bus_up ();
+  con = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+  received = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  subscription_id = g_dbus_connection_signal_subscribe (con,
+                                                        NULL, "org.gtk.ExampleInterface", "Burst", "/",
+                                                        NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+                                                        test_write_burst_handler,
+                                                        received, NULL);
+
+  for (n = 0; n < n_signals; n++)
+    {
+      /* vary the sizes so that batches end at different offsets */
+      gchar *padding = g_strnfill (n % 97, 'x');
+
+      g_dbus_connection_emit_signal (con,
+                                     NULL, "/", "org.gtk.ExampleInterface", "Burst",
+                                     g_variant_new ("(us)", n, padding),
+                                     &error);
+      g_assert_no_error (error);
+      g_free (padding);
+    }
+
+  g_dbus_connection_flush_sync (con, NULL, &error);
+  g_assert_no_error (error);
+
+  while (received->len < n_signals)
+    g_main_context_iteration (NULL, TRUE);
+
+  for (n = 0; n < n_signals; n++)
+    g_assert_cmpuint (g_array_index (received, guint32, n), ==, n);
+
+  g_dbus_connection_signal_unsubscribe (con, subscription_id);
+  g_array_unref (received);
+  g_object_unref (con);
+  session_bus_down ();
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 /* Accessed both from the test code and the filter function (in a worker thread)
@@ -1433,6 +1785,10 @@ main (int   argc,
   g_test_add_func ("/gdbus/connection/send", test_connection_send);
   g_test_add_func ("/gdbus/connection/signals", test_connection_signals);
   g_test_add_func ("/gdbus/connection/signal-match-rules", test_connection_signal_match_rules);
+  g_test_add_func ("/gdbus/connection/signal-index", test_connection_signal_index);
+  g_test_add_func ("/gdbus/connection/large-arrays", test_connection_large_arrays);
+  g_test_add_func ("/gdbus/connection/many-large-arrays", test_connection_many_large_arrays);
+  g_test_add_func ("/gdbus/connection/write-burst", test_connection_write_burst);
   g_test_add_func ("/gdbus/connection/filter", test_connection_filter);
   g_test_add_func ("/gdbus/connection/serials", test_connection_serials);
   g_test_add_func ("/gdbus/connection/cancel", test_connection_cancel);
@@ -1966,6 +1966,347 @@ test_threaded_unregistration (gconstpointer test_data)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  GThread *main_thread;
+  guint wait_for_running;  /* block each call until this many are running */
+  guint running;
+  guint max_running;
+  GArray *order;  /* (element-type guint32) */
+  guint outstanding;
+} DispatchPoolData;
+
+static void
+dispatch_pool_method_call (GDBusConnection       *connection,
+                           const gchar           *sender,
+                           const gchar           *object_path,
+                           const gchar           *interface_name,
+                           const gchar           *method_name,
+                           GVariant              *parameters,
+                           GDBusMethodInvocation *invocation,
+                           gpointer               user_data)
+{
+  DispatchPoolData *data = user_data;
+  gint64 end_time;
+  guint32 n;
+
+  g_assert_true (g_thread_self () != data->main_thread);
+  g_variant_get (parameters, "(u)", &n);
+
+  g_mutex_lock (&data->lock);
+  g_array_append_val (data->order, n);
+  data->running++;
+  data->max_running = MAX (data->max_running, data->running);
+  g_cond_broadcast (&data->cond);
+
+  end_time = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+  while (data->running < data->wait_for_running &&
+         g_cond_wait_until (&data->cond, &data->lock, end_time))
+    ;
+  g_mutex_unlock (&data->lock);
+
+  /* give other calls from the same sender a chance to run concurrently */
+  g_usleep (1000);
+
+  g_mutex_lock (&data->lock);
+  data->running--;
+  g_mutex_unlock (&data->lock);
+
+  g_dbus_method_invocation_return_value (invocation, NULL);
+}
+
+static void
+dispatch_pool_call_cb (GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  DispatchPoolData *data = user_data;
+  GVariant *ret;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), result, &error);
+  g_assert_no_error (error);
+  g_variant_unref (ret);
+
+  data->outstanding--;
+  g_main_context_wakeup (NULL);
+}
+
+static void
+test_dispatch_thread_pool (gconstpointer test_data)
+{
+  gboolean ordered = GPOINTER_TO_INT (test_data);
+  const gchar *xml_data =
+    "<node>"
+    "  <interface name='org.example.Pool'>"
+    "    <method name='Work'>"
+    "      <arg type='u' name='n' direction='in'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+  const GDBusInterfaceVTable vtable = {
+    dispatch_pool_method_call, NULL, NULL, { 0 }
+  };
+  const guint max_threads = 3;
+  const guint n_calls = 12;
+  DispatchPoolData data;
+  GDBusNodeInfo *node_info;
+  GError *error = NULL;
+  guint registration_id;
+  guint i;
+
+  g_test_summary ("Test that method calls can be dispatched to a thread pool "
+                  "with a concurrency limit, optionally ordered per sender");
+
+  memset (&data, 0, sizeof (data));
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+  data.main_thread = g_thread_self ();
+  data.order = g_array_new (FALSE, FALSE, sizeof (guint32));
+  /* all calls come from the same sender, so ordering serializes them */
+  data.wait_for_running = ordered ? 1 : max_threads;
+
+  node_info = g_dbus_node_info_new_for_xml (xml_data, &error);
+  g_assert_no_error (error);
+
+  c = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (c);
+
+  registration_id = g_dbus_connection_register_object (c,
+                                                       "/pool",
+                                                       node_info->interfaces[0],
+                                                       &vtable,
+                                                       &data,
+                                                       NULL,
+                                                       &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (registration_id, >, 0);
+
+  g_assert_false (g_dbus_connection_set_dispatch_thread_pool (c, registration_id + 1000, max_threads,
+                                                              G_DBUS_DISPATCH_FLAGS_NONE));
+  g_assert_true (g_dbus_connection_set_dispatch_thread_pool (c, registration_id, max_threads,
+                                                             ordered ? G_DBUS_DISPATCH_FLAGS_ORDER_PER_SENDER :
+                                                                       G_DBUS_DISPATCH_FLAGS_NONE));
+
+  for (i = 0; i < n_calls; i++)
+    {
+      g_dbus_connection_call (c,
+                              g_dbus_connection_get_unique_name (c),
+                              "/pool",
+                              "org.example.Pool",
+                              "Work",
+                              g_variant_new ("(u)", i),
+                              G_VARIANT_TYPE_UNIT,
+                              G_DBUS_CALL_FLAGS_NONE,
+                              -1,
+                              NULL,
+                              dispatch_pool_call_cb,
+                              &data);
+      data.outstanding++;
+    }
+
+  while (data.outstanding > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (data.order->len, ==, n_calls);
+  if (ordered)
+    {
+      g_assert_cmpuint (data.max_running, ==, 1);
+      for (i = 0; i < n_calls; i++)
+        g_assert_cmpuint (g_array_index (data.order, guint32, i), ==, i);
+    }
+  else
+    {
+      g_assert_cmpuint (data.max_running, ==, max_threads);
+    }
+
+  g_assert_true (g_dbus_connection_unregister_object (c, registration_id));
+  g_object_unref (c);
+  g_dbus_node_info_unref (node_info);
+  g_array_unref (data.order);
+  g_cond_clear (&data.cond);
+  g_mutex_clear (&data.lock);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+/* A minimal interface skeleton, recording the thread its method handler
+ * runs in */
+typedef struct
+{
+  GDBusInterfaceSkeleton parent_instance;
+  GDBusInterfaceInfo *info;  /* (owned) */
+  GThread *handler_thread;  /* (atomic) */
+} PoolSkeleton;
+
+typedef GDBusInterfaceSkeletonClass PoolSkeletonClass;
+
+static GType pool_skeleton_get_type (void);
+G_DEFINE_TYPE (PoolSkeleton, pool_skeleton, G_TYPE_DBUS_INTERFACE_SKELETON)
+
+static void
+pool_skeleton_method_call (GDBusConnection       *connection,
+                           const gchar           *sender,
+                           const gchar           *object_path,
+                           const gchar           *interface_name,
+                           const gchar           *method_name,
+                           GVariant              *parameters,
+                           GDBusMethodInvocation *invocation,
+                           gpointer               user_data)
+{
+  PoolSkeleton *skeleton = user_data;
+
+  g_atomic_pointer_set (&skeleton->handler_thread, g_thread_self ());
+  g_dbus_method_invocation_return_value (invocation, NULL);
+}
+
+static const GDBusInterfaceVTable pool_skeleton_vtable = {
+  pool_skeleton_method_call, NULL, NULL, { 0 }
+};
+
+static GDBusInterfaceInfo *
+pool_skeleton_get_info (GDBusInterfaceSkeleton *skeleton)
+{
+  return ((PoolSkeleton *) skeleton)->info;
+}
+
+static GDBusInterfaceVTable *
+pool_skeleton_get_vtable (GDBusInterfaceSkeleton *skeleton)
+{
+  return (GDBusInterfaceVTable *) &pool_skeleton_vtable;
+}
+
+static GVariant *
+pool_skeleton_get_properties (GDBusInterfaceSkeleton *skeleton)
+{
+  return g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
+}
+
+static void
+pool_skeleton_flush (GDBusInterfaceSkeleton *skeleton)
+{
+}
+
+static void
+pool_skeleton_finalize (GObject *object)
+{
+  g_dbus_interface_info_unref (((PoolSkeleton *) object)->info);
+
+  G_OBJECT_CLASS (pool_skeleton_parent_class)->finalize (object);
+}
+
+static void
+pool_skeleton_init (PoolSkeleton *skeleton)
+{
+}
+
+static void
+pool_skeleton_class_init (PoolSkeletonClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = pool_skeleton_finalize;
+  klass->get_info = pool_skeleton_get_info;
+  klass->get_vtable = pool_skeleton_get_vtable;
+  klass->get_properties = pool_skeleton_get_properties;
+  klass->flush = pool_skeleton_flush;
+}
+
+static void
+skeleton_pool_call_cb (GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  gboolean *done = user_data;
+  GVariant *ret;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), result, &error);
+  g_assert_no_error (error);
+  g_variant_unref (ret);
+
+  *done = TRUE;
+  g_main_context_wakeup (NULL);
+}
+
+static void
+test_skeleton_dispatch_thread_pool_changed (void)
+{
+  GDBusNodeInfo *node_info;
+  PoolSkeleton *skeleton;
+  GMainContext *context;
+  GError *error = NULL;
+  gboolean done = FALSE;
+
+  g_test_summary ("Test that a call queued for the main context before a "
+                  "dispatch pool is set on the skeleton still honours "
+                  "G_DBUS_INTERFACE_SKELETON_FLAGS_HANDLE_METHOD_INVOCATIONS_IN_THREAD");
+
+  node_info = g_dbus_node_info_new_for_xml ("<node>"
+                                            "  <interface name='org.example.SkeletonPool'>"
+                                            "    <method name='Work'/>"
+                                            "  </interface>"
+                                            "</node>", &error);
+  g_assert_no_error (error);
+
+  c = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+  g_assert_no_error (error);
+
+  /* Method calls are dispatched to @context, so that the test can tell when
+   * one is queued there */
+  context = g_main_context_new ();
+  g_main_context_push_thread_default (context);
+  skeleton = g_object_new (pool_skeleton_get_type (), NULL);
+  skeleton->info = g_dbus_interface_info_ref (node_info->interfaces[0]);
+  g_dbus_interface_skeleton_set_flags (G_DBUS_INTERFACE_SKELETON (skeleton),
+                                       G_DBUS_INTERFACE_SKELETON_FLAGS_HANDLE_METHOD_INVOCATIONS_IN_THREAD);
+  g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (skeleton), c,
+                                    "/skeleton_pool", &error);
+  g_assert_no_error (error);
+  g_main_context_pop_thread_default (context);
+
+  g_dbus_connection_call (c,
+                          g_dbus_connection_get_unique_name (c),
+                          "/skeleton_pool",
+                          "org.example.SkeletonPool",
+                          "Work",
+                          NULL,
+                          G_VARIANT_TYPE_UNIT,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL,
+                          skeleton_pool_call_cb,
+                          &done);
+
+  while (!g_main_context_pending (context))
+    g_main_context_iteration (NULL, FALSE);
+
+  /* The queued call was not dispatched in the pool, so it must still be
+   * handled in a thread rather than in the main context */
+  g_dbus_interface_skeleton_set_dispatch_thread_pool (G_DBUS_INTERFACE_SKELETON (skeleton), 1,
+                                                      G_DBUS_DISPATCH_FLAGS_NONE);
+
+  while (g_main_context_iteration (context, FALSE))
+    ;
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_nonnull (g_atomic_pointer_get (&skeleton->handler_thread));
+  g_assert_true (g_atomic_pointer_get (&skeleton->handler_thread) != g_thread_self ());
+
+  g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (skeleton));
+  g_object_unref (skeleton);
+  g_main_context_unref (context);
+  g_object_unref (c);
+  g_dbus_node_info_unref (node_info);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 int
 main (int   argc,
       char *argv[])
@@ -1983,6 +2324,9 @@ main (int   argc,
   g_test_add_func ("/gdbus/async-properties", test_async_properties);
   g_test_add_data_func ("/gdbus/threaded-unregistration/object", GINT_TO_POINTER (FALSE), test_threaded_unregistration);
   g_test_add_data_func ("/gdbus/threaded-unregistration/subtree", GINT_TO_POINTER (TRUE), test_threaded_unregistration);
+  g_test_add_data_func ("/gdbus/dispatch-thread-pool/unordered", GINT_TO_POINTER (FALSE), test_dispatch_thread_pool);
+  g_test_add_data_func ("/gdbus/dispatch-thread-pool/ordered", GINT_TO_POINTER (TRUE), test_dispatch_thread_pool);
+  g_test_add_func ("/gdbus/dispatch-thread-pool/skeleton-changed", test_skeleton_dispatch_thread_pool_changed);
 
   /* TODO: check that we spit out correct introspection data */
   /* TODO: check that registering a whole subtree works */
@@ -39,9 +39,39 @@ typedef struct {
   GDBusInterfaceSkeletonClass parent_class;
 } MockInterfaceClass;
 
+enum
+{
+  PROP_0,
+  PROP_NUMBER,
+};
+
 static GType mock_interface_get_type (void);
 G_DEFINE_TYPE (MockInterface, mock_interface, G_TYPE_DBUS_INTERFACE_SKELETON)
 
+static void
+mock_interface_get_gproperty (GObject    *object,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  MockInterface *self = (MockInterface *) object;
+
+  g_assert_cmpuint (prop_id, ==, PROP_NUMBER);
+  g_value_set_int (value, self->number);
+}
+
+static void
+mock_interface_set_gproperty (GObject      *object,
+                              guint         prop_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+  MockInterface *self = (MockInterface *) object;
+
+  g_assert_cmpuint (prop_id, ==, PROP_NUMBER);
+  self->number = g_value_get_int (value);
+}
+
 static void
 mock_interface_init (MockInterface *self)
 {
@@ -161,7 +191,17 @@ mock_interface_flush (GDBusInterfaceSkeleton *skeleton)
 static void
 mock_interface_class_init (MockInterfaceClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GDBusInterfaceSkeletonClass *skeleton_class = G_DBUS_INTERFACE_SKELETON_CLASS (klass);
+
+  gobject_class->get_property = mock_interface_get_gproperty;
+  gobject_class->set_property = mock_interface_set_gproperty;
+  g_object_class_install_property (gobject_class, PROP_NUMBER,
+                                   g_param_spec_int ("number", NULL, NULL,
+                                                     G_MININT, G_MAXINT, 0,
+                                                     G_PARAM_READWRITE |
+                                                     G_PARAM_STATIC_STRINGS));
+
   skeleton_class->get_info = mock_interface_get_info;
   skeleton_class->get_properties = mock_interface_get_properties;
   skeleton_class->flush = mock_interface_flush;
@@ -373,6 +413,163 @@ test_object_manager (Test *test,
   g_free (number1_path);
 }
 
+static void
+on_object_manager_signal (GDBusConnection *connection,
+                          const gchar     *sender_name,
+                          const gchar     *object_path,
+                          const gchar     *interface_name,
+                          const gchar     *signal_name,
+                          GVariant        *parameters,
+                          gpointer         user_data)
+{
+  GPtrArray *signals = user_data;
+  const gchar *path;
+
+  g_variant_get_child (parameters, 0, "&o", &path);
+  g_ptr_array_add (signals, g_strdup_printf ("%s %s", signal_name, path));
+}
+
+static GVariant *
+get_managed_objects (Test        *test,
+                     const gchar *object_path)
+{
+  GError *error = NULL;
+  GVariant *result;
+
+  g_dbus_connection_call (test->client, NULL, object_path,
+                          "org.freedesktop.DBus.ObjectManager", "GetManagedObjects",
+                          NULL, G_VARIANT_TYPE ("(a{oa{sa{sv}}})"),
+                          G_DBUS_CALL_FLAGS_NONE, -1, NULL, on_result, test);
+  g_main_loop_run (test->loop);
+  result = g_dbus_connection_call_finish (test->client, test->result, &error);
+  g_assert_no_error (error);
+  g_clear_object (&test->result);
+
+  return result;
+}
+
+static gint
+get_managed_number (GVariant    *managed_objects,
+                    const gchar *object_path)
+{
+  GVariant *objects, *interfaces, *properties;
+  gint32 number = -1;
+
+  objects = g_variant_get_child_value (managed_objects, 0);
+  interfaces = g_variant_lookup_value (objects, object_path, G_VARIANT_TYPE ("a{sa{sv}}"));
+  g_assert_nonnull (interfaces);
+  properties = g_variant_lookup_value (interfaces, "org.mock.Interface", G_VARIANT_TYPE_VARDICT);
+  g_assert_nonnull (properties);
+  g_assert_true (g_variant_lookup (properties, "Number", "i", &number));
+  g_variant_unref (properties);
+  g_variant_unref (interfaces);
+  g_variant_unref (objects);
+
+  return number;
+}
+
+static GDBusObjectSkeleton *
+export_mock_object (GDBusObjectManagerServer *server,
+                    const gchar              *object_path,
+                    gint                      number)
+{
+  MockInterface *mock;
+  GDBusObjectSkeleton *skeleton;
+
+  mock = g_object_new (mock_interface_get_type (), "number", number, NULL);
+  skeleton = g_dbus_object_skeleton_new (object_path);
+  g_dbus_object_skeleton_add_interface (skeleton, G_DBUS_INTERFACE_SKELETON (mock));
+  g_dbus_object_manager_server_export (server, skeleton);
+  g_object_unref (mock);
+
+  return skeleton;
+}
+
+static void
+test_object_manager_batched (Test          *test,
+                             gconstpointer  test_data)
+{
+  GDBusObjectManagerServer *server;
+  GDBusObjectSkeleton *skeleton;
+  GDBusInterface *mock;
+  GPtrArray *signals;
+  GVariant *managed_objects;
+  GVariant *objects;
+  guint subscription_id;
+
+  g_test_summary ("Test that InterfacesAdded and InterfacesRemoved are coalesced "
+                  "while frozen, and that GetManagedObjects is served from a cache "
+                  "which is updated on property changes");
+
+  server = g_dbus_object_manager_server_new ("/objects");
+  g_dbus_object_manager_server_set_cache_managed_objects (server, TRUE);
+  g_dbus_object_manager_server_set_connection (server, test->server);
+
+  signals = g_ptr_array_new_with_free_func (g_free);
+  subscription_id = g_dbus_connection_signal_subscribe (test->client, NULL,
+                                                        "org.freedesktop.DBus.ObjectManager",
+                                                        NULL, "/objects", NULL,
+                                                        G_DBUS_SIGNAL_FLAGS_NONE,
+                                                        on_object_manager_signal,
+                                                        signals, NULL);
+
+  /* Nothing is emitted while frozen, and nothing at all for objects which
+   * were only there for part of the batch */
+  g_dbus_object_manager_server_freeze_signals (server);
+  g_object_unref (export_mock_object (server, "/objects/number_1", 1));
+  skeleton = export_mock_object (server, "/objects/number_2", 2);
+  g_object_unref (export_mock_object (server, "/objects/number_3", 3));
+  g_assert_true (g_dbus_object_manager_server_unexport (server, "/objects/number_3"));
+  g_dbus_object_manager_server_thaw_signals (server);
+
+  /* GetManagedObjects flushes the held back signals before replying */
+  managed_objects = get_managed_objects (test, "/objects");
+  g_assert_cmpuint (signals->len, ==, 2);
+  g_assert_cmpstr (signals->pdata[0], ==, "InterfacesAdded /objects/number_1");
+  g_assert_cmpstr (signals->pdata[1], ==, "InterfacesAdded /objects/number_2");
+  objects = g_variant_get_child_value (managed_objects, 0);
+  g_assert_cmpuint (g_variant_n_children (objects), ==, 2);
+  g_variant_unref (objects);
+  g_assert_cmpint (get_managed_number (managed_objects, "/objects/number_2"), ==, 2);
+  g_variant_unref (managed_objects);
+
+  /* The cache is updated when a property changes */
+  mock = g_dbus_object_get_interface (G_DBUS_OBJECT (skeleton), "org.mock.Interface");
+  g_object_set (mock, "number", 22, NULL);
+  managed_objects = get_managed_objects (test, "/objects");
+  g_assert_cmpint (get_managed_number (managed_objects, "/objects/number_1"), ==, 1);
+  g_assert_cmpint (get_managed_number (managed_objects, "/objects/number_2"), ==, 22);
+  g_variant_unref (managed_objects);
+  g_object_unref (mock);
+
+  /* Removing and re-adding an interface in a batch is announced as such */
+  g_ptr_array_set_size (signals, 0);
+  g_dbus_object_manager_server_freeze_signals (server);
+  g_assert_true (g_dbus_object_manager_server_unexport (server, "/objects/number_2"));
+  g_dbus_object_manager_server_export (server, skeleton);
+  g_assert_true (g_dbus_object_manager_server_unexport (server, "/objects/number_1"));
+  g_dbus_object_manager_server_thaw_signals (server);
+  g_assert_cmpuint (signals->len, ==, 0);
+
+  while (signals->len < 3)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpstr (signals->pdata[0], ==, "InterfacesRemoved /objects/number_2");
+  g_assert_cmpstr (signals->pdata[1], ==, "InterfacesAdded /objects/number_2");
+  g_assert_cmpstr (signals->pdata[2], ==, "InterfacesRemoved /objects/number_1");
+
+  managed_objects = get_managed_objects (test, "/objects");
+  objects = g_variant_get_child_value (managed_objects, 0);
+  g_assert_cmpuint (g_variant_n_children (objects), ==, 1);
+  g_variant_unref (objects);
+  g_variant_unref (managed_objects);
+  g_assert_cmpuint (signals->len, ==, 3);
+
+  g_dbus_connection_signal_unsubscribe (test->client, subscription_id);
+  g_ptr_array_unref (signals);
+  g_object_unref (skeleton);
+  g_object_unref (server);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -383,6 +580,8 @@ main (int   argc,
               setup, test_object_manager, teardown);
   g_test_add ("/gdbus/peer-object-manager/root", Test, "/",
               setup, test_object_manager, teardown);
+  g_test_add ("/gdbus/peer-object-manager/batched", Test, NULL,
+              setup, test_object_manager_batched, teardown);
 
   return g_test_run();
 }
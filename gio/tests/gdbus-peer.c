@@ -2226,6 +2226,241 @@ codegen_test_peer (void)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+#ifdef G_OS_UNIX
+
+typedef struct
+{
+  GDBusConnection *server;
+  GDBusConnection *client;
+  GVariant *received;
+  gboolean saw_outgoing;
+} MemfdArraysData;
+
+static void
+memfd_arrays_on_connection (GObject      *source_object,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+  GDBusConnection **connection = user_data;
+  GError *error = NULL;
+
+  *connection = g_dbus_connection_new_finish (result, &error);
+  g_assert_no_error (error);
+  g_main_context_wakeup (NULL);
+}
+
+static GDBusMessage *
+memfd_arrays_filter (GDBusConnection *connection,
+                     GDBusMessage    *message,
+                     gboolean         incoming,
+                     gpointer         user_data)
+{
+  MemfdArraysData *data = user_data;
+  GVariant *array;
+
+  if (g_strcmp0 (g_dbus_message_get_member (message), "Blob") != 0)
+    return message;
+
+  /* both sides only ever see the array inline, without extra fds */
+  array = g_variant_get_child_value (g_dbus_message_get_body (message), 0);
+  g_assert_cmpuint (g_variant_get_size (array), ==, 65537);
+  g_variant_unref (array);
+  g_assert_null (g_dbus_message_get_unix_fd_list (message));
+  g_assert_null (g_dbus_message_get_header (message, 0x80));
+
+  if (!incoming)
+    data->saw_outgoing = TRUE;
+
+  return message;
+}
+
+static void
+memfd_arrays_on_signal (GDBusConnection *connection,
+                        const gchar     *sender_name,
+                        const gchar     *object_path,
+                        const gchar     *interface_name,
+                        const gchar     *signal_name,
+                        GVariant        *parameters,
+                        gpointer         user_data)
+{
+  MemfdArraysData *data = user_data;
+
+  g_assert_null (data->received);
+  data->received = g_variant_ref (parameters);
+  g_main_context_wakeup (NULL);
+}
+
+static void
+memfd_arrays_connect (MemfdArraysData *data)
+{
+  GSocket *socket;
+  GSocketConnection *stream;
+  GError *error = NULL;
+  gchar *guid;
+  int pair[2];
+
+  g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM, 0, pair), ==, 0);
+
+  socket = g_socket_new_from_fd (pair[1], &error);
+  g_assert_no_error (error);
+  stream = g_socket_connection_factory_create_connection (socket);
+  g_object_unref (socket);
+  guid = g_dbus_generate_guid ();
+  g_dbus_connection_new (G_IO_STREAM (stream), guid,
+                         G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_SERVER,
+                         NULL, NULL, memfd_arrays_on_connection, &data->server);
+  g_object_unref (stream);
+  g_free (guid);
+
+  socket = g_socket_new_from_fd (pair[0], &error);
+  g_assert_no_error (error);
+  stream = g_socket_connection_factory_create_connection (socket);
+  g_object_unref (socket);
+  g_dbus_connection_new (G_IO_STREAM (stream), NULL,
+                         G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                         NULL, NULL, memfd_arrays_on_connection, &data->client);
+  g_object_unref (stream);
+
+  while (data->server == NULL || data->client == NULL)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+test_peer_memfd_arrays (void)
+{
+  MemfdArraysData data = { NULL, };
+  GError *error = NULL;
+  GVariant *big, *small, *expected;
+  guchar *payload;
+  guint subscription_id;
+  gsize n;
+
+  g_test_summary ("Test that large byte arrays can be passed as memfds on "
+                  "peer-to-peer connections without changing the signature");
+
+  memfd_arrays_connect (&data);
+
+#ifndef HAVE_MEMFD_CREATE
+  g_assert_false (g_dbus_connection_set_memfd_threshold (data.client, 4096));
+  g_test_skip ("memfd_create() is not available");
+#else
+  g_assert_true (g_dbus_connection_set_memfd_threshold (data.client, 4096));
+
+  g_dbus_connection_add_filter (data.client, memfd_arrays_filter, &data, NULL);
+  g_dbus_connection_add_filter (data.server, memfd_arrays_filter, &data, NULL);
+  subscription_id = g_dbus_connection_signal_subscribe (data.server,
+                                                        NULL,
+                                                        "org.gtk.GDBus.MemfdTest",
+                                                        "Blob",
+                                                        "/org/gtk/GDBus/MemfdTest",
+                                                        NULL,
+                                                        G_DBUS_SIGNAL_FLAGS_NONE,
+                                                        memfd_arrays_on_signal,
+                                                        &data,
+                                                        NULL);
+
+  payload = g_malloc (65537);
+  for (n = 0; n < 65537; n++)
+    payload[n] = n % 251;
+  big = g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, payload, 65537, 1);
+  small = g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, payload, 100, 1);
+  expected = g_variant_ref_sink (g_variant_new ("(@ayu@ay)", big, 42, small));
+  g_free (payload);
+
+  g_dbus_connection_emit_signal (data.client,
+                                 NULL,
+                                 "/org/gtk/GDBus/MemfdTest",
+                                 "org.gtk.GDBus.MemfdTest",
+                                 "Blob",
+                                 expected,
+                                 &error);
+  g_assert_no_error (error);
+
+  while (data.received == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_true (data.saw_outgoing);
+  g_assert_cmpvariant (data.received, expected);
+
+  g_dbus_connection_signal_unsubscribe (data.server, subscription_id);
+  g_variant_unref (expected);
+  g_variant_unref (data.received);
+#endif
+
+  g_dbus_connection_close_sync (data.client, NULL, NULL);
+  g_object_unref (data.client);
+  g_object_unref (data.server);
+}
+
+static void
+memfd_arrays_on_closed (GDBusConnection *connection,
+                        gboolean         remote_peer_vanished,
+                        GError          *error,
+                        gpointer         user_data)
+{
+  gboolean *closed = user_data;
+
+  *closed = TRUE;
+  g_main_context_wakeup (NULL);
+}
+
+static void
+test_peer_memfd_arrays_unsealed (void)
+{
+  MemfdArraysData data = { NULL, };
+  GDBusMessage *message;
+  GUnixFDList *fd_list;
+  GError *error = NULL;
+  gboolean closed = FALSE;
+  gchar *path;
+  gint fd;
+
+  g_test_summary ("Test that an array passed in an fd which is not a sealed "
+                  "memfd is rejected instead of read into memory");
+
+#ifndef HAVE_MEMFD_CREATE
+  g_test_skip ("memfd_create() is not available");
+#else
+  memfd_arrays_connect (&data);
+  g_signal_connect (data.server, "closed", G_CALLBACK (memfd_arrays_on_closed), &closed);
+
+  /* a sparse file claiming to be much larger than the message */
+  fd = g_file_open_tmp ("gdbus-peer-memfd-XXXXXX", &path, &error);
+  g_assert_no_error (error);
+  g_assert_no_errno (ftruncate (fd, G_GINT64_CONSTANT (1) << 40));
+  g_unlink (path);
+  g_free (path);
+
+  fd_list = g_unix_fd_list_new_from_array (&fd, 1);
+  message = g_dbus_message_new_signal ("/org/gtk/GDBus/MemfdTest",
+                                       "org.gtk.GDBus.MemfdTest",
+                                       "Blob");
+  g_dbus_message_set_body (message, g_variant_new ("(@ayu)",
+                                                   g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, NULL, 0, 1),
+                                                   42));
+  g_dbus_message_set_header (message, 0x80, g_variant_new_parsed ("[(@u 0, @h 0)]"));
+  g_dbus_message_set_unix_fd_list (message, fd_list);
+  g_object_unref (fd_list);
+
+  g_test_expect_message ("GLib-GIO", G_LOG_LEVEL_WARNING,
+                         "*arrays passed as memfds*not passed in a sealed memfd*");
+  g_dbus_connection_send_message (data.client, message, G_DBUS_SEND_MESSAGE_FLAGS_NONE, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (message);
+
+  while (!closed)
+    g_main_context_iteration (NULL, TRUE);
+  g_test_assert_expected_messages ();
+
+  g_object_unref (data.client);
+  g_object_unref (data.server);
+#endif
+}
+
+#endif /* G_OS_UNIX */
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 
 int
 main (int   argc,
@@ -2252,6 +2487,10 @@ main (int   argc,
   g_test_add_func ("/gdbus/peer-to-peer/invalid/conn/addr/sync",
                    test_peer_invalid_conn_addr_sync);
   g_test_add_func ("/gdbus/peer-to-peer/signals", test_peer_signals);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/gdbus/peer-to-peer/memfd-arrays", test_peer_memfd_arrays);
+  g_test_add_func ("/gdbus/peer-to-peer/memfd-arrays/unsealed", test_peer_memfd_arrays_unsealed);
+#endif
   g_test_add_func ("/gdbus/delayed-message-processing", delayed_message_processing);
   g_test_add_func ("/gdbus/nonce-tcp", test_nonce_tcp);
 
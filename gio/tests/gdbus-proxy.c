@@ -1017,6 +1017,104 @@ test_proxy_no_match_rule (void)
   g_clear_object (&connection);
 }
 
+/* ---------------------------------------------------------------------------------------------------- */
+
+static void
+set_frob_property (GDBusProxy  *proxy,
+                   const gchar *property_name,
+                   GVariant    *value)
+{
+  GError *error = NULL;
+  GVariant *result;
+
+  result = g_dbus_proxy_call_sync (proxy,
+                                   "FrobSetProperty",
+                                   g_variant_new ("(sv)", property_name, value),
+                                   G_DBUS_CALL_FLAGS_NONE,
+                                   -1,
+                                   NULL,
+                                   &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (result);
+  g_variant_unref (result);
+}
+
+static void
+test_load_properties_on_demand (void)
+{
+  GDBusProxy *proxy;
+  GDBusConnection *connection;
+  GError *error = NULL;
+  GVariant *variant;
+  gchar **names;
+  const gchar *tracked[] = { "y", NULL };
+
+  g_test_summary ("Test that G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND and "
+                  "g_dbus_proxy_set_tracked_properties() only cache the "
+                  "properties which are used");
+
+  connection = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+  g_assert_no_error (error);
+  proxy = g_dbus_proxy_new_sync (connection,
+                                 G_DBUS_PROXY_FLAGS_LOAD_PROPERTIES_ON_DEMAND,
+                                 NULL,                      /* GDBusInterfaceInfo */
+                                 "com.example.TestService", /* name */
+                                 "/com/example/TestObject", /* object path */
+                                 "com.example.Frob",        /* interface */
+                                 NULL, /* GCancellable */
+                                 &error);
+  g_assert_no_error (error);
+
+  /* this is safe; we explicitly kill the service later on */
+  g_assert_true (g_spawn_command_line_async (g_test_get_filename (G_TEST_BUILT, "gdbus-testserver", NULL), NULL));
+
+  _g_assert_property_notify (proxy, "g-name-owner");
+
+  /* Nothing is loaded until it is looked up */
+  g_assert_null (g_dbus_proxy_get_cached_property_names (proxy));
+
+  /* Lookups in the same iteration are fetched together */
+  g_assert_null (g_dbus_proxy_get_cached_property (proxy, "y"));
+  g_assert_null (g_dbus_proxy_get_cached_property (proxy, "i"));
+  g_assert_null (g_dbus_proxy_get_cached_property (proxy, "NoSuchProperty"));
+  _g_assert_signal_received (proxy, "g-properties-changed");
+
+  names = g_dbus_proxy_get_cached_property_names (proxy);
+  g_assert_true (strv_equal (names, "i", "y", NULL));
+  g_strfreev (names);
+
+  variant = g_dbus_proxy_get_cached_property (proxy, "y");
+  g_assert_nonnull (variant);
+  g_assert_cmpint (g_variant_get_byte (variant), ==, 1);
+  g_variant_unref (variant);
+
+  /* Untracked properties are dropped and their changes ignored */
+  g_dbus_proxy_set_tracked_properties (proxy, tracked);
+
+  names = g_dbus_proxy_get_cached_property_names (proxy);
+  g_assert_true (strv_equal (names, "y", NULL));
+  g_strfreev (names);
+
+  set_frob_property (proxy, "i", g_variant_new_int32 (7));
+  set_frob_property (proxy, "y", g_variant_new_byte (42));
+  _g_assert_signal_received (proxy, "g-properties-changed");
+
+  variant = g_dbus_proxy_get_cached_property (proxy, "y");
+  g_assert_nonnull (variant);
+  g_assert_cmpint (g_variant_get_byte (variant), ==, 42);
+  g_variant_unref (variant);
+  g_assert_null (g_dbus_proxy_get_cached_property (proxy, "i"));
+
+  names = g_dbus_proxy_get_cached_property_names (proxy);
+  g_assert_true (strv_equal (names, "y", NULL));
+  g_strfreev (names);
+
+  kill_test_service (connection);
+
+  g_object_unref (proxy);
+  g_object_unref (connection);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -1038,6 +1136,7 @@ main (int   argc,
   g_test_add_func ("/gdbus/proxy/wellknown-noauto", test_wellknown_noauto);
   g_test_add_func ("/gdbus/proxy/async", test_async);
   g_test_add_func ("/gdbus/proxy/no-match-rule", test_proxy_no_match_rule);
+  g_test_add_func ("/gdbus/proxy/load-properties-on-demand", test_load_properties_on_demand);
 
   ret = session_bus_run();
 
@@ -0,0 +1,244 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+#
+# Copyright © 2024 GNOME Foundation Inc.
+#
+# SPDX-License-Identifier: LGPL-2.1-or-later
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+# MA  02110-1301  USA
+
+"""Integration tests for glib-compile-resources --jobs and --cache-dir."""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import taptestrunner
+
+
+# Stands in for json-glib-format: copies the input to the output, and
+# records each run so that the tests can tell cache hits from misses.
+FAKE_FORMATTER = """#!/bin/sh
+echo "$3" >> "$(dirname "$0")/formatter.log"
+exec cp "$3" "$2"
+"""
+
+N_FILES = 12
+
+
+@unittest.skipIf(os.name == "nt", "The fake preprocessor is a shell script")
+class TestCompileResources(unittest.TestCase):
+    """Integration test for running glib-compile-resources.
+
+    This can be run when installed or uninstalled. When uninstalled, it
+    requires G_TEST_BUILDDIR and G_TEST_SRCDIR to be set.
+    """
+
+    # Track the cwd, we want to back out to that to clean up our tempdir
+    cwd = ""
+
+    def setUp(self):
+        self.timeout_seconds = 30  # seconds per run
+        self.tmpdir = tempfile.TemporaryDirectory()
+        self.cwd = os.getcwd()
+        os.chdir(self.tmpdir.name)
+        print("tmpdir:", self.tmpdir.name)
+
+        if "G_TEST_BUILDDIR" in os.environ:
+            self.__compiler = os.path.join(
+                os.environ["G_TEST_BUILDDIR"], "..", "glib-compile-resources"
+            )
+        else:
+            self.__compiler = shutil.which("glib-compile-resources")
+        print("glib-compile-resources:", self.__compiler)
+
+        self.formatter = os.path.join(self.tmpdir.name, "json-glib-format")
+        with open(self.formatter, "w") as f:
+            f.write(FAKE_FORMATTER)
+        os.chmod(self.formatter, 0o755)
+
+        # A mix of preprocessed and compressed files, so that all kinds of
+        # cache entries are written
+        os.mkdir("data")
+        files = []
+        for i in range(N_FILES):
+            name = "file%d.json" % i
+            with open(os.path.join("data", name), "w") as f:
+                f.write('{ "index": %d, "padding": "%s" }\n' % (i, "x" * (i * 100)))
+            attributes = ['preprocess="json-stripblanks"']
+            if i % 3 == 1:
+                attributes.append('compressed="true"')
+            elif i % 3 == 2:
+                attributes.append('compressed="true" compression="lz4"')
+            files.append(
+                "    <file %s>%s</file>\n" % (" ".join(attributes), name)
+            )
+
+        with open("test.gresource.xml", "w") as f:
+            f.write(
+                '<?xml version="1.0" encoding="UTF-8"?>\n'
+                "<gresources>\n"
+                '  <gresource prefix="/org/gtk/test">\n'
+                + "".join(files)
+                + "  </gresource>\n"
+                "</gresources>\n"
+            )
+
+    def tearDown(self):
+        os.chdir(self.cwd)
+        self.tmpdir.cleanup()
+
+    def runCompiler(self, *args, xml="test.gresource.xml", check=True):
+        argv = [self.__compiler, "--sourcedir=data"]
+        argv.extend(args)
+        argv.append(xml)
+        print("Running:", argv)
+
+        env = os.environ.copy()
+        env["LC_ALL"] = "C.UTF-8"
+        env["G_DEBUG"] = "fatal-warnings"
+        env["JSON_GLIB_FORMAT"] = self.formatter
+
+        info = subprocess.run(
+            argv,
+            timeout=self.timeout_seconds,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            env=env,
+            universal_newlines=True,
+        )
+        print("Output:", info.stdout.strip(), info.stderr.strip())
+        if check:
+            info.check_returncode()
+        return info
+
+    def compile(self, target, *args):
+        self.runCompiler("--target=" + target, *args)
+        with open(target, "rb") as f:
+            return f.read()
+
+    def formatterRuns(self):
+        try:
+            with open("formatter.log") as f:
+                return len(f.readlines())
+        except FileNotFoundError:
+            return 0
+
+    def cacheEntries(self):
+        return sorted(os.listdir("cache"))
+
+    def test_jobs(self):
+        """Test that the output does not depend on the number of jobs."""
+        serial = self.compile("serial.gresource", "--jobs=1")
+        self.assertEqual(self.formatterRuns(), N_FILES)
+
+        for jobs in ("2", "4", "16"):
+            parallel = self.compile("parallel.gresource", "--jobs=" + jobs)
+            self.assertEqual(parallel, serial)
+
+        # The default is the number of processors
+        self.assertEqual(self.compile("default.gresource"), serial)
+
+    def test_cache_hit(self):
+        """Test that cached files are not processed again."""
+        uncached = self.compile("uncached.gresource")
+        self.assertEqual(self.formatterRuns(), N_FILES)
+
+        first = self.compile("first.gresource", "--cache-dir=cache")
+        self.assertEqual(first, uncached)
+        self.assertEqual(self.formatterRuns(), 2 * N_FILES)
+        self.assertEqual(len(self.cacheEntries()), N_FILES)
+
+        second = self.compile("second.gresource", "--cache-dir=cache", "--jobs=4")
+        self.assertEqual(second, uncached)
+        self.assertEqual(self.formatterRuns(), 2 * N_FILES)
+
+    def test_cache_miss(self):
+        """Test that changed files are processed again."""
+        self.compile("first.gresource", "--cache-dir=cache")
+        entries = self.cacheEntries()
+        self.assertEqual(self.formatterRuns(), N_FILES)
+
+        with open(os.path.join("data", "file4.json"), "a") as f:
+            f.write("\n")
+
+        changed = self.compile("changed.gresource", "--cache-dir=cache")
+        self.assertEqual(self.formatterRuns(), N_FILES + 1)
+        self.assertEqual(len(self.cacheEntries()), N_FILES + 1)
+        self.assertTrue(set(entries) < set(self.cacheEntries()))
+
+        self.assertEqual(changed, self.compile("uncached.gresource"))
+
+    def test_cache_corrupt(self):
+        """Test that corrupt cache entries are ignored and replaced."""
+        expected = self.compile("first.gresource", "--cache-dir=cache")
+        entries = self.cacheEntries()
+        self.assertEqual(self.formatterRuns(), N_FILES)
+
+        # Flip a byte of the content in the first entries, truncate the
+        # next ones, and empty one; each is still a valid (uuayay)
+        # variant or at least readable, but must not be used
+        for i, entry in enumerate(entries[:6]):
+            path = os.path.join("cache", entry)
+            with open(path, "rb") as f:
+                contents = bytearray(f.read())
+            if i < 3:
+                contents[8 + 32 + i] ^= 0xFF
+            elif i < 5:
+                contents = contents[: len(contents) // 2]
+            else:
+                contents = bytearray()
+            with open(path, "wb") as f:
+                f.write(contents)
+
+        second = self.compile("second.gresource", "--cache-dir=cache")
+        self.assertEqual(second, expected)
+        self.assertEqual(self.formatterRuns(), N_FILES + 6)
+        self.assertEqual(self.cacheEntries(), entries)
+
+        # The entries were rewritten, and are used again
+        third = self.compile("third.gresource", "--cache-dir=cache")
+        self.assertEqual(third, expected)
+        self.assertEqual(self.formatterRuns(), N_FILES + 6)
+
+    def test_compression_without_compressed(self):
+        """Test that compression= is rejected unless compressed="true"."""
+        for attributes in ('compression="lz4"', 'compressed="false" compression="lz4"'):
+            with open("uncompressed.gresource.xml", "w") as f:
+                f.write(
+                    '<?xml version="1.0" encoding="UTF-8"?>\n'
+                    "<gresources>\n"
+                    '  <gresource prefix="/org/gtk/test">\n'
+                    "    <file %s>file0.json</file>\n"
+                    "  </gresource>\n"
+                    "</gresources>\n" % attributes
+                )
+
+            info = self.runCompiler(
+                "--target=uncompressed.gresource",
+                xml="uncompressed.gresource.xml",
+                check=False,
+            )
+            self.assertEqual(info.returncode, 1)
+            self.assertIn("requires compressed", info.stderr)
+            self.assertFalse(os.path.exists("uncompressed.gresource"))
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=taptestrunner.TAPTestRunner())
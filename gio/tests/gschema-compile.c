@@ -137,6 +137,182 @@ static const SchemaTest tests[] = {
   { "cdata",                        NULL, NULL                                                  }
 };
 
+/* Returns: whether glib-compile-schemas succeeded on @dir with the
+ * %NULL-terminated @options */
+static gboolean
+run_compile_schemas (const gchar         *dir,
+                     const gchar * const *options)
+{
+  GPtrArray *argv;
+  gint wait_status;
+  GError *error = NULL;
+  gboolean success;
+
+  argv = g_ptr_array_new ();
+  g_ptr_array_add (argv, (gchar *) GLIB_COMPILE_SCHEMAS);
+  for (; *options != NULL; options++)
+    g_ptr_array_add (argv, (gchar *) *options);
+  g_ptr_array_add (argv, (gchar *) dir);
+  g_ptr_array_add (argv, NULL);
+
+  g_spawn_sync (NULL, (gchar **) argv->pdata, NULL,
+                G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL,
+                NULL, NULL, NULL, NULL, &wait_status, &error);
+  g_assert_no_error (error);
+  success = g_spawn_check_wait_status (wait_status, NULL);
+
+  g_ptr_array_unref (argv);
+
+  return success;
+}
+
+static void
+compile_schemas (const gchar *dir,
+                 gboolean     incremental)
+{
+  const gchar *options[] = { "--strict", NULL, NULL };
+
+  if (incremental)
+    options[1] = "--incremental";
+
+  g_assert_true (run_compile_schemas (dir, options));
+}
+
+static void
+write_schema_with_key (const gchar *dir,
+                       const gchar *key,
+                       gint         value)
+{
+  gchar *path, *contents;
+  GError *error = NULL;
+
+  path = g_build_filename (dir, "org.gtk.test.incremental.gschema.xml", NULL);
+  contents = g_strdup_printf ("<schemalist>"
+                              "  <schema id='org.gtk.test.incremental' path='/tests/incremental/'>"
+                              "    <key name='%s' type='i'><default>%d</default></key>"
+                              "  </schema>"
+                              "</schemalist>", key, value);
+  g_file_set_contents (path, contents, -1, &error);
+  g_assert_no_error (error);
+
+  g_free (contents);
+  g_free (path);
+}
+
+static void
+write_schema (const gchar *dir,
+              gint         value)
+{
+  write_schema_with_key (dir, "value", value);
+}
+
+static GBytes *
+read_file (const gchar *dir,
+           const gchar *name)
+{
+  gchar *path, *contents;
+  gsize size;
+  GError *error = NULL;
+
+  path = g_build_filename (dir, name, NULL);
+  g_file_get_contents (path, &contents, &size, &error);
+  g_assert_no_error (error);
+  g_free (path);
+
+  return g_bytes_new_take (contents, size);
+}
+
+static void
+remove_dir (gchar *dir)
+{
+  GDir *d;
+  const gchar *name;
+
+  d = g_dir_open (dir, 0, NULL);
+  while ((name = g_dir_read_name (d)) != NULL)
+    {
+      gchar *path = g_build_filename (dir, name, NULL);
+      g_remove (path);
+      g_free (path);
+    }
+  g_dir_close (d);
+
+  g_rmdir (dir);
+  g_free (dir);
+}
+
+static void
+test_incremental (void)
+{
+  gchar *dir, *full_dir;
+  GBytes *output, *manifest, *full_output, *bytes;
+  GError *error = NULL;
+
+  dir = g_dir_make_tmp ("gschema-compile-XXXXXX", &error);
+  g_assert_no_error (error);
+  full_dir = g_dir_make_tmp ("gschema-compile-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  write_schema (dir, 1);
+  compile_schemas (dir, TRUE);
+  output = read_file (dir, "gschemas.compiled");
+  manifest = read_file (dir, "gschemas.compiled.manifest");
+
+  /* Nothing changed */
+  compile_schemas (dir, TRUE);
+  bytes = read_file (dir, "gschemas.compiled");
+  g_assert_true (g_bytes_equal (bytes, output));
+  g_bytes_unref (bytes);
+  bytes = read_file (dir, "gschemas.compiled.manifest");
+  g_assert_true (g_bytes_equal (bytes, manifest));
+  g_bytes_unref (bytes);
+
+  /* A changed schema gives the same output as a full build */
+  write_schema (dir, 2);
+  compile_schemas (dir, TRUE);
+  g_bytes_unref (output);
+  output = read_file (dir, "gschemas.compiled");
+
+  write_schema (full_dir, 2);
+  compile_schemas (full_dir, FALSE);
+  full_output = read_file (full_dir, "gschemas.compiled");
+  g_assert_true (g_bytes_equal (output, full_output));
+
+  g_bytes_unref (full_output);
+  g_bytes_unref (manifest);
+  g_bytes_unref (output);
+  remove_dir (full_dir);
+  remove_dir (dir);
+}
+
+/* Options which change the result of compiling are recorded in the manifest,
+ * so an unchanged schema is compiled again when they change */
+static void
+test_incremental_options (void)
+{
+  const gchar *allow_any_name[] = { "--incremental", "--strict", "--allow-any-name", NULL };
+  const gchar *strict[] = { "--incremental", "--strict", NULL };
+  const gchar *not_strict[] = { "--incremental", NULL };
+  gchar *dir;
+  GError *error = NULL;
+
+  dir = g_dir_make_tmp ("gschema-compile-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  /* Not a valid key name unless --allow-any-name is given */
+  write_schema_with_key (dir, "Value", 1);
+
+  g_assert_true (run_compile_schemas (dir, allow_any_name));
+  g_assert_true (run_compile_schemas (dir, allow_any_name));
+  g_assert_false (run_compile_schemas (dir, strict));
+
+  /* Without --strict, the invalid schema file is skipped */
+  g_assert_true (run_compile_schemas (dir, not_strict));
+  g_assert_true (run_compile_schemas (dir, not_strict));
+  g_assert_false (run_compile_schemas (dir, strict));
+
+  remove_dir (dir);
+}
 
 int
 main (int argc, char *argv[])
@@ -160,5 +336,8 @@ main (int argc, char *argv[])
       g_free (name);
     }
 
+  g_test_add_func ("/gschema/incremental", test_incremental);
+  g_test_add_func ("/gschema/incremental/options", test_incremental_options);
+
   return g_test_run ();
 }
@@ -2271,6 +2271,263 @@ test_keyfile_no_root_group (Fixture       *fixture,
   g_free (keyfile_path);
 }
 
+/* Test that the keyfile is reloaded when it is rewritten in place without
+ * its modification time changing */
+static void
+test_keyfile_external_rewrite (Fixture       *fixture,
+                               gconstpointer  user_data)
+{
+  GSettingsBackend *kf_backend;
+  GSettings *settings;
+  GFile *file;
+  GFileInfo *info;
+  const gchar *data = "[tests]\ngreeting='rewritten externally'\n";
+  gchar *str;
+  gboolean called = FALSE;
+  GError *error = NULL;
+  gchar *keyfile_path = NULL, *store_path = NULL;
+
+  keyfile_path = g_build_filename (fixture->tmp_dir, "keyfile", NULL);
+  store_path = g_build_filename (keyfile_path, "gsettings.store", NULL);
+  kf_backend = g_keyfile_settings_backend_new (store_path, "/", "root");
+  settings = g_settings_new_with_backend ("org.gtk.test", kf_backend);
+
+  g_settings_set (settings, "greeting", "s", "ours");
+
+  file = g_file_new_for_path (store_path);
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC,
+                            G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+
+  g_signal_connect (settings, "changed::greeting", G_CALLBACK (key_changed_cb), &called);
+
+  g_file_set_contents_full (store_path, data, -1, G_FILE_SET_CONTENTS_NONE, 0600, &error);
+  g_assert_no_error (error);
+  g_file_set_attributes_from_info (file, info, G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+
+  while (!called)
+    g_main_context_iteration (NULL, FALSE);
+
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "rewritten externally");
+  g_free (str);
+
+  g_object_unref (info);
+  g_object_unref (file);
+  g_object_unref (settings);
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_finalize_object (kf_backend);
+
+  /* Clean up the temporary directory. */
+  g_assert_no_errno (g_remove (store_path));
+  g_assert_no_errno (g_rmdir (keyfile_path));
+  g_free (store_path);
+  g_free (keyfile_path);
+}
+
+static GSettingsBackend *
+keyfile_backend_new_with_write_delay (const gchar *filename,
+                                      guint        write_delay)
+{
+  /* The keyfile backend type is private; this registers it */
+  g_object_unref (g_settings_backend_get_default ());
+
+  return g_object_new (g_type_from_name ("GKeyfileSettingsBackend"),
+                       "filename", filename,
+                       "root-path", "/",
+                       "root-group", "root",
+                       "write-delay", write_delay,
+                       NULL);
+}
+
+/*
+ * Test that a keyfile backend with a write-delay coalesces writes, and
+ * keeps its pending changes when the file is modified by someone else.
+ */
+static void
+test_keyfile_write_delay (Fixture       *fixture,
+                          gconstpointer  user_data)
+{
+  GSettingsBackend *kf_backend;
+  GSettings *settings;
+  GKeyFile *keyfile;
+  gchar *str;
+  gchar *data;
+  gsize len;
+  gboolean called = FALSE;
+  GError *error = NULL;
+  gchar *keyfile_path = NULL, *store_path = NULL;
+
+  keyfile_path = g_build_filename (fixture->tmp_dir, "keyfile", NULL);
+  store_path = g_build_filename (keyfile_path, "gsettings.store", NULL);
+
+  /* Long enough to never expire during the test */
+  kf_backend = keyfile_backend_new_with_write_delay (store_path, 600000);
+  settings = g_settings_new_with_backend ("org.gtk.test", kf_backend);
+
+  g_settings_set (settings, "greeting", "s", "one");
+  g_settings_set (settings, "greeting", "s", "two");
+  g_assert_false (g_file_test (store_path, G_FILE_TEST_EXISTS));
+
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "two");
+  g_free (str);
+
+  g_signal_connect (settings, "changed::farewell", G_CALLBACK (key_changed_cb), &called);
+
+  keyfile = g_key_file_new ();
+  g_key_file_set_string (keyfile, "tests", "greeting", "'external'");
+  g_key_file_set_string (keyfile, "tests", "farewell", "'external'");
+  data = g_key_file_to_data (keyfile, &len, NULL);
+  g_file_set_contents (store_path, data, len, &error);
+  g_assert_no_error (error);
+  g_key_file_free (keyfile);
+  g_free (data);
+
+  while (!called)
+    g_main_context_iteration (NULL, FALSE);
+  g_signal_handlers_disconnect_by_func (settings, key_changed_cb, &called);
+
+  str = g_settings_get_string (settings, "farewell");
+  g_assert_cmpstr (str, ==, "external");
+  g_free (str);
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "two");
+  g_free (str);
+
+  /* The pending write is flushed when the backend goes away */
+  g_object_unref (settings);
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_finalize_object (kf_backend);
+
+  keyfile = g_key_file_new ();
+  g_assert_true (g_key_file_load_from_file (keyfile, store_path, 0, NULL));
+
+  str = g_key_file_get_string (keyfile, "tests", "greeting", NULL);
+  g_assert_cmpstr (str, ==, "'two'");
+  g_free (str);
+
+  str = g_key_file_get_string (keyfile, "tests", "farewell", NULL);
+  g_assert_cmpstr (str, ==, "'external'");
+  g_free (str);
+  g_key_file_free (keyfile);
+
+  /* Clean up the temporary directory. */
+  g_assert_no_errno (g_remove (store_path));
+  g_assert_no_errno (g_rmdir (keyfile_path));
+  g_free (store_path);
+  g_free (keyfile_path);
+}
+
+/* Test that changes are written out together when the write-delay expires */
+static void
+test_keyfile_write_delay_expire (Fixture       *fixture,
+                                 gconstpointer  user_data)
+{
+  GSettingsBackend *kf_backend;
+  GSettings *settings;
+  GKeyFile *keyfile;
+  gchar *str;
+  gchar *keyfile_path = NULL, *store_path = NULL;
+
+  keyfile_path = g_build_filename (fixture->tmp_dir, "keyfile", NULL);
+  store_path = g_build_filename (keyfile_path, "gsettings.store", NULL);
+
+  kf_backend = keyfile_backend_new_with_write_delay (store_path, 10);
+  settings = g_settings_new_with_backend ("org.gtk.test", kf_backend);
+
+  g_settings_set (settings, "greeting", "s", "one");
+  g_settings_set (settings, "farewell", "s", "two");
+
+  /* Nothing is written until the timeout is dispatched */
+  g_assert_false (g_file_test (store_path, G_FILE_TEST_EXISTS));
+
+  while (!g_file_test (store_path, G_FILE_TEST_EXISTS))
+    g_main_context_iteration (NULL, TRUE);
+
+  keyfile = g_key_file_new ();
+  g_assert_true (g_key_file_load_from_file (keyfile, store_path, 0, NULL));
+
+  str = g_key_file_get_string (keyfile, "tests", "greeting", NULL);
+  g_assert_cmpstr (str, ==, "'one'");
+  g_free (str);
+
+  str = g_key_file_get_string (keyfile, "tests", "farewell", NULL);
+  g_assert_cmpstr (str, ==, "'two'");
+  g_free (str);
+  g_key_file_free (keyfile);
+
+  g_object_unref (settings);
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_finalize_object (kf_backend);
+
+  /* Clean up the temporary directory. */
+  g_assert_no_errno (g_remove (store_path));
+  g_assert_no_errno (g_rmdir (keyfile_path));
+  g_free (store_path);
+  g_free (keyfile_path);
+}
+
+/* Test that g_settings_sync() writes out pending changes of the default
+ * keyfile backend, with the write-delay taken from the environment */
+static void
+test_keyfile_write_delay_sync (Fixture       *fixture,
+                               gconstpointer  user_data)
+{
+  gchar *store_path;
+  gchar **envp;
+
+  envp = g_get_environ ();
+  envp = g_environ_setenv (g_steal_pointer (&envp), "GSETTINGS_BACKEND", "keyfile", TRUE);
+  envp = g_environ_setenv (g_steal_pointer (&envp), "GSETTINGS_KEYFILE_WRITE_DELAY", "600000", TRUE);
+  envp = g_environ_setenv (g_steal_pointer (&envp), "XDG_CONFIG_HOME", fixture->tmp_dir, TRUE);
+
+  g_test_trap_subprocess_with_envp ("/gsettings/keyfile/write-delay/sync/subprocess",
+                                    (const gchar * const *) envp, 0,
+                                    G_TEST_SUBPROCESS_DEFAULT);
+  g_test_trap_assert_passed ();
+  g_strfreev (envp);
+
+  /* Clean up the temporary directory. */
+  store_path = g_build_filename (fixture->tmp_dir, "glib-2.0", "settings", "keyfile", NULL);
+  g_assert_no_errno (g_remove (store_path));
+  g_free (store_path);
+
+  store_path = g_build_filename (fixture->tmp_dir, "glib-2.0", "settings", NULL);
+  g_assert_no_errno (g_rmdir (store_path));
+  g_free (store_path);
+
+  store_path = g_build_filename (fixture->tmp_dir, "glib-2.0", NULL);
+  g_assert_no_errno (g_rmdir (store_path));
+  g_free (store_path);
+}
+
+static void
+test_keyfile_write_delay_sync_subprocess (void)
+{
+  GSettings *settings;
+  gchar *store_path;
+  gchar *contents;
+
+  store_path = g_build_filename (g_get_user_config_dir (), "glib-2.0", "settings", "keyfile", NULL);
+
+  settings = g_settings_new ("org.gtk.test");
+  g_settings_set (settings, "greeting", "s", "synced");
+  g_assert_false (g_file_test (store_path, G_FILE_TEST_EXISTS));
+
+  g_settings_sync ();
+
+  g_assert_true (g_file_get_contents (store_path, &contents, NULL, NULL));
+  g_assert_nonnull (strstr (contents, "greeting='synced'"));
+  g_free (contents);
+
+  g_object_unref (settings);
+  g_free (store_path);
+}
+
 /* Test that getting child schemas works
  */
 static void
@@ -3042,6 +3299,264 @@ test_memory_backend (void)
   g_object_unref (backend);
 }
 
+static gpointer
+cache_writer_thread (gpointer data)
+{
+  GSettings *settings = data;
+
+  g_settings_set_string (settings, "greeting", "from a thread");
+
+  return NULL;
+}
+
+static void
+cache_changed_cb (GSettings   *settings,
+                  const gchar *key,
+                  gpointer     data)
+{
+  guint *n_changes = data;
+  gchar *str;
+
+  /* the new value must already be visible from the signal handler */
+  str = g_settings_get_string (settings, key);
+  g_assert_cmpstr (str, ==, "from a thread");
+  g_free (str);
+
+  (*n_changes)++;
+}
+
+/* Test that values cached by a GSettings are invalidated as soon as
+ * the backend changes, even before the ::changed signal is delivered */
+static void
+test_cache (void)
+{
+  GSettingsBackend *backend;
+  GSettings *settings;
+  GSettings *settings2;
+  GThread *thread;
+  guint n_changes = 0;
+  gchar *str;
+
+  backend = g_memory_settings_backend_new ();
+  settings = g_settings_new_with_backend ("org.gtk.test", backend);
+  settings2 = g_settings_new_with_backend ("org.gtk.test", backend);
+
+  /* populate the cache, twice to hit it */
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "Hello, earthlings");
+  g_free (str);
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "Hello, earthlings");
+  g_free (str);
+
+  g_settings_set_string (settings2, "greeting", "hi");
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "hi");
+  g_free (str);
+
+  g_settings_reset (settings2, "greeting");
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "Hello, earthlings");
+  g_free (str);
+
+  /* Own the main context so that the change notification from the
+   * other thread is queued rather than dispatched there */
+  g_signal_connect (settings, "changed::greeting",
+                    G_CALLBACK (cache_changed_cb), &n_changes);
+  g_assert_true (g_main_context_acquire (NULL));
+
+  thread = g_thread_new ("writer", cache_writer_thread, settings2);
+  g_thread_join (thread);
+
+  g_assert_cmpuint (n_changes, ==, 0);
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "from a thread");
+  g_free (str);
+
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_cmpuint (n_changes, ==, 1);
+
+  g_main_context_release (NULL);
+
+  g_object_unref (settings2);
+  g_object_unref (settings);
+  g_object_unref (backend);
+}
+
+/* A backend that can lock keys at runtime; locked keys read as their
+ * default value */
+typedef struct
+{
+  GSettingsBackend parent_instance;
+
+  GMutex lock;
+  GHashTable *values;
+  GHashTable *locked;
+} TestLockBackend;
+
+typedef GSettingsBackendClass TestLockBackendClass;
+
+static GType test_lock_backend_get_type (void);
+G_DEFINE_TYPE (TestLockBackend, test_lock_backend, G_TYPE_SETTINGS_BACKEND)
+
+static GVariant *
+test_lock_backend_read (GSettingsBackend   *backend,
+                        const gchar        *key,
+                        const GVariantType *expected_type,
+                        gboolean            default_value)
+{
+  TestLockBackend *self = (TestLockBackend *) backend;
+  GVariant *value = NULL;
+
+  g_mutex_lock (&self->lock);
+  if (!default_value && !g_hash_table_contains (self->locked, key))
+    value = g_hash_table_lookup (self->values, key);
+  if (value != NULL)
+    g_variant_ref (value);
+  g_mutex_unlock (&self->lock);
+
+  return value;
+}
+
+static gboolean
+test_lock_backend_write (GSettingsBackend *backend,
+                         const gchar      *key,
+                         GVariant         *value,
+                         gpointer          origin_tag)
+{
+  TestLockBackend *self = (TestLockBackend *) backend;
+
+  g_mutex_lock (&self->lock);
+  g_hash_table_insert (self->values, g_strdup (key), g_variant_ref_sink (value));
+  g_mutex_unlock (&self->lock);
+
+  g_settings_backend_changed (backend, key, origin_tag);
+
+  return TRUE;
+}
+
+static gboolean
+test_lock_backend_get_writable (GSettingsBackend *backend,
+                                const gchar      *key)
+{
+  TestLockBackend *self = (TestLockBackend *) backend;
+  gboolean writable;
+
+  g_mutex_lock (&self->lock);
+  writable = !g_hash_table_contains (self->locked, key);
+  g_mutex_unlock (&self->lock);
+
+  return writable;
+}
+
+static void
+test_lock_backend_finalize (GObject *object)
+{
+  TestLockBackend *self = (TestLockBackend *) object;
+
+  g_hash_table_unref (self->values);
+  g_hash_table_unref (self->locked);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (test_lock_backend_parent_class)->finalize (object);
+}
+
+static void
+test_lock_backend_init (TestLockBackend *self)
+{
+  g_mutex_init (&self->lock);
+  self->values = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                        g_free, (GDestroyNotify) g_variant_unref);
+  self->locked = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+}
+
+static void
+test_lock_backend_class_init (TestLockBackendClass *class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+  object_class->finalize = test_lock_backend_finalize;
+
+  class->read = test_lock_backend_read;
+  class->write = test_lock_backend_write;
+  class->get_writable = test_lock_backend_get_writable;
+}
+
+static gpointer
+cache_lock_thread (gpointer data)
+{
+  TestLockBackend *backend = data;
+
+  g_mutex_lock (&backend->lock);
+  g_hash_table_add (backend->locked, g_strdup ("/tests/greeting"));
+  g_mutex_unlock (&backend->lock);
+
+  g_settings_backend_writable_changed (G_SETTINGS_BACKEND (backend), "/tests/greeting");
+
+  return NULL;
+}
+
+static void
+assert_greeting (GSettings   *settings,
+                 const gchar *expected)
+{
+  gchar *str;
+
+  /* twice, so that the second read comes from the cache */
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, expected);
+  g_free (str);
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, expected);
+  g_free (str);
+}
+
+/* Test that the value cache of a GSettings in delay-apply mode is
+ * invalidated as soon as the underlying backend changes, and that locking
+ * a key invalidates it, before any notification reaches the main context */
+static void
+test_cache_delay_and_lock (void)
+{
+  GSettingsBackend *backend;
+  GSettings *settings;
+  GSettings *delayed;
+  GThread *thread;
+
+  backend = g_object_new (test_lock_backend_get_type (), NULL);
+  settings = g_settings_new_with_backend ("org.gtk.test", backend);
+  delayed = g_settings_new_with_backend ("org.gtk.test", backend);
+  g_settings_delay (delayed);
+
+  assert_greeting (settings, "Hello, earthlings");
+  assert_greeting (delayed, "Hello, earthlings");
+
+  /* Own the main context so that notifications from the other threads are
+   * queued rather than dispatched there */
+  g_assert_true (g_main_context_acquire (NULL));
+
+  thread = g_thread_new ("writer", cache_writer_thread, settings);
+  g_thread_join (thread);
+
+  assert_greeting (settings, "from a thread");
+  assert_greeting (delayed, "from a thread");
+
+  thread = g_thread_new ("locker", cache_lock_thread, backend);
+  g_thread_join (thread);
+
+  assert_greeting (settings, "Hello, earthlings");
+  assert_greeting (delayed, "Hello, earthlings");
+
+  while (g_main_context_iteration (NULL, FALSE));
+  g_main_context_release (NULL);
+
+  g_assert_false (g_settings_is_writable (settings, "greeting"));
+  g_assert_false (g_settings_get_has_unapplied (delayed));
+
+  g_object_unref (delayed);
+  g_object_unref (settings);
+  g_object_unref (backend);
+}
+
 static void
 test_read_descriptions (void)
 {
@@ -3403,6 +3918,11 @@ main (int argc, char *argv[])
   g_test_add ("/gsettings/keyfile/long-path", Fixture, &keyfile_test_data_long_path, setup, test_keyfile_no_path, teardown);
   g_test_add ("/gsettings/keyfile/outside-root-path", Fixture, NULL, setup, test_keyfile_outside_root_path, teardown);
   g_test_add ("/gsettings/keyfile/no-root-group", Fixture, NULL, setup, test_keyfile_no_root_group, teardown);
+  g_test_add ("/gsettings/keyfile/external-rewrite", Fixture, NULL, setup, test_keyfile_external_rewrite, teardown);
+  g_test_add ("/gsettings/keyfile/write-delay", Fixture, NULL, setup, test_keyfile_write_delay, teardown);
+  g_test_add ("/gsettings/keyfile/write-delay/expire", Fixture, NULL, setup, test_keyfile_write_delay_expire, teardown);
+  g_test_add ("/gsettings/keyfile/write-delay/sync", Fixture, NULL, setup, test_keyfile_write_delay_sync, teardown);
+  g_test_add_func ("/gsettings/keyfile/write-delay/sync/subprocess", test_keyfile_write_delay_sync_subprocess);
   g_test_add_func ("/gsettings/child-schema", test_child_schema);
   g_test_add_func ("/gsettings/strinfo", test_strinfo);
   g_test_add_func ("/gsettings/enums", test_enums);
@@ -3427,6 +3947,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/gsettings/actions", test_actions);
   g_test_add_func ("/gsettings/null-backend", test_null_backend);
   g_test_add_func ("/gsettings/memory-backend", test_memory_backend);
+  g_test_add_func ("/gsettings/cache", test_cache);
+  g_test_add_func ("/gsettings/cache/delay-and-lock", test_cache_delay_and_lock);
   g_test_add_func ("/gsettings/read-descriptions", test_read_descriptions);
   g_test_add_func ("/gsettings/test-extended-schema", test_extended_schema);
   g_test_add_func ("/gsettings/default-value", test_default_value);
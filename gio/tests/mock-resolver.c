@@ -29,6 +29,7 @@ struct _MockResolver
   GList *ipv6_results;
   GError *ipv4_error;
   GError *ipv6_error;
+  guint n_lookups;
 };
 
 G_DEFINE_TYPE (MockResolver, mock_resolver, G_TYPE_RESOLVER)
@@ -89,6 +90,12 @@ mock_resolver_set_ipv6_error (MockResolver *self, GError *error)
     self->ipv6_error = g_error_copy (error);
 }
 
+guint
+mock_resolver_get_n_lookups (MockResolver *self)
+{
+  return self->n_lookups;
+}
+
 static gboolean lookup_by_name_cb (gpointer user_data);
 
 /* Core of the implementation of `lookup_by_name()` in the mock resolver.
@@ -108,6 +115,7 @@ do_lookup_by_name (MockResolver             *self,
 {
   GSource *source = NULL;
 
+  self->n_lookups++;
   g_task_set_task_data (task, GINT_TO_POINTER (flags), NULL);
 
   if (flags == G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY)
@@ -176,6 +184,24 @@ lookup_by_name_with_flags_async (GResolver                *resolver,
   g_object_unref (task);
 }
 
+static void
+lookup_by_name_async (GResolver           *resolver,
+                      const gchar         *hostname,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             user_data)
+{
+  MockResolver *self = MOCK_RESOLVER (resolver);
+  GTask *task = NULL;
+
+  task = g_task_new (resolver, cancellable, callback, user_data);
+  g_task_set_source_tag (task, lookup_by_name_async);
+
+  do_lookup_by_name (self, task, G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT);
+
+  g_object_unref (task);
+}
+
 static void
 async_result_cb (GObject      *source_object,
                  GAsyncResult *result,
@@ -256,6 +282,8 @@ mock_resolver_class_init (MockResolverClass *klass)
   resolver_class->lookup_by_name_with_flags_async  = lookup_by_name_with_flags_async;
   resolver_class->lookup_by_name_with_flags_finish = lookup_by_name_with_flags_finish;
   resolver_class->lookup_by_name = lookup_by_name;
+  resolver_class->lookup_by_name_async = lookup_by_name_async;
+  resolver_class->lookup_by_name_finish = lookup_by_name_with_flags_finish;
   object_class->finalize = mock_resolver_finalize;
 }
 
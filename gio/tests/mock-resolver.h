@@ -34,4 +34,5 @@ void mock_resolver_set_ipv4_error (MockResolver *self, GError *error);
 void mock_resolver_set_ipv6_delay_ms (MockResolver *self, guint delay_ms);
 void mock_resolver_set_ipv6_results (MockResolver *self, GList *results);
 void mock_resolver_set_ipv6_error (MockResolver *self, GError *error);
+guint mock_resolver_get_n_lookups (MockResolver *self);
 G_END_DECLS
@@ -555,6 +555,79 @@ test_resource_registered (void)
   g_clear_error (&error);
 }
 
+static void
+test_resource_registered_overlapping (void)
+{
+  GResource *resource1, *resource2;
+  GError *error = NULL;
+  GBytes *data;
+  GInputStream *in;
+  char **children;
+  gboolean found;
+
+  g_test_summary ("Test global lookups in several registered resources sharing paths");
+
+  resource1 = g_resource_load (g_test_get_filename (G_TEST_BUILT, "test.gresource", NULL), &error);
+  g_assert_no_error (error);
+  resource2 = g_resource_load (g_test_get_filename (G_TEST_BUILT, "test.gresource", NULL), &error);
+  g_assert_no_error (error);
+
+  g_resources_register (resource1);
+  g_resources_register (resource2);
+
+  /* Children present in both resources are only listed once */
+  children = g_resources_enumerate_children ("/a_prefix", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_strv_length (children), ==, 2);
+  g_strfreev (children);
+
+  /* The root is shared with the resources registered by the test binary */
+  children = g_resources_enumerate_children ("/", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_true (g_strv_contains ((const gchar * const *) children, "a_prefix/"));
+  g_assert_true (g_strv_contains ((const gchar * const *) children, "manual_loaded/"));
+  g_strfreev (children);
+
+  data = g_resources_lookup_data ("/a_prefix/test2.txt/", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (g_bytes_get_data (data, NULL), ==, "test2\n");
+  g_bytes_unref (data);
+
+  /* Lookups fall back to the remaining registration */
+  g_resources_unregister (resource2);
+
+  data = g_resources_lookup_data ("/a_prefix/test2.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (g_bytes_get_data (data, NULL), ==, "test2\n");
+  g_bytes_unref (data);
+
+  g_resources_unregister (resource1);
+
+  found = g_resources_get_info ("/a_prefix/test2.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, NULL, NULL, &error);
+  g_assert_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND);
+  g_assert_false (found);
+  g_clear_error (&error);
+
+  in = g_resources_open_stream ("/a_prefix/test2.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND);
+  g_assert_null (in);
+  g_clear_error (&error);
+
+  children = g_resources_enumerate_children ("/a_prefix", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND);
+  g_assert_null (children);
+  g_clear_error (&error);
+
+  children = g_resources_enumerate_children ("/", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_false (g_strv_contains ((const gchar * const *) children, "a_prefix/"));
+  g_assert_true (g_strv_contains ((const gchar * const *) children, "manual_loaded/"));
+  g_strfreev (children);
+
+  g_resource_unref (resource2);
+  g_resource_unref (resource1);
+}
+
 static void
 test_resource_automatic (void)
 {
@@ -1015,6 +1088,157 @@ test_resource_64k (void)
   g_bytes_unref (data);
 }
 
+static void
+test_resource_compressed (void)
+{
+  GError *error = NULL;
+  gboolean found;
+  gsize size;
+  guint32 flags;
+  GBytes *expected, *data, *data2;
+  GInputStream *in;
+  gchar *buffer;
+  gsize bytes_read;
+
+  expected = g_resources_lookup_data ("/big_prefix/gresource-big-test.txt",
+                                      G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                      &error);
+  g_assert_no_error (error);
+
+  found = g_resources_get_info ("/compressed/big-zlib.txt",
+                                G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                &size, &flags, &error);
+  g_assert_no_error (error);
+  g_assert_true (found);
+  g_assert_cmpuint (size, ==, g_bytes_get_size (expected));
+  g_assert_cmpuint (flags, ==, G_RESOURCE_FLAGS_COMPRESSED);
+
+  found = g_resources_get_info ("/compressed/big-lz4.txt",
+                                G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                &size, &flags, &error);
+  g_assert_no_error (error);
+  g_assert_true (found);
+  g_assert_cmpuint (size, ==, g_bytes_get_size (expected));
+  g_assert_cmpuint (flags, ==, G_RESOURCE_FLAGS_COMPRESSED | G_RESOURCE_FLAGS_COMPRESSED_LZ4);
+
+  /* Repeated lookups of compressed data share the cached copy */
+  data = g_resources_lookup_data ("/compressed/big-zlib.txt",
+                                  G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                  &error);
+  g_assert_no_error (error);
+  g_assert_true (g_bytes_equal (data, expected));
+  data2 = g_resources_lookup_data ("/compressed/big-zlib.txt",
+                                   G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                   &error);
+  g_assert_no_error (error);
+  g_assert_true (g_bytes_get_data (data2, NULL) == g_bytes_get_data (data, NULL));
+  g_bytes_unref (data2);
+  g_bytes_unref (data);
+
+  data = g_resources_lookup_data ("/compressed/big-lz4.txt",
+                                  G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                  &error);
+  g_assert_no_error (error);
+  g_assert_true (g_bytes_equal (data, expected));
+  g_assert_cmpint (((const gchar *) g_bytes_get_data (data, NULL))[g_bytes_get_size (data)], ==, 0);
+  g_bytes_unref (data);
+
+  data = g_resources_lookup_data ("/compressed/small-lz4.txt",
+                                  G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                  &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (g_bytes_get_data (data, NULL), ==, "test1\n");
+  g_bytes_unref (data);
+
+  /* Streams give the same data */
+  buffer = g_malloc (g_bytes_get_size (expected) + 1);
+
+  in = g_resources_open_stream ("/compressed/big-lz4.txt",
+                                G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                &error);
+  g_assert_no_error (error);
+  g_input_stream_read_all (in, buffer, g_bytes_get_size (expected) + 1,
+                           &bytes_read, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (buffer, bytes_read,
+                   g_bytes_get_data (expected, NULL), g_bytes_get_size (expected));
+  g_object_unref (in);
+
+  in = g_resources_open_stream ("/compressed/big-zlib.txt",
+                                G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                &error);
+  g_assert_no_error (error);
+  g_input_stream_read_all (in, buffer, g_bytes_get_size (expected) + 1,
+                           &bytes_read, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (buffer, bytes_read,
+                   g_bytes_get_data (expected, NULL), g_bytes_get_size (expected));
+  g_object_unref (in);
+
+  g_free (buffer);
+  g_bytes_unref (expected);
+}
+
+/* Test that corrupt LZ4 data is reported as an error rather than read out of
+ * bounds. test.gresource contains /lz4/test1.txt, whose 6 bytes are stored as
+ * a single literal run; claim a longer run than there is input. */
+static void
+test_resource_compressed_corrupt (void)
+{
+  const guint32 header[] = { 6, G_RESOURCE_FLAGS_COMPRESSED | G_RESOURCE_FLAGS_COMPRESSED_LZ4 };
+  GResource *resource;
+  GError *error = NULL;
+  gboolean loaded_file;
+  char *content, *entry;
+  gsize content_size;
+  GBytes *data;
+  GInputStream *in;
+  gboolean found;
+  gsize size;
+  guint32 flags;
+
+  loaded_file = g_file_get_contents (g_test_get_filename (G_TEST_BUILT, "test.gresource", NULL),
+                                     &content, &content_size, NULL);
+  g_assert_true (loaded_file);
+
+  for (entry = content; entry + sizeof (header) + 7 <= content + content_size; entry++)
+    if (memcmp (entry, header, sizeof (header)) == 0)
+      break;
+  g_assert_true (entry + sizeof (header) + 7 <= content + content_size);
+  entry += sizeof (header);
+  g_assert_cmpmem (entry, 7, "\x60test1\n", 7);
+  entry[0] = (char) 0xf0;
+
+  data = g_bytes_new_take (content, content_size);
+  resource = g_resource_new_from_data (data, &error);
+  g_bytes_unref (data);
+  g_assert_no_error (error);
+
+  /* The metadata is still readable */
+  found = g_resource_get_info (resource, "/lz4/test1.txt",
+                               G_RESOURCE_LOOKUP_FLAGS_NONE,
+                               &size, &flags, &error);
+  g_assert_no_error (error);
+  g_assert_true (found);
+  g_assert_cmpuint (size, ==, 6);
+
+  data = g_resource_lookup_data (resource, "/lz4/test1.txt",
+                                 G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                 &error);
+  g_assert_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL);
+  g_assert_null (data);
+  g_clear_error (&error);
+
+  in = g_resource_open_stream (resource, "/lz4/test1.txt",
+                               G_RESOURCE_LOOKUP_FLAGS_NONE,
+                               &error);
+  g_assert_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL);
+  g_assert_null (in);
+  g_clear_error (&error);
+
+  g_resource_unref (resource);
+}
+
 /* Check that g_resources_get_info() respects G_RESOURCE_OVERLAYS */
 static void
 test_overlay (void)
@@ -1062,6 +1286,7 @@ main (int   argc,
   g_test_add_func ("/resource/data-corrupt", test_resource_data_corrupt);
   g_test_add_func ("/resource/data-empty", test_resource_data_empty);
   g_test_add_func ("/resource/registered", test_resource_registered);
+  g_test_add_func ("/resource/registered-overlapping", test_resource_registered_overlapping);
   g_test_add_func ("/resource/manual", test_resource_manual);
   g_test_add_func ("/resource/manual2", test_resource_manual2);
 #ifdef G_HAS_CONSTRUCTORS
@@ -1073,6 +1298,8 @@ main (int   argc,
   g_test_add_func ("/resource/uri/query-info", test_uri_query_info);
   g_test_add_func ("/resource/uri/file", test_uri_file);
   g_test_add_func ("/resource/64k", test_resource_64k);
+  g_test_add_func ("/resource/compressed", test_resource_compressed);
+  g_test_add_func ("/resource/compressed/corrupt", test_resource_compressed_corrupt);
   g_test_add_func ("/resource/overlay", test_overlay);
   g_test_add_func ("/resource/digits", test_resource_digits);
 
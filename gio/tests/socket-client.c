@@ -0,0 +1,290 @@
+/* GLib testing framework examples and tests
+ *
+ * Copyright 2024 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+
+typedef struct {
+  GSocketListener *listener;
+  GSocketConnectable *address;  /* the listening address */
+  GSocketClient *client;
+  GPtrArray *servers;  /* (element-type GSocketConnection) accepted connections */
+} Fixture;
+
+static void
+setup (Fixture       *fixture,
+       gconstpointer  user_data)
+{
+  GInetAddress *iaddr;
+  GSocketAddress *saddr, *effective_address = NULL;
+  GError *error = NULL;
+
+  fixture->listener = g_socket_listener_new ();
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  saddr = g_inet_socket_address_new (iaddr, 0);
+  g_socket_listener_add_address (fixture->listener, saddr,
+                                 G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP,
+                                 NULL, &effective_address, &error);
+  g_assert_no_error (error);
+  fixture->address = G_SOCKET_CONNECTABLE (effective_address);
+  g_object_unref (saddr);
+  g_object_unref (iaddr);
+
+  fixture->servers = g_ptr_array_new_with_free_func (g_object_unref);
+  fixture->client = g_socket_client_new ();
+  g_socket_client_set_enable_proxy (fixture->client, FALSE);
+  g_socket_client_set_max_idle_connections_per_host (fixture->client, 2);
+}
+
+static void
+teardown (Fixture       *fixture,
+          gconstpointer  user_data)
+{
+  g_assert_finalize_object (fixture->client);
+  g_ptr_array_unref (fixture->servers);
+  g_object_unref (fixture->address);
+  g_socket_listener_close (fixture->listener);
+  g_object_unref (fixture->listener);
+}
+
+static GSocketConnection *
+connect_and_accept (Fixture            *fixture,
+                    GSocketConnection **server_out)
+{
+  GSocketConnection *connection, *server;
+  GError *error = NULL;
+
+  connection = g_socket_client_connect (fixture->client, fixture->address, NULL, &error);
+  g_assert_no_error (error);
+
+  server = g_socket_listener_accept (fixture->listener, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  /* Keep the server side open, so that the connection stays reusable. */
+  if (server_out != NULL)
+    *server_out = server;
+  else
+    g_ptr_array_add (fixture->servers, server);
+
+  return connection;
+}
+
+static void
+assert_statistics (GSocketClient *client,
+                   guint64        expected_hits,
+                   guint64        expected_misses,
+                   guint          expected_idle)
+{
+  guint64 n_hits, n_misses;
+  guint n_idle;
+
+  g_socket_client_get_pool_statistics (client, &n_hits, &n_misses, &n_idle);
+  g_assert_cmpuint (n_hits, ==, expected_hits);
+  g_assert_cmpuint (n_misses, ==, expected_misses);
+  g_assert_cmpuint (n_idle, ==, expected_idle);
+}
+
+static void
+wait_for_eof (GSocketConnection *connection)
+{
+  GError *error = NULL;
+
+  g_socket_condition_wait (g_socket_connection_get_socket (connection),
+                           G_IO_IN, NULL, &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_pool_reuse (Fixture       *fixture,
+                 gconstpointer  user_data)
+{
+  GSocketConnection *connection, *server, *reused;
+  GError *error = NULL;
+
+  connection = connect_and_accept (fixture, &server);
+  assert_statistics (fixture->client, 0, 1, 0);
+
+  g_socket_client_release_connection (fixture->client, connection);
+  assert_statistics (fixture->client, 0, 1, 1);
+
+  reused = g_socket_client_connect (fixture->client, fixture->address, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (reused == connection);
+  assert_statistics (fixture->client, 1, 1, 0);
+
+  /* A connection closed by the peer while idle is not reused. */
+  g_socket_client_release_connection (fixture->client, reused);
+  assert_statistics (fixture->client, 1, 1, 1);
+  g_io_stream_close (G_IO_STREAM (server), NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (server);
+  wait_for_eof (connection);
+
+  reused = connect_and_accept (fixture, NULL);
+  g_assert_true (g_socket_is_connected (g_socket_connection_get_socket (reused)));
+  assert_statistics (fixture->client, 1, 2, 0);
+
+  /* Nor is one closed before being released. */
+  g_io_stream_close (G_IO_STREAM (reused), NULL, &error);
+  g_assert_no_error (error);
+  g_socket_client_release_connection (fixture->client, reused);
+  assert_statistics (fixture->client, 1, 2, 0);
+}
+
+static void
+connected_cb (GObject      *source,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+  GSocketConnection **connection_out = user_data;
+  GError *error = NULL;
+
+  *connection_out = g_socket_client_connect_finish (G_SOCKET_CLIENT (source), result, &error);
+  g_assert_no_error (error);
+  g_main_context_wakeup (NULL);
+}
+
+static void
+test_pool_async (Fixture       *fixture,
+                 gconstpointer  user_data)
+{
+  GSocketConnection *connection, *reused = NULL;
+
+  connection = connect_and_accept (fixture, NULL);
+  g_socket_client_release_connection (fixture->client, connection);
+
+  g_socket_client_connect_async (fixture->client, fixture->address, NULL,
+                                 connected_cb, &reused);
+  while (reused == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_true (reused == connection);
+  assert_statistics (fixture->client, 1, 1, 0);
+
+  g_object_unref (reused);
+}
+
+static void
+test_pool_limits (Fixture       *fixture,
+                  gconstpointer  user_data)
+{
+  GSocketConnection *connections[3];
+  GSocketClient *other_client;
+  GSocketConnection *other;
+  GError *error = NULL;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (connections); i++)
+    connections[i] = connect_and_accept (fixture, NULL);
+
+  /* Only two connections are kept per host. */
+  for (i = 0; i < G_N_ELEMENTS (connections); i++)
+    g_socket_client_release_connection (fixture->client, connections[i]);
+  assert_statistics (fixture->client, 0, 3, 2);
+
+  g_socket_client_flush_idle_connections (fixture->client);
+  assert_statistics (fixture->client, 0, 3, 0);
+
+  /* Connections made with other settings are kept apart. */
+  other_client = g_socket_client_new ();
+  g_socket_client_set_enable_proxy (other_client, FALSE);
+  other = g_socket_client_connect (other_client, fixture->address, NULL, &error);
+  g_assert_no_error (error);
+  g_socket_client_release_connection (fixture->client, other);
+  assert_statistics (fixture->client, 0, 3, 0);
+  g_object_unref (other_client);
+
+  /* So are connections from another client, even with the same settings. */
+  other_client = g_socket_client_new ();
+  g_socket_client_set_enable_proxy (other_client, FALSE);
+  g_socket_client_set_max_idle_connections_per_host (other_client, 2);
+  other = g_socket_client_connect (other_client, fixture->address, NULL, &error);
+  g_assert_no_error (error);
+  g_socket_client_release_connection (fixture->client, other);
+  assert_statistics (fixture->client, 0, 3, 0);
+  assert_statistics (other_client, 0, 1, 0);
+  g_object_unref (other_client);
+
+  /* Disabling pooling drops the idle connections. */
+  g_socket_client_release_connection (fixture->client, connect_and_accept (fixture, NULL));
+  assert_statistics (fixture->client, 0, 4, 1);
+  g_socket_client_set_max_idle_connections_per_host (fixture->client, 0);
+  assert_statistics (fixture->client, 0, 4, 0);
+}
+
+static void
+test_pool_proxy_resolver (Fixture       *fixture,
+                          gconstpointer  user_data)
+{
+  GProxyResolver *resolver;
+  gsize i;
+
+  /* Connections are not reused once the proxy resolver has changed, even if
+   * the new resolver is allocated where the old one was. */
+  for (i = 0; i < 3; i++)
+    {
+      resolver = g_simple_proxy_resolver_new (NULL, NULL);
+      g_socket_client_set_proxy_resolver (fixture->client, resolver);
+      g_object_unref (resolver);
+
+      g_socket_client_release_connection (fixture->client, connect_and_accept (fixture, NULL));
+      assert_statistics (fixture->client, 0, i + 1, i + 1);
+
+      g_socket_client_set_proxy_resolver (fixture->client, NULL);
+    }
+}
+
+static void
+test_pool_idle_timeout (Fixture       *fixture,
+                        gconstpointer  user_data)
+{
+  guint n_idle;
+  gint64 deadline;
+
+  g_socket_client_set_idle_timeout (fixture->client, 1);
+  g_socket_client_release_connection (fixture->client, connect_and_accept (fixture, NULL));
+  assert_statistics (fixture->client, 0, 1, 1);
+
+  /* Idle connections are expired without any main loop running. */
+  deadline = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+  do
+    {
+      g_usleep (G_USEC_PER_SEC / 10);
+      g_socket_client_get_pool_statistics (fixture->client, NULL, NULL, &n_idle);
+    }
+  while (n_idle > 0 && g_get_monotonic_time () < deadline);
+
+  g_assert_cmpuint (n_idle, ==, 0);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add ("/socket-client/pool/reuse", Fixture, NULL, setup, test_pool_reuse, teardown);
+  g_test_add ("/socket-client/pool/async", Fixture, NULL, setup, test_pool_async, teardown);
+  g_test_add ("/socket-client/pool/limits", Fixture, NULL, setup, test_pool_limits, teardown);
+  g_test_add ("/socket-client/pool/proxy-resolver", Fixture, NULL, setup, test_pool_proxy_resolver, teardown);
+  g_test_add ("/socket-client/pool/idle-timeout", Fixture, NULL, setup, test_pool_idle_timeout, teardown);
+
+  return g_test_run ();
+}
@@ -20,6 +20,7 @@
  */
 
 #include <gio/gio.h>
+#include <gio/gnetworking.h>
 
 static void
 active_notify_cb (GSocketService *service,
@@ -553,6 +554,388 @@ test_read_writev_async (void)
 }
 
 
+#define N_PARKED_CLIENTS 3
+
+typedef struct
+{
+  guint16 port;
+  gint n_runs;  /* (atomic) */
+  gint n_closed;  /* (atomic) */
+  gboolean client_done;  /* (atomic) */
+} ParkedData;
+
+static gboolean
+parked_run_cb (GThreadedSocketService *service,
+               GSocketConnection      *connection,
+               GObject                *source_object,
+               gpointer                user_data)
+{
+  ParkedData *data = user_data;
+  GInputStream *in = g_io_stream_get_input_stream (G_IO_STREAM (connection));
+  GOutputStream *out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+  gchar buf[64];
+  gssize n_read;
+  GError *error = NULL;
+
+  g_atomic_int_inc (&data->n_runs);
+
+  /* The connection is not parked while it is being handled. */
+  g_assert_false (g_threaded_socket_service_resume_connection (service, connection));
+
+  /* Only handle what is available, so as to never block the only thread. */
+  n_read = g_pollable_input_stream_read_nonblocking (G_POLLABLE_INPUT_STREAM (in),
+                                                     buf, sizeof (buf),
+                                                     NULL, &error);
+  if (n_read < 0)
+    {
+      g_assert_error (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK);
+      g_clear_error (&error);
+    }
+  else if (n_read == 0)
+    {
+      g_io_stream_close (G_IO_STREAM (connection), NULL, &error);
+      g_assert_no_error (error);
+      g_atomic_int_inc (&data->n_closed);
+      return TRUE;
+    }
+  else
+    {
+      g_output_stream_write_all (out, buf, n_read, NULL, NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  g_threaded_socket_service_park_connection (service, connection);
+
+  return TRUE;
+}
+
+static gpointer
+parked_client_thread (gpointer user_data)
+{
+  ParkedData *data = user_data;
+  GSocketClient *client;
+  GSocketConnection *conns[N_PARKED_CLIENTS];
+  GError *error = NULL;
+  guint round, i;
+
+  client = g_socket_client_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (conns); i++)
+    {
+      conns[i] = g_socket_client_connect_to_host (client, "127.0.0.1", data->port,
+                                                  NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  /* Talk to all the connections in turn; with a single thread in the
+   * service, this only works if idle connections do not occupy it. */
+  for (round = 0; round < 2; round++)
+    {
+      for (i = 0; i < G_N_ELEMENTS (conns); i++)
+        {
+          GInputStream *in = g_io_stream_get_input_stream (G_IO_STREAM (conns[i]));
+          GOutputStream *out = g_io_stream_get_output_stream (G_IO_STREAM (conns[i]));
+          gchar buf[6] = { 0, };
+
+          g_output_stream_write_all (out, "hello", 5, NULL, NULL, &error);
+          g_assert_no_error (error);
+          g_input_stream_read_all (in, buf, 5, NULL, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpstr (buf, ==, "hello");
+        }
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (conns); i++)
+    {
+      g_io_stream_close (G_IO_STREAM (conns[i]), NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (conns[i]);
+    }
+
+  g_object_unref (client);
+  g_atomic_int_set (&data->client_done, TRUE);
+  g_main_context_wakeup (NULL);
+
+  return NULL;
+}
+
+static void
+test_threaded_park (void)
+{
+  GSocketService *service;
+  GThread *client_thread;
+  ParkedData data = { 0, };
+  GError *error = NULL;
+
+  g_test_summary ("Test that parked connections do not occupy threads of a "
+                  "GThreadedSocketService, and are handled again when readable");
+
+  service = g_threaded_socket_service_new (1);
+  g_signal_connect (service, "run", G_CALLBACK (parked_run_cb), &data);
+
+  data.port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service),
+                                                   NULL, &error);
+  g_assert_no_error (error);
+
+  client_thread = g_thread_new ("parked-client", parked_client_thread, &data);
+
+  while (!g_atomic_int_get (&data.client_done) ||
+         g_atomic_int_get (&data.n_closed) < N_PARKED_CLIENTS)
+    g_main_context_iteration (NULL, !g_atomic_int_get (&data.client_done));
+
+  g_thread_join (client_thread);
+
+  /* One run per round, and one for closing, at least. */
+  g_assert_cmpint (g_atomic_int_get (&data.n_runs), >=, N_PARKED_CLIENTS * 3);
+
+  g_socket_service_stop (service);
+  g_socket_listener_close (G_SOCKET_LISTENER (service));
+  g_object_unref (service);
+}
+
+typedef struct
+{
+  guint16 port;
+  gint in_run;  /* (atomic) */
+  gint n_runs;  /* (atomic) */
+  gboolean overlapped;  /* (atomic) */
+  gboolean parked;  /* (atomic) */
+  gboolean client_done;  /* (atomic) */
+} ParkRaceData;
+
+static gboolean
+park_race_run_cb (GThreadedSocketService *service,
+                  GSocketConnection      *connection,
+                  GObject                *source_object,
+                  gpointer                user_data)
+{
+  ParkRaceData *data = user_data;
+  GSocket *socket = g_socket_connection_get_socket (connection);
+  GError *error = NULL;
+
+  if (g_atomic_int_add (&data->in_run, 1) != 0)
+    g_atomic_int_set (&data->overlapped, TRUE);
+
+  if (g_atomic_int_add (&data->n_runs, 1) == 0)
+    {
+      /* Park, and let data arrive and the connection be resumed before
+       * returning: neither may run the connection again until then. */
+      g_threaded_socket_service_park_connection (service, connection);
+      g_atomic_int_set (&data->parked, TRUE);
+
+      g_socket_condition_wait (socket, G_IO_IN, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_true (g_threaded_socket_service_resume_connection (service, connection));
+      g_usleep (G_USEC_PER_SEC / 10);
+    }
+  else
+    {
+      gchar buf[1];
+
+      g_socket_receive (socket, buf, sizeof (buf), NULL, &error);
+      g_assert_no_error (error);
+      g_io_stream_close (G_IO_STREAM (connection), NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  g_atomic_int_add (&data->in_run, -1);
+
+  return TRUE;
+}
+
+static gpointer
+park_race_client_thread (gpointer user_data)
+{
+  ParkRaceData *data = user_data;
+  GSocketClient *client;
+  GSocketConnection *conn;
+  GInputStream *in;
+  GOutputStream *out;
+  gchar buf[1];
+  GError *error = NULL;
+
+  client = g_socket_client_new ();
+  conn = g_socket_client_connect_to_host (client, "127.0.0.1", data->port,
+                                          NULL, &error);
+  g_assert_no_error (error);
+  in = g_io_stream_get_input_stream (G_IO_STREAM (conn));
+  out = g_io_stream_get_output_stream (G_IO_STREAM (conn));
+
+  while (!g_atomic_int_get (&data->parked))
+    g_usleep (1000);
+
+  g_output_stream_write_all (out, "x", 1, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  /* Wait for the server to close the connection */
+  g_assert_cmpint (g_input_stream_read (in, buf, sizeof (buf), NULL, &error), ==, 0);
+  g_assert_no_error (error);
+
+  g_object_unref (conn);
+  g_object_unref (client);
+  g_atomic_int_set (&data->client_done, TRUE);
+  g_main_context_wakeup (NULL);
+
+  return NULL;
+}
+
+static void
+test_threaded_park_in_run (void)
+{
+  GSocketService *service;
+  GThread *client_thread;
+  ParkRaceData data = { 0, };
+  GError *error = NULL;
+
+  g_test_summary ("Test that a connection parked or resumed while ::run is "
+                  "still running is not handled again before ::run returns");
+
+  service = g_threaded_socket_service_new (4);
+  g_signal_connect (service, "run", G_CALLBACK (park_race_run_cb), &data);
+
+  data.port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service),
+                                                   NULL, &error);
+  g_assert_no_error (error);
+
+  client_thread = g_thread_new ("park-race-client", park_race_client_thread, &data);
+
+  while (!g_atomic_int_get (&data.client_done))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_thread_join (client_thread);
+
+  g_assert_false (g_atomic_int_get (&data.overlapped));
+  g_assert_cmpint (g_atomic_int_get (&data.n_runs), ==, 2);
+
+  g_socket_service_stop (service);
+  g_socket_listener_close (G_SOCKET_LISTENER (service));
+  g_object_unref (service);
+}
+
+#define N_SHARDED_CLIENTS 32
+#define N_SHARDED_QUEUED_CLIENTS 8
+
+typedef struct
+{
+  GMutex mutex;
+  GHashTable *threads;  /* (element-type GThread) (owned) */
+  gint n_incoming;  /* (atomic) */
+} ShardedData;
+
+static gboolean
+sharded_incoming_cb (GSocketService    *service,
+                     GSocketConnection *connection,
+                     GObject           *source_object,
+                     gpointer           user_data)
+{
+  ShardedData *data = user_data;
+  GMainContext *context = g_main_context_get_thread_default ();
+
+  /* Each worker runs its own context, distinct from the main thread’s. */
+  g_assert_nonnull (context);
+  g_assert_true (context != g_main_context_default ());
+  g_assert_true (g_main_context_is_owner (context));
+  g_assert_true (source_object == G_OBJECT (service));
+
+  g_mutex_lock (&data->mutex);
+  g_hash_table_add (data->threads, g_thread_self ());
+  g_mutex_unlock (&data->mutex);
+
+  g_atomic_int_inc (&data->n_incoming);
+
+  return TRUE;
+}
+
+static void
+test_sharded (void)
+{
+  GSocketService *service;
+  GSocketClient *client;
+  GPtrArray *connections;
+  ShardedData data;
+  GError *error = NULL;
+  guint16 port;
+  guint i;
+
+  g_test_summary ("Test that a sharded socket service accepts connections on its workers");
+
+  service = g_socket_service_new_sharded (4);
+  g_assert_cmpuint (g_socket_service_get_n_workers (service), ==, 4);
+
+  g_mutex_init (&data.mutex);
+  data.threads = g_hash_table_new (NULL, NULL);
+  data.n_incoming = 0;
+  g_signal_connect (service, "incoming", G_CALLBACK (sharded_incoming_cb), &data);
+
+  port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service),
+                                              G_OBJECT (service), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (port, !=, 0);
+
+  client = g_socket_client_new ();
+  connections = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (i = 0; i < N_SHARDED_CLIENTS; i++)
+    {
+      GSocketConnection *conn;
+
+      conn = g_socket_client_connect_to_host (client, "127.0.0.1", port, NULL, &error);
+      g_assert_no_error (error);
+      g_ptr_array_add (connections, conn);
+    }
+
+  while (g_atomic_int_get (&data.n_incoming) < N_SHARDED_CLIENTS)
+    g_usleep (1000);
+
+  g_mutex_lock (&data.mutex);
+#ifdef SO_REUSEPORT
+  /* The kernel hashes each connection to one of the shards, so with this
+   * many clients more than one of them is all but certain to be used. */
+  g_assert_cmpuint (g_hash_table_size (data.threads), >, 1);
+#else
+  g_assert_cmpuint (g_hash_table_size (data.threads), >=, 1);
+#endif
+  g_assert_cmpuint (g_hash_table_size (data.threads), <=, 4);
+  g_assert_false (g_hash_table_contains (data.threads, g_thread_self ()));
+  g_mutex_unlock (&data.mutex);
+
+  /* Stopping the service must stop all its workers from accepting. */
+  g_socket_service_stop (service);
+  g_assert_false (g_socket_service_is_active (service));
+
+  /* Few enough not to overflow the listen backlog of any shard */
+  for (i = 0; i < N_SHARDED_QUEUED_CLIENTS; i++)
+    {
+      GSocketConnection *conn;
+
+      /* The kernel still completes the handshake into the backlog */
+      conn = g_socket_client_connect_to_host (client, "127.0.0.1", port, NULL, &error);
+      g_assert_no_error (error);
+      g_ptr_array_add (connections, conn);
+    }
+
+  g_usleep (100 * G_TIME_SPAN_MILLISECOND);
+  g_assert_cmpint (g_atomic_int_get (&data.n_incoming), ==, N_SHARDED_CLIENTS);
+
+  /* Once started again, the workers accept the queued connections. */
+  g_socket_service_start (service);
+  g_assert_true (g_socket_service_is_active (service));
+
+  while (g_atomic_int_get (&data.n_incoming) < N_SHARDED_CLIENTS + N_SHARDED_QUEUED_CLIENTS)
+    g_usleep (1000);
+
+  g_socket_service_stop (service);
+  g_socket_listener_close (G_SOCKET_LISTENER (service));
+
+  g_ptr_array_unref (connections);
+  g_object_unref (client);
+  g_object_unref (service);
+
+  g_hash_table_unref (data.threads);
+  g_mutex_clear (&data.mutex);
+}
+
+
 int
 main (int   argc,
       char *argv[])
@@ -561,8 +944,11 @@ main (int   argc,
 
   g_test_add_func ("/socket-service/start-stop", test_start_stop);
   g_test_add_func ("/socket-service/threaded/712570", test_threaded_712570);
+  g_test_add_func ("/socket-service/threaded/park", test_threaded_park);
+  g_test_add_func ("/socket-service/threaded/park-in-run", test_threaded_park_in_run);
   g_test_add_func ("/socket-service/read_write_async", test_read_write_async);
   g_test_add_func ("/socket-service/read_writev_async", test_read_writev_async);
+  g_test_add_func ("/socket-service/sharded", test_sharded);
 
   return g_test_run();
 }
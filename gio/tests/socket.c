@@ -1697,6 +1697,330 @@ test_reuse_udp (void)
   g_object_unref (sock2);
 }
 
+static void
+test_udp_segment_offload (void)
+{
+  GSocket *sender, *receiver;
+  GError *error = NULL;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  GOutputVector vector;
+  GSocketControlMessage *message;
+  gchar data[350], buf[sizeof (data)];
+  gsize total = 0;
+  gssize len;
+  gboolean gro = FALSE;
+
+  if (!g_udp_segment_message_is_supported ())
+    {
+      g_test_skip ("UDP segmentation offload is not supported on this platform");
+      return;
+    }
+
+  receiver = g_socket_new (G_SOCKET_FAMILY_IPV4,
+                           G_SOCKET_TYPE_DATAGRAM,
+                           G_SOCKET_PROTOCOL_DEFAULT,
+                           &error);
+  g_assert_no_error (error);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+  g_socket_bind (receiver, addr, TRUE, &error);
+  g_object_unref (addr);
+  g_assert_no_error (error);
+
+  /* Coalescing is optional; the segments are checked either way. */
+#ifdef __linux__
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+  gro = g_socket_set_option (receiver, IPPROTO_UDP, UDP_GRO, 1, NULL);
+#endif
+  g_socket_set_timeout (receiver, 5);
+
+  sender = g_socket_new (G_SOCKET_FAMILY_IPV4,
+                         G_SOCKET_TYPE_DATAGRAM,
+                         G_SOCKET_PROTOCOL_DEFAULT,
+                         &error);
+  g_assert_no_error (error);
+
+  memset (data, 'x', sizeof (data));
+  vector.buffer = data;
+  vector.size = sizeof (data);
+  message = g_udp_segment_message_new (100);
+  g_assert_cmpuint (g_udp_segment_message_get_segment_size (G_UDP_SEGMENT_MESSAGE (message)), ==, 100);
+
+  addr = g_socket_get_local_address (receiver, &error);
+  g_assert_no_error (error);
+  len = g_socket_send_message (sender, addr, &vector, 1, &message, 1,
+                               G_SOCKET_MSG_NONE, NULL, &error);
+  g_object_unref (addr);
+  g_object_unref (message);
+
+  if (len < 0)
+    {
+      /* Older kernels reject the control message */
+      g_test_skip_printf ("UDP segmentation offload is not available: %s", error->message);
+      g_clear_error (&error);
+      g_object_unref (sender);
+      g_object_unref (receiver);
+      return;
+    }
+  g_assert_cmpint (len, ==, sizeof (data));
+
+  while (total < sizeof (data))
+    {
+      GInputVector input = { buf, sizeof (buf) };
+      GSocketControlMessage **messages = NULL;
+      gint n_messages = 0, i;
+      guint segment_size = 0;
+
+      len = g_socket_receive_message (receiver, NULL, &input, 1,
+                                      &messages, &n_messages,
+                                      NULL, NULL, &error);
+      g_assert_no_error (error);
+
+      for (i = 0; i < n_messages; i++)
+        {
+          if (G_IS_UDP_SEGMENT_MESSAGE (messages[i]))
+            segment_size = g_udp_segment_message_get_segment_size (G_UDP_SEGMENT_MESSAGE (messages[i]));
+          g_object_unref (messages[i]);
+        }
+      g_free (messages);
+
+      /* Over loopback, the datagrams arrive coalesced when GRO is on */
+      if (gro)
+        {
+          g_assert_cmpint (len, ==, sizeof (data));
+          g_assert_cmpuint (segment_size, ==, 100);
+        }
+      else if (segment_size != 0)
+        g_assert_cmpuint (segment_size, ==, 100);
+      else if (total + len < sizeof (data))
+        g_assert_cmpint (len, ==, 100);
+      else
+        g_assert_cmpint (len, ==, 50);
+
+      total += len;
+    }
+
+  g_assert_cmpuint (total, ==, sizeof (data));
+
+  g_object_unref (sender);
+  g_object_unref (receiver);
+}
+
+static void
+tcp_socket_pair (GSocket **client,
+                 GSocket **server)
+{
+  GSocket *listener;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  GError *error = NULL;
+
+  listener = g_socket_new (G_SOCKET_FAMILY_IPV4,
+                           G_SOCKET_TYPE_STREAM,
+                           G_SOCKET_PROTOCOL_DEFAULT,
+                           &error);
+  g_assert_no_error (error);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+  g_socket_bind (listener, addr, TRUE, &error);
+  g_object_unref (addr);
+  g_assert_no_error (error);
+  g_socket_listen (listener, &error);
+  g_assert_no_error (error);
+
+  *client = g_socket_new (G_SOCKET_FAMILY_IPV4,
+                          G_SOCKET_TYPE_STREAM,
+                          G_SOCKET_PROTOCOL_DEFAULT,
+                          &error);
+  g_assert_no_error (error);
+
+  addr = g_socket_get_local_address (listener, &error);
+  g_assert_no_error (error);
+  g_socket_connect (*client, addr, NULL, &error);
+  g_object_unref (addr);
+  g_assert_no_error (error);
+
+  *server = g_socket_accept (listener, NULL, &error);
+  g_assert_no_error (error);
+
+  g_object_unref (listener);
+}
+
+static gboolean
+zerocopy_cb (GSocket  *socket,
+             guint32   first_id,
+             guint32   last_id,
+             gboolean  copied,
+             gpointer  user_data)
+{
+  gint *n_completed = user_data;
+
+  g_assert_cmpuint (first_id, ==, *n_completed);
+  g_assert_cmpuint (last_id, >=, first_id);
+  *n_completed = last_id + 1;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+test_zerocopy (void)
+{
+  GSocket *client, *server;
+  GError *error = NULL;
+  GSource *source;
+  gchar data[4096], buf[sizeof (data)];
+  gint n_completed = 0;
+  gsize received = 0;
+  guint i;
+
+  if (G_SOCKET_MSG_ZEROCOPY == 0)
+    {
+      g_test_skip ("MSG_ZEROCOPY is not supported on this platform");
+      return;
+    }
+
+  tcp_socket_pair (&client, &server);
+
+#ifdef SO_ZEROCOPY
+  if (!g_socket_set_option (client, SOL_SOCKET, SO_ZEROCOPY, 1, &error))
+#endif
+    {
+      g_test_skip ("SO_ZEROCOPY is not supported");
+      g_clear_error (&error);
+      g_object_unref (client);
+      g_object_unref (server);
+      return;
+    }
+
+  g_assert_false (g_socket_receive_zerocopy_completion (client, NULL, NULL, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK);
+  g_clear_error (&error);
+
+  memset (data, 'z', sizeof (data));
+  for (i = 0; i < 3; i++)
+    {
+      GOutputVector vector = { data, sizeof (data) };
+      gssize len;
+
+      len = g_socket_send_message (client, NULL, &vector, 1, NULL, 0,
+                                   G_SOCKET_MSG_ZEROCOPY, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (len, ==, sizeof (data));
+    }
+
+  while (received < 3 * sizeof (data))
+    {
+      gssize len = g_socket_receive (server, buf, sizeof (buf), NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (len, >, 0);
+      received += len;
+    }
+
+  source = g_socket_create_zerocopy_source (client);
+  g_source_set_callback (source, (GSourceFunc) G_CALLBACK (zerocopy_cb), &n_completed, NULL);
+  g_source_attach (source, NULL);
+
+  while (n_completed < 3)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_source_destroy (source);
+  g_source_unref (source);
+  g_object_unref (client);
+  g_object_unref (server);
+}
+
+static gboolean
+zerocopy_unexpected_cb (GSocket  *socket,
+                        guint32   first_id,
+                        guint32   last_id,
+                        gboolean  copied,
+                        gpointer  user_data)
+{
+  g_assert_not_reached ();
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_zerocopy_socket_error (void)
+{
+  GSocket *closed, *sock;
+  GError *error = NULL;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  GMainContext *context;
+  GSource *source;
+  gssize len;
+
+  if (G_SOCKET_MSG_ZEROCOPY == 0)
+    {
+      g_test_skip ("MSG_ZEROCOPY is not supported on this platform");
+      return;
+    }
+
+  /* Find a port nobody listens on */
+  closed = g_socket_new (G_SOCKET_FAMILY_IPV4,
+                         G_SOCKET_TYPE_DATAGRAM,
+                         G_SOCKET_PROTOCOL_DEFAULT,
+                         &error);
+  g_assert_no_error (error);
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+  g_socket_bind (closed, addr, TRUE, &error);
+  g_object_unref (addr);
+  g_assert_no_error (error);
+  addr = g_socket_get_local_address (closed, &error);
+  g_assert_no_error (error);
+  g_object_unref (closed);
+
+  sock = g_socket_new (G_SOCKET_FAMILY_IPV4,
+                       G_SOCKET_TYPE_DATAGRAM,
+                       G_SOCKET_PROTOCOL_DEFAULT,
+                       &error);
+  g_assert_no_error (error);
+  g_socket_connect (sock, addr, NULL, &error);
+  g_object_unref (addr);
+  g_assert_no_error (error);
+
+  /* The ICMP port unreachable reply leaves a pending error on the socket,
+   * and nothing in the error queue. */
+  len = g_socket_send (sock, "x", 1, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, 1);
+
+  g_socket_set_timeout (sock, 5);
+  if (!g_socket_condition_wait (sock, G_IO_ERR, NULL, NULL))
+    {
+      g_test_skip ("No error was reported for an unreachable port");
+      g_object_unref (sock);
+      return;
+    }
+
+  context = g_main_context_new ();
+  source = g_socket_create_zerocopy_source (sock);
+  g_source_set_callback (source, (GSourceFunc) G_CALLBACK (zerocopy_unexpected_cb), NULL, NULL);
+  g_source_attach (source, context);
+
+  g_assert_true (g_main_context_iteration (context, FALSE));
+
+  /* The error was consumed, so the source must not fire again */
+  g_assert_false (g_main_context_pending (context));
+  g_assert_false (g_source_is_destroyed (source));
+  g_assert_cmpint (g_socket_condition_check (sock, G_IO_ERR), ==, 0);
+
+  g_source_destroy (source);
+  g_source_unref (source);
+  g_main_context_unref (context);
+  g_object_unref (sock);
+}
+
 static void
 test_get_available (gconstpointer user_data)
 {
@@ -2593,6 +2917,9 @@ main (int   argc,
   g_test_add_func ("/socket/source-postmortem", test_source_postmortem);
   g_test_add_func ("/socket/reuse/tcp", test_reuse_tcp);
   g_test_add_func ("/socket/reuse/udp", test_reuse_udp);
+  g_test_add_func ("/socket/udp-segment-offload", test_udp_segment_offload);
+  g_test_add_func ("/socket/zerocopy", test_zerocopy);
+  g_test_add_func ("/socket/zerocopy/socket-error", test_zerocopy_socket_error);
   g_test_add_data_func ("/socket/get_available/datagram", GUINT_TO_POINTER (G_SOCKET_TYPE_DATAGRAM),
                         test_get_available);
   g_test_add_data_func ("/socket/get_available/stream", GUINT_TO_POINTER (G_SOCKET_TYPE_STREAM),
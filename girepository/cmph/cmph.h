@@ -73,6 +73,12 @@ cmph_uint32 cmph_search(cmph_t *mphf, const char *key, cmph_uint32 keylen);
 cmph_uint32 cmph_size(cmph_t *mphf);
 void cmph_destroy(cmph_t *mphf);
 
+/** void cmph_reset_random(void);
+ *  \brief GLib addition: rewinds the calling thread's generator for hash
+ *  seeds, so the next cmph_new() only depends on its keys.
+ */
+void cmph_reset_random(void);
+
 /** Hash serialization/deserialization */
 int cmph_dump(cmph_t *mphf, FILE *f);
 cmph_t *cmph_load(FILE *f);
@@ -1,5 +1,7 @@
+#include "cmph.h"
 #include "jenkins_hash.h"
 #include <stdlib.h>
+#include <glib.h>
 #ifdef WIN32
 #define _USE_MATH_DEFINES //For M_LOG2E
 #endif
@@ -84,11 +86,36 @@ Use for hash table lookup, or anything where one collision in 2^^32 is
 acceptable.  Do NOT use for cryptographic purposes.
 --------------------------------------------------------------------
  */
+/* GLib change: upstream seeds the hash with rand(), so the generated
+ * function depends on the state of the process-wide generator. That made
+ * typelibs differ depending on what else the process had compiled before.
+ * Use a per-thread generator instead, which cmph_reset_random() rewinds. */
+static GPrivate random_state = G_PRIVATE_INIT (g_free);
+
+static cmph_uint32 jenkins_random(void)
+{
+	cmph_uint32 *state = g_private_get (&random_state);
+	if (state == NULL)
+	{
+		state = g_new (cmph_uint32, 1);
+		*state = 1;
+		g_private_set (&random_state, state);
+	}
+	*state = *state * 1103515245 + 12345;
+	return (*state >> 16) & 0x7fff;
+}
+
+void cmph_reset_random(void)
+{
+	cmph_uint32 *state = g_private_get (&random_state);
+	if (state != NULL) *state = 1;
+}
+
 jenkins_state_t *jenkins_state_new(cmph_uint32 size) //size of hash table
 {
 	jenkins_state_t *state = (jenkins_state_t *)malloc(sizeof(jenkins_state_t));
 	DEBUGP("Initializing jenkins hash\n");
-	state->seed = ((cmph_uint32)rand() % size);
+	state->seed = (jenkins_random() % size);
 	return state;
 }
 void jenkins_state_destroy(jenkins_state_t *state)
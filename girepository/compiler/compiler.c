@@ -44,29 +44,33 @@
 static gchar **includedirs = NULL;
 static gchar **input = NULL;
 static gchar *output = NULL;
+static gchar *output_dir = NULL;
+static gchar *cache_dir = NULL;
+static gint n_jobs = 0;
 static gchar **shlibs = NULL;
 static gboolean debug = FALSE;
 static gboolean verbose = FALSE;
 static gboolean show_version = FALSE;
 
+static GLogLevelFlags logged_levels;
+
 static gboolean
-write_out_typelib (gchar     *prefix,
-                   GITypelib *typelib)
+write_out_typelib (const gchar  *filename,
+                   const guint8 *data,
+                   gsize         len)
 {
   FILE *file;
   gsize written;
   GFile *file_obj;
-  gchar *filename;
   GFile *tmp_file_obj;
   gchar *tmp_filename;
   GError *error = NULL;
   gboolean success = FALSE;
 
-  if (output == NULL)
+  if (filename == NULL)
     {
       file = stdout;
       file_obj = NULL;
-      filename = NULL;
       tmp_filename = NULL;
       tmp_file_obj = NULL;
 #ifdef G_OS_WIN32
@@ -75,14 +79,6 @@ write_out_typelib (gchar     *prefix,
     }
   else
     {
-      if (prefix)
-        {
-          filename = g_strdup_printf ("%s-%s", prefix, output);
-        }
-      else
-        {
-          filename = g_strdup (output);
-        }
       file_obj = g_file_new_for_path (filename);
       tmp_filename = g_strdup_printf ("%s.tmp", filename);
       tmp_file_obj = g_file_new_for_path (tmp_filename);
@@ -97,8 +93,8 @@ write_out_typelib (gchar     *prefix,
         }
     }
 
-  written = fwrite (typelib->data, 1, typelib->len, file);
-  if (written < typelib->len)
+  written = fwrite (data, 1, len, file);
+  if (written < len)
     {
       char *message = g_strdup_printf (_("Error: Could not write the whole output: %s"), g_strerror (errno));
       g_fprintf (stderr, "%s\n", message);
@@ -106,7 +102,7 @@ write_out_typelib (gchar     *prefix,
       goto out;
     }
 
-  if (output != NULL)
+  if (filename != NULL)
     fclose (file);
   if (tmp_filename != NULL)
     {
@@ -125,13 +121,258 @@ write_out_typelib (gchar     *prefix,
 out:
   g_clear_object (&file_obj);
   g_clear_object (&tmp_file_obj);
-  g_free (filename);
   g_free (tmp_filename);
 
   return success;
 }
 
-static GLogLevelFlags logged_levels;
+typedef struct
+{
+  const gchar *input;  /* (not owned) */
+  gchar *output;  /* (owned) (nullable); NULL means standard output */
+} CompileJob;
+
+typedef struct
+{
+  CompileJob *jobs;  /* (array length=n_jobs) (owned) */
+  guint n_jobs;
+  gint next_job;  /* (atomic) */
+  gint n_failed;  /* (atomic) */
+
+  /* Modules included by the inputs are parsed into this once, and shared by
+   * all the jobs. */
+  GIIrParser *dependency_parser;  /* (owned) */
+
+  GMutex digests_lock;
+  GHashTable *digests;  /* (element-type filename utf8) (owned) (locked-by digests_lock) */
+} CompileState;
+
+static GIIrParser *
+new_parser (void)
+{
+  GIIrParser *parser = gi_ir_parser_new ();
+
+  gi_ir_parser_set_debug (parser, logged_levels);
+  gi_ir_parser_set_includes (parser, (const char *const *) includedirs);
+
+  return parser;
+}
+
+/* Returns the SHA-256 of the contents of @filename, caching it for the rest of
+ * the run, as the same dependencies are typically shared by many inputs. */
+static gchar *
+get_file_digest (CompileState  *state,
+                 const gchar   *filename,
+                 GError       **error)
+{
+  gchar *digest, *contents;
+  gsize length;
+
+  g_mutex_lock (&state->digests_lock);
+  digest = g_strdup (g_hash_table_lookup (state->digests, filename));
+  g_mutex_unlock (&state->digests_lock);
+
+  if (digest != NULL)
+    return digest;
+
+  if (!g_file_get_contents (filename, &contents, &length, error))
+    return NULL;
+
+  digest = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (const guchar *) contents, length);
+  g_free (contents);
+
+  g_mutex_lock (&state->digests_lock);
+  g_hash_table_replace (state->digests, g_strdup (filename), g_strdup (digest));
+  g_mutex_unlock (&state->digests_lock);
+
+  return digest;
+}
+
+/* The cache key covers everything the typelib is built from: the compiler
+ * version, the options which affect the output, and the contents of the
+ * input and of every GIR it includes, directly or indirectly. */
+static gchar *
+compute_cache_key (CompileState  *state,
+                   GIIrParser    *parser,
+                   const gchar   *filename,
+                   GError       **error)
+{
+  GPtrArray *dependencies;
+  GChecksum *checksum;
+  gchar *digest, *basename, *version;
+  gchar *key = NULL;
+
+  dependencies = gi_ir_parser_list_dependencies (parser, filename, error);
+  if (dependencies == NULL)
+    return NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  version = g_strdup_printf ("gi-compile-repository %u.%u.%u",
+                             GLIB_MAJOR_VERSION, GLIB_MINOR_VERSION, GLIB_MICRO_VERSION);
+  g_checksum_update (checksum, (const guchar *) version, strlen (version) + 1);
+  g_free (version);
+  if (shlibs != NULL)
+    {
+      gchar *joined = g_strjoinv (",", shlibs);
+      g_checksum_update (checksum, (const guchar *) joined, strlen (joined) + 1);
+      g_free (joined);
+    }
+  else
+    g_checksum_update (checksum, (const guchar *) "", 1);
+
+  /* The namespace is taken from the file name */
+  basename = g_path_get_basename (filename);
+  g_checksum_update (checksum, (const guchar *) basename, strlen (basename) + 1);
+  g_free (basename);
+
+  digest = get_file_digest (state, filename, error);
+  if (digest == NULL)
+    goto out;
+  g_checksum_update (checksum, (const guchar *) digest, strlen (digest) + 1);
+  g_free (digest);
+
+  for (guint i = 0; i < dependencies->len; i++)
+    {
+      const gchar *dependency = g_ptr_array_index (dependencies, i);
+
+      digest = get_file_digest (state, dependency, error);
+      if (digest == NULL)
+        goto out;
+
+      basename = g_path_get_basename (dependency);
+      g_checksum_update (checksum, (const guchar *) basename, strlen (basename) + 1);
+      g_checksum_update (checksum, (const guchar *) digest, strlen (digest) + 1);
+      g_free (basename);
+      g_free (digest);
+    }
+
+  key = g_strdup (g_checksum_get_string (checksum));
+
+out:
+  g_checksum_free (checksum);
+  g_ptr_array_unref (dependencies);
+
+  return key;
+}
+
+static gboolean
+compile_one (CompileState *state,
+             CompileJob   *job)
+{
+  GError *error = NULL;
+  GIIrParser *parser;
+  GIIrModule *module;
+  GITypelib *typelib = NULL;
+  gchar *cache_path = NULL;
+  gboolean success = FALSE;
+
+  parser = new_parser ();
+  gi_ir_parser_set_dependency_parser (parser, state->dependency_parser);
+
+  if (cache_dir != NULL)
+    {
+      gchar *key, *contents;
+      gsize length;
+
+      /* If the key can’t be computed, compile anyway, so that the error is
+       * reported by the parser. */
+      key = compute_cache_key (state, parser, job->input, &error);
+      if (key != NULL)
+        {
+          gchar *cache_name = g_strconcat (key, ".typelib", NULL);
+          cache_path = g_build_filename (cache_dir, cache_name, NULL);
+          g_free (cache_name);
+          g_free (key);
+        }
+      else
+        {
+          g_debug ("[cache] not using the cache for %s: %s", job->input, error->message);
+          g_clear_error (&error);
+        }
+
+      if (cache_path != NULL &&
+          g_file_get_contents (cache_path, &contents, &length, NULL))
+        {
+          g_debug ("[cache] %s is up to date in %s", job->input, cache_path);
+
+          success = write_out_typelib (job->output, (const guint8 *) contents, length);
+          g_free (contents);
+          goto out;
+        }
+    }
+
+  g_debug ("[parsing] %s", job->input);
+
+  module = gi_ir_parser_parse_file (parser, job->input, &error);
+  if (module == NULL)
+    {
+      char *message = g_strdup_printf (_("Error parsing file ‘%s’: %s"), job->input, error->message);
+      g_fprintf (stderr, "%s\n", message);
+      g_free (message);
+      g_clear_error (&error);
+
+      goto out;
+    }
+
+  if (shlibs)
+    {
+      if (module->shared_library)
+        g_free (module->shared_library);
+      module->shared_library = g_strjoinv (",", shlibs);
+    }
+
+  g_debug ("[building] module %s", module->name);
+
+  typelib = gi_ir_module_build_typelib (module);
+  if (typelib == NULL)
+    g_error (_("Failed to build typelib for module ‘%s’"), module->name);
+  if (!gi_typelib_validate (typelib, &error))
+    g_error (_("Invalid typelib for module ‘%s’: %s"),
+             module->name, error->message);
+
+  if (!write_out_typelib (job->output, typelib->data, typelib->len))
+    goto out;
+
+  success = TRUE;
+
+  if (cache_path != NULL)
+    {
+      /* A failure to populate the cache only makes the next run slower */
+      if (g_mkdir_with_parents (cache_dir, 0755) != 0 ||
+          !g_file_set_contents (cache_path, (const gchar *) typelib->data, typelib->len, &error))
+        {
+          char *message = g_strdup_printf (_("Failed to write ‘%s’ to the cache: %s"),
+                                           cache_path,
+                                           error ? error->message : g_strerror (errno));
+          g_fprintf (stderr, "%s\n", message);
+          g_free (message);
+          g_clear_error (&error);
+        }
+    }
+
+out:
+  g_clear_pointer (&typelib, gi_typelib_unref);
+  g_free (cache_path);
+  gi_ir_parser_free (parser);
+
+  return success;
+}
+
+static gpointer
+compile_thread (gpointer user_data)
+{
+  CompileState *state = user_data;
+  guint i;
+
+  while ((i = (guint) g_atomic_int_add (&state->next_job, 1)) < state->n_jobs)
+    {
+      if (!compile_one (state, &state->jobs[i]))
+        g_atomic_int_inc (&state->n_failed);
+    }
+
+  return NULL;
+}
 
 static void
 log_handler (const gchar   *log_domain,
@@ -146,6 +387,9 @@ log_handler (const gchar   *log_domain,
 static GOptionEntry options[] = {
   { "includedir", 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &includedirs, N_("Include directories in GIR search path"), N_("DIRECTORY") },
   { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output, N_("Output file"), N_("FILE") },
+  { "output-dir", 0, 0, G_OPTION_ARG_FILENAME, &output_dir, N_("Directory to write typelibs to, one for each input file"), N_("DIRECTORY") },
+  { "jobs", 'j', 0, G_OPTION_ARG_INT, &n_jobs, N_("Number of input files to compile in parallel"), N_("N") },
+  { "cache-dir", 0, 0, G_OPTION_ARG_FILENAME, &cache_dir, N_("Directory to cache compiled typelibs in"), N_("DIRECTORY") },
   { "shared-library", 'l', 0, G_OPTION_ARG_FILENAME_ARRAY, &shlibs, N_("Shared library"), N_("FILE") },
   { "debug", 0, 0, G_OPTION_ARG_NONE, &debug, N_("Show debug messages"), NULL },
   { "verbose", 0, 0, G_OPTION_ARG_NONE, &verbose, N_("Show verbose messages"), NULL },
@@ -159,8 +403,10 @@ main (int argc, char **argv)
 {
   GOptionContext *context;
   GError *error = NULL;
-  GIIrParser *parser;
-  GIIrModule *module;
+  CompileState state = { 0, };
+  GHashTable *outputs = NULL;
+  guint n_threads;
+  int ret = 0;
 
   setlocale (LC_ALL, "");
 
@@ -197,64 +443,124 @@ main (int argc, char **argv)
       return 0;
     }
 
-  if (!input || g_strv_length (input) != 1)
+  if (!input || input[0] == NULL)
     {
-      g_fprintf (stderr, "%s\n", _("Please specify exactly one input file"));
+      g_fprintf (stderr, "%s\n", _("Please specify at least one input file"));
 
       return 1;
     }
 
-  g_debug ("[parsing] start, %d includes",
-           includedirs ? g_strv_length (includedirs) : 0);
+  if (output_dir == NULL && g_strv_length (input) != 1)
+    {
+      g_fprintf (stderr, "%s\n", _("Please specify exactly one input file, or use --output-dir"));
 
-  parser = gi_ir_parser_new ();
-  gi_ir_parser_set_debug (parser, logged_levels);
+      return 1;
+    }
 
-  gi_ir_parser_set_includes (parser, (const char *const *) includedirs);
+  if (output != NULL && output_dir != NULL)
+    {
+      g_fprintf (stderr, "%s\n", _("--output and --output-dir cannot be used together"));
 
-  module = gi_ir_parser_parse_file (parser, input[0], &error);
-  if (module == NULL)
+      return 1;
+    }
+
+  if (shlibs != NULL && g_strv_length (input) != 1)
+    {
+      g_fprintf (stderr, "%s\n", _("--shared-library can only be used with a single input file"));
+
+      return 1;
+    }
+
+  state.n_jobs = g_strv_length (input);
+  state.jobs = g_new0 (CompileJob, state.n_jobs);
+  outputs = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (guint i = 0; i < state.n_jobs; i++)
+    {
+      CompileJob *job = &state.jobs[i];
+
+      job->input = input[i];
+
+      if (output_dir != NULL)
+        {
+          gchar *basename = g_path_get_basename (input[i]);
+          gchar *typelib_name;
+
+          if (g_str_has_suffix (basename, ".gir"))
+            basename[strlen (basename) - strlen (".gir")] = '\0';
+
+          typelib_name = g_strconcat (basename, ".typelib", NULL);
+          job->output = g_build_filename (output_dir, typelib_name, NULL);
+          g_free (typelib_name);
+          g_free (basename);
+
+          if (!g_hash_table_add (outputs, job->output))
+            {
+              char *message = g_strdup_printf (_("Input files would both be written to ‘%s’"), job->output);
+              g_fprintf (stderr, "%s\n", message);
+              g_free (message);
+
+              ret = 1;
+              goto out;
+            }
+        }
+      else
+        {
+          job->output = g_strdup (output);
+        }
+    }
+
+  if (output_dir != NULL && g_mkdir_with_parents (output_dir, 0755) != 0)
     {
-      char *message = g_strdup_printf (_("Error parsing file ‘%s’: %s"), input[0], error->message);
+      char *message = g_strdup_printf (_("Failed to create ‘%s’: %s"), output_dir, g_strerror (errno));
       g_fprintf (stderr, "%s\n", message);
       g_free (message);
-      gi_ir_parser_free (parser);
 
-      return 1;
+      ret = 1;
+      goto out;
     }
 
-  g_debug ("[parsing] done");
+  g_debug ("[compiling] start, %u inputs, %d includes",
+           state.n_jobs,
+           includedirs ? g_strv_length (includedirs) : 0);
 
-  g_debug ("[building] start");
+  state.dependency_parser = new_parser ();
+  g_mutex_init (&state.digests_lock);
+  state.digests = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
-  {
-    GITypelib *typelib = NULL;
+  n_threads = (n_jobs > 0) ? (guint) n_jobs : g_get_num_processors ();
+  n_threads = CLAMP (n_threads, 1, state.n_jobs);
 
-    if (shlibs)
-      {
-        if (module->shared_library)
-          g_free (module->shared_library);
-        module->shared_library = g_strjoinv (",", shlibs);
-      }
+  if (n_threads == 1)
+    {
+      compile_thread (&state);
+    }
+  else
+    {
+      GThread **threads = g_new0 (GThread *, n_threads);
 
-    g_debug ("[building] module %s", module->name);
+      for (guint i = 0; i < n_threads; i++)
+        threads[i] = g_thread_new ("gi-compile", compile_thread, &state);
+      for (guint i = 0; i < n_threads; i++)
+        g_thread_join (threads[i]);
 
-    typelib = gi_ir_module_build_typelib (module);
-    if (typelib == NULL)
-      g_error (_("Failed to build typelib for module ‘%s’"), module->name);
-    if (!gi_typelib_validate (typelib, &error))
-      g_error (_("Invalid typelib for module ‘%s’: %s"),
-               module->name, error->message);
+      g_free (threads);
+    }
 
-    if (!write_out_typelib (NULL, typelib))
-      return 1;
+  g_debug ("[compiling] done");
 
-    g_clear_pointer (&typelib, gi_typelib_unref);
-  }
+  if (g_atomic_int_get (&state.n_failed) > 0)
+    ret = 1;
 
-  g_debug ("[building] done");
+  g_clear_pointer (&state.digests, g_hash_table_unref);
+  g_mutex_clear (&state.digests_lock);
+  g_clear_pointer (&state.dependency_parser, gi_ir_parser_free);
 
-  gi_ir_parser_free (parser);
+out:
+  for (guint i = 0; i < state.n_jobs; i++)
+    g_free (state.jobs[i].output);
+  g_free (state.jobs);
+  g_hash_table_unref (outputs);
 
-  return 0;
+  return ret;
 }
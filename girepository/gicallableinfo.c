@@ -610,6 +610,139 @@ gi_type_info_extract_ffi_return_value (GITypeInfo       *return_info,
                                         ffi_value, arg);
 }
 
+static void
+invoke_cache_free (GICallableInvokeCache *cache)
+{
+  g_free (cache->atypes);
+  g_free (cache->directions);
+  g_free (cache);
+}
+
+static GICallableInvokeCache *
+invoke_cache_new (GICallableInfo *info)
+{
+  GICallableInvokeCache *cache;
+  GITypeInfo rinfo;
+  unsigned int i, offset;
+
+  cache = g_new0 (GICallableInvokeCache, 1);
+
+  gi_callable_info_load_return_type (info, &rinfo);
+  cache->return_tag = gi_type_info_get_tag (&rinfo);
+  if (cache->return_tag == GI_TYPE_TAG_INTERFACE)
+    {
+      GIBaseInfo *interface_info = gi_type_info_get_interface (&rinfo);
+      cache->return_interface_type = G_TYPE_FROM_INSTANCE (interface_info);
+      gi_base_info_unref (interface_info);
+    }
+
+  cache->is_method = gi_callable_info_is_method (info);
+  cache->throws = gi_callable_info_can_throw_gerror (info);
+  cache->n_args = gi_callable_info_get_n_args (info);
+  cache->n_invoke_args = cache->n_args;
+  if (cache->is_method)
+    cache->n_invoke_args++;
+  if (cache->throws)
+    /* Add an argument for the GError */
+    cache->n_invoke_args++;
+
+  cache->atypes = g_new0 (ffi_type *, cache->n_invoke_args);
+  cache->directions = g_new0 (GIDirection, cache->n_args);
+
+  offset = cache->is_method ? 1 : 0;
+  if (cache->is_method)
+    cache->atypes[0] = &ffi_type_pointer;
+  if (cache->throws)
+    cache->atypes[cache->n_invoke_args - 1] = &ffi_type_pointer;
+
+  for (i = 0; i < cache->n_args; i++)
+    {
+      GIArgInfo ainfo;
+
+      gi_callable_info_load_arg (info, i, &ainfo);
+      cache->directions[i] = gi_arg_info_get_direction (&ainfo);
+
+      switch (cache->directions[i])
+        {
+        case GI_DIRECTION_IN:
+          {
+            GITypeInfo tinfo;
+
+            gi_arg_info_load_type_info (&ainfo, &tinfo);
+            cache->atypes[i + offset] = gi_type_info_get_ffi_type (&tinfo);
+            gi_base_info_clear (&tinfo);
+          }
+          break;
+        case GI_DIRECTION_OUT:
+        case GI_DIRECTION_INOUT:
+          cache->atypes[i + offset] = &ffi_type_pointer;
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+
+      gi_base_info_clear (&ainfo);
+    }
+
+  cache->cif_prepared = (ffi_prep_cif (&cache->cif, FFI_DEFAULT_ABI,
+                                       cache->n_invoke_args,
+                                       gi_type_info_get_ffi_type (&rinfo),
+                                       cache->atypes) == FFI_OK);
+
+  gi_base_info_clear (&rinfo);
+
+  return cache;
+}
+
+/*< private >
+ * gi_callable_info_get_invoke_cache:
+ * @info: a #GICallableInfo
+ *
+ * Get the prepared invocation state for @info, creating it on first use.
+ *
+ * Infos are cheap, transient wrappers around a typelib blob, so the state is
+ * cached on the typelib and keyed by the blob offset. It is shared by every
+ * info for the same callable, and lives until the typelib is freed.
+ *
+ * Returns: (transfer none): the invocation state for @info
+ */
+GICallableInvokeCache *
+gi_callable_info_get_invoke_cache (GICallableInfo *info)
+{
+  GIRealInfo *rinfo = (GIRealInfo *) info;
+  GITypelib *typelib = rinfo->typelib;
+  void *key = GUINT_TO_POINTER (rinfo->offset);
+  GICallableInvokeCache *cache, *new_cache;
+
+  g_mutex_lock (&typelib->invoke_cache_lock);
+  cache = (typelib->invoke_cache != NULL) ? g_hash_table_lookup (typelib->invoke_cache, key) : NULL;
+  g_mutex_unlock (&typelib->invoke_cache_lock);
+
+  if (cache != NULL)
+    return cache;
+
+  /* Build the entry without holding the lock, as it may need to look up
+   * other infos in the repository. If another thread races us, use its. */
+  new_cache = invoke_cache_new (info);
+
+  g_mutex_lock (&typelib->invoke_cache_lock);
+  if (typelib->invoke_cache == NULL)
+    typelib->invoke_cache = g_hash_table_new_full (NULL, NULL, NULL,
+                                                   (GDestroyNotify) invoke_cache_free);
+
+  cache = g_hash_table_lookup (typelib->invoke_cache, key);
+  if (cache == NULL)
+    {
+      cache = g_steal_pointer (&new_cache);
+      g_hash_table_insert (typelib->invoke_cache, key, cache);
+    }
+  g_mutex_unlock (&typelib->invoke_cache_lock);
+
+  g_clear_pointer (&new_cache, invoke_cache_free);
+
+  return cache;
+}
+
 /**
  * gi_callable_info_invoke:
  * @info: a #GICallableInfo
@@ -644,33 +777,59 @@ gi_callable_info_invoke (GICallableInfo    *info,
                          GIArgument        *return_value,
                          GError           **error)
 {
-  ffi_cif cif;
-  ffi_type *rtype;
-  ffi_type **atypes;
-  GITypeInfo *tinfo;
-  GITypeInfo *rinfo;
-  GITypeTag rtag;
-  GIArgInfo *ainfo;
-  unsigned int n_args, n_invoke_args, in_pos, out_pos, i;
+  return gi_callable_info_invoke_with_cache (info,
+                                             gi_callable_info_get_invoke_cache (info),
+                                             function,
+                                             in_args,
+                                             n_in_args,
+                                             out_args,
+                                             n_out_args,
+                                             return_value,
+                                             error);
+}
+
+/*< private >
+ * gi_callable_info_invoke_with_cache:
+ * @info: a #GICallableInfo
+ * @cache: (transfer none): the invocation state for @info, from
+ *   gi_callable_info_get_invoke_cache()
+ * @function: function pointer to call
+ * @in_args: (array length=n_in_args): array of ‘in’ arguments
+ * @n_in_args: number of arguments in @in_args
+ * @out_args: (array length=n_out_args): array of ‘out’ arguments
+ * @n_out_args: number of arguments in @out_args
+ * @return_value: (out caller-allocates) (not optional): return location for
+ *   the return value from the callable
+ * @error: return location for a [type@GLib.Error], or `NULL`
+ *
+ * Implementation of gi_callable_info_invoke(), for callers which already
+ * have @cache to hand. Only the argument pointer array is built per call.
+ *
+ * Returns: `TRUE` if the callable was executed successfully and didn’t throw
+ *   a [type@GLib.Error]; `FALSE` if @error is set
+ */
+gboolean
+gi_callable_info_invoke_with_cache (GICallableInfo         *info,
+                                    GICallableInvokeCache  *cache,
+                                    void                   *function,
+                                    const GIArgument       *in_args,
+                                    size_t                  n_in_args,
+                                    GIArgument             *out_args,
+                                    size_t                  n_out_args,
+                                    GIArgument             *return_value,
+                                    GError                **error)
+{
+  unsigned int in_pos, out_pos, i, offset;
   void **args;
-  gboolean success = FALSE;
   GError *local_error = NULL;
   void *error_address = &local_error;
   GIFFIReturnValue ffi_return_value;
   void *return_value_p; /* Will point inside the union return_value */
-  gboolean is_method, throws;
-
-  rinfo = gi_callable_info_get_return_type ((GICallableInfo *)info);
-  rtype = gi_type_info_get_ffi_type (rinfo);
-  rtag = gi_type_info_get_tag(rinfo);
-  is_method = gi_callable_info_is_method (info);
-  throws = gi_callable_info_can_throw_gerror (info);
 
   in_pos = 0;
   out_pos = 0;
 
-  n_args = gi_callable_info_get_n_args ((GICallableInfo *)info);
-  if (is_method)
+  if (cache->is_method)
     {
       if (n_in_args == 0)
         {
@@ -678,45 +837,29 @@ gi_callable_info_invoke (GICallableInfo    *info,
                        GI_INVOKE_ERROR,
                        GI_INVOKE_ERROR_ARGUMENT_MISMATCH,
                        "Too few \"in\" arguments (handling this)");
-          goto out;
+          return FALSE;
         }
-      n_invoke_args = n_args+1;
       in_pos++;
     }
-  else
-    n_invoke_args = n_args;
 
-  if (throws)
-    /* Add an argument for the GError */
-    n_invoke_args ++;
+  args = g_alloca (sizeof (void *) * cache->n_invoke_args);
 
-  atypes = g_alloca (sizeof (ffi_type*) * n_invoke_args);
-  args = g_alloca (sizeof (void *) * n_invoke_args);
+  if (cache->is_method)
+    args[0] = (void *) &in_args[0];
 
-  if (is_method)
+  offset = cache->is_method ? 1 : 0;
+  for (i = 0; i < cache->n_args; i++)
     {
-      atypes[0] = &ffi_type_pointer;
-      args[0] = (void *) &in_args[0];
-    }
-  for (i = 0; i < n_args; i++)
-    {
-      int offset = (is_method ? 1 : 0);
-      ainfo = gi_callable_info_get_arg ((GICallableInfo *)info, i);
-      switch (gi_arg_info_get_direction (ainfo))
+      switch (cache->directions[i])
         {
         case GI_DIRECTION_IN:
-          tinfo = gi_arg_info_get_type_info (ainfo);
-          atypes[i+offset] = gi_type_info_get_ffi_type (tinfo);
-          gi_base_info_unref ((GIBaseInfo *)ainfo);
-          gi_base_info_unref ((GIBaseInfo *)tinfo);
-
           if (in_pos >= n_in_args)
             {
               g_set_error (error,
                            GI_INVOKE_ERROR,
                            GI_INVOKE_ERROR_ARGUMENT_MISMATCH,
                            "Too few \"in\" arguments (handling in)");
-              goto out;
+              return FALSE;
             }
 
           args[i+offset] = (void *)&in_args[in_pos];
@@ -724,32 +867,26 @@ gi_callable_info_invoke (GICallableInfo    *info,
 
           break;
         case GI_DIRECTION_OUT:
-          atypes[i+offset] = &ffi_type_pointer;
-          gi_base_info_unref ((GIBaseInfo *)ainfo);
-
           if (out_pos >= n_out_args)
             {
               g_set_error (error,
                            GI_INVOKE_ERROR,
                            GI_INVOKE_ERROR_ARGUMENT_MISMATCH,
                            "Too few \"out\" arguments (handling out)");
-              goto out;
+              return FALSE;
             }
 
           args[i+offset] = (void *)&out_args[out_pos];
           out_pos++;
           break;
         case GI_DIRECTION_INOUT:
-          atypes[i+offset] = &ffi_type_pointer;
-          gi_base_info_unref ((GIBaseInfo *)ainfo);
-
           if (in_pos >= n_in_args)
             {
               g_set_error (error,
                            GI_INVOKE_ERROR,
                            GI_INVOKE_ERROR_ARGUMENT_MISMATCH,
                            "Too few \"in\" arguments (handling inout)");
-              goto out;
+              return FALSE;
             }
 
           if (out_pos >= n_out_args)
@@ -758,7 +895,7 @@ gi_callable_info_invoke (GICallableInfo    *info,
                            GI_INVOKE_ERROR,
                            GI_INVOKE_ERROR_ARGUMENT_MISMATCH,
                            "Too few \"out\" arguments (handling inout)");
-              goto out;
+              return FALSE;
             }
 
           args[i+offset] = (void *)&in_args[in_pos];
@@ -766,16 +903,12 @@ gi_callable_info_invoke (GICallableInfo    *info,
           out_pos++;
           break;
         default:
-          gi_base_info_unref ((GIBaseInfo *)ainfo);
           g_assert_not_reached ();
         }
     }
 
-  if (throws)
-    {
-      args[n_invoke_args - 1] = &error_address;
-      atypes[n_invoke_args - 1] = &ffi_type_pointer;
-    }
+  if (cache->throws)
+    args[cache->n_invoke_args - 1] = &error_address;
 
   if (in_pos < n_in_args)
     {
@@ -783,7 +916,7 @@ gi_callable_info_invoke (GICallableInfo    *info,
                    GI_INVOKE_ERROR,
                    GI_INVOKE_ERROR_ARGUMENT_MISMATCH,
                    "Too many \"in\" arguments (at end)");
-      goto out;
+      return FALSE;
     }
   if (out_pos < n_out_args)
     {
@@ -791,15 +924,15 @@ gi_callable_info_invoke (GICallableInfo    *info,
                    GI_INVOKE_ERROR,
                    GI_INVOKE_ERROR_ARGUMENT_MISMATCH,
                    "Too many \"out\" arguments (at end)");
-      goto out;
+      return FALSE;
     }
 
-  if (ffi_prep_cif (&cif, FFI_DEFAULT_ABI, n_invoke_args, rtype, atypes) != FFI_OK)
-    goto out;
+  if (!cache->cif_prepared)
+    return FALSE;
 
   g_return_val_if_fail (return_value, FALSE);
   /* See comment for GIFFIReturnValue above */
-  switch (rtag)
+  switch (cache->return_tag)
     {
     case GI_TYPE_TAG_FLOAT:
       return_value_p = &ffi_return_value.v_float;
@@ -814,21 +947,18 @@ gi_callable_info_invoke (GICallableInfo    *info,
     default:
       return_value_p = &ffi_return_value.v_long;
     }
-  ffi_call (&cif, function, return_value_p, args);
+  ffi_call (&cache->cif, function, return_value_p, args);
 
   if (local_error)
     {
       g_propagate_error (error, local_error);
-      success = FALSE;
+      return FALSE;
     }
-  else
-    {
-      gi_type_info_extract_ffi_return_value (rinfo, &ffi_return_value, return_value);
-      success = TRUE;
-    }
- out:
-  gi_base_info_unref ((GIBaseInfo *)rinfo);
-  return success;
+
+  gi_type_tag_extract_ffi_return_value (cache->return_tag,
+                                        cache->return_interface_type,
+                                        &ffi_return_value, return_value);
+  return TRUE;
 }
 
 void
@@ -269,30 +269,42 @@ gi_function_info_invoke (GIFunctionInfo    *info,
                          GIArgument        *return_value,
                          GError           **error)
 {
-  const char *symbol;
+  GICallableInvokeCache *cache;
   void *func;
 
-  symbol = gi_function_info_get_symbol (info);
+  cache = gi_callable_info_get_invoke_cache ((GICallableInfo *) info);
 
-  if (!gi_typelib_symbol (gi_base_info_get_typelib ((GIBaseInfo *) info),
-                          symbol, &func))
+  /* Symbol lookups go through every module of the typelib, so remember the
+   * result. Failures are not cached, as the caller may load the library
+   * containing the symbol later. */
+  func = g_atomic_pointer_get (&cache->symbol_address);
+  if (func == NULL)
     {
-      g_set_error (error,
-                   GI_INVOKE_ERROR,
-                   GI_INVOKE_ERROR_SYMBOL_NOT_FOUND,
-                   "Could not locate %s: %s", symbol, g_module_error ());
+      const char *symbol = gi_function_info_get_symbol (info);
 
-      return FALSE;
+      if (!gi_typelib_symbol (gi_base_info_get_typelib ((GIBaseInfo *) info),
+                              symbol, &func))
+        {
+          g_set_error (error,
+                       GI_INVOKE_ERROR,
+                       GI_INVOKE_ERROR_SYMBOL_NOT_FOUND,
+                       "Could not locate %s: %s", symbol, g_module_error ());
+
+          return FALSE;
+        }
+
+      g_atomic_pointer_set (&cache->symbol_address, func);
     }
 
-  return gi_callable_info_invoke ((GICallableInfo*) info,
-                                  func,
-                                  in_args,
-                                  n_in_args,
-                                  out_args,
-                                  n_out_args,
-                                  return_value,
-                                  error);
+  return gi_callable_info_invoke_with_cache ((GICallableInfo*) info,
+                                             cache,
+                                             func,
+                                             in_args,
+                                             n_in_args,
+                                             out_args,
+                                             n_out_args,
+                                             return_value,
+                                             error);
 }
 
 void
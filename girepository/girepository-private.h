@@ -30,6 +30,7 @@
 #include <girepository/gibaseinfo.h>
 #include <girepository/girepository.h>
 #include <girepository/gitypelib.h>
+#include <girepository/girffi.h>
 
 #include "gitypelib-internal.h"
 
@@ -158,6 +159,36 @@ struct _GICallableInfo
 void gi_callable_info_class_init (gpointer g_class,
                                   gpointer class_data);
 
+/* Everything gi_callable_info_invoke() needs to know about a callable which
+ * can be computed once, rather than on every call. Entries are owned by the
+ * typelib, and are immutable once created, apart from @symbol_address. */
+typedef struct
+{
+  ffi_cif cif;
+  gboolean cif_prepared;
+  ffi_type **atypes;  /* (owned) (array length=n_invoke_args) */
+  GIDirection *directions;  /* (owned) (array length=n_args) */
+  unsigned int n_args;
+  unsigned int n_invoke_args;
+  gboolean is_method;
+  gboolean throws;
+  GITypeTag return_tag;
+  GType return_interface_type;
+  void *symbol_address;  /* (atomic) (nullable); only used for functions */
+} GICallableInvokeCache;
+
+GICallableInvokeCache *gi_callable_info_get_invoke_cache (GICallableInfo *info);
+
+gboolean gi_callable_info_invoke_with_cache (GICallableInfo         *info,
+                                             GICallableInvokeCache  *cache,
+                                             void                   *function,
+                                             const GIArgument       *in_args,
+                                             size_t                  n_in_args,
+                                             GIArgument             *out_args,
+                                             size_t                  n_out_args,
+                                             GIArgument             *return_value,
+                                             GError                **error);
+
 struct _GIFunctionInfo
 {
   GICallableInfo parent;
@@ -64,6 +64,10 @@ struct _GIIrModule
    * 'disguised' flag
    */
   GHashTable *disguised_structures;
+
+  /* Held while computing the layout of this module’s types, if it is
+   * included by modules being built in several threads at once. */
+  GRecMutex *shared_lock;  /* (nullable) (not owned) */
 };
 
 GIIrModule *gi_ir_module_new            (const char  *name,
@@ -35,7 +35,7 @@
 #define ALIGN_VALUE(this, boundary) \
   (( ((unsigned long)(this)) + (((unsigned long)(boundary)) -1)) & (~(((unsigned long)(boundary))-1)))
 
-#define NUM_SECTIONS 2
+#define NUM_SECTIONS 3
 
 /*< private >
  * gi_ir_module_new:
@@ -323,6 +323,71 @@ add_directory_index_section (uint8_t *data, GIIrModule *module, uint32_t *offset
   return data;
 }
 
+static uint8_t *
+add_gtype_index_section (uint8_t *data, GIIrModule *module, uint32_t *offset2)
+{
+  Header *header = (Header*) data;
+  GITypelibHashBuilder *gtype_builder;
+  GHashTable *seen;
+  uint32_t n_gtypes;
+  uint32_t required_size;
+  uint32_t new_offset;
+
+  gtype_builder = gi_typelib_hash_builder_new ();
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (uint16_t i = 0; i < header->n_local_entries; i++)
+    {
+      DirEntry *entry;
+      RegisteredTypeBlob *blob;
+      const char *str;
+
+      entry = (DirEntry *)&data[header->directory + (i * header->entry_blob_size)];
+      if (!BLOB_IS_REGISTERED_TYPE (entry))
+        continue;
+
+      blob = (RegisteredTypeBlob *)&data[entry->offset];
+      if (!blob->gtype_name)
+        continue;
+
+      /* Keep the first entry for a name, as the linear search did */
+      str = (const char *) (&data[blob->gtype_name]);
+      if (!g_hash_table_add (seen, (char *) str))
+        continue;
+
+      gi_typelib_hash_builder_add_string (gtype_builder, str, i);
+    }
+
+  n_gtypes = g_hash_table_size (seen);
+  g_hash_table_destroy (seen);
+
+  /* Same as for the directory index, the lookup falls back to a linear
+   * search if there is no section. */
+  if (n_gtypes == 0 || !gi_typelib_hash_builder_prepare (gtype_builder))
+    {
+      gi_typelib_hash_builder_destroy (gtype_builder);
+      return data;
+    }
+
+  alloc_section (data, GI_SECTION_GTYPE_INDEX, *offset2);
+
+  required_size = sizeof (uint32_t) + gi_typelib_hash_builder_get_buffer_size (gtype_builder);
+  required_size = ALIGN_VALUE (required_size, 4);
+
+  new_offset = *offset2 + required_size;
+
+  data = g_realloc (data, new_offset);
+
+  *(uint32_t *) &data[*offset2] = n_gtypes;
+  gi_typelib_hash_builder_pack (gtype_builder, ((uint8_t*)data) + *offset2 + sizeof (uint32_t),
+                                required_size - sizeof (uint32_t));
+
+  *offset2 = new_offset;
+
+  gi_typelib_hash_builder_destroy (gtype_builder);
+  return data;
+}
+
 GITypelib *
 gi_ir_module_build_typelib (GIIrModule *module)
 {
@@ -466,8 +531,8 @@ gi_ir_module_build_typelib (GIIrModule *module)
   header->sections = offset2;
 
   /* Initialize all the sections to _END/0; we fill them in later using
-   * alloc_section().  (Right now there's just the directory index
-   * though, note)
+   * alloc_section().  (Right now there's just the directory and GType
+   * indexes though, note; the last one is always left as _END)
    */
   for (i = 0; i < NUM_SECTIONS; i++)
     {
@@ -579,6 +644,7 @@ gi_ir_module_build_typelib (GIIrModule *module)
   header = (Header*) data;
 
   data = add_directory_index_section (data, module, &offset2);
+  data = add_gtype_index_section (data, module, &offset2);
   header = (Header *)data;
 
   length = header->size = offset2;
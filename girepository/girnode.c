@@ -27,6 +27,7 @@
 #include "girnode-private.h"
 #include "girepository-private.h"
 #include "gitypelib-internal.h"
+#include "glib-private.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -37,12 +38,20 @@
 #define strtoull _strtoui64
 #endif
 
-static gulong string_count = 0;
-static gulong unique_string_count = 0;
-static gulong string_size = 0;
-static gulong unique_string_size = 0;
-static gulong types_count = 0;
-static gulong unique_types_count = 0;
+/* The statistics are per typelib build, and gi-compile-repository may run
+ * several builds in parallel threads. */
+#ifdef G_THREAD_LOCAL
+#define STATS_THREAD_LOCAL G_THREAD_LOCAL
+#else
+#define STATS_THREAD_LOCAL
+#endif
+
+static STATS_THREAD_LOCAL gulong string_count = 0;
+static STATS_THREAD_LOCAL gulong unique_string_count = 0;
+static STATS_THREAD_LOCAL gulong string_size = 0;
+static STATS_THREAD_LOCAL gulong unique_string_size = 0;
+static STATS_THREAD_LOCAL gulong types_count = 0;
+static STATS_THREAD_LOCAL gulong unique_types_count = 0;
 
 void
 gi_ir_node_init_stats (void)
@@ -507,20 +507,9 @@ check_needs_computation (GIIrTypelibBuild *build,
   return offsets_state == GI_IR_OFFSETS_UNKNOWN;
 }
 
-/*
- * gi_ir_node_compute_offsets:
- * @build: Current typelib build
- * @node: a #GIIrNode
- *
- * If a node is a a structure or union, makes sure that the field
- * offsets have been computed, and also computes the overall size and
- * alignment for the type.
- *
- * Since: 2.80
- */
-void
-gi_ir_node_compute_offsets (GIIrTypelibBuild *build,
-                            GIIrNode         *node)
+static void
+compute_offsets_unlocked (GIIrTypelibBuild *build,
+                          GIIrNode         *node)
 {
   gboolean appended_stack;
 
@@ -597,3 +586,31 @@ gi_ir_node_compute_offsets (GIIrTypelibBuild *build,
   if (appended_stack)
     build->stack = g_list_delete_link (build->stack, build->stack);
 }
+
+/*
+ * gi_ir_node_compute_offsets:
+ * @build: Current typelib build
+ * @node: a #GIIrNode
+ *
+ * If a node is a a structure or union, makes sure that the field
+ * offsets have been computed, and also computes the overall size and
+ * alignment for the type.
+ *
+ * Since: 2.80
+ */
+void
+gi_ir_node_compute_offsets (GIIrTypelibBuild *build,
+                            GIIrNode         *node)
+{
+  GRecMutex *lock = node->module->shared_lock;
+
+  /* @node may belong to an included module which other threads are also
+   * computing the layout of */
+  if (lock != NULL)
+    g_rec_mutex_lock (lock);
+
+  compute_offsets_unlocked (build, node);
+
+  if (lock != NULL)
+    g_rec_mutex_unlock (lock);
+}
@@ -37,6 +37,8 @@ void        gi_ir_parser_set_debug    (GIIrParser          *parser,
                                        GLogLevelFlags       logged_levels);
 void        gi_ir_parser_set_includes (GIIrParser         *parser,
                                        const char  *const *includes);
+void        gi_ir_parser_set_dependency_parser (GIIrParser *parser,
+                                                GIIrParser *dependency_parser);
 
 GIIrModule *gi_ir_parser_parse_string (GIIrParser   *parser,
                                        const char   *namespace,
@@ -48,4 +50,8 @@ GIIrModule *gi_ir_parser_parse_file   (GIIrParser   *parser,
                                        const char   *filename,
                                        GError      **error);
 
+GPtrArray  *gi_ir_parser_list_dependencies (GIIrParser  *parser,
+                                            const char  *filename,
+                                            GError     **error);
+
 G_END_DECLS
@@ -69,6 +69,12 @@ struct _GIIrParser
   char **gi_gir_path;
   GList *parsed_modules; /* All previously parsed modules */
   GLogLevelFlags logged_levels;
+
+  /* Included modules are looked up in, and parsed into, @dependency_parser
+   * if it is set; it may be shared with parsers in other threads, so @lock
+   * must be held while using it. */
+  GIIrParser *dependency_parser;  /* (nullable) (not owned) */
+  GRecMutex lock;
 };
 
 typedef enum
@@ -200,6 +206,7 @@ gi_ir_parser_new (void)
     parser->gi_gir_path = g_strsplit (gi_gir_path, G_SEARCHPATH_SEPARATOR_S, 0);
 
   parser->logged_levels = G_LOG_LEVEL_MASK & ~(G_LOG_LEVEL_MESSAGE | G_LOG_LEVEL_DEBUG);
+  g_rec_mutex_init (&parser->lock);
   return parser;
 }
 
@@ -217,6 +224,7 @@ gi_ir_parser_free (GIIrParser *parser)
   g_strfreev (parser->gi_gir_path);
 
   g_clear_list (&parser->parsed_modules, (GDestroyNotify) gi_ir_module_free);
+  g_rec_mutex_clear (&parser->lock);
 
   g_slice_free (GIIrParser, parser);
 }
@@ -230,6 +238,31 @@ gi_ir_parser_set_includes (GIIrParser         *parser,
   parser->includes = g_strdupv ((char **)includes);
 }
 
+/*< private >
+ * gi_ir_parser_set_dependency_parser:
+ * @parser: a #GIIrParser
+ * @dependency_parser: (nullable) (transfer none): parser to hold included
+ *   modules, or `NULL` to use @parser itself
+ *
+ * Makes @parser look up included GIRs in @dependency_parser, and parse them
+ * into it if they have not been parsed yet.
+ *
+ * This lets several parsers, possibly in different threads, share a single
+ * in-memory copy of each dependency. Building a typelib fills in the layout
+ * of the included types it uses, so the modules in @dependency_parser are
+ * given its lock as their #GIIrModule.shared_lock, which
+ * gi_ir_node_compute_offsets() holds while doing so. @dependency_parser must
+ * not be used to build typelibs itself, and must outlive @parser.
+ */
+void
+gi_ir_parser_set_dependency_parser (GIIrParser *parser,
+                                    GIIrParser *dependency_parser)
+{
+  g_return_if_fail (dependency_parser != parser);
+
+  parser->dependency_parser = dependency_parser;
+}
+
 static void
 firstpass_start_element_handler (GMarkupParseContext  *context,
                                  const char           *element_name,
@@ -2870,10 +2903,11 @@ start_discriminator (GMarkupParseContext  *context,
 }
 
 static gboolean
-parse_include (GMarkupParseContext *context,
-               ParseContext        *ctx,
-               const char          *name,
-               const char          *version)
+parse_include_into (GMarkupParseContext *context,
+                    ParseContext        *ctx,
+                    GIIrParser          *parser,
+                    const char          *name,
+                    const char          *version)
 {
   GError *error = NULL;
   char *buffer;
@@ -2882,7 +2916,7 @@ parse_include (GMarkupParseContext *context,
   GIIrModule *module;
   GList *l;
 
-  for (l = ctx->parser->parsed_modules; l; l = l->next)
+  for (l = parser->parsed_modules; l; l = l->next)
     {
       GIIrModule *m = l->data;
 
@@ -2904,7 +2938,7 @@ parse_include (GMarkupParseContext *context,
     }
 
   girname = g_strdup_printf ("%s-%s.gir", name, version);
-  girpath = locate_gir (ctx->parser, girname);
+  girpath = locate_gir (parser, girname);
 
   if (girpath == NULL)
     {
@@ -2925,7 +2959,7 @@ parse_include (GMarkupParseContext *context,
       return FALSE;
     }
 
-  module = gi_ir_parser_parse_string (ctx->parser, name, girpath, buffer, length, &error);
+  module = gi_ir_parser_parse_string (parser, name, girpath, buffer, length, &error);
   g_free (buffer);
   if (error != NULL)
     {
@@ -2944,6 +2978,36 @@ parse_include (GMarkupParseContext *context,
   return TRUE;
 }
 
+static gboolean
+parse_include (GMarkupParseContext *context,
+               ParseContext        *ctx,
+               const char          *name,
+               const char          *version)
+{
+  GIIrParser *dependency_parser = ctx->parser->dependency_parser;
+  GList *previous_modules;
+  gboolean ret;
+
+  if (dependency_parser == NULL)
+    return parse_include_into (context, ctx, ctx->parser, name, version);
+
+  /* Includes of the included GIR are parsed with @dependency_parser as their
+   * parser, so this does not recurse into taking the lock again. */
+  g_rec_mutex_lock (&dependency_parser->lock);
+  previous_modules = dependency_parser->parsed_modules;
+  ret = parse_include_into (context, ctx, dependency_parser, name, version);
+
+  /* Newly parsed modules are prepended. Only those are given the lock: the
+   * others may already be in use by other threads, and other threads can
+   * only reach the new ones once the lock is released. */
+  for (GList *l = dependency_parser->parsed_modules; l != previous_modules; l = l->next)
+    ((GIIrModule *) l->data)->shared_lock = &dependency_parser->lock;
+
+  g_rec_mutex_unlock (&dependency_parser->lock);
+
+  return ret;
+}
+
 static void
 start_element_handler (GMarkupParseContext  *context,
                        const char           *element_name,
@@ -3900,4 +3964,138 @@ gi_ir_parser_parse_file (GIIrParser   *parser,
   return module;
 }
 
+typedef struct
+{
+  GPtrArray *girnames;  /* (element-type filename) (owned) */
+  gboolean reached_namespace;
+} ScanIncludesData;
+
+static void
+scan_includes_start_element_handler (GMarkupParseContext  *context,
+                                     const char           *element_name,
+                                     const char          **attribute_names,
+                                     const char          **attribute_values,
+                                     void                 *user_data,
+                                     GError              **error)
+{
+  ScanIncludesData *data = user_data;
+
+  if (strcmp (element_name, "include") == 0)
+    {
+      const char *name = find_attribute ("name", attribute_names, attribute_values);
+      const char *version = find_attribute ("version", attribute_names, attribute_values);
+
+      if (name == NULL)
+        MISSING_ATTRIBUTE (context, error, element_name, "name");
+      else if (version == NULL)
+        MISSING_ATTRIBUTE (context, error, element_name, "version");
+      else
+        g_ptr_array_add (data->girnames, g_strdup_printf ("%s-%s.gir", name, version));
+    }
+  else if (strcmp (element_name, "namespace") == 0)
+    {
+      /* Includes all come before the namespace, so there is no need to read
+       * the rest of the file. */
+      data->reached_namespace = TRUE;
+      g_set_error_literal (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                           "Reached namespace");
+    }
+}
+
+static const GMarkupParser scan_includes_parser =
+{
+  scan_includes_start_element_handler,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+};
+
+/*< private >
+ * gi_ir_parser_list_dependencies:
+ * @parser: a #GIIrParser
+ * @filename: (type filename): GIR file to list the dependencies of
+ * @error: return location for a [type@GLib.Error], or `NULL`
+ *
+ * Find the GIR files which @filename includes, directly or indirectly, using
+ * the same search path as parsing @filename with @parser would.
+ *
+ * Only the `<include/>` elements are looked at, so this is much cheaper than
+ * parsing the files.
+ *
+ * Returns: (transfer full) (element-type filename): paths of the included GIR
+ *   files, in the order they were found, or `NULL` on error
+ */
+GPtrArray *
+gi_ir_parser_list_dependencies (GIIrParser  *parser,
+                                const char  *filename,
+                                GError     **error)
+{
+  GPtrArray *paths = g_ptr_array_new_with_free_func (g_free);
+  GHashTable *seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  ScanIncludesData data = { NULL, FALSE };
+  const char *path = filename;
+  size_t i = 0;
+
+  data.girnames = g_ptr_array_new_with_free_func (g_free);
 
+  while (path != NULL)
+    {
+      GMarkupParseContext *context;
+      char *buffer;
+      gsize length;
+      GError *local_error = NULL;
+
+      if (!g_file_get_contents (path, &buffer, &length, error))
+        goto error;
+
+      data.reached_namespace = FALSE;
+      context = g_markup_parse_context_new (&scan_includes_parser, 0, &data, NULL);
+      if (!g_markup_parse_context_parse (context, buffer, length, &local_error) &&
+          !data.reached_namespace)
+        {
+          g_propagate_prefixed_error (error, g_steal_pointer (&local_error), "%s: ", path);
+          g_markup_parse_context_free (context);
+          g_free (buffer);
+          goto error;
+        }
+      g_clear_error (&local_error);
+      g_markup_parse_context_free (context);
+      g_free (buffer);
+
+      path = NULL;
+      while (path == NULL && i < data.girnames->len)
+        {
+          const char *girname = g_ptr_array_index (data.girnames, i++);
+          char *girpath;
+
+          if (g_hash_table_contains (seen, girname))
+            continue;
+          g_hash_table_add (seen, g_strdup (girname));
+
+          girpath = locate_gir (parser->dependency_parser ? parser->dependency_parser : parser,
+                                girname);
+          if (girpath == NULL)
+            {
+              g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                           "Could not find GIR file ‘%s’", girname);
+              goto error;
+            }
+
+          g_ptr_array_add (paths, girpath);
+          path = girpath;
+        }
+    }
+
+  g_ptr_array_unref (data.girnames);
+  g_hash_table_unref (seen);
+
+  return paths;
+
+error:
+  g_ptr_array_unref (data.girnames);
+  g_hash_table_unref (seen);
+  g_ptr_array_unref (paths);
+
+  return NULL;
+}
@@ -335,6 +335,9 @@ typedef struct {
  * SectionType:
  * @GI_SECTION_END: TODO
  * @GI_SECTION_DIRECTORY_INDEX: TODO
+ * @GI_SECTION_GTYPE_INDEX: Perfect hash from the [type@GObject.Type] names
+ *   of the local registered types to their directory index, preceded by
+ *   the number of names as a `uint32_t`. Since: 2.82
  *
  * TODO
  *
@@ -342,7 +345,8 @@ typedef struct {
  */
 typedef enum {
   GI_SECTION_END = 0,
-  GI_SECTION_DIRECTORY_INDEX = 1
+  GI_SECTION_DIRECTORY_INDEX = 1,
+  GI_SECTION_GTYPE_INDEX = 2
 } SectionType;
 
 /**
@@ -351,8 +355,8 @@ typedef enum {
  * @offset: Integer offset for this section
  *
  * A section is a blob of data that's (at least theoretically) optional,
- * and may or may not be present in the typelib.  Presently, just used
- * for the directory index.  This allows a form of dynamic extensibility
+ * and may or may not be present in the typelib.  Presently, used for
+ * the directory and GType indexes.  This allows a form of dynamic extensibility
  * with different tradeoffs from the format minor version.
  *
  * Since: 2.80
@@ -1321,6 +1325,11 @@ struct _GITypelib {
   GList *modules;
   gboolean open_attempted;
   GPtrArray *library_paths;  /* (element-type filename) (owned) (nullable) */
+
+  /* Prepared invocation state for callables in this typelib, keyed by blob
+   * offset. See gi_callable_info_get_invoke_cache(). */
+  GMutex invoke_cache_lock;
+  GHashTable *invoke_cache;  /* (element-type uint32_t GICallableInvokeCache) (owned) (nullable) (locked-by invoke_cache_lock) */
 };
 
 DirEntry *gi_typelib_get_dir_entry (GITypelib *typelib,
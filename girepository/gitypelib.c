@@ -249,6 +249,33 @@ gi_typelib_get_dir_entry_by_gtype_name (GITypelib   *typelib,
                                         const char  *gtype_name)
 {
   Header *header = (Header *)typelib->data;
+  Section *gtype_index;
+
+  gtype_index = get_section_by_id (typelib, GI_SECTION_GTYPE_INDEX);
+  if (gtype_index != NULL)
+    {
+      uint8_t *data = (uint8_t *) &typelib->data[gtype_index->offset];
+      uint32_t n_gtypes = *(uint32_t *) data;
+      RegisteredTypeBlob *blob;
+      DirEntry *entry;
+      uint16_t index;
+
+      index = gi_typelib_hash_search (data + sizeof (uint32_t), gtype_name, n_gtypes);
+      if (index >= header->n_local_entries)
+        return NULL;
+
+      /* The hash gives an arbitrary entry for unknown names, so check it */
+      entry = gi_typelib_get_dir_entry (typelib, index + 1);
+      if (!BLOB_IS_REGISTERED_TYPE (entry))
+        return NULL;
+
+      blob = (RegisteredTypeBlob *)(&typelib->data[entry->offset]);
+      if (blob->gtype_name &&
+          strcmp (gi_typelib_get_string (typelib, blob->gtype_name), gtype_name) == 0)
+        return entry;
+
+      return NULL;
+    }
 
   for (size_t i = 1; i <= header->n_local_entries; i++)
     {
@@ -2361,6 +2388,7 @@ gi_typelib_new_from_bytes (GBytes *bytes,
   meta->data = data;
   meta->len = len;
   meta->modules = NULL;
+  g_mutex_init (&meta->invoke_cache_lock);
 
   return meta;
 }
@@ -2405,6 +2433,9 @@ gi_typelib_unref (GITypelib *typelib)
 
       g_clear_pointer (&typelib->library_paths, g_ptr_array_unref);
 
+      g_clear_pointer (&typelib->invoke_cache, g_hash_table_unref);
+      g_mutex_clear (&typelib->invoke_cache_lock);
+
       if (typelib->modules)
         {
           g_list_foreach (typelib->modules, (GFunc) (void *) g_module_close, NULL);
@@ -116,6 +116,8 @@ gi_typelib_hash_builder_prepare (GITypelibHashBuilder *builder)
   config = cmph_config_new (io);
   cmph_config_set_algo (config, CMPH_BDZ);
 
+  /* Make the output reproducible, however many hashes were built before */
+  cmph_reset_random ();
   builder->c = cmph_new (config);
   builder->prepared = TRUE;
   if (!builder->c)
@@ -0,0 +1,376 @@
+/*
+ * Copyright 2024 GNOME Foundation, Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+/* Tests for compiling several GIR files with one gi-compile-repository run */
+
+#define N_DEP_RECORDS 300
+#define N_INPUTS 8
+
+static char *
+get_compiler_path (void)
+{
+#ifdef G_OS_WIN32
+  return g_test_build_filename (G_TEST_BUILT, "..", "compiler", "gi-compile-repository.exe", NULL);
+#else
+  return g_test_build_filename (G_TEST_BUILT, "..", "compiler", "gi-compile-repository", NULL);
+#endif
+}
+
+static void
+rm_rf (const char *path)
+{
+  GDir *dir = g_dir_open (path, 0, NULL);
+
+  if (dir != NULL)
+    {
+      const char *name;
+
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          char *child = g_build_filename (path, name, NULL);
+          rm_rf (child);
+          g_free (child);
+        }
+
+      g_dir_close (dir);
+      g_rmdir (path);
+    }
+  else
+    {
+      g_remove (path);
+    }
+}
+
+static void
+write_gir (const char *dir,
+           const char *namespace,
+           const char *include,
+           const char *body)
+{
+  GString *gir = g_string_new (NULL);
+  char *basename, *path;
+  char *lower = g_ascii_strdown (namespace, -1);
+  GError *local_error = NULL;
+
+  g_string_append (gir,
+                   "<?xml version=\"1.0\"?>\n"
+                   "<repository version=\"1.2\" "
+                   "xmlns=\"http://www.gtk.org/introspection/core/1.0\" "
+                   "xmlns:c=\"http://www.gtk.org/introspection/c/1.0\" "
+                   "xmlns:glib=\"http://www.gtk.org/introspection/glib/1.0\">\n");
+  if (include != NULL)
+    g_string_append_printf (gir, "  <include name=\"%s\" version=\"1.0\"/>\n", include);
+  g_string_append_printf (gir,
+                          "  <namespace name=\"%s\" version=\"1.0\" shared-library=\"lib%s.so\" "
+                          "c:identifier-prefixes=\"%s\" c:symbol-prefixes=\"%s\">\n",
+                          namespace, lower, namespace, lower);
+  g_string_append (gir, body);
+  g_string_append (gir, "  </namespace>\n</repository>\n");
+
+  basename = g_strdup_printf ("%s-1.0.gir", namespace);
+  path = g_build_filename (dir, basename, NULL);
+  g_file_set_contents (path, gir->str, gir->len, &local_error);
+  g_assert_no_error (local_error);
+
+  g_free (path);
+  g_free (basename);
+  g_free (lower);
+  g_string_free (gir, TRUE);
+}
+
+/* Writes Dep-1.0.gir, whose records each embed the previous one, and
+ * N_INPUTS GIRs whose records embed records from Dep. Building the inputs
+ * computes the layout of the Dep records, which are shared between them. */
+static void
+write_girs (const char *dir,
+            const char *dep_field_type)
+{
+  GString *body = g_string_new (NULL);
+
+  for (unsigned int i = 0; i < N_DEP_RECORDS; i++)
+    {
+      g_string_append_printf (body,
+                              "    <record name=\"S%u\" c:type=\"DepS%u\">"
+                              "<field name=\"x\" writable=\"1\"><type name=\"%s\"/></field>",
+                              i, i, dep_field_type);
+      if (i > 0)
+        g_string_append_printf (body,
+                                "<field name=\"prev\" writable=\"1\"><type name=\"S%u\" c:type=\"DepS%u\"/></field>",
+                                i - 1, i - 1);
+      g_string_append (body, "</record>\n");
+    }
+  write_gir (dir, "Dep", NULL, body->str);
+
+  for (unsigned int n = 0; n < N_INPUTS; n++)
+    {
+      char *namespace = g_strdup_printf ("In%u", n);
+
+      g_string_truncate (body, 0);
+      for (unsigned int i = 0; i < N_DEP_RECORDS; i++)
+        {
+          unsigned int dep = (i * 37 + n * 101) % N_DEP_RECORDS;
+          g_string_append_printf (body,
+                                  "    <record name=\"S%u\" c:type=\"In%uS%u\">"
+                                  "<field name=\"dep\" writable=\"1\"><type name=\"Dep.S%u\" c:type=\"DepS%u\"/></field>"
+                                  "</record>\n",
+                                  i, n, i, dep, dep);
+        }
+      write_gir (dir, namespace, "Dep", body->str);
+
+      g_free (namespace);
+    }
+
+  g_string_free (body, TRUE);
+}
+
+/* Runs the compiler in @dir with the given arguments, and returns whether it
+ * succeeded. Its output, including debug messages, is returned in @output_out. */
+static gboolean
+run_compiler (const char   *dir,
+              const char  **args,
+              char        **output_out)
+{
+  GPtrArray *argv = g_ptr_array_new_with_free_func (g_free);
+  char **envp = g_environ_setenv (g_get_environ (), "G_MESSAGES_DEBUG", "all", TRUE);
+  char *out = NULL, *err = NULL;
+  GError *local_error = NULL;
+  int wait_status;
+  gboolean success;
+
+  g_ptr_array_add (argv, get_compiler_path ());
+  g_ptr_array_add (argv, g_strdup ("--includedir"));
+  g_ptr_array_add (argv, g_strdup ("."));
+  for (; *args != NULL; args++)
+    g_ptr_array_add (argv, g_strdup (*args));
+  g_ptr_array_add (argv, NULL);
+
+  g_spawn_sync (dir, (char **) argv->pdata, envp, G_SPAWN_DEFAULT,
+                NULL, NULL, &out, &err, &wait_status, &local_error);
+  g_assert_no_error (local_error);
+
+  success = g_spawn_check_wait_status (wait_status, NULL);
+  if (!success)
+    g_test_message ("Compiler failed: %s", err);
+
+  if (output_out != NULL)
+    *output_out = g_strconcat (out, err, NULL);
+
+  g_free (err);
+  g_free (out);
+  g_strfreev (envp);
+  g_ptr_array_unref (argv);
+
+  return success;
+}
+
+static GBytes *
+load_typelib (const char *dir,
+              const char *subdir,
+              unsigned int n)
+{
+  char *basename = g_strdup_printf ("In%u-1.0.typelib", n);
+  char *path = g_build_filename (dir, subdir, basename, NULL);
+  char *contents;
+  gsize length;
+  GError *local_error = NULL;
+
+  g_file_get_contents (path, &contents, &length, &local_error);
+  g_assert_no_error (local_error);
+
+  g_free (path);
+  g_free (basename);
+
+  return g_bytes_new_take (contents, length);
+}
+
+static void
+assert_same_typelibs (const char *dir,
+                      const char *subdir1,
+                      const char *subdir2)
+{
+  for (unsigned int n = 0; n < N_INPUTS; n++)
+    {
+      GBytes *typelib1 = load_typelib (dir, subdir1, n);
+      GBytes *typelib2 = load_typelib (dir, subdir2, n);
+
+      g_assert_true (g_bytes_equal (typelib1, typelib2));
+
+      g_bytes_unref (typelib2);
+      g_bytes_unref (typelib1);
+    }
+}
+
+/* Compiles each input with its own compiler run, as a baseline */
+static void
+compile_serially (const char *dir,
+                  const char *subdir)
+{
+  char *output_dir = g_build_filename (dir, subdir, NULL);
+
+  g_assert_cmpint (g_mkdir_with_parents (output_dir, 0755), ==, 0);
+
+  for (unsigned int n = 0; n < N_INPUTS; n++)
+    {
+      char *input = g_strdup_printf ("In%u-1.0.gir", n);
+      char *output = g_strdup_printf ("%s/In%u-1.0.typelib", subdir, n);
+      const char *args[] = { "-o", output, input, NULL };
+
+      g_assert_true (run_compiler (dir, args, NULL));
+
+      g_free (output);
+      g_free (input);
+    }
+
+  g_free (output_dir);
+}
+
+static unsigned int
+count_files (const char *dir,
+             const char *subdir)
+{
+  char *path = g_build_filename (dir, subdir, NULL);
+  GDir *d = g_dir_open (path, 0, NULL);
+  unsigned int n = 0;
+
+  g_assert_nonnull (d);
+  while (g_dir_read_name (d) != NULL)
+    n++;
+
+  g_dir_close (d);
+  g_free (path);
+
+  return n;
+}
+
+static unsigned int
+count_occurrences (const char *haystack,
+                   const char *needle)
+{
+  unsigned int n = 0;
+
+  while ((haystack = strstr (haystack, needle)) != NULL)
+    {
+      haystack += strlen (needle);
+      n++;
+    }
+
+  return n;
+}
+
+#define INPUTS "In0-1.0.gir", "In1-1.0.gir", "In2-1.0.gir", "In3-1.0.gir", \
+               "In4-1.0.gir", "In5-1.0.gir", "In6-1.0.gir", "In7-1.0.gir"
+G_STATIC_ASSERT (N_INPUTS == 8);
+
+static void
+test_output_dir (void)
+{
+  GError *local_error = NULL;
+  char *dir;
+  const char *batch_args[] = { "--output-dir", "batch", "--jobs", "1", INPUTS, NULL };
+  const char *parallel_args[] = { "--output-dir", "parallel", "--jobs", "4", INPUTS, NULL };
+  const char *no_output_dir_args[] = { "-o", "x.typelib", INPUTS, NULL };
+
+  g_test_summary ("Test that compiling several GIRs in one run, serially or in "
+                  "parallel, gives the same typelibs as separate runs");
+
+  dir = g_dir_make_tmp ("gi-compile-repository-XXXXXX", &local_error);
+  g_assert_no_error (local_error);
+
+  write_girs (dir, "gint");
+  compile_serially (dir, "single");
+
+  g_assert_true (run_compiler (dir, batch_args, NULL));
+  assert_same_typelibs (dir, "single", "batch");
+
+  /* The inputs share the in-memory copy of Dep, and compute the layout of
+   * its records from several threads. Run a few times, as races are not
+   * deterministic. */
+  for (unsigned int i = 0; i < 5; i++)
+    {
+      g_assert_true (run_compiler (dir, parallel_args, NULL));
+      assert_same_typelibs (dir, "single", "parallel");
+    }
+
+  g_assert_false (run_compiler (dir, no_output_dir_args, NULL));
+
+  rm_rf (dir);
+  g_free (dir);
+}
+
+static void
+test_cache_dir (void)
+{
+  GError *local_error = NULL;
+  char *dir, *output = NULL;
+  const char *args[] = { "--debug", "--output-dir", "out", "--cache-dir", "cache", "--jobs", "2", INPUTS, NULL };
+
+  g_test_summary ("Test that --cache-dir reuses typelibs only while the inputs "
+                  "and their dependencies are unchanged");
+
+  dir = g_dir_make_tmp ("gi-compile-repository-XXXXXX", &local_error);
+  g_assert_no_error (local_error);
+
+  write_girs (dir, "gint");
+  compile_serially (dir, "single");
+
+  /* Nothing cached yet */
+  g_assert_true (run_compiler (dir, args, &output));
+  g_assert_cmpuint (count_occurrences (output, "is up to date"), ==, 0);
+  g_assert_cmpuint (count_files (dir, "cache"), ==, N_INPUTS);
+  assert_same_typelibs (dir, "single", "out");
+  g_clear_pointer (&output, g_free);
+
+  /* Everything cached */
+  g_assert_true (run_compiler (dir, args, &output));
+  g_assert_cmpuint (count_occurrences (output, "is up to date"), ==, N_INPUTS);
+  assert_same_typelibs (dir, "single", "out");
+  g_clear_pointer (&output, g_free);
+
+  /* Changing the layout of the shared dependency must invalidate all of them */
+  write_girs (dir, "gint64");
+  compile_serially (dir, "single");
+
+  g_assert_true (run_compiler (dir, args, &output));
+  g_assert_cmpuint (count_occurrences (output, "is up to date"), ==, 0);
+  g_assert_cmpuint (count_files (dir, "cache"), ==, 2 * N_INPUTS);
+  assert_same_typelibs (dir, "single", "out");
+  g_clear_pointer (&output, g_free);
+
+  rm_rf (dir);
+  g_free (dir);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/compiler/output-dir", test_output_dir);
+  g_test_add_func ("/compiler/cache-dir", test_cache_dir);
+
+  return g_test_run ();
+}
@@ -45,6 +45,85 @@ test_function_info_invoker (RepositoryFixture *fx,
   g_clear_pointer (&function_info, gi_base_info_unref);
 }
 
+static void
+test_function_info_invoke (RepositoryFixture *fx,
+                           const void *unused)
+{
+  GIFunctionInfo *function_info = NULL;
+  GIArgument in_args[2];
+  GIArgument return_value;
+  GError *local_error = NULL;
+  gboolean success;
+  unsigned int i;
+
+  g_test_summary ("Test invoking a function repeatedly, including with mismatched arguments");
+
+  for (i = 0; i < 3; i++)
+    {
+      /* Use a new info each time, as the prepared invocation state is
+       * shared between them. */
+      function_info = GI_FUNCTION_INFO (gi_repository_find_by_name (fx->repository, "GLib", "ascii_digit_value"));
+      g_assert_nonnull (function_info);
+
+      in_args[0].v_int8 = '7';
+      success = gi_function_info_invoke (function_info, in_args, 1, NULL, 0, &return_value, &local_error);
+      g_assert_no_error (local_error);
+      g_assert_true (success);
+      g_assert_cmpint (return_value.v_int32, ==, 7);
+
+      success = gi_function_info_invoke (function_info, in_args, 0, NULL, 0, &return_value, &local_error);
+      g_assert_error (local_error, GI_INVOKE_ERROR, GI_INVOKE_ERROR_ARGUMENT_MISMATCH);
+      g_assert_false (success);
+      g_clear_error (&local_error);
+
+      in_args[1].v_int8 = '8';
+      success = gi_function_info_invoke (function_info, in_args, 2, NULL, 0, &return_value, &local_error);
+      g_assert_error (local_error, GI_INVOKE_ERROR, GI_INVOKE_ERROR_ARGUMENT_MISMATCH);
+      g_assert_false (success);
+      g_clear_error (&local_error);
+
+      g_clear_pointer (&function_info, gi_base_info_unref);
+    }
+}
+
+static void
+test_function_info_invoke_performance (RepositoryFixture *fx,
+                                       const void *unused)
+{
+  GIFunctionInfo *function_info = NULL;
+  GIArgument in_arg;
+  GIArgument return_value;
+  GError *local_error = NULL;
+  unsigned int i, n_iterations;
+  GTimer *timer;
+  double elapsed;
+
+  g_test_summary ("Benchmark repeated calls to gi_function_info_invoke()");
+
+  n_iterations = g_test_perf () ? 10000000 : 10000;
+
+  function_info = GI_FUNCTION_INFO (gi_repository_find_by_name (fx->repository, "GLib", "ascii_digit_value"));
+  g_assert_nonnull (function_info);
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      in_arg.v_int8 = '0' + i % 10;
+      if (!gi_function_info_invoke (function_info, &in_arg, 1, NULL, 0, &return_value, &local_error))
+        break;
+      g_assert_cmpint (return_value.v_int32, ==, (int) (i % 10));
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_assert_no_error (local_error);
+
+  g_test_minimized_result (elapsed * 1e9 / n_iterations, "%.1f ns per call", elapsed * 1e9 / n_iterations);
+
+  g_timer_destroy (timer);
+  g_clear_pointer (&function_info, gi_base_info_unref);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -52,6 +131,8 @@ main (int   argc,
   repository_init (&argc, &argv);
 
   ADD_REPOSITORY_TEST ("/function-info/invoker", test_function_info_invoker, &typelib_load_spec_glib);
+  ADD_REPOSITORY_TEST ("/function-info/invoke", test_function_info_invoke, &typelib_load_spec_glib);
+  ADD_REPOSITORY_TEST ("/function-info/invoke/performance", test_function_info_invoke_performance, &typelib_load_spec_glib);
 
   return g_test_run ();
 }
@@ -57,12 +57,56 @@ test_build_retrieve (void)
   g_free (buf);
 }
 
+static uint8_t *
+build_hash (uint32_t *bufsize)
+{
+  GITypelibHashBuilder *builder;
+  uint8_t *buf;
+
+  builder = gi_typelib_hash_builder_new ();
+
+  for (unsigned int i = 0; i < 100; i++)
+    {
+      char *name = g_strdup_printf ("Type%u", i);
+      gi_typelib_hash_builder_add_string (builder, name, i);
+      g_free (name);
+    }
+
+  g_assert_true (gi_typelib_hash_builder_prepare (builder));
+
+  *bufsize = gi_typelib_hash_builder_get_buffer_size (builder);
+  buf = g_malloc (*bufsize);
+  gi_typelib_hash_builder_pack (builder, buf, *bufsize);
+
+  gi_typelib_hash_builder_destroy (builder);
+
+  return buf;
+}
+
+static void
+test_reproducible (void)
+{
+  uint8_t *buf1, *buf2;
+  uint32_t bufsize1, bufsize2;
+
+  g_test_summary ("Test that building the same hash twice in a process gives the same output");
+
+  buf1 = build_hash (&bufsize1);
+  buf2 = build_hash (&bufsize2);
+
+  g_assert_cmpmem (buf1, bufsize1, buf2, bufsize2);
+
+  g_free (buf2);
+  g_free (buf1);
+}
+
 int
 main(int argc, char **argv)
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/gthash/build-retrieve", test_build_retrieve);
+  g_test_add_func ("/gthash/reproducible", test_reproducible);
 
   return g_test_run ();
 }
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2024 GNOME Foundation, Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "girepository.h"
+#include "gitypelib-internal.h"
+
+/* Tests for the GType index section emitted by gi-compile-repository */
+
+static char *
+get_compiler_path (void)
+{
+#ifdef G_OS_WIN32
+  return g_test_build_filename (G_TEST_BUILT, "..", "compiler", "gi-compile-repository.exe", NULL);
+#else
+  return g_test_build_filename (G_TEST_BUILT, "..", "compiler", "gi-compile-repository", NULL);
+#endif
+}
+
+static void
+rm_rf (const char *path)
+{
+  GDir *dir = g_dir_open (path, 0, NULL);
+
+  if (dir != NULL)
+    {
+      const char *name;
+
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          char *child = g_build_filename (path, name, NULL);
+          rm_rf (child);
+          g_free (child);
+        }
+
+      g_dir_close (dir);
+      g_rmdir (path);
+    }
+  else
+    {
+      g_remove (path);
+    }
+}
+
+static void
+write_gir (const char *dir,
+           const char *namespace,
+           const char *body)
+{
+  GString *gir = g_string_new (NULL);
+  char *basename, *path;
+  char *lower = g_ascii_strdown (namespace, -1);
+  GError *local_error = NULL;
+
+  g_string_append (gir,
+                   "<?xml version=\"1.0\"?>\n"
+                   "<repository version=\"1.2\" "
+                   "xmlns=\"http://www.gtk.org/introspection/core/1.0\" "
+                   "xmlns:c=\"http://www.gtk.org/introspection/c/1.0\" "
+                   "xmlns:glib=\"http://www.gtk.org/introspection/glib/1.0\">\n");
+  g_string_append_printf (gir,
+                          "  <namespace name=\"%s\" version=\"1.0\" shared-library=\"lib%s.so\" "
+                          "c:identifier-prefixes=\"%s\" c:symbol-prefixes=\"%s\">\n",
+                          namespace, lower, namespace, lower);
+  g_string_append (gir, body);
+  g_string_append (gir, "  </namespace>\n</repository>\n");
+
+  basename = g_strdup_printf ("%s-1.0.gir", namespace);
+  path = g_build_filename (dir, basename, NULL);
+  g_file_set_contents (path, gir->str, gir->len, &local_error);
+  g_assert_no_error (local_error);
+
+  g_free (path);
+  g_free (basename);
+  g_free (lower);
+  g_string_free (gir, TRUE);
+}
+
+/* Runs the compiler in @dir with the given arguments, and returns whether it
+ * succeeded */
+static gboolean
+run_compiler (const char  *dir,
+              const char **args)
+{
+  GPtrArray *argv = g_ptr_array_new_with_free_func (g_free);
+  char *err = NULL;
+  GError *local_error = NULL;
+  int wait_status;
+  gboolean success;
+
+  g_ptr_array_add (argv, get_compiler_path ());
+  g_ptr_array_add (argv, g_strdup ("--includedir"));
+  g_ptr_array_add (argv, g_strdup ("."));
+  for (; *args != NULL; args++)
+    g_ptr_array_add (argv, g_strdup (*args));
+  g_ptr_array_add (argv, NULL);
+
+  g_spawn_sync (dir, (char **) argv->pdata, NULL, G_SPAWN_DEFAULT,
+                NULL, NULL, NULL, &err, &wait_status, &local_error);
+  g_assert_no_error (local_error);
+
+  success = g_spawn_check_wait_status (wait_status, NULL);
+  if (!success)
+    g_test_message ("Compiler failed: %s", err);
+
+  g_free (err);
+  g_ptr_array_unref (argv);
+
+  return success;
+}
+
+#define N_GTYPE_RECORDS 50
+
+static gpointer
+boxed_copy (gpointer boxed)
+{
+  return boxed;
+}
+
+static void
+boxed_free (gpointer boxed)
+{
+}
+
+/* Returns the GType index section of @typelib_bytes, or %NULL */
+static Section *
+get_gtype_index_section (GBytes *typelib_bytes)
+{
+  const uint8_t *data = g_bytes_get_data (typelib_bytes, NULL);
+  const Header *header = (const Header *) data;
+  Section *section;
+
+  g_assert_cmpuint (header->sections, !=, 0);
+
+  for (section = (Section *) &data[header->sections]; section->id != GI_SECTION_END; section++)
+    {
+      if (section->id == GI_SECTION_GTYPE_INDEX)
+        return section;
+    }
+
+  return NULL;
+}
+
+/* Returns the name of the entry gi_repository_find_by_gtype() gives for
+ * @gtype_name in @typelib_bytes, loaded into a new repository */
+static char *
+find_by_gtype_name (GBytes     *typelib_bytes,
+                    const char *gtype_name)
+{
+  GIRepository *repository = gi_repository_new ();
+  GITypelib *typelib;
+  GIBaseInfo *info;
+  GError *local_error = NULL;
+  char *name = NULL;
+
+  typelib = gi_typelib_new_from_bytes (typelib_bytes, &local_error);
+  g_assert_no_error (local_error);
+  gi_repository_load_typelib (repository, typelib, 0, &local_error);
+  g_assert_no_error (local_error);
+
+  info = gi_repository_find_by_gtype (repository, g_type_from_name (gtype_name));
+  if (info != NULL)
+    {
+      name = g_strdup (gi_base_info_get_name (info));
+      gi_base_info_unref (info);
+    }
+
+  gi_typelib_unref (typelib);
+  g_object_unref (repository);
+
+  return name;
+}
+
+static void
+test_gtype_index (void)
+{
+  GError *local_error = NULL;
+  GString *body = g_string_new (NULL);
+  char *dir, *path, *contents;
+  gsize length;
+  GBytes *with_index, *without_index;
+  Section *section;
+  const char *args[] = { "-o", "Idx-1.0.typelib", "Idx-1.0.gir", NULL };
+  const char *unknown_names[] = { "IdxUnknown", "OtherPrefixUnknown" };
+
+  g_test_summary ("Test that the GType index section is emitted, and that "
+                  "gi_repository_find_by_gtype() gives the same results with "
+                  "and without it");
+
+  dir = g_dir_make_tmp ("gi-compile-repository-XXXXXX", &local_error);
+  g_assert_no_error (local_error);
+
+  for (unsigned int i = 0; i < N_GTYPE_RECORDS; i++)
+    g_string_append_printf (body,
+                            "    <record name=\"R%u\" c:type=\"IdxR%u\" "
+                            "glib:type-name=\"IdxR%u\" glib:get-type=\"idx_r%u_get_type\"/>\n"
+                            "    <record name=\"Plain%u\" c:type=\"IdxPlain%u\"/>\n",
+                            i, i, i, i, i, i);
+  /* two entries registering the same GType name */
+  g_string_append (body,
+                   "    <record name=\"Dup1\" c:type=\"IdxDup1\" "
+                   "glib:type-name=\"IdxDup\" glib:get-type=\"idx_dup_get_type\"/>\n"
+                   "    <record name=\"Dup2\" c:type=\"IdxDup2\" "
+                   "glib:type-name=\"IdxDup\" glib:get-type=\"idx_dup_get_type\"/>\n");
+  write_gir (dir, "Idx", body->str);
+  g_string_free (body, TRUE);
+
+  g_assert_true (run_compiler (dir, args));
+
+  path = g_build_filename (dir, "Idx-1.0.typelib", NULL);
+  g_file_get_contents (path, &contents, &length, &local_error);
+  g_assert_no_error (local_error);
+  with_index = g_bytes_new_take (contents, length);
+  g_free (path);
+
+  section = get_gtype_index_section (with_index);
+  g_assert_nonnull (section);
+  g_assert_cmpuint (section->offset, <, length);
+
+  /* A typelib from an older compiler has no such section: end the section
+   * table before it, so that lookups take the linear path */
+  contents = g_memdup2 (contents, length);
+  without_index = g_bytes_new_take (contents, length);
+  section = get_gtype_index_section (without_index);
+  section->id = GI_SECTION_END;
+  g_assert_null (get_gtype_index_section (without_index));
+
+  for (unsigned int i = 0; i < N_GTYPE_RECORDS; i++)
+    {
+      char *gtype_name = g_strdup_printf ("IdxR%u", i);
+      char *expected = g_strdup_printf ("R%u", i);
+      char *name;
+
+      g_boxed_type_register_static (gtype_name, boxed_copy, boxed_free);
+
+      name = find_by_gtype_name (with_index, gtype_name);
+      g_assert_cmpstr (name, ==, expected);
+      g_free (name);
+
+      name = find_by_gtype_name (without_index, gtype_name);
+      g_assert_cmpstr (name, ==, expected);
+      g_free (name);
+
+      g_free (expected);
+      g_free (gtype_name);
+    }
+
+  /* The index keeps the same entry for a duplicate name as the linear
+   * search finds */
+  g_boxed_type_register_static ("IdxDup", boxed_copy, boxed_free);
+  {
+    char *name = find_by_gtype_name (with_index, "IdxDup");
+    char *linear_name = find_by_gtype_name (without_index, "IdxDup");
+
+    g_assert_nonnull (linear_name);
+    g_assert_true (g_str_equal (linear_name, "Dup1") || g_str_equal (linear_name, "Dup2"));
+    g_assert_cmpstr (name, ==, linear_name);
+
+    g_free (linear_name);
+    g_free (name);
+  }
+
+  for (size_t i = 0; i < G_N_ELEMENTS (unknown_names); i++)
+    {
+      char *name;
+
+      g_boxed_type_register_static (unknown_names[i], boxed_copy, boxed_free);
+
+      name = find_by_gtype_name (with_index, unknown_names[i]);
+      g_assert_null (name);
+
+      name = find_by_gtype_name (without_index, unknown_names[i]);
+      g_assert_null (name);
+    }
+
+  g_bytes_unref (without_index);
+  g_bytes_unref (with_index);
+  rm_rf (dir);
+  g_free (dir);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/gtype-index/find-by-gtype", test_gtype_index);
+
+  return g_test_run ();
+}
@@ -165,6 +165,8 @@ typedef struct
   gsize n_buckets;
 } HashTable;
 
+#define BLOOM_SHIFT 5
+
 static HashTable *
 hash_table_new (gsize n_buckets)
 {
@@ -342,13 +344,29 @@ file_builder_allocate_for_hash (FileBuilder            *fb,
   memset (*bloom_filter, 0, n_bloom_words * sizeof (guint32_le));
   memset (*hash_buckets, 0, n_buckets * sizeof (guint32_le));
   memset (*hash_items, 0, n_items * sizeof (struct gvdb_hash_item));
+}
 
-  /* NOTE - the code to actually fill in the bloom filter here is missing.
-   * Patches welcome!
-   *
-   * http://en.wikipedia.org/wiki/Bloom_filter
-   * http://0pointer.de/blog/projects/bloom.html
-   */
+/* Sets the two bits for @hash_value in the bloom filter.  The reader
+ * checks the same two bits to reject most missing keys without looking
+ * at the hash table.  Readers that ignore the shift only check the first
+ * bit, which is always set too, so they keep working.
+ *
+ * http://en.wikipedia.org/wiki/Bloom_filter
+ * http://0pointer.de/blog/projects/bloom.html
+ */
+static void
+bloom_filter_add (guint32_le *bloom_filter,
+                  gsize       n_bloom_words,
+                  guint       bloom_shift,
+                  guint32     hash_value)
+{
+  guint32 word, mask;
+
+  word = (hash_value / 32) % n_bloom_words;
+  mask = 1u << (hash_value & 31);
+  mask |= 1u << ((hash_value >> bloom_shift) & 31);
+
+  bloom_filter[word] = guint32_to_le (guint32_from_le (bloom_filter[word]) | mask);
 }
 
 static void
@@ -362,6 +380,7 @@ file_builder_add_hash (FileBuilder         *fb,
   GvdbItem *item;
   guint32 index;
   gsize bucket;
+  gsize n_bloom_words;
 
   mytable = hash_table_new (g_hash_table_size (table));
   g_hash_table_foreach (table, hash_table_insert, mytable);
@@ -371,7 +390,12 @@ file_builder_add_hash (FileBuilder         *fb,
     for (item = mytable->buckets[bucket]; item; item = item->next)
       item->assigned_index = guint32_to_le (index++);
 
-  file_builder_allocate_for_hash (fb, mytable->n_buckets, index, 5, 0,
+  /* About 8 bits per item, which rejects roughly 95% of the lookups
+   * for missing keys */
+  n_bloom_words = (index + 3) / 4;
+
+  file_builder_allocate_for_hash (fb, mytable->n_buckets, index,
+                                  BLOOM_SHIFT, n_bloom_words,
                                   &bloom_filter, &buckets, &items, pointer);
 
   index = 0;
@@ -386,6 +410,8 @@ file_builder_add_hash (FileBuilder         *fb,
 
           g_assert (index == guint32_from_le (item->assigned_index));
           entry->hash_value = guint32_to_le (item->hash_value);
+          bloom_filter_add (bloom_filter, n_bloom_words, BLOOM_SHIFT,
+                            item->hash_value);
           entry->parent = item_to_index (item->parent);
           entry->unused = 0;
 
@@ -96,6 +96,7 @@ gvdb_table_setup_root (GvdbTable                 *file,
 
   n_bloom_words = guint32_from_le (header->n_bloom_words);
   n_buckets = guint32_from_le (header->n_buckets);
+  file->bloom_shift = n_bloom_words >> 27;
   n_bloom_words &= (1u << 27) - 1;
 
   if G_UNLIKELY (n_bloom_words * sizeof (guint32_le) > size)
@@ -231,8 +232,8 @@ gvdb_table_bloom_filter (GvdbTable *file,
     return TRUE;
 
   word = (hash_value / 32) % file->n_bloom_words;
-  mask = 1 << (hash_value & 31);
-  mask |= 1 << ((hash_value >> file->bloom_shift) & 31);
+  mask = 1u << (hash_value & 31);
+  mask |= 1u << ((hash_value >> file->bloom_shift) & 31);
 
   return (guint32_from_le (file->bloom_words[word]) & mask) == mask;
 }
@@ -243,30 +244,34 @@ gvdb_table_check_name (GvdbTable             *file,
                        const gchar           *key,
                        guint                  key_length)
 {
-  const gchar *this_key;
-  gsize this_size;
-  guint32 parent;
+  /* Walk up the parent chain, matching each item's part of the name
+   * against the end of what is left of @key.  Every step consumes at
+   * least one byte of @key, so this terminates even on corrupt files. */
+  while (TRUE)
+    {
+      const gchar *this_key;
+      gsize this_size;
+      guint32 parent;
 
-  this_key = gvdb_table_item_get_key (file, item, &this_size);
+      this_key = gvdb_table_item_get_key (file, item, &this_size);
 
-  if G_UNLIKELY (this_key == NULL || this_size > key_length)
-    return FALSE;
+      if G_UNLIKELY (this_key == NULL || this_size > key_length)
+        return FALSE;
 
-  key_length -= this_size;
+      key_length -= this_size;
 
-  if G_UNLIKELY (memcmp (this_key, key + key_length, this_size) != 0)
-    return FALSE;
+      if G_UNLIKELY (memcmp (this_key, key + key_length, this_size) != 0)
+        return FALSE;
 
-  parent = guint32_from_le (item->parent);
-  if (key_length == 0 && parent == 0xffffffffu)
-    return TRUE;
+      parent = guint32_from_le (item->parent);
+      if (key_length == 0 && parent == 0xffffffffu)
+        return TRUE;
 
-  if G_LIKELY (parent < file->n_hash_items && this_size > 0)
-    return gvdb_table_check_name (file,
-                                   &file->hash_items[parent],
-                                   key, key_length);
+      if G_UNLIKELY (parent >= file->n_hash_items || this_size == 0)
+        return FALSE;
 
-  return FALSE;
+      item = &file->hash_items[parent];
+    }
 }
 
 static const struct gvdb_hash_item *